@@ -46,6 +46,7 @@
 #include "session.h" /* to fetch the current user. */
 #include "vclock.h" /* VCLOCK_MAX */
 #include "memtx_tuple.h"
+#include "memtx_read_view.h"
 
 /** _space columns */
 #define ID               0
@@ -928,6 +929,19 @@ ModifySpace::prepare(struct alter_space *alter)
 			  space_name(alter->old_space),
 			  "can not switch temporary flag on a non-empty space");
 	}
+	/*
+	 * Secondary indexes may contain stale entries, which are
+	 * only filtered out on read while the flag is set. Vinyl
+	 * can't tell cheaply if a space is empty, so don't allow
+	 * to clear the flag once the space has a primary key.
+	 */
+	if (!def.opts.defer_deletes && alter->old_space->def.opts.defer_deletes &&
+	    space_index(alter->old_space, 0) != NULL) {
+		tnt_raise(ClientError, ER_ALTER_SPACE,
+			  space_name(alter->old_space),
+			  "can not disable defer_deletes flag of a space "
+			  "with indexes");
+	}
 }
 
 /** Amend the definition of the new space. */
@@ -1361,6 +1375,11 @@ on_replace_dd_space(struct trigger * /* trigger */, void *event)
 		txn_on_rollback(txn, on_rollback);
 	} else if (new_tuple == NULL) { /* DELETE */
 		access_check_ddl(old_space->def.uid, SC_SPACE);
+		if (memtx_read_view_has_space(old_id)) {
+			tnt_raise(ClientError, ER_DROP_SPACE,
+				  space_name(old_space),
+				  "the space is used by a read view");
+		}
 		/* Verify that the space is empty (has no indexes) */
 		if (old_space->index_count) {
 			tnt_raise(ClientError, ER_DROP_SPACE,
@@ -1382,6 +1401,11 @@ on_replace_dd_space(struct trigger * /* trigger */, void *event)
 		txn_on_commit(txn, on_commit);
 	} else { /* UPDATE, REPLACE */
 		assert(old_space != NULL && new_tuple != NULL);
+		if (memtx_read_view_has_space(old_id)) {
+			tnt_raise(ClientError, ER_ALTER_SPACE,
+				  space_name(old_space),
+				  "the space is used by a read view");
+		}
 		/*
 		 * Allow change of space properties, but do it
 		 * in WAL-error-safe mode.
@@ -1451,6 +1475,11 @@ on_replace_dd_index(struct trigger * /* trigger */, void *event)
 				       INDEX_ID);
 	struct space *old_space = space_cache_find(id);
 	access_check_ddl(old_space->def.uid, SC_SPACE);
+	if (memtx_read_view_has_space(id)) {
+		tnt_raise(ClientError, ER_ALTER_SPACE,
+			  space_name(old_space),
+			  "the space is used by a read view");
+	}
 	Index *old_index = space_index(old_space, iid);
 	struct alter_space *alter = alter_space_new();
 	auto scoped_guard =
@@ -46,6 +46,7 @@
 #include "trigger.h"
 #include "xrow_io.h"
 #include "error.h"
+#include "errinj.h"
 
 /* TODO: add configuration options */
 static const int RECONNECT_DELAY = 1;
@@ -190,6 +191,93 @@ done:
 	applier_set_state(applier, APPLIER_READY);
 }
 
+/** Apply a row received from the master. */
+typedef void
+(*applier_apply_row_f)(struct applier *applier, struct xrow_header *row);
+
+/**
+ * Apply rows of an xlog tx block sent by the master,
+ * @sa IPROTO_RAW_BLOCK.
+ */
+static void
+applier_apply_raw_block(struct applier *applier, struct xrow_header *packet,
+			applier_apply_row_f apply_row)
+{
+	if (applier->zdctx == NULL &&
+	    (applier->zdctx = ZSTD_createDStream()) == NULL) {
+		tnt_raise(OutOfMemory, sizeof(applier->zdctx),
+			  "runtime", "zstd context");
+	}
+	if (packet->bodycnt == 0)
+		tnt_raise(ClientError, ER_INVALID_MSGPACK, "raw block");
+	const char *data = (const char *) packet->body[0].iov_base;
+	const char *end = data + packet->body[0].iov_len;
+	const char *tmp = data;
+	if (mp_typeof(*data) != MP_BIN || mp_check(&tmp, end) != 0)
+		tnt_raise(ClientError, ER_INVALID_MSGPACK, "raw block");
+	uint32_t size;
+	data = mp_decode_bin(&data, &size);
+	end = data + size;
+
+	struct xlog_tx_cursor tx_cursor;
+	ssize_t rc = xlog_tx_cursor_create(&tx_cursor, &data, end,
+					   applier->zdctx);
+	if (rc < 0)
+		diag_raise();
+	if (rc > 0)
+		tnt_raise(ClientError, ER_INVALID_MSGPACK, "raw block");
+	auto guard = make_scoped_guard([&]{
+		xlog_tx_cursor_destroy(&tx_cursor);
+	});
+	struct xrow_header row;
+	while ((rc = xlog_tx_cursor_next_row(&tx_cursor, &row)) == 0)
+		apply_row(applier, &row);
+	if (rc < 0)
+		diag_raise();
+}
+
+static void
+applier_apply_join_row(struct applier *applier, struct xrow_header *row)
+{
+	xstream_write_xc(applier->join_stream, row);
+}
+
+static void
+applier_apply_final_join_row(struct applier *applier, struct xrow_header *row)
+{
+	vclock_follow(&replicaset_vclock, row->replica_id, row->lsn);
+	xstream_write_xc(applier->subscribe_stream, row);
+}
+
+static void
+applier_apply_subscribe_row(struct applier *applier, struct xrow_header *row)
+{
+	applier->lag = ev_now(loop()) - row->tm;
+	/* Replication request. */
+	if (row->replica_id == REPLICA_ID_NIL ||
+	    row->replica_id >= VCLOCK_MAX) {
+		/*
+		 * A safety net, this can only occur
+		 * if we're fed a strangely broken xlog.
+		 */
+		tnt_raise(ClientError, ER_UNKNOWN_REPLICA,
+			  int2str(row->replica_id),
+			  tt_uuid_str(&REPLICASET_UUID));
+	}
+	if (vclock_get(&replicaset_vclock, row->replica_id) < row->lsn) {
+		/**
+		 * Promote the replica set vclock before
+		 * applying the row. If there is an
+		 * exception (conflict) applying the row,
+		 * the row is skipped when the replication
+		 * is resumed.
+		 */
+		vclock_follow(&replicaset_vclock, row->replica_id,
+			      row->lsn);
+		xstream_write_xc(applier->subscribe_stream, row);
+	}
+}
+
 /**
  * Execute and process JOIN request (bootstrap the instance).
  */
@@ -200,7 +288,10 @@ applier_join(struct applier *applier)
 	struct ev_io *coio = &applier->io;
 	struct iobuf *iobuf = applier->iobuf;
 	struct xrow_header row;
-	xrow_encode_join(&row, &INSTANCE_UUID);
+	/* Pretend to be a replica that predates raw blocks. */
+	bool raw_blocks = true;
+	ERROR_INJECT(ERRINJ_APPLIER_NO_RAW_BLOCKS, { raw_blocks = false; });
+	xrow_encode_join(&row, &INSTANCE_UUID, raw_blocks);
 	coio_write_xrow(coio, &row);
 
 	/**
@@ -235,7 +326,10 @@ applier_join(struct applier *applier)
 		coio_read_xrow(coio, &iobuf->in, &row);
 		applier->last_row_time = ev_now(loop());
 		if (iproto_type_is_dml(row.type)) {
-			xstream_write_xc(applier->join_stream, &row);
+			applier_apply_join_row(applier, &row);
+		} else if (row.type == IPROTO_RAW_BLOCK) {
+			applier_apply_raw_block(applier, &row,
+						applier_apply_join_row);
 		} else if (row.type == IPROTO_OK) {
 			if (applier->version_id < version_id(1, 7, 0)) {
 				/*
@@ -272,9 +366,10 @@ applier_join(struct applier *applier)
 		coio_read_xrow(coio, &iobuf->in, &row);
 		applier->last_row_time = ev_now(loop());
 		if (iproto_type_is_dml(row.type)) {
-			vclock_follow(&replicaset_vclock, row.replica_id,
-				      row.lsn);
-			xstream_write_xc(applier->subscribe_stream, &row);
+			applier_apply_final_join_row(applier, &row);
+		} else if (row.type == IPROTO_RAW_BLOCK) {
+			applier_apply_raw_block(applier, &row,
+						applier_apply_final_join_row);
 		} else if (row.type == IPROTO_OK) {
 			/*
 			 * Current vclock. This is not used now,
@@ -308,8 +403,10 @@ applier_subscribe(struct applier *applier)
 	struct iobuf *iobuf = applier->iobuf;
 	struct xrow_header row;
 
+	bool raw_blocks = true;
+	ERROR_INJECT(ERRINJ_APPLIER_NO_RAW_BLOCKS, { raw_blocks = false; });
 	xrow_encode_subscribe(&row, &REPLICASET_UUID, &INSTANCE_UUID,
-			      &replicaset_vclock);
+			      &replicaset_vclock, raw_blocks);
 	coio_write_xrow(coio, &row);
 	applier_set_state(applier, APPLIER_FOLLOW);
 
@@ -348,33 +445,15 @@ applier_subscribe(struct applier *applier)
 	 */
 	while (true) {
 		coio_read_xrow(coio, &iobuf->in, &row);
-		applier->lag = ev_now(loop()) - row.tm;
 		applier->last_row_time = ev_now(loop());
 
 		if (iproto_type_is_error(row.type))
 			xrow_decode_error(&row);  /* error */
-		/* Replication request. */
-		if (row.replica_id == REPLICA_ID_NIL ||
-		    row.replica_id >= VCLOCK_MAX) {
-			/*
-			 * A safety net, this can only occur
-			 * if we're fed a strangely broken xlog.
-			 */
-			tnt_raise(ClientError, ER_UNKNOWN_REPLICA,
-				  int2str(row.replica_id),
-				  tt_uuid_str(&REPLICASET_UUID));
-		}
-		if (vclock_get(&replicaset_vclock, row.replica_id) < row.lsn) {
-			/**
-			 * Promote the replica set vclock before
-			 * applying the row. If there is an
-			 * exception (conflict) applying the row,
-			 * the row is skipped when the replication
-			 * is resumed.
-			 */
-			vclock_follow(&replicaset_vclock, row.replica_id,
-				      row.lsn);
-			xstream_write_xc(applier->subscribe_stream, &row);
+		if (row.type == IPROTO_RAW_BLOCK) {
+			applier_apply_raw_block(applier, &row,
+						applier_apply_subscribe_row);
+		} else {
+			applier_apply_subscribe_row(applier, &row);
 		}
 		iobuf_reset(iobuf);
 		fiber_gc();
@@ -527,6 +606,8 @@ applier_delete(struct applier *applier)
 {
 	assert(applier->reader == NULL);
 	iobuf_delete(applier->iobuf);
+	if (applier->zdctx != NULL)
+		ZSTD_freeDStream(applier->zdctx);
 	assert(applier->io.fd == -1);
 	ipc_channel_destroy(&applier->pause);
 	trigger_destroy(&applier->on_state);
@@ -41,6 +41,7 @@
 #include "third_party/tarantool_ev.h"
 #include "vclock.h"
 #include "ipc.h"
+#include "zstd.h"
 
 struct xstream;
 
@@ -104,6 +105,11 @@ struct applier {
 	struct xstream *join_stream;
 	/** xstream to process rows during final JOIN and SUBSCRIBE */
 	struct xstream *subscribe_stream;
+	/**
+	 * zstd context to decompress IPROTO_RAW_BLOCK packets,
+	 * created on the first packet.
+	 */
+	ZSTD_DStream *zdctx;
 };
 
 /**
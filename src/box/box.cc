@@ -58,6 +58,7 @@
 #include "user.h"
 #include "cfg.h"
 #include "iobuf.h"
+#include "coio_uring.h"
 #include "coio.h"
 #include "replication.h" /* replica */
 #include "title.h"
@@ -69,6 +70,8 @@
 #include "authentication.h"
 #include "path_lock.h"
 #include "gc.h"
+#include "expire.h"
+#include "errinj.h"
 
 static char status[64] = "unknown";
 
@@ -168,7 +171,9 @@ static void
 process_rw(struct request *request, struct space *space, struct tuple **result)
 {
 	assert(iproto_type_is_dml(request->type));
-	rmean_collect(rmean_box, request->type, 1);
+	/* DELETE_RANGE is accounted as DELETE in box.stat(). */
+	rmean_collect(rmean_box, request->type == IPROTO_DELETE_RANGE ?
+		      IPROTO_DELETE : request->type, 1);
 	try {
 		struct txn *txn = txn_begin_stmt(space);
 		access_check_space(space, PRIV_W);
@@ -208,6 +213,21 @@ process_rw(struct request *request, struct space *space, struct tuple **result)
 			space->handler->executeUpsert(txn, space, request);
 			tuple = NULL;
 			break;
+		case IPROTO_DELETE_RANGE:
+			/*
+			 * The whole point of the request is not to
+			 * look at every deleted tuple, which is what
+			 * on_replace triggers (alter of system spaces
+			 * in particular) need.
+			 */
+			if (!rlist_empty(&space->on_replace)) {
+				tnt_raise(ClientError, ER_UNSUPPORTED,
+					  "delete_range", "on_replace triggers");
+			}
+			space->handler->executeDeleteRange(txn, space,
+							   request);
+			tuple = NULL;
+			break;
 		default:
 			tuple = NULL;
 		}
@@ -233,6 +253,8 @@ void
 box_set_ro(bool ro)
 {
 	is_ro = ro;
+	if (!ro)
+		expire_wakeup();
 }
 
 bool
@@ -410,6 +432,37 @@ box_check_wal_max_size(int64_t wal_max_size)
 	return wal_max_size;
 }
 
+static int64_t
+box_check_wal_writeback_interval(int64_t interval)
+{
+	if (interval < 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_writeback_interval",
+			  "must be >= 0");
+	}
+	return interval;
+}
+
+static int
+box_check_replication_compression(int level)
+{
+	if (level < 0 || level > ZSTD_maxCLevel()) {
+		tnt_raise(ClientError, ER_CFG, "replication_compression",
+			  "must be between 0 (disabled) and "
+			  "the maximal zstd level");
+	}
+	return level;
+}
+
+static int
+box_check_checkpoint_delta_count(int checkpoint_delta_count)
+{
+	if (checkpoint_delta_count < 0) {
+		tnt_raise(ClientError, ER_CFG, "checkpoint_delta_count",
+			  "must be >= 0");
+	}
+	return checkpoint_delta_count;
+}
+
 void
 box_check_config()
 {
@@ -420,7 +473,10 @@ box_check_config()
 	box_check_wal_max_rows(cfg_geti64("rows_per_wal"));
 	box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	box_check_wal_mode(cfg_gets("wal_mode"));
+	box_check_wal_writeback_interval(cfg_geti64("wal_writeback_interval"));
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
+	box_check_checkpoint_delta_count(cfg_geti("checkpoint_delta_count"));
+	box_check_replication_compression(cfg_geti("replication_compression"));
 	if (cfg_geti64("vinyl_page_size") > cfg_geti64("vinyl_range_size"))
 		tnt_raise(ClientError, ER_CFG, "vinyl_page_size",
 			  "can't be greater than vinyl_range_size");
@@ -541,6 +597,23 @@ box_set_snap_io_rate_limit(void)
 		memtx->setSnapIoRateLimit(cfg_getd("snap_io_rate_limit"));
 }
 
+void
+box_set_checkpoint_delta_count(void)
+{
+	int count = box_check_checkpoint_delta_count(
+		cfg_geti("checkpoint_delta_count"));
+	MemtxEngine *memtx = (MemtxEngine *) engine_find("memtx");
+	if (memtx)
+		memtx->setCheckpointDeltaCount(count);
+}
+
+void
+box_set_replication_compression(void)
+{
+	/* The level is read by a relay on start. */
+	box_check_replication_compression(cfg_geti("replication_compression"));
+}
+
 void
 box_set_too_long_threshold(void)
 {
@@ -801,6 +874,23 @@ box_upsert(uint32_t space_id, uint32_t index_id, const char *tuple,
 	return box_process1(request, result);
 }
 
+int
+box_delete_range(uint32_t space_id, const char *begin, const char *begin_end,
+		 const char *end, const char *end_end)
+{
+	mp_tuple_assert(begin, begin_end);
+	mp_tuple_assert(end, end_end);
+	struct request *request;
+	request = region_alloc_object_xc(&fiber()->gc, struct request);
+	request_create(request, IPROTO_DELETE_RANGE);
+	request->space_id = space_id;
+	request->key = begin;
+	request->key_end = begin_end;
+	request->tuple = end;
+	request->tuple_end = end_end;
+	return box_process1(request, NULL);
+}
+
 static void
 space_truncate(struct space *space)
 {
@@ -1169,7 +1259,10 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 
 	/* Decode JOIN request */
 	struct tt_uuid instance_uuid = uuid_nil;
-	xrow_decode_join(header, &instance_uuid);
+	bool raw_blocks;
+	xrow_decode_join(header, &instance_uuid, &raw_blocks);
+	/* Pretend to be a master that predates raw blocks. */
+	ERROR_INJECT(ERRINJ_RELAY_NO_RAW_BLOCKS, { raw_blocks = false; });
 
 	/* Check that bootstrap has been finished */
 	if (!is_box_configured)
@@ -1212,7 +1305,9 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 	/*
 	 * Initial stream: feed replica with dirty data from engines.
 	 */
-	relay_initial_join(io->fd, header->sync, &start_vclock);
+	say_info("sending initial data to %s in %s",
+		 tt_uuid_str(&instance_uuid), raw_blocks ? "blocks" : "rows");
+	relay_initial_join(io->fd, header->sync, &start_vclock, raw_blocks);
 	say_info("initial data sent.");
 
 	/**
@@ -1236,7 +1331,8 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 	 * Final stage: feed replica with WALs in range
 	 * (start_vclock, stop_vclock).
 	 */
-	relay_final_join(io->fd, header->sync, &start_vclock, &stop_vclock);
+	relay_final_join(io->fd, header->sync, &start_vclock, &stop_vclock,
+			 raw_blocks);
 	say_info("final data sent.");
 
 	/* Send end of WAL stream marker */
@@ -1259,8 +1355,10 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	struct tt_uuid replicaset_uuid = uuid_nil, replica_uuid = uuid_nil;
 	struct vclock replica_clock;
 	vclock_create(&replica_clock);
+	bool raw_blocks;
 	xrow_decode_subscribe(header, &replicaset_uuid, &replica_uuid,
-			      &replica_clock);
+			      &replica_clock, &raw_blocks);
+	ERROR_INJECT(ERRINJ_RELAY_NO_RAW_BLOCKS, { raw_blocks = false; });
 
 	/* Forbid connection to itself */
 	if (tt_uuid_is_equal(&replica_uuid, &INSTANCE_UUID))
@@ -1327,7 +1425,8 @@ box_process_subscribe(struct ev_io *io, struct xrow_header *header)
 	 * a stall in updates (in this case replica may hang
 	 * indefinitely).
 	 */
-	relay_subscribe(io->fd, header->sync, replica, &replica_clock);
+	relay_subscribe(io->fd, header->sync, replica, &replica_clock,
+			raw_blocks);
 }
 
 /** Insert a new cluster into _schema */
@@ -1359,6 +1458,7 @@ box_free(void)
 		tuple_free();
 		port_free();
 #endif
+		expire_free();
 		gc_free();
 		engine_shutdown();
 		wal_thread_stop();
@@ -1381,6 +1481,8 @@ engine_init()
 					     cfg_geti("memtx_max_tuple_size"),
 					     cfg_getd("slab_alloc_factor"));
 	engine_register(memtx);
+	/* Must be known before recovery starts. */
+	box_set_checkpoint_delta_count();
 
 	SysviewEngine *sysview = new SysviewEngine();
 	engine_register(sysview);
@@ -1541,6 +1643,13 @@ box_cfg_xc(void)
 	rmean_box = rmean_new(iproto_type_strs, IPROTO_TYPE_STAT_MAX);
 	rmean_error = rmean_new(rmean_error_strings, RMEAN_ERROR_LAST);
 
+	/*
+	 * io_uring is optional: if the kernel doesn't support
+	 * it, cooperative file I/O keeps using eio.
+	 */
+	if (cfg_geti("io_uring") && coio_uring_init() != 0)
+		say_syserror("failed to set up io_uring, using eio");
+
 	if (gc_init(cfg_gets("memtx_dir")) < 0)
 		diag_raise();
 
@@ -1679,11 +1788,16 @@ box_cfg_xc(void)
 	int64_t wal_max_rows = box_check_wal_max_rows(cfg_geti64("rows_per_wal"));
 	int64_t wal_max_size = box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
+	int64_t wal_writeback_interval = box_check_wal_writeback_interval(
+		cfg_geti64("wal_writeback_interval"));
 	wal_init(wal_mode, cfg_gets("wal_dir"), &INSTANCE_UUID,
-		 &replicaset_vclock, wal_max_rows, wal_max_size);
+		 &replicaset_vclock, wal_max_rows, wal_max_size,
+		 wal_writeback_interval);
 
 	rmean_cleanup(rmean_box);
 
+	expire_init();
+
 	/* Follow replica */
 	replicaset_foreach(replica) {
 		if (replica->applier != NULL)
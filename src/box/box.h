@@ -152,6 +152,8 @@ void box_set_replication(void);
 void box_set_log_level(void);
 void box_set_io_collect_interval(void);
 void box_set_snap_io_rate_limit(void);
+void box_set_checkpoint_delta_count(void);
+void box_set_replication_compression(void);
 void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_force_recovery(void);
@@ -312,6 +314,26 @@ box_upsert(uint32_t space_id, uint32_t index_id, const char *tuple,
 	   const char *tuple_end, const char *ops, const char *ops_end,
 	   int index_base, box_tuple_t **result);
 
+/**
+ * Execute a DELETE_RANGE request: delete all tuples with the
+ * primary key greater than or equal to \a begin and less than
+ * \a end. Keys may be partial.
+ *
+ * \param space_id space identifier
+ * \param begin encoded start key in MsgPack Array format,
+ * an empty array stands for -inf.
+ * \param begin_end the end of encoded \a begin.
+ * \param end encoded end key in MsgPack Array format,
+ * an empty array stands for +inf.
+ * \param end_end the end of encoded \a end.
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \sa \code box.space[space_id]:delete_range(begin, end) \endcode
+ */
+API_EXPORT int
+box_delete_range(uint32_t space_id, const char *begin, const char *begin_end,
+		 const char *end, const char *end_end);
+
 /**
  * Truncate space.
  *
@@ -211,6 +211,12 @@ Handler::executeUpsert(struct txn *, struct space *, struct request *)
 	tnt_raise(ClientError, ER_UNSUPPORTED, engine->name, "upsert");
 }
 
+void
+Handler::executeDeleteRange(struct txn *, struct space *, struct request *)
+{
+	tnt_raise(ClientError, ER_UNSUPPORTED, engine->name, "delete_range");
+}
+
 void
 Handler::prepareAlterSpace(struct space *, struct space *)
 {
@@ -40,6 +40,7 @@ struct relay;
 
 enum engine_flags {
 	ENGINE_CAN_BE_TEMPORARY = 1,
+	ENGINE_CAN_DEFER_DELETES = 2,
 };
 
 extern struct rlist engines;
@@ -219,6 +220,14 @@ public:
 	virtual void
 	executeUpsert(struct txn *, struct space *,
 		      struct request *);
+	/**
+	 * Delete all tuples with the primary key in
+	 * [request->key, request->tuple). An empty end key
+	 * stands for +inf.
+	 */
+	virtual void
+	executeDeleteRange(struct txn *, struct space *,
+			   struct request *);
 
 	virtual void
 	executeSelect(struct txn *, struct space *,
@@ -272,6 +281,12 @@ engine_can_be_temporary(uint32_t flags)
 	return flags & ENGINE_CAN_BE_TEMPORARY;
 }
 
+static inline bool
+engine_can_defer_deletes(uint32_t flags)
+{
+	return flags & ENGINE_CAN_DEFER_DELETES;
+}
+
 static inline uint32_t
 engine_id(Handler *space)
 {
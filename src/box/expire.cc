@@ -0,0 +1,315 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "expire.h"
+
+#include "msgpuck/msgpuck.h"
+#include "small/ibuf.h"
+#include "fiber.h"
+#include "clock.h"
+#include "rmean.h"
+#include "say.h"
+
+#include "box.h"
+#include "schema.h"
+#include "space.h"
+#include "index.h"
+#include "tuple.h"
+#include "txn.h"
+
+/** How often to look for expired tuples, in seconds. */
+static const double EXPIRE_PERIOD = 0.1;
+/** Max number of tuples deleted in one transaction. */
+enum { EXPIRE_BATCH_MAX = 1000 };
+/**
+ * Max time a batch may spend in the tx thread before the
+ * transaction is committed and the fiber yields, in seconds.
+ */
+static const double EXPIRE_BATCH_BUDGET = 0.001;
+
+static const char *expire_stat_strings[] = { "EXPIRED" };
+
+struct rmean *rmean_expire;
+
+/** Background fiber deleting expired tuples. */
+static struct fiber *expire_fiber;
+/** Set while the expiration fiber waits for the read-only mode to end. */
+static bool expire_is_idle;
+/** Max expiration lag seen by the current round. */
+static double expire_round_lag;
+/** Max expiration lag seen by the last complete round. */
+static double expire_last_lag;
+
+double
+expire_lag(void)
+{
+	return MAX(expire_round_lag, expire_last_lag);
+}
+
+/**
+ * Find a TREE index ordered by the timestamp field of a space.
+ * Return the index or NULL if there is no such index.
+ */
+static Index *
+expire_find_index(struct space *space)
+{
+	uint32_t fieldno = space->def.opts.ttl_field;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		Index *index = space->index[i];
+		struct index_def *def = index->index_def;
+		if (def->type != TREE)
+			continue;
+		struct key_part *part = &def->key_def.parts[0];
+		if (part->fieldno != fieldno)
+			continue;
+		if (part->type == FIELD_TYPE_UNSIGNED ||
+		    part->type == FIELD_TYPE_INTEGER ||
+		    part->type == FIELD_TYPE_NUMBER)
+			return index;
+	}
+	return NULL;
+}
+
+/**
+ * Decode the timestamp of a tuple.
+ * Return -1 if the field is absent or is not a number.
+ */
+static int
+expire_tuple_time(struct tuple *tuple, uint32_t fieldno, double *time)
+{
+	const char *field = tuple_field(tuple, fieldno);
+	if (field == NULL)
+		return -1;
+	switch (mp_typeof(*field)) {
+	case MP_UINT:
+		*time = mp_decode_uint(&field);
+		return 0;
+	case MP_INT:
+		*time = mp_decode_int(&field);
+		return 0;
+	case MP_FLOAT:
+		*time = mp_decode_float(&field);
+		return 0;
+	case MP_DOUBLE:
+		*time = mp_decode_double(&field);
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+/** Primary key of a tuple to delete. */
+struct expire_key {
+	const char *data;
+	uint32_t size;
+};
+
+/**
+ * Delete a batch of expired tuples from a space in one
+ * transaction.
+ *
+ * @param space_id id of the space
+ * @param[out] is_done set if there are no more expired tuples
+ *
+ * @retval 0 success
+ * @retval -1 error, check diag
+ */
+static int
+expire_space_batch(uint32_t space_id, bool *is_done)
+{
+	*is_done = true;
+	struct space *space = space_by_id(space_id);
+	if (space == NULL || space->def.opts.ttl <= 0)
+		return 0;
+	Index *index = expire_find_index(space);
+	if (index == NULL)
+		return 0;
+	uint32_t index_id = index->index_def->iid;
+	uint32_t fieldno = space->def.opts.ttl_field;
+	double ttl = space->def.opts.ttl;
+
+	struct expire_key *keys = (struct expire_key *)
+		box_txn_alloc(EXPIRE_BATCH_MAX * sizeof(*keys));
+	if (keys == NULL) {
+		diag_set(OutOfMemory, EXPIRE_BATCH_MAX * sizeof(*keys),
+			 "region", "expire keys");
+		return -1;
+	}
+	if (box_txn_begin() != 0)
+		return -1;
+	double start = clock_monotonic();
+	double now = fiber_time();
+	double lag = 0;
+	uint32_t count = 0;
+	/*
+	 * The index is ordered by the timestamp, so the scan
+	 * stops at the first tuple which hasn't expired yet.
+	 */
+	char key[1];
+	mp_encode_array(key, 0);
+	box_iterator_t *it = box_index_iterator(space_id, index_id, ITER_GE,
+						key, key + sizeof(key));
+	if (it == NULL)
+		goto rollback;
+	while (true) {
+		struct tuple *tuple;
+		if (box_iterator_next(it, &tuple) != 0) {
+			box_iterator_free(it);
+			goto rollback;
+		}
+		if (tuple == NULL)
+			break;
+		double time;
+		if (expire_tuple_time(tuple, fieldno, &time) != 0 ||
+		    time + ttl > now)
+			break;
+		struct expire_key *k = &keys[count];
+		k->data = box_tuple_extract_key(tuple, space_id, 0, &k->size);
+		if (k->data == NULL) {
+			box_iterator_free(it);
+			goto rollback;
+		}
+		lag = MAX(lag, now - (time + ttl));
+		if (++count == EXPIRE_BATCH_MAX ||
+		    clock_monotonic() - start > EXPIRE_BATCH_BUDGET) {
+			*is_done = false;
+			break;
+		}
+	}
+	box_iterator_free(it);
+
+	/*
+	 * Deletes may be slow too (e.g. vinyl reads from disk),
+	 * so commit what has been deleted once out of time and
+	 * let the caller yield before the next batch.
+	 */
+	uint32_t deleted = 0;
+	while (deleted < count) {
+		struct expire_key *k = &keys[deleted];
+		if (box_delete(space_id, 0, k->data, k->data + k->size,
+			       NULL) != 0)
+			goto rollback;
+		if (++deleted < count &&
+		    clock_monotonic() - start > EXPIRE_BATCH_BUDGET) {
+			*is_done = false;
+			break;
+		}
+	}
+	if (box_txn_commit() != 0)
+		return -1;
+	rmean_collect(rmean_expire, EXPIRE_STAT_EXPIRED, deleted);
+	expire_round_lag = MAX(expire_round_lag, lag);
+	return 0;
+rollback:
+	*is_done = true;
+	box_txn_rollback();
+	return -1;
+}
+
+static void
+expire_space_id(struct space *space, void *udata)
+{
+	struct ibuf *ids = (struct ibuf *) udata;
+	if (space->def.opts.ttl <= 0)
+		return;
+	uint32_t *id = (uint32_t *) ibuf_alloc(ids, sizeof(*id));
+	if (id != NULL)
+		*id = space_id(space);
+}
+
+/** Run one expiration round over all spaces with ttl. */
+static void
+expire_round(struct ibuf *ids)
+{
+	ibuf_reset(ids);
+	space_foreach(expire_space_id, ids);
+	uint32_t *id = (uint32_t *) ids->rpos;
+	uint32_t *end = (uint32_t *) ids->wpos;
+	for (; id < end && !fiber_is_cancelled(); id++) {
+		bool is_done = false;
+		while (!is_done && !box_is_ro() && !fiber_is_cancelled()) {
+			if (expire_space_batch(*id, &is_done) != 0)
+				error_log(diag_last_error(diag_get()));
+			fiber_gc();
+			/* Let other fibers run between batches. */
+			fiber_sleep(0);
+		}
+	}
+}
+
+static int
+expire_f(va_list ap)
+{
+	(void) ap;
+	struct ibuf ids;
+	ibuf_create(&ids, &cord()->slabc, 16 * sizeof(uint32_t));
+	while (!fiber_is_cancelled()) {
+		if (box_is_ro()) {
+			/* Woken up by expire_wakeup() or cancellation. */
+			expire_is_idle = true;
+			fiber_yield();
+			expire_is_idle = false;
+			continue;
+		}
+		expire_round_lag = 0;
+		expire_round(&ids);
+		expire_last_lag = expire_round_lag;
+		expire_round_lag = 0;
+		fiber_sleep(EXPIRE_PERIOD);
+	}
+	ibuf_destroy(&ids);
+	return 0;
+}
+
+void
+expire_init(void)
+{
+	rmean_expire = rmean_new(expire_stat_strings, EXPIRE_STAT_LAST);
+	if (rmean_expire == NULL)
+		tnt_raise(OutOfMemory, sizeof(*rmean_expire), "rmean_new",
+			  "struct rmean");
+	expire_fiber = fiber_new_xc("expire", expire_f);
+	fiber_start(expire_fiber);
+}
+
+void
+expire_wakeup(void)
+{
+	if (expire_fiber != NULL && expire_is_idle)
+		fiber_wakeup(expire_fiber);
+}
+
+void
+expire_free(void)
+{
+	if (expire_fiber != NULL)
+		fiber_cancel(expire_fiber);
+	expire_fiber = NULL;
+}
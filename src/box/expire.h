@@ -0,0 +1,96 @@
+#ifndef TARANTOOL_BOX_EXPIRE_H_INCLUDED
+#define TARANTOOL_BOX_EXPIRE_H_INCLUDED
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Background expiration of tuples.
+ *
+ * A space with the ttl option set names a field storing a
+ * timestamp (seconds since the Epoch, as returned by
+ * fiber.time()). Once the timestamp is ttl seconds in the past,
+ * the tuple is deleted by a background fiber.
+ *
+ * Expired tuples are looked up with a cursor over a TREE index
+ * whose first part is the timestamp field, so such an index is
+ * required: spaces without it are ignored. Deletions are done
+ * in batched transactions, each limited by the number of tuples
+ * and by the time spent in the tx thread, the fiber yields
+ * between batches. Nothing is deleted in the read-only mode,
+ * since deletions are replicated from the master.
+ */
+
+struct rmean;
+
+enum expire_stat_name {
+	EXPIRE_STAT_EXPIRED,
+	EXPIRE_STAT_LAST,
+};
+
+/** Expiration statistics, per second rate and total. */
+extern struct rmean *rmean_expire;
+
+/**
+ * Start the expiration fiber. Called when the box is
+ * configured.
+ */
+void
+expire_init(void);
+
+/** Stop the expiration fiber. */
+void
+expire_free(void);
+
+/**
+ * Resume expiration after the read-only mode has been turned
+ * off. The expiration fiber sleeps while the box is read-only.
+ */
+void
+expire_wakeup(void);
+
+/**
+ * Return the max delay between the expiration time of a tuple
+ * and the moment it was deleted, in seconds, over the last
+ * expiration round.
+ */
+double
+expire_lag(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_EXPIRE_H_INCLUDED */
@@ -155,6 +155,19 @@ gc_ref_last_checkpoint(struct vclock *vclock)
 	return vclock_sum(last);
 }
 
+int
+gc_ref_checkpoint(const struct vclock *vclock)
+{
+	struct vclock *cpt_vclock = vclockset_search(&gc.checkpoints,
+						     (struct vclock *) vclock);
+	if (cpt_vclock == NULL)
+		return -1;
+	struct checkpoint_info *cpt = container_of(cpt_vclock,
+			struct checkpoint_info, vclock);
+	cpt->refs++;
+	return 0;
+}
+
 void
 gc_unref_checkpoint(struct vclock *vclock)
 {
@@ -109,6 +109,14 @@ gc_last_checkpoint(struct vclock *vclock);
 int64_t
 gc_ref_last_checkpoint(struct vclock *vclock);
 
+/**
+ * Pin the checkpoint with vclock @vclock so that it cannot be
+ * removed by garbage collection.
+ * Returns 0 on success, -1 if there is no such checkpoint.
+ */
+int
+gc_ref_checkpoint(const struct vclock *vclock);
+
 /**
  * Unpin a checkpoint that was pinned with gc_pin_last_checkpoint()
  * and retry garbage collection if necessary.
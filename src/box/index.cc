@@ -38,6 +38,8 @@
 #include "txn.h"
 #include "rmean.h"
 #include "info.h"
+#include "scoped_guard.h"
+#include "fiber.h"
 
 const char *iterator_type_strs[] = {
 	/* [ITER_EQ]  = */ "EQ",
@@ -235,6 +237,32 @@ Index::findByKey(const char *key, uint32_t part_count) const
 	return NULL;
 }
 
+void
+Index::findByKeys(const char **keys, uint32_t part_count,
+		  uint32_t key_count, struct tuple **result) const
+{
+	memset(result, 0, key_count * sizeof(*result));
+	auto guard = make_scoped_guard([=]{
+		for (uint32_t i = 0; i < key_count; i++) {
+			if (result[i] != NULL)
+				tuple_unref(result[i]);
+		}
+	});
+	for (uint32_t i = 0; i < key_count; i++) {
+		/*
+		 * A tuple returned by findByKey() may be only
+		 * held by box_tuple_last, reference it before
+		 * looking up the next key.
+		 */
+		struct tuple *tuple = findByKey(keys[i], part_count);
+		if (tuple != NULL) {
+			tuple_ref_xc(tuple);
+			result[i] = tuple;
+		}
+	}
+	guard.is_active = false;
+}
+
 struct tuple *
 Index::findByTuple(struct tuple *tuple) const
 {
@@ -379,6 +407,52 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	}
 }
 
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, box_tuple_t **result)
+{
+	assert(keys != NULL && keys_end != NULL && result != NULL);
+	mp_tuple_assert(keys, keys_end);
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	try {
+		struct space *space;
+		Index *index = check_index(space_id, index_id, &space);
+		if (!index->index_def->opts.is_unique)
+			tnt_raise(ClientError, ER_MORE_THAN_ONE_TUPLE);
+		uint32_t key_count = mp_decode_array(&keys);
+		const char **key_ptrs = (const char **)
+			region_alloc_xc(region, key_count * sizeof(*key_ptrs) + 1);
+		uint32_t part_count = index->index_def->key_def.part_count;
+		for (uint32_t i = 0; i < key_count; i++) {
+			if (mp_typeof(*keys) != MP_ARRAY) {
+				tnt_raise(ClientError, ER_ILLEGAL_PARAMS,
+					  "key must be an array");
+			}
+			uint32_t key_part_count = mp_decode_array(&keys);
+			if (primary_key_validate(index->index_def, keys,
+						 key_part_count))
+				diag_raise();
+			key_ptrs[i] = keys;
+			for (uint32_t part = 0; part < key_part_count; part++)
+				mp_next(&keys);
+		}
+		/* Start transaction in the engine. */
+		struct txn *txn = txn_begin_ro_stmt(space);
+		index->findByKeys(key_ptrs, part_count, key_count, result);
+		/* Count statistics */
+		rmean_collect(rmean_box, IPROTO_SELECT, key_count);
+
+		txn_commit_ro_stmt(txn);
+		region_truncate(region, used);
+		return 0;
+	}  catch (Exception *) {
+		region_truncate(region, used);
+		txn_rollback_stmt();
+		return -1;
+	}
+}
+
 int
 box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result)
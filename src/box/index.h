@@ -192,6 +192,31 @@ int
 box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result);
 
+/**
+ * Get tuples from index by a batch of keys.
+ *
+ * Lookups of the batch are interleaved, so that memory accesses
+ * of different keys overlap. This is faster than calling
+ * box_index_get() for each key.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param keys encoded keys in MsgPack Array format
+ *        ([[part1, part2, ...], [part1, part2, ...], ...]).
+ * \param keys_end the end of encoded \a keys
+ * \param[out] result an array with room for one tuple per key,
+ *        result[i] is set to the tuple found by the i-th key or NULL.
+ *        Found tuples are referenced and must be released with
+ *        box_tuple_unref().
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \pre keys != NULL
+ * \sa \code box.space[space_id].index[index_id]:get_many(keys) \endcode
+ */
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, box_tuple_t **result);
+
 /**
  * Return a first (minimal) tuple matched the provided key.
  *
@@ -357,6 +382,15 @@ public:
 	virtual size_t count(enum iterator_type type, const char *key,
 			     uint32_t part_count) const;
 	virtual struct tuple *findByKey(const char *key, uint32_t part_count) const;
+	/**
+	 * Look up a batch of keys, each of @a part_count parts.
+	 * The tuple found by keys[i], or NULL, is stored in
+	 * result[i]. Found tuples are referenced, the caller
+	 * must unreference them. The default implementation
+	 * calls findByKey() for each key.
+	 */
+	virtual void findByKeys(const char **keys, uint32_t part_count,
+				uint32_t key_count, struct tuple **result) const;
 	virtual struct tuple *findByTuple(struct tuple *tuple) const;
 	virtual struct tuple *replace(struct tuple *old_tuple,
 				      struct tuple *new_tuple,
@@ -372,7 +372,7 @@ static const struct cmsg_hop process1_route[] = {
 	{ net_send_msg, NULL },
 };
 
-static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
+static const struct cmsg_hop *dml_route[IPROTO_DELETE_RANGE + 1] = {
 	NULL,                                   /* IPROTO_OK */
 	select_route,                           /* IPROTO_SELECT */
 	process1_route,                         /* IPROTO_INSERT */
@@ -383,7 +383,8 @@ static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
 	misc_route,                             /* IPROTO_AUTH */
 	misc_route,                             /* IPROTO_EVAL */
 	process1_route,                         /* IPROTO_UPSERT */
-	misc_route                              /* IPROTO_CALL */
+	misc_route,                             /* IPROTO_CALL */
+	process1_route                          /* IPROTO_DELETE_RANGE */
 };
 
 static const struct cmsg_hop sync_route[] = {
@@ -571,6 +572,7 @@ iproto_decode_msg(struct iproto_msg *msg, const char **pos, const char *reqend,
 	case IPROTO_AUTH:
 	case IPROTO_EVAL:
 	case IPROTO_UPSERT:
+	case IPROTO_DELETE_RANGE:
 		/*
 		 * This is a common request which can be parsed with
 		 * request_decode(). Parse it before putting it into
@@ -86,6 +86,7 @@ const unsigned char iproto_key_type[IPROTO_KEY_MAX] =
 	/* 0x26 */	MP_MAP, /* IPROTO_VCLOCK */
 	/* 0x27 */	MP_STR, /* IPROTO_EXPR */
 	/* 0x28 */	MP_ARRAY, /* IPROTO_OPS */
+	/* 0x29 */	MP_BOOL, /* IPROTO_RAW_BLOCKS */
 	/* }}} */
 };
 
@@ -105,7 +106,7 @@ const char *iproto_type_strs[] =
 };
 
 #define bit(c) (1ULL<<IPROTO_##c)
-const uint64_t iproto_body_key_map[IPROTO_CALL + 1] = {
+const uint64_t iproto_body_key_map[IPROTO_DELETE_RANGE + 1] = {
 	0,                                                     /* unused */
 	bit(SPACE_ID) | bit(LIMIT) | bit(KEY),                 /* SELECT */
 	bit(SPACE_ID) | bit(TUPLE),                            /* INSERT */
@@ -117,6 +118,7 @@ const uint64_t iproto_body_key_map[IPROTO_CALL + 1] = {
 	bit(EXPR)     | bit(TUPLE),                            /* EVAL */
 	bit(SPACE_ID) | bit(OPS) | bit(TUPLE),                 /* UPSERT */
 	bit(FUNCTION_NAME) | bit(TUPLE),                       /* CALL */
+	bit(SPACE_ID) | bit(KEY) | bit(TUPLE),                 /* DELETE_RANGE */
 };
 #undef bit
 
@@ -162,7 +164,7 @@ const char *iproto_key_strs[IPROTO_KEY_MAX] = {
 	"vector clock",     /* 0x26 */
 	"expression",       /* 0x27 */
 	"operations",       /* 0x28 */
-	NULL,               /* 0x29 */
+	"raw blocks",       /* 0x29 */
 	"data",             /* 0x30 */
 	"error"             /* 0x31 */
 };
@@ -174,7 +176,8 @@ const char *vy_page_info_key_strs[VY_PAGE_INFO_KEY_MAX] = {
 	"unpacked size",
 	"count",
 	"min",
-	"page index offset"
+	"page index offset",
+	"version"
 };
 
 const char *vy_run_info_key_strs[VY_RUN_INFO_KEY_MAX] = {
@@ -189,3 +192,8 @@ const char *vy_page_index_key_strs[VY_PAGE_INDEX_KEY_MAX] = {
 	NULL,
 	"page index",
 };
+
+const char *vy_page_rows_key_strs[VY_PAGE_ROWS_KEY_MAX] = {
+	NULL,
+	"rows",
+};
@@ -75,6 +75,8 @@ enum iproto_key {
 	IPROTO_VCLOCK = 0x26,
 	IPROTO_EXPR = 0x27, /* EVAL */
 	IPROTO_OPS = 0x28, /* UPSERT but not UPDATE ops, because of legacy */
+	/* The replica accepts IPROTO_RAW_BLOCK on JOIN/SUBSCRIBE. */
+	IPROTO_RAW_BLOCKS = 0x29,
 	/* Leave a gap between request keys and response keys */
 	IPROTO_DATA = 0x30,
 	IPROTO_ERROR = 0x31,
@@ -143,6 +145,12 @@ enum iproto_type {
 	IPROTO_CALL = 10,
 	/** The maximum typecode used for box.stat() */
 	IPROTO_TYPE_STAT_MAX = IPROTO_CALL + 1,
+	/**
+	 * DELETE_RANGE request: delete all tuples with the
+	 * primary key in [KEY, TUPLE). Accounted as DELETE
+	 * in box.stat().
+	 */
+	IPROTO_DELETE_RANGE = 11,
 
 	/** PING request */
 	IPROTO_PING = 64,
@@ -150,6 +158,13 @@ enum iproto_type {
 	IPROTO_JOIN = 65,
 	/** Replication SUBSCRIBE command */
 	IPROTO_SUBSCRIBE = 66,
+	/**
+	 * An xlog tx block, the body is MP_BIN with the block
+	 * data. Snapshot blocks are sent as is on initial JOIN,
+	 * WAL rows are packed into compressed blocks if
+	 * replication_compression is set.
+	 */
+	IPROTO_RAW_BLOCK = 67,
 
 	/** General information about Vinyl's runs stored in .index file */
 	VY_INDEX_RUN_INFO = 100,
@@ -157,6 +172,8 @@ enum iproto_type {
 	VY_INDEX_PAGE_INFO = 101,
 	/** Offsets for Vinyl's pages stored in .run file */
 	VY_RUN_PAGE_INDEX = 102,
+	/** Prefix-compressed statements of a Vinyl's page in .run file */
+	VY_RUN_PAGE_ROWS = 103,
 
 	/**
 	 * Error codes = (IPROTO_TYPE_ERROR | ER_XXX from errcode.h)
@@ -178,12 +195,16 @@ iproto_type_name(uint32_t type)
 		return iproto_type_strs[type];
 
 	switch (type) {
+	case IPROTO_DELETE_RANGE:
+		return "DELETE_RANGE";
 	case VY_INDEX_RUN_INFO:
 		return "RUNINFO";
 	case VY_INDEX_PAGE_INFO:
 		return "PAGEINFO";
 	case VY_RUN_PAGE_INDEX:
 		return "PAGEINDEX";
+	case VY_RUN_PAGE_ROWS:
+		return "PAGEROWS";
 	default:
 		return NULL;
 	}
@@ -210,7 +231,7 @@ static inline uint64_t
 request_key_map(uint32_t type)
 {
 	/** Advanced requests don't have a defined key map. */
-	assert(type <= IPROTO_CALL);
+	assert(type <= IPROTO_DELETE_RANGE);
 	extern const uint64_t iproto_body_key_map[];
 	return iproto_body_key_map[type];
 }
@@ -249,7 +270,7 @@ static inline bool
 iproto_type_is_dml(uint32_t type)
 {
 	return (type >= IPROTO_SELECT && type <= IPROTO_DELETE) ||
-		type == IPROTO_UPSERT;
+		type == IPROTO_UPSERT || type == IPROTO_DELETE_RANGE;
 }
 
 /** This is an error. */
@@ -314,8 +335,10 @@ enum vy_page_info_key {
 	VY_PAGE_INFO_MIN_KEY = 5,
 	/* Page index offset in a page */
 	VY_PAGE_INFO_PAGE_INDEX_OFFSET = 6,
+	/* Page format version, optional, 0 if absent */
+	VY_PAGE_INFO_VERSION = 7,
 	/** The last key in this enum + 1 */
-	VY_PAGE_INFO_KEY_MAX = VY_PAGE_INFO_PAGE_INDEX_OFFSET + 1
+	VY_PAGE_INFO_KEY_MAX = VY_PAGE_INFO_VERSION + 1
 };
 
 /**
@@ -336,7 +359,11 @@ vy_page_info_key_name(enum vy_page_info_key key)
  * @sa struct vy_page.
  */
 enum vy_page_index_key {
-	/** An array of row offsets in a page data (a page index). */
+	/**
+	 * An array of row offsets in a page data (a page index).
+	 * For prefix-compressed pages, offsets of restart points
+	 * in the page rows.
+	 */
 	VY_PAGE_INDEX_INDEX = 1,
 	/** The last key in this enum + 1 */
 	VY_PAGE_INDEX_KEY_MAX = VY_PAGE_INDEX_INDEX + 1
@@ -355,6 +382,30 @@ vy_page_index_key_name(enum vy_page_index_key key)
 	return vy_page_index_key_strs[key];
 }
 
+/**
+ * Keys for Vinyl's prefix-compressed page rows.
+ * @sa struct vy_page.
+ */
+enum vy_page_rows_key {
+	/** Statement records of a page. */
+	VY_PAGE_ROWS_ROWS = 1,
+	/** The last key in this enum + 1 */
+	VY_PAGE_ROWS_KEY_MAX = VY_PAGE_ROWS_ROWS + 1
+};
+
+/**
+ * Return vy_page_rows key name by @a key code.
+ * @param key key
+ */
+static inline const char *
+vy_page_rows_key_name(enum vy_page_rows_key key)
+{
+	if (key < VY_PAGE_ROWS_ROWS || key >= VY_PAGE_ROWS_KEY_MAX)
+		return NULL;
+	extern const char *vy_page_rows_key_strs[];
+	return vy_page_rows_key_strs[key];
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif
@@ -548,10 +548,16 @@ key_validate_parts(struct index_def *index_def, const char *key,
 
 const struct space_opts space_opts_default = {
 	/* .temporary = */ false,
+	/* .ttl = */ 0,
+	/* .ttl_field = */ -1,
+	/* .defer_deletes = */ false,
 };
 
 const struct opt_def space_opts_reg[] = {
 	OPT_DEF("temporary", OPT_BOOL, struct space_opts, temporary),
+	OPT_DEF("ttl", OPT_FLOAT, struct space_opts, ttl),
+	OPT_DEF("ttl_field", OPT_INT, struct space_opts, ttl_field),
+	OPT_DEF("defer_deletes", OPT_BOOL, struct space_opts, defer_deletes),
 	{ NULL, opt_type_MAX, 0, 0 }
 };
 
@@ -584,6 +590,21 @@ space_def_check(struct space_def *def, uint32_t namelen, uint32_t engine_namelen
 				  def->name,
 			         "space does not support temporary flag");
 	}
+	if (def->opts.defer_deletes) {
+		Engine *engine = engine_find(def->engine_name);
+		if (! engine_can_defer_deletes(engine->flags))
+			tnt_raise(ClientError, ER_ALTER_SPACE,
+				  def->name,
+				  "space does not support defer_deletes flag");
+	}
+	if (def->opts.ttl < 0) {
+		tnt_raise(ClientError, errcode, def->name,
+			  "ttl must be non-negative");
+	}
+	if (def->opts.ttl > 0 && def->opts.ttl_field < 0) {
+		tnt_raise(ClientError, errcode, def->name,
+			  "ttl_field is not set");
+	}
 }
 
 bool
@@ -388,6 +388,22 @@ struct space_opts {
 	 * - changes are not part of a snapshot
 	 */
 	bool temporary;
+	/**
+	 * Time to live of tuples, in seconds. If set (> 0),
+	 * tuples are deleted in background once the timestamp
+	 * stored in ttl_field is ttl seconds in the past.
+	 * @sa expire.h
+	 */
+	double ttl;
+	/** Number of the timestamp field, 0-based, -1 if unset. */
+	int64_t ttl_field;
+	/**
+	 * REPLACE and DELETE don't look up the old tuple to
+	 * delete it from secondary indexes. Stale secondary
+	 * entries are skipped on read instead, by checking
+	 * them against the primary index. Vinyl only.
+	 */
+	bool defer_deletes;
 };
 
 extern const struct space_opts space_opts_default;
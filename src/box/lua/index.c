@@ -36,6 +36,9 @@
 #include "box/lua/info.h"
 #include "box/lua/tuple.h"
 #include "box/lua/misc.h" /* lbox_encode_tuple_on_gc() */
+#include "fiber.h"
+#include "small/region.h"
+#include <msgpuck.h>
 
 /** {{{ box.index Lua library: access to spaces and indexes
  */
@@ -117,6 +120,26 @@ lbox_upsert(lua_State *L)
 	return luaT_pushtupleornil(L, result);
 }
 
+static int
+lbox_delete_range(lua_State *L)
+{
+	if (lua_gettop(L) != 3 || !lua_isnumber(L, 1) ||
+	    (lua_type(L, 2) != LUA_TTABLE && luaT_istuple(L, 2) == NULL) ||
+	    (lua_type(L, 3) != LUA_TTABLE && luaT_istuple(L, 3) == NULL))
+		return luaL_error(L, "Usage space:delete_range(begin, end)");
+
+	uint32_t space_id = lua_tointeger(L, 1);
+	size_t begin_len;
+	const char *begin = lbox_encode_tuple_on_gc(L, 2, &begin_len);
+	size_t end_len;
+	const char *end = lbox_encode_tuple_on_gc(L, 3, &end_len);
+
+	if (box_delete_range(space_id, begin, begin + begin_len,
+			     end, end + end_len) != 0)
+		return luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_index_delete(lua_State *L)
 {
@@ -169,6 +192,44 @@ lbox_index_get(lua_State *L)
 	return luaT_pushtupleornil(L, tuple);
 }
 
+static int
+lbox_index_get_many(lua_State *L)
+{
+	if (lua_gettop(L) != 3 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2))
+		return luaL_error(L, "Usage index.get_many(space_id, index_id, keys)");
+
+	uint32_t space_id = lua_tointeger(L, 1);
+	uint32_t index_id = lua_tointeger(L, 2);
+	size_t keys_len;
+	const char *keys = lbox_encode_tuple_on_gc(L, 3, &keys_len);
+	const char *keys_end = keys + keys_len;
+	const char *p = keys;
+	uint32_t key_count = mp_decode_array(&p);
+
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	struct tuple **result = (struct tuple **)
+		region_alloc(region, key_count * sizeof(*result) + 1);
+	if (result == NULL)
+		return luaL_error(L, "failed to allocate get_many() result");
+	if (box_index_get_many(space_id, index_id, keys, keys_end,
+			       result) != 0) {
+		region_truncate(region, used);
+		return luaT_error(L);
+	}
+	/* The i-th element is the tuple found by the i-th key or nil. */
+	lua_createtable(L, key_count, 0);
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (result[i] == NULL)
+			continue;
+		luaT_pushtuple(L, result[i]);
+		lua_rawseti(L, -2, i + 1);
+		box_tuple_unref(result[i]);
+	}
+	region_truncate(region, used);
+	return 1;
+}
+
 static int
 lbox_index_min(lua_State *L)
 {
@@ -341,8 +402,10 @@ box_lua_index_init(struct lua_State *L)
 		{"update", lbox_index_update},
 		{"upsert",  lbox_upsert},
 		{"delete",  lbox_index_delete},
+		{"delete_range", lbox_delete_range},
 		{"random", lbox_index_random},
 		{"get",  lbox_index_get},
+		{"get_many", lbox_index_get_many},
 		{"min", lbox_index_min},
 		{"max", lbox_index_max},
 		{"count", lbox_index_count},
@@ -106,6 +106,25 @@ lbox_pushrelay(lua_State *L, struct relay *relay)
 	lua_pushstring(L, "vclock");
 	lbox_pushvclock(L, relay_vclock(relay));
 	lua_settable(L, -3);
+
+	int level = relay_compression_level(relay);
+	if (level == 0)
+		return;
+	const struct relay_compression_stat *stat =
+		relay_compression_stat(relay);
+	lua_pushstring(L, "compression");
+	lua_newtable(L);
+	lua_pushstring(L, "level");
+	lua_pushinteger(L, level);
+	lua_settable(L, -3);
+	lua_pushstring(L, "ratio");
+	lua_pushnumber(L, stat->compressed_size > 0 ?
+		       (double)stat->raw_size / stat->compressed_size : 1);
+	lua_settable(L, -3);
+	lua_pushstring(L, "time");
+	lua_pushnumber(L, stat->time);
+	lua_settable(L, -3);
+	lua_settable(L, -3);
 }
 
 static void
@@ -31,14 +31,17 @@ local default_cfg = {
     log_level           = 5,
     io_collect_interval = nil,
     readahead           = 16320,
+    io_uring            = false,
     snap_io_rate_limit  = nil, -- no limit
     too_long_threshold  = 0.5,
     wal_mode            = "write",
     rows_per_wal        = 500000,
     wal_max_size        = 1024 * 1024 * 1024 * 256,
+    wal_writeback_interval = 0,     -- 0 = disabled
     wal_dir_rescan_delay= 2,
     force_recovery      = false,
     replication         = nil,
+    replication_compression = 0,    -- 0 = disabled
     custom_proc_title   = nil,
     pid_file            = nil,
     background          = false,
@@ -50,6 +53,7 @@ local default_cfg = {
     -- snapshot_daemon
     checkpoint_interval = 0,        -- 0 = disabled
     checkpoint_count    = 6,
+    checkpoint_delta_count = 0,     -- 0 = only full checkpoints
 }
 
 -- types of available options
@@ -78,14 +82,17 @@ local template_cfg = {
     log_level           = 'number',
     io_collect_interval = 'number',
     readahead           = 'number',
+    io_uring            = 'boolean',
     snap_io_rate_limit  = 'number',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
     rows_per_wal        = 'number',
     wal_max_size        = 'number',
+    wal_writeback_interval = 'number',
     wal_dir_rescan_delay= 'number',
     force_recovery      = 'boolean',
     replication         = 'string, number, table',
+    replication_compression = 'number',
     custom_proc_title   = 'string',
     pid_file            = 'string',
     background          = 'boolean',
@@ -93,6 +100,7 @@ local template_cfg = {
     coredump            = 'boolean',
     checkpoint_interval = 'number',
     checkpoint_count    = 'number',
+    checkpoint_delta_count = 'number',
     read_only           = 'boolean',
     hot_standby         = 'boolean'
 }
@@ -139,9 +147,12 @@ local dynamic_cfg = {
     too_long_threshold      = private.cfg_set_too_long_threshold,
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
     read_only               = private.cfg_set_read_only,
+    -- affects new relays only
+    replication_compression = private.cfg_set_replication_compression,
     -- snapshot_daemon
     checkpoint_interval     = box.internal.snapshot_daemon.set_checkpoint_interval,
     checkpoint_count        = box.internal.snapshot_daemon.set_checkpoint_count,
+    checkpoint_delta_count  = private.cfg_set_checkpoint_delta_count,
     -- do nothing, affects new replicas, which query this value on start
     wal_dir_rescan_delay    = function() end,
     custom_proc_title       = function()
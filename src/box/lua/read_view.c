@@ -0,0 +1,189 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "box/lua/read_view.h"
+
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+
+#include "lua/utils.h"
+#include "fiber.h"
+#include "small/region.h"
+#include "box/memtx_read_view.h"
+#include "box/memtx_tuple.h"
+
+/**
+ * Open a read view over spaces listed in a Lua table
+ * at the given stack index.
+ */
+static struct memtx_read_view *
+lbox_read_view_open(struct lua_State *L, int idx)
+{
+	if (!lua_istable(L, idx))
+		luaL_error(L, "expected a table of space ids");
+	uint32_t space_count = lua_objlen(L, idx);
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	uint32_t *space_ids = (uint32_t *)
+		region_alloc(region, space_count * sizeof(*space_ids) + 1);
+	if (space_ids == NULL)
+		luaL_error(L, "failed to allocate space ids");
+	for (uint32_t i = 0; i < space_count; i++) {
+		lua_rawgeti(L, idx, i + 1);
+		if (!lua_isnumber(L, -1)) {
+			region_truncate(region, used);
+			luaL_error(L, "expected a table of space ids");
+		}
+		space_ids[i] = lua_tointeger(L, -1);
+		lua_pop(L, 1);
+	}
+	struct memtx_read_view *rv = box_read_view_open(space_ids,
+							space_count);
+	region_truncate(region, used);
+	if (rv == NULL)
+		luaT_error(L);
+	return rv;
+}
+
+/**
+ * box.read_view.export({space_id, ...}, path)
+ * Write a consistent copy of spaces to a file in the snapshot
+ * format without blocking the tx thread.
+ */
+static int
+lbox_read_view_export(struct lua_State *L)
+{
+	if (lua_gettop(L) != 2 || !lua_isstring(L, 2))
+		return luaL_error(L, "Usage: box.read_view.export({space_id, "
+				  "...}, path)");
+	struct memtx_read_view *rv = lbox_read_view_open(L, 1);
+	int rc = memtx_read_view_export(rv, lua_tostring(L, 2));
+	memtx_read_view_delete(rv);
+	if (rc != 0)
+		return luaT_error(L);
+	lua_pushboolean(L, true);
+	return 1;
+}
+
+/**
+ * box.read_view.stat({space_id, ...})
+ * Count tuples and their total size in spaces without
+ * blocking the tx thread.
+ */
+static int
+lbox_read_view_stat(struct lua_State *L)
+{
+	if (lua_gettop(L) != 1)
+		return luaL_error(L, "Usage: box.read_view.stat({space_id, "
+				  "...})");
+	struct memtx_read_view *rv = lbox_read_view_open(L, 1);
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	struct memtx_read_view_stat *stat = (struct memtx_read_view_stat *)
+		region_alloc(region, rv->space_count * sizeof(*stat) + 1);
+	if (stat == NULL) {
+		memtx_read_view_delete(rv);
+		return luaL_error(L, "failed to allocate read view stat");
+	}
+	int rc = memtx_read_view_stat(rv, stat);
+	uint32_t space_count = rv->space_count;
+	memtx_read_view_delete(rv);
+	if (rc != 0) {
+		region_truncate(region, used);
+		return luaT_error(L);
+	}
+	lua_newtable(L);
+	for (uint32_t i = 0; i < space_count; i++) {
+		lua_pushnumber(L, stat[i].space_id);
+		lua_newtable(L);
+
+		lua_pushstring(L, "count");
+		luaL_pushuint64(L, stat[i].count);
+		lua_settable(L, -3);
+
+		lua_pushstring(L, "bsize");
+		luaL_pushuint64(L, stat[i].bsize);
+		lua_settable(L, -3);
+
+		lua_settable(L, -3);
+	}
+	region_truncate(region, used);
+	return 1;
+}
+
+static void
+lbox_read_view_info_space(uint32_t space_id, size_t size, void *arg)
+{
+	struct lua_State *L = (struct lua_State *) arg;
+	lua_pushnumber(L, space_id);
+	lua_newtable(L);
+
+	lua_pushstring(L, "delayed_free_size");
+	luaL_pushuint64(L, size);
+	lua_settable(L, -3);
+
+	lua_settable(L, -3);
+}
+
+/**
+ * box.read_view.info()
+ * Memory pinned by open read views, in total and by space.
+ */
+static int
+lbox_read_view_info(struct lua_State *L)
+{
+	lua_newtable(L);
+
+	lua_pushstring(L, "delayed_free_size");
+	luaL_pushuint64(L, memtx_tuple_delayed_free_size());
+	lua_settable(L, -3);
+
+	lua_pushstring(L, "spaces");
+	lua_newtable(L);
+	memtx_read_view_delayed_free_stat(lbox_read_view_info_space, L);
+	lua_settable(L, -3);
+
+	return 1;
+}
+
+void
+box_lua_read_view_init(struct lua_State *L)
+{
+	static const struct luaL_reg read_view_lib[] = {
+		{"export", lbox_read_view_export},
+		{"stat", lbox_read_view_stat},
+		{"info", lbox_read_view_info},
+		{NULL, NULL}
+	};
+
+	luaL_register(L, "box.read_view", read_view_lib);
+	lua_pop(L, 1);
+}
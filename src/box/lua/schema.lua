@@ -241,6 +241,9 @@ box.schema.space.create = function(name, options)
         user = 'string, number',
         format = 'table',
         temporary = 'boolean',
+        ttl = 'number',
+        ttl_field = 'number',
+        defer_deletes = 'boolean',
     }
     local options_defaults = {
         engine = 'memtx',
@@ -282,6 +285,9 @@ box.schema.space.create = function(name, options)
     -- filter out global parameters from the options array
     local space_options = setmetatable({
         temporary = options.temporary and true or nil,
+        ttl = options.ttl,
+        ttl_field = options.ttl_field and options.ttl_field - 1 or nil,
+        defer_deletes = options.defer_deletes and true or nil,
     }, { __serialize = 'map' })
     _space:insert{id, uid, name, options.engine, options.field_count,
         space_options, format}
@@ -870,6 +876,19 @@ function box.schema.space.bless(space)
         key = keify(key)
         return internal.get(index.space_id, index.id, key)
     end
+    -- Batched get: result[i] is the tuple found by keys[i] or nil,
+    -- so the result may have holes; iterate over it with #keys.
+    index_mt.get_many = function(index, keys)
+        check_index_arg(index, 'get_many')
+        if type(keys) ~= 'table' then
+            box.error(box.error.PROC_LUA, "Usage: index:get_many({key1, key2, ...})")
+        end
+        local keys_t = {}
+        for i, key in ipairs(keys) do
+            keys_t[i] = keify(key)
+        end
+        return internal.get_many(index.space_id, index.id, keys_t)
+    end
 
     local function check_select_opts(opts, key_is_nil)
         local offset = 0
@@ -991,6 +1010,10 @@ function box.schema.space.bless(space)
         check_space_arg(space, 'get')
         return check_primary_index(space):get(key)
     end
+    space_mt.get_many = function(space, keys)
+        check_space_arg(space, 'get_many')
+        return check_primary_index(space):get_many(keys)
+    end
     space_mt.select = function(space, key, opts)
         check_space_arg(space, 'select')
         return check_primary_index(space):select(key, opts)
@@ -1022,6 +1045,13 @@ function box.schema.space.bless(space)
         check_space_arg(space, 'delete')
         return check_primary_index(space):delete(key)
     end
+    -- Delete all tuples with the primary key in [begin, end),
+    -- nil stands for -inf for begin and +inf for end.
+    space_mt.delete_range = function(space, begin, end_key)
+        check_space_arg(space, 'delete_range')
+        check_primary_index(space)
+        return internal.delete_range(space.id, keify(begin), keify(end_key))
+    end
 -- Assumes that spaceno has a TREE (NUM) primary key
 -- inserts a tuple after getting the next value of the
 -- primary key and returns it back to the user
@@ -39,6 +39,7 @@
 #include <lualib.h>
 
 #include "lua/utils.h"
+#include "box/expire.h"
 
 extern struct rmean *rmean_box;
 extern struct rmean *rmean_error;
@@ -124,6 +125,28 @@ lbox_stat_net_call(struct lua_State *L)
 	return 1;
 }
 
+static int
+lbox_stat_expire_index(struct lua_State *L)
+{
+	luaL_checkstring(L, -1);
+	if (strcmp(lua_tostring(L, -1), "lag") == 0) {
+		lua_pushnumber(L, expire_lag());
+		return 1;
+	}
+	return rmean_foreach(rmean_expire, seek_stat_item, L);
+}
+
+static int
+lbox_stat_expire_call(struct lua_State *L)
+{
+	lua_newtable(L);
+	rmean_foreach(rmean_expire, set_stat_item, L);
+	lua_pushstring(L, "lag");
+	lua_pushnumber(L, expire_lag());
+	lua_settable(L, -3);
+	return 1;
+}
+
 static const struct luaL_reg lbox_stat_meta [] = {
 	{"__index", lbox_stat_index},
 	{"__call",  lbox_stat_call},
@@ -136,6 +159,12 @@ static const struct luaL_reg lbox_stat_net_meta [] = {
 	{NULL, NULL}
 };
 
+static const struct luaL_reg lbox_stat_expire_meta [] = {
+	{"__index", lbox_stat_expire_index},
+	{"__call",  lbox_stat_expire_call},
+	{NULL, NULL}
+};
+
 /** Initialize box.stat package. */
 void
 box_lua_stat_init(struct lua_State *L)
@@ -158,5 +187,12 @@ box_lua_stat_init(struct lua_State *L)
 	luaL_register(L, NULL, lbox_stat_net_meta);
 	lua_setmetatable(L, -2);
 	lua_pop(L, 1); /* stat net module */
+
+	luaL_register_module(L, "box.stat.expire", statlib);
+
+	lua_newtable(L);
+	luaL_register(L, NULL, lbox_stat_expire_meta);
+	lua_setmetatable(L, -2);
+	lua_pop(L, 1); /* stat expire module */
 }
 
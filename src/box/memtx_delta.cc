@@ -0,0 +1,224 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "memtx_delta.h"
+
+#include "msgpuck/msgpuck.h"
+#include "fiber.h"
+#include "say.h"
+
+#include "iproto_constants.h"
+#include "schema.h"
+#include "space.h"
+#include "index.h"
+#include "tuple.h"
+
+enum { MEMTX_DELTA_LOG_BUF_SIZE = 16 * 1024 };
+
+/** Changes since the last checkpoint. */
+static struct memtx_delta_log memtx_delta_current;
+/** Set if changes are logged. */
+static bool memtx_delta_is_enabled;
+
+static void
+memtx_delta_log_create(struct memtx_delta_log *log)
+{
+	ibuf_create(&log->data, &cord()->slabc, MEMTX_DELTA_LOG_BUF_SIZE);
+	log->is_overflow = false;
+}
+
+void
+memtx_delta_log_destroy(struct memtx_delta_log *log)
+{
+	ibuf_destroy(&log->data);
+}
+
+/** Mark the current log as overflown and free its rows. */
+static void
+memtx_delta_overflow(void)
+{
+	memtx_delta_current.is_overflow = true;
+	ibuf_destroy(&memtx_delta_current.data);
+	ibuf_create(&memtx_delta_current.data, &cord()->slabc,
+		    MEMTX_DELTA_LOG_BUF_SIZE);
+}
+
+void
+memtx_delta_enable(bool is_complete)
+{
+	if (memtx_delta_is_enabled)
+		return;
+	memtx_delta_log_create(&memtx_delta_current);
+	memtx_delta_current.is_overflow = !is_complete;
+	memtx_delta_is_enabled = true;
+}
+
+void
+memtx_delta_disable(void)
+{
+	if (!memtx_delta_is_enabled)
+		return;
+	memtx_delta_log_destroy(&memtx_delta_current);
+	memtx_delta_is_enabled = false;
+}
+
+bool
+memtx_delta_is_complete(void)
+{
+	return memtx_delta_is_enabled && !memtx_delta_current.is_overflow;
+}
+
+void
+memtx_delta_take(struct memtx_delta_log *log)
+{
+	if (!memtx_delta_is_enabled) {
+		memtx_delta_log_create(log);
+		log->is_overflow = true;
+		return;
+	}
+	*log = memtx_delta_current;
+	memtx_delta_log_create(&memtx_delta_current);
+}
+
+void
+memtx_delta_restore(struct memtx_delta_log *log)
+{
+	if (!memtx_delta_is_enabled) {
+		memtx_delta_log_destroy(log);
+		return;
+	}
+	if (log->is_overflow || memtx_delta_current.is_overflow) {
+		memtx_delta_log_destroy(log);
+		memtx_delta_overflow();
+		return;
+	}
+	struct ibuf *curr = &memtx_delta_current.data;
+	size_t size = ibuf_used(curr);
+	void *buf = ibuf_alloc(&log->data, size);
+	if (buf == NULL) {
+		memtx_delta_log_destroy(log);
+		memtx_delta_overflow();
+		return;
+	}
+	memcpy(buf, curr->rpos, size);
+	ibuf_destroy(curr);
+	*curr = log->data;
+}
+
+/**
+ * Append a row to the current log. The request body is
+ * {IPROTO_SPACE_ID: space_id, key: data}.
+ */
+static void
+memtx_delta_write(uint32_t type, uint32_t space_id, uint32_t key,
+		  const char *data, uint32_t size)
+{
+	uint32_t bsize = mp_sizeof_map(2) +
+			 mp_sizeof_uint(IPROTO_SPACE_ID) +
+			 mp_sizeof_uint(space_id) +
+			 mp_sizeof_uint(key) + size;
+	struct memtx_delta_row *row = (struct memtx_delta_row *)
+		ibuf_alloc(&memtx_delta_current.data,
+			   memtx_delta_row_size(bsize));
+	if (row == NULL) {
+		say_warn("failed to allocate memory for memtx delta log, "
+			 "the next checkpoint will be full");
+		memtx_delta_overflow();
+		return;
+	}
+	row->type = type;
+	row->bsize = bsize;
+	char *pos = (char *) (row + 1);
+	pos = mp_encode_map(pos, 2);
+	pos = mp_encode_uint(pos, IPROTO_SPACE_ID);
+	pos = mp_encode_uint(pos, space_id);
+	pos = mp_encode_uint(pos, key);
+	memcpy(pos, data, size);
+}
+
+/** Return true if changes of a space must be logged. */
+static bool
+memtx_delta_need_log(struct space *space)
+{
+	if (!memtx_delta_is_enabled || memtx_delta_current.is_overflow)
+		return false;
+	if (space_is_temporary(space))
+		return false;
+	if (space_is_system(space)) {
+		/*
+		 * A DDL statement may change or drop a space
+		 * without logging deletions of its tuples.
+		 */
+		memtx_delta_overflow();
+		return false;
+	}
+	return true;
+}
+
+void
+memtx_delta_on_replace(struct space *space, struct tuple *old_tuple,
+		       struct tuple *new_tuple)
+{
+	if (!memtx_delta_need_log(space))
+		return;
+	if (old_tuple == NULL || new_tuple != NULL)
+		return; /* written from the read view */
+	Index *pk = space->index[0];
+	uint32_t size;
+	const char *key = tuple_extract_key(old_tuple, &pk->index_def->key_def,
+					    &size);
+	if (key == NULL) {
+		diag_clear(diag_get());
+		memtx_delta_overflow();
+		return;
+	}
+	memtx_delta_write(IPROTO_DELETE, space_id(space), IPROTO_KEY,
+			  key, size);
+}
+
+void
+memtx_delta_on_rollback(struct space *space, struct tuple *old_tuple,
+			struct tuple *new_tuple)
+{
+	/*
+	 * Only a rolled back deletion needs to be logged:
+	 * a restored tuple may be unchanged since the base
+	 * checkpoint and thus not be written from the read
+	 * view, while its deletion has been logged.
+	 */
+	if (!memtx_delta_need_log(space))
+		return;
+	if (old_tuple == NULL || new_tuple != NULL)
+		return;
+	uint32_t size;
+	const char *data = tuple_data_range(old_tuple, &size);
+	memtx_delta_write(IPROTO_REPLACE, space_id(space), IPROTO_TUPLE,
+			  data, size);
+}
@@ -0,0 +1,147 @@
+#ifndef TARANTOOL_BOX_MEMTX_DELTA_H_INCLUDED
+#define TARANTOOL_BOX_MEMTX_DELTA_H_INCLUDED
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include "small/ibuf.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Delta (incremental) memtx checkpoints.
+ *
+ * A delta snapshot contains only changes made since the
+ * previous checkpoint, the base, and is recovered by loading
+ * the chain of files it refers to, starting from a full
+ * snapshot (@sa xlog_meta::base_signature).
+ *
+ * A delta snapshot consists of DELETE and REPLACE rows.
+ * Inserted and updated tuples are found by their versions: a
+ * tuple with version >= the generation of the base checkpoint
+ * read view has changed since the base was taken (@sa
+ * memtx_tuple_version()) and is written as REPLACE. Deleted
+ * tuples leave no trace in the read view, so deletions are
+ * recorded in the change log, along with deletions undone by a
+ * rollback. Logged rows are written before the changed tuples,
+ * in the order the changes were made.
+ *
+ * The log is not maintained for temporary spaces. A change of
+ * a system space (i.e. DDL) overflows the log, which makes the
+ * next checkpoint full.
+ */
+struct memtx_delta_log {
+	/** Logged rows, see memtx_delta_row. */
+	struct ibuf data;
+	/** Set if a change wasn't logged. */
+	bool is_overflow;
+};
+
+/** Header of a row in memtx_delta_log::data. */
+struct memtx_delta_row {
+	/** IPROTO_DELETE or IPROTO_REPLACE. */
+	uint32_t type;
+	/** Size of the request body following the header. */
+	uint32_t bsize;
+};
+
+/**
+ * Size of a row in the log including the header. Rows are
+ * padded to keep headers aligned.
+ */
+static inline size_t
+memtx_delta_row_size(uint32_t bsize)
+{
+	return sizeof(struct memtx_delta_row) +
+	       ((bsize + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1));
+}
+
+/**
+ * Start logging changes. If @a is_complete is false, changes
+ * made before the call are unknown and the log is created
+ * overflown.
+ */
+void
+memtx_delta_enable(bool is_complete);
+
+/** Stop logging changes and free the log. */
+void
+memtx_delta_disable(void);
+
+/**
+ * Return true if all changes since the last checkpoint are
+ * logged, i.e. the next checkpoint may be a delta.
+ */
+bool
+memtx_delta_is_complete(void);
+
+/**
+ * Move the log to @a log and start a new one. Called when
+ * a checkpoint read view is opened.
+ */
+void
+memtx_delta_take(struct memtx_delta_log *log);
+
+/**
+ * Put rows of a log taken with memtx_delta_take() back in
+ * front of the current log. Called if a checkpoint is
+ * aborted. @a log is destroyed.
+ */
+void
+memtx_delta_restore(struct memtx_delta_log *log);
+
+/** Free a log taken with memtx_delta_take(). */
+void
+memtx_delta_log_destroy(struct memtx_delta_log *log);
+
+struct space;
+struct tuple;
+
+/** Log a change of a memtx space. */
+void
+memtx_delta_on_replace(struct space *space, struct tuple *old_tuple,
+		       struct tuple *new_tuple);
+
+/**
+ * Log a rollback of a change of a memtx space, @a old_tuple
+ * is put back to the space in place of @a new_tuple.
+ */
+void
+memtx_delta_on_rollback(struct space *space, struct tuple *old_tuple,
+			struct tuple *new_tuple);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_MEMTX_DELTA_H_INCLUDED */
@@ -31,6 +31,8 @@
 #include "memtx_engine.h"
 #include "memtx_space.h"
 #include "memtx_tuple.h"
+#include "memtx_read_view.h"
+#include "memtx_delta.h"
 
 #include "coeio_file.h"
 #include "scoped_guard.h"
@@ -44,6 +46,8 @@
 #include "bootstrap.h"
 #include "replication.h"
 #include "schema.h"
+#include "box.h"
+#include "gc.h"
 
 /** For all memory used by all indexes.
  * If you decide to use memtx_index_arena or
@@ -124,7 +128,12 @@ MemtxEngine::MemtxEngine(const char *snap_dirname, bool force_recovery,
 	m_checkpoint(0),
 	m_state(MEMTX_INITIALIZED),
 	m_snap_io_rate_limit(0),
-	m_force_recovery(force_recovery)
+	m_force_recovery(force_recovery),
+	m_checkpoint_delta_count(0),
+	m_delta_chain_length(0),
+	m_last_checkpoint_signature(-1),
+	m_last_checkpoint_generation(0),
+	m_delta_chain_is_pinned(false)
 {
 	memtx_tuple_init(tuple_arena_max_size, objsize_min, objsize_max,
 			 alloc_factor);
@@ -135,6 +144,7 @@ MemtxEngine::MemtxEngine(const char *snap_dirname, bool force_recovery,
 
 MemtxEngine::~MemtxEngine()
 {
+	memtx_delta_disable();
 	xdir_destroy(&m_snap_dir);
 
 	memtx_tuple_free();
@@ -146,17 +156,43 @@ MemtxEngine::recoverSnapshot(const struct vclock *vclock)
 	/* Process existing snapshot */
 	say_info("recovery start");
 	int64_t signature = vclock_sum(vclock);
+	m_delta_chain_length = 0;
+	recoverSnapshotFile(signature);
+	m_last_checkpoint_signature = signature;
+	/*
+	 * Tuples recovered so far are in the checkpoint,
+	 * changes replayed from WAL are not.
+	 */
+	m_last_checkpoint_generation = memtx_tuple_new_generation();
+	if (m_checkpoint_delta_count > 0)
+		memtx_delta_enable(true);
+}
+
+/**
+ * Recover a snapshot file. If it's a delta snapshot, the
+ * snapshot it's based on is recovered first.
+ */
+void
+MemtxEngine::recoverSnapshotFile(int64_t signature)
+{
 	const char *filename = xdir_format_filename(&m_snap_dir, signature,
 						    NONE);
-
-	say_info("recovering from `%s'", filename);
 	struct xlog_cursor cursor;
 	xlog_cursor_open_xc(&cursor, filename);
 	INSTANCE_UUID = cursor.meta.instance_uuid;
 	auto reader_guard = make_scoped_guard([&]{
 		xlog_cursor_close(&cursor, false);
 	});
+	if (cursor.meta.base_signature >= 0) {
+		recoverSnapshotFile(cursor.meta.base_signature);
+		m_delta_chain_length++;
+	} else {
+		pinDeltaChain(&cursor.meta.vclock);
+	}
+	/* The buffer is reused by nested calls. */
+	filename = cursor.name;
 
+	say_info("recovering from `%s'", filename);
 	struct xrow_header row;
 	uint64_t row_count = 0;
 	while (xlog_cursor_next_xc(&cursor, &row, m_force_recovery) == 0) {
@@ -190,7 +226,9 @@ void
 MemtxEngine::recoverSnapshotRow(struct xrow_header *row)
 {
 	assert(row->bodycnt == 1); /* always 1 for read */
-	if (row->type != IPROTO_INSERT) {
+	/* Delta snapshots consist of REPLACE and DELETE rows. */
+	if (row->type != IPROTO_INSERT && row->type != IPROTO_REPLACE &&
+	    row->type != IPROTO_DELETE) {
 		tnt_raise(ClientError, ER_UNKNOWN_REQUEST_TYPE,
 			  (uint32_t) row->type);
 	}
@@ -228,15 +266,26 @@ MemtxEngine::beginInitialRecovery(struct vclock *vclock)
 	m_state = (m_force_recovery ? MEMTX_OK : MEMTX_INITIAL_RECOVERY);
 }
 
+void
+MemtxEngine::beginDeltaRecovery()
+{
+	if (m_state != MEMTX_INITIAL_RECOVERY)
+		return;
+	space_foreach(memtx_end_build_primary_key, this);
+	m_state = MEMTX_FINAL_RECOVERY;
+}
+
 void
 MemtxEngine::beginFinalRecovery()
 {
 	if (m_state == MEMTX_OK)
 		return;
 
-	assert(m_state == MEMTX_INITIAL_RECOVERY);
+	assert(m_state == MEMTX_INITIAL_RECOVERY ||
+	       m_state == MEMTX_FINAL_RECOVERY);
 	/* End of the fast path: loaded the primary key. */
-	space_foreach(memtx_end_build_primary_key, this);
+	if (m_state == MEMTX_INITIAL_RECOVERY)
+		space_foreach(memtx_end_build_primary_key, this);
 
 	if (!m_force_recovery) {
 		/*
@@ -272,6 +321,31 @@ MemtxEngine::endRecovery()
 		m_state = MEMTX_OK;
 		space_foreach(memtx_build_secondary_keys, this);
 	}
+	/*
+	 * After bootstrap or join the first checkpoint is full,
+	 * so changes made before this point are not needed.
+	 */
+	if (m_checkpoint_delta_count > 0)
+		memtx_delta_enable(false);
+}
+
+void
+MemtxEngine::setCheckpointDeltaCount(int count)
+{
+	m_checkpoint_delta_count = count;
+	if (count == 0)
+		memtx_delta_disable();
+	else if (m_state == MEMTX_OK)
+		memtx_delta_enable(false);
+}
+
+void
+MemtxEngine::pinDeltaChain(const struct vclock *vclock)
+{
+	if (m_delta_chain_is_pinned)
+		gc_unref_checkpoint(&m_delta_chain_vclock);
+	vclock_copy(&m_delta_chain_vclock, vclock);
+	m_delta_chain_is_pinned = gc_ref_checkpoint(vclock) == 0;
 }
 
 Handler *MemtxEngine::open()
@@ -500,8 +574,15 @@ MemtxEngine::begin(struct txn *txn)
 void
 MemtxEngine::rollbackStatement(struct txn *, struct txn_stmt *stmt)
 {
-	if (stmt->old_tuple == NULL && stmt->new_tuple == NULL)
+	if (stmt->old_tuple == NULL && stmt->new_tuple == NULL) {
+		if (stmt->engine_savepoint != NULL)
+			memtx_rollback_delete_range(stmt);
+		return;
+	}
+	if (stmt->old_tuple == stmt->new_tuple) {
+		memtx_rollback_update_in_place(stmt);
 		return;
+	}
 	struct space *space = stmt->space;
 	int index_count;
 	struct MemtxSpace *handler = (struct MemtxSpace *) space->handler;
@@ -520,6 +601,8 @@ MemtxEngine::rollbackStatement(struct txn *, struct txn_stmt *stmt)
 		Index *index = space->index[i];
 		index->replace(stmt->new_tuple, stmt->old_tuple, DUP_INSERT);
 	}
+	if (index_count > 0)
+		memtx_delta_on_rollback(space, stmt->old_tuple, stmt->new_tuple);
 	/** Rollback change of bsize */
 	space_bsize_rollback(space, stmt->bsize_change);
 
@@ -528,6 +611,7 @@ MemtxEngine::rollbackStatement(struct txn *, struct txn_stmt *stmt)
 
 	stmt->old_tuple = NULL;
 	stmt->new_tuple = NULL;
+	stmt->engine_savepoint = NULL;
 }
 
 void
@@ -548,6 +632,9 @@ MemtxEngine::commit(struct txn *txn, int64_t signature)
 	stailq_foreach_entry(stmt, &txn->stmts, next) {
 		if (stmt->old_tuple)
 			tuple_unref(stmt->old_tuple);
+		else if (stmt->new_tuple == NULL &&
+			 stmt->engine_savepoint != NULL)
+			memtx_commit_delete_range(stmt);
 	}
 }
 
@@ -576,86 +663,34 @@ MemtxEngine::bootstrap()
 		recoverSnapshotRow(&row);
 }
 
-static void
-checkpoint_write_row(struct xlog *l, struct xrow_header *row)
-{
-	static ev_tstamp last = 0;
-	if (last == 0) {
-		ev_now_update(loop());
-		last = ev_now(loop());
-	}
-
-	row->tm = last;
-	row->replica_id = 0;
-	/**
-	 * Rows in snapshot are numbered from 1 to %rows.
-	 * This makes streaming such rows to a replica or
-	 * to recovery look similar to streaming a normal
-	 * WAL. @sa the place which skips old rows in
-	 * recovery_apply_row().
-	 */
-	row->lsn = l->rows + l->tx_rows;
-	row->sync = 0; /* don't write sync to wal */
-
-	ssize_t written = xlog_write_row(l, row);
-	fiber_gc();
-	if (written < 0) {
-		diag_raise();
-	}
-
-	if ((l->rows + l->tx_rows) % 100000 == 0)
-		say_crit("%.1fM rows written", (l->rows + l->tx_rows) / 1000000.0);
-
-}
-
-static void
-checkpoint_write_tuple(struct xlog *l, uint32_t n, struct tuple *tuple)
-{
-	struct request_replace_body body;
-	body.m_body = 0x82; /* map of two elements. */
-	body.k_space_id = IPROTO_SPACE_ID;
-	body.m_space_id = 0xce; /* uint32 */
-	body.v_space_id = mp_bswap_u32(n);
-	body.k_tuple = IPROTO_TUPLE;
-
-	struct xrow_header row;
-	memset(&row, 0, sizeof(struct xrow_header));
-	row.type = IPROTO_INSERT;
-
-	row.bodycnt = 2;
-	row.body[0].iov_base = &body;
-	row.body[0].iov_len = sizeof(body);
-	uint32_t bsize;
-	row.body[1].iov_base = (char *) tuple_data_range(tuple, &bsize);
-	row.body[1].iov_len = bsize;
-	checkpoint_write_row(l, &row);
-}
-
-struct checkpoint_entry {
-	struct space *space;
-	struct iterator *iterator;
-	struct rlist link;
-};
-
 struct checkpoint {
-	/**
-	 * List of MemTX spaces to snapshot, with consistent
-	 * read view iterators.
-	 */
-	struct rlist entries;
+	/** Read view of all memtx spaces to snapshot. */
+	struct memtx_read_view *rv;
 	uint64_t snap_io_rate_limit;
 	struct cord cord;
 	bool waiting_for_snap_thread;
 	/** The vclock of the snapshot file. */
 	struct vclock vclock;
 	struct xdir dir;
+	/** Set if only changes since the last checkpoint are written. */
+	bool is_delta;
+	/** Signature of the checkpoint a delta is based on. */
+	int64_t base_signature;
+	/** Tuple generation of the base checkpoint read view. */
+	uint32_t base_generation;
+	/** Changes not seen in the read view, @sa memtx_delta.h. */
+	struct memtx_delta_log delta_log;
+	/** memtx_tuple_lost_version_count() at start. */
+	uint64_t lost_version_count;
 };
 
 static void
 checkpoint_init(struct checkpoint *ckpt, const char *snap_dirname,
 		uint64_t snap_io_rate_limit)
 {
-	ckpt->entries = RLIST_HEAD_INITIALIZER(ckpt->entries);
+	ckpt->rv = memtx_read_view_new();
+	if (ckpt->rv == NULL)
+		diag_raise();
 	ckpt->waiting_for_snap_thread = false;
 	xdir_create(&ckpt->dir, snap_dirname, SNAP, &INSTANCE_UUID);
 	ckpt->snap_io_rate_limit = snap_io_rate_limit;
@@ -666,13 +701,8 @@ checkpoint_init(struct checkpoint *ckpt, const char *snap_dirname,
 static void
 checkpoint_destroy(struct checkpoint *ckpt)
 {
-	struct checkpoint_entry *entry;
-	rlist_foreach_entry(entry, &ckpt->entries, link) {
-		Index *pk = space_index(entry->space, 0);
-		pk->destroyReadViewForIterator(entry->iterator);
-		entry->iterator->free(entry->iterator);
-	}
-	ckpt->entries = RLIST_HEAD_INITIALIZER(ckpt->entries);
+	memtx_read_view_delete(ckpt->rv);
+	ckpt->rv = NULL;
 	xdir_destroy(&ckpt->dir);
 }
 
@@ -684,19 +714,10 @@ checkpoint_add_space(struct space *sp, void *data)
 		return;
 	if (!space_is_memtx(sp))
 		return;
-	Index *pk = space_index(sp, 0);
-	if (!pk)
+	if (space_index(sp, 0) == NULL)
 		return;
 	struct checkpoint *ckpt = (struct checkpoint *)data;
-	struct checkpoint_entry *entry;
-	entry = region_alloc_object_xc(&fiber()->gc, struct checkpoint_entry);
-	rlist_add_tail_entry(&ckpt->entries, entry, link);
-
-	entry->space = sp;
-	entry->iterator = pk->allocIterator();
-
-	pk->initIterator(entry->iterator, ITER_ALL, NULL, 0);
-	pk->createReadViewForIterator(entry->iterator);
+	memtx_read_view_add_space(ckpt->rv, sp);
 };
 
 int
@@ -705,21 +726,21 @@ checkpoint_f(va_list ap)
 	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
 
 	struct xlog snap;
-	if (xdir_create_xlog(&ckpt->dir, &snap, &ckpt->vclock) != 0)
+	if (xdir_create_xlog_delta(&ckpt->dir, &snap, &ckpt->vclock,
+				   ckpt->is_delta ? ckpt->base_signature :
+				   -1) != 0)
 		diag_raise();
 
 	auto guard = make_scoped_guard([&]{ xlog_close(&snap, false); });
 	snap.rate_limit = ckpt->snap_io_rate_limit;
 
-	say_info("saving snapshot `%s'", snap.filename);
-	struct checkpoint_entry *entry;
-	rlist_foreach_entry(entry, &ckpt->entries, link) {
-		struct tuple *tuple;
-		struct iterator *it = entry->iterator;
-		for (tuple = it->next(it); tuple; tuple = it->next(it)) {
-			checkpoint_write_tuple(&snap, space_id(entry->space),
-					       tuple);
-		}
+	if (ckpt->is_delta) {
+		say_info("saving delta snapshot `%s'", snap.filename);
+		memtx_read_view_write_delta(ckpt->rv, &ckpt->delta_log,
+					    ckpt->base_generation, &snap);
+	} else {
+		say_info("saving snapshot `%s'", snap.filename);
+		memtx_read_view_write(ckpt->rv, &snap);
 	}
 	xlog_flush(&snap);
 	say_info("done");
@@ -731,13 +752,30 @@ MemtxEngine::beginCheckpoint()
 {
 	assert(m_checkpoint == 0);
 
-	m_checkpoint = region_alloc_object_xc(&fiber()->gc, struct checkpoint);
-
-	checkpoint_init(m_checkpoint, m_snap_dir.dirname, m_snap_io_rate_limit);
-	space_foreach(checkpoint_add_space, m_checkpoint);
+	struct checkpoint *ckpt =
+		region_alloc_object_xc(&fiber()->gc, struct checkpoint);
 
-	/* increment snapshot version; set tuple deletion to delayed mode */
-	memtx_tuple_begin_snapshot();
+	checkpoint_init(ckpt, m_snap_dir.dirname, m_snap_io_rate_limit);
+	auto guard = make_scoped_guard([=]{ checkpoint_destroy(ckpt); });
+	space_foreach(checkpoint_add_space, ckpt);
+	guard.is_active = false;
+	/*
+	 * Make a delta checkpoint unless the chain is too
+	 * long or some changes since the last one are unknown.
+	 */
+	ckpt->is_delta = (m_checkpoint_delta_count > 0 &&
+			  m_last_checkpoint_signature >= 0 &&
+			  m_delta_chain_length < m_checkpoint_delta_count &&
+			  memtx_delta_is_complete());
+	ckpt->base_signature = m_last_checkpoint_signature;
+	ckpt->base_generation = m_last_checkpoint_generation;
+	/* The log must be taken along with the read view. */
+	memtx_delta_take(&ckpt->delta_log);
+	ckpt->lost_version_count = memtx_tuple_lost_version_count();
+	m_checkpoint = ckpt;
+
+	/* let vinyl know that a new snapshot has been started */
+	snapshot_version++;
 	return 0;
 }
 
@@ -756,6 +794,16 @@ MemtxEngine::waitCheckpoint(struct vclock *vclock)
 
 	/* wait for memtx-part snapshot completion */
 	int result = cord_cojoin(&m_checkpoint->cord);
+	if (result == 0 && m_checkpoint->is_delta &&
+	    memtx_tuple_lost_version_count() !=
+	    m_checkpoint->lost_version_count) {
+		/*
+		 * A delta is written by tuple versions, which
+		 * may have been lost for deleted tuples.
+		 */
+		diag_set(OutOfMemory, 0, "malloc", "delayed free list");
+		result = -1;
+	}
 	if (result != 0)
 		error_log(diag_last_error(diag_get()));
 
@@ -772,8 +820,6 @@ MemtxEngine::commitCheckpoint(struct vclock *vclock)
 	/* waitCheckpoint() must have been done. */
 	assert(!m_checkpoint->waiting_for_snap_thread);
 
-	memtx_tuple_end_snapshot();
-
 	int64_t lsn = vclock_sum(&m_checkpoint->vclock);
 	struct xdir *dir = &m_checkpoint->dir;
 	/* rename snapshot on completion */
@@ -785,6 +831,15 @@ MemtxEngine::commitCheckpoint(struct vclock *vclock)
 	if (rc != 0)
 		panic("can't rename .snap.inprogress");
 
+	m_last_checkpoint_signature = lsn;
+	m_last_checkpoint_generation = m_checkpoint->rv->generation;
+	if (m_checkpoint->is_delta) {
+		m_delta_chain_length++;
+	} else {
+		m_delta_chain_length = 0;
+		pinDeltaChain(&m_checkpoint->vclock);
+	}
+	memtx_delta_log_destroy(&m_checkpoint->delta_log);
 	checkpoint_destroy(m_checkpoint);
 	m_checkpoint = 0;
 }
@@ -802,8 +857,6 @@ MemtxEngine::abortCheckpoint()
 		m_checkpoint->waiting_for_snap_thread = false;
 	}
 
-	memtx_tuple_end_snapshot();
-
 	/** Remove garbage .inprogress file. */
 	char *filename =
 		xdir_format_filename(&m_checkpoint->dir,
@@ -811,6 +864,8 @@ MemtxEngine::abortCheckpoint()
 				     INPROGRESS);
 	(void) coeio_unlink(filename);
 
+	/* Changes will get to the next checkpoint. */
+	memtx_delta_restore(&m_checkpoint->delta_log);
 	checkpoint_destroy(m_checkpoint);
 	m_checkpoint = 0;
 }
@@ -818,9 +873,20 @@ MemtxEngine::abortCheckpoint()
 int
 MemtxEngine::backup(struct vclock *vclock, engine_backup_cb cb, void *cb_arg)
 {
-	char *filename = xdir_format_filename(&m_snap_dir,
-					      vclock_sum(vclock), NONE);
-	return cb(filename, cb_arg);
+	/* A delta snapshot is useless without its base. */
+	int64_t signature = vclock_sum(vclock);
+	do {
+		char *filename = xdir_format_filename(&m_snap_dir,
+						      signature, NONE);
+		if (cb(filename, cb_arg) != 0)
+			return -1;
+		struct xlog_cursor cursor;
+		if (xdir_open_cursor(&m_snap_dir, signature, &cursor) != 0)
+			return -1;
+		signature = cursor.meta.base_signature;
+		xlog_cursor_close(&cursor, false);
+	} while (signature >= 0);
+	return 0;
 }
 
 /** Used to pass arguments to memtx_initial_join_f */
@@ -830,6 +896,49 @@ struct memtx_join_arg {
 	struct xstream *stream;
 };
 
+/**
+ * Feed rows of a snapshot file. If it's a delta snapshot,
+ * the snapshot it's based on is sent first.
+ */
+static void
+memtx_initial_join_file(struct xdir *dir, int64_t signature,
+			struct xstream *stream)
+{
+	struct xlog_cursor cursor;
+	xdir_open_cursor_xc(dir, signature, &cursor);
+	auto reader_guard = make_scoped_guard([&]{
+		xlog_cursor_close(&cursor, false);
+	});
+	if (cursor.meta.base_signature >= 0)
+		memtx_initial_join_file(dir, cursor.meta.base_signature,
+					stream);
+
+	if (stream->write_block != NULL) {
+		/* Send blocks as is, leave decoding to the replica. */
+		off_t offset;
+		size_t size;
+		while (xlog_cursor_next_block_xc(&cursor, &offset,
+						 &size) == 0) {
+			stream->write_block(stream, cursor.fd, offset, size);
+		}
+	} else {
+		struct xrow_header row;
+		while (xlog_cursor_next_xc(&cursor, &row, true) == 0) {
+			xstream_write_xc(stream, &row);
+		}
+	}
+
+	/**
+	 * We should never try to read snapshots with no EOF
+	 * marker - such snapshots are very likely corrupted and
+	 * should not be trusted.
+	 */
+	/* TODO: replace panic with tnt_raise() */
+	if (cursor.state != XLOG_CURSOR_EOF)
+		panic("snapshot `%s' has no EOF marker",
+		      cursor.name);
+}
+
 /**
  * Invoked from a thread to feed snapshot rows.
  */
@@ -850,26 +959,7 @@ memtx_initial_join_f(va_list ap)
 	auto guard = make_scoped_guard([&]{
 		xdir_destroy(&dir);
 	});
-	struct xlog_cursor cursor;
-	xdir_open_cursor_xc(&dir, checkpoint_lsn, &cursor);
-	auto reader_guard = make_scoped_guard([&]{
-		xlog_cursor_close(&cursor, false);
-	});
-
-	struct xrow_header row;
-	while (xlog_cursor_next_xc(&cursor, &row, true) == 0) {
-		xstream_write_xc(stream, &row);
-	}
-
-	/**
-	 * We should never try to read snapshots with no EOF
-	 * marker - such snapshots are very likely corrupted and
-	 * should not be trusted.
-	 */
-	/* TODO: replace panic with tnt_raise() */
-	if (cursor.state != XLOG_CURSOR_EOF)
-		panic("snapshot `%s' has no EOF marker",
-		      cursor.name);
+	memtx_initial_join_file(&dir, checkpoint_lsn, stream);
 	return 0;
 }
 
@@ -107,10 +107,23 @@ struct MemtxEngine: public Engine {
 	{
 		m_snap_io_rate_limit = new_limit * 1024 * 1024;
 	}
+	/* Update checkpoint_delta_count. */
+	void setCheckpointDeltaCount(int count);
 	void recoverSnapshot(const struct vclock *vclock);
+	/**
+	 * Switch to the final recovery state when the first
+	 * row of a delta snapshot is applied: deltas are applied
+	 * as normal DML, so the primary keys must be built.
+	 */
+	void beginDeltaRecovery();
 private:
+	void
+	recoverSnapshotFile(int64_t signature);
 	void
 	recoverSnapshotRow(struct xrow_header *row);
+	/** Pin the full snapshot a chain of deltas starts from. */
+	void
+	pinDeltaChain(const struct vclock *vclock);
 	/** Non-zero if there is a checkpoint (snapshot) in progress. */
 	struct checkpoint *m_checkpoint;
 	enum memtx_recovery_state m_state;
@@ -119,6 +132,24 @@ private:
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t m_snap_io_rate_limit;
 	bool m_force_recovery;
+	/**
+	 * Max number of delta checkpoints between two full
+	 * ones, 0 if delta checkpoints are disabled.
+	 */
+	int m_checkpoint_delta_count;
+	/** Number of delta checkpoints since the last full one. */
+	int m_delta_chain_length;
+	/** Signature of the last checkpoint or -1. */
+	int64_t m_last_checkpoint_signature;
+	/** Tuple generation of the last checkpoint read view. */
+	uint32_t m_last_checkpoint_generation;
+	/**
+	 * Vclock of the full snapshot the last checkpoint
+	 * depends on. It is pinned, so that garbage collection
+	 * doesn't remove it along with the delta snapshots.
+	 */
+	struct vclock m_delta_chain_vclock;
+	bool m_delta_chain_is_pinned;
 };
 
 enum {
@@ -186,6 +186,45 @@ MemtxHash::findByKey(const char *key, uint32_t part_count) const
 	return ret;
 }
 
+void
+MemtxHash::findByKeys(const char **keys, uint32_t part_count,
+		      uint32_t key_count, struct tuple **result) const
+{
+	assert(index_def->opts.is_unique && part_count == index_def->key_def.part_count);
+	(void) part_count;
+
+	/*
+	 * Lookups are done in batches in three passes: hash the
+	 * keys and prefetch their buckets, prefetch the tuples
+	 * stored in the buckets, compare the keys. Each pass
+	 * issues independent memory accesses, so that their
+	 * cache misses overlap instead of stalling one by one.
+	 */
+	enum { BATCH_SIZE = 32 };
+	struct key_def *key_def = &index_def->key_def;
+	uint32_t hashes[BATCH_SIZE];
+	for (uint32_t start = 0; start < key_count; start += BATCH_SIZE) {
+		uint32_t n = MIN(key_count - start, (uint32_t) BATCH_SIZE);
+		const char **batch = keys + start;
+		for (uint32_t i = 0; i < n; i++) {
+			hashes[i] = key_hash(batch[i], key_def);
+			light_index_prefetch(hash_table, hashes[i]);
+		}
+		for (uint32_t i = 0; i < n; i++) {
+			struct tuple *tuple;
+			if (light_index_peek(hash_table, hashes[i], &tuple))
+				__builtin_prefetch(tuple);
+		}
+		for (uint32_t i = 0; i < n; i++) {
+			uint32_t k = light_index_find_key(hash_table,
+							  hashes[i], batch[i]);
+			result[start + i] = k != light_index_end ?
+				light_index_get(hash_table, k) : NULL;
+		}
+	}
+	memtx_index_ref_found(result, key_count);
+}
+
 struct tuple *
 MemtxHash::replace(struct tuple *old_tuple, struct tuple *new_tuple,
 		   enum dup_replace_mode mode)
@@ -86,6 +86,20 @@ MemtxIndex::count(enum iterator_type type, const char *key,
 	return count;
 }
 
+void
+memtx_index_ref_found(struct tuple **tuples, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		if (tuples[i] == NULL || tuple_ref(tuples[i]) == 0)
+			continue;
+		while (i-- > 0) {
+			if (tuples[i] != NULL)
+				tuple_unref(tuples[i]);
+		}
+		diag_raise();
+	}
+}
+
 void
 index_build(MemtxIndex *index, MemtxIndex *pk)
 {
@@ -75,6 +75,13 @@ protected:
 	mutable struct iterator *m_position;
 };
 
+/**
+ * Reference tuples found by a batch lookup, skipping NULLs.
+ * On error, no tuple is left referenced.
+ */
+void
+memtx_index_ref_found(struct tuple **tuples, uint32_t count);
+
 /** Build this index based on the contents of another index. */
 void
 index_build(MemtxIndex *index, MemtxIndex *pk);
@@ -0,0 +1,460 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "memtx_read_view.h"
+#include "memtx_tuple.h"
+#include "memtx_delta.h"
+
+#include <pmatomic.h>
+
+#include "scoped_guard.h"
+#include "fiber.h"
+
+#include "index.h"
+#include "space.h"
+#include "schema.h"
+#include "tuple.h"
+#include "xlog.h"
+#include "xrow.h"
+#include "iproto_constants.h"
+#include "replication.h"
+
+/** All open read views. */
+static RLIST_HEAD(memtx_open_views);
+
+/**
+ * Release formats of spaces which have been scanned by the
+ * thread iterating a read view.
+ */
+static void
+memtx_read_view_on_space_done(ev_loop * /* loop */, struct ev_async *watcher,
+			      int /* events */)
+{
+	struct memtx_read_view *rv = (struct memtx_read_view *) watcher->data;
+	struct memtx_read_view_entry *entry;
+	rlist_foreach_entry(entry, &rv->entries, link) {
+		if (entry->is_released ||
+		    !pm_atomic_load_explicit(&entry->is_done,
+					     pm_memory_order_acquire))
+			continue;
+		memtx_tuple_release_format(entry->format);
+		entry->is_released = true;
+	}
+}
+
+/** Called by the thread iterating a view when a space is done. */
+static void
+memtx_read_view_space_done(struct memtx_read_view *rv,
+			   struct memtx_read_view_entry *entry)
+{
+	pm_atomic_store_explicit(&entry->is_done, true,
+				 pm_memory_order_release);
+	ev_async_send(rv->loop, &rv->on_space_done);
+}
+
+struct memtx_read_view *
+memtx_read_view_new(void)
+{
+	struct memtx_read_view *rv =
+		(struct memtx_read_view *) malloc(sizeof(*rv));
+	if (rv == NULL) {
+		diag_set(OutOfMemory, sizeof(*rv), "malloc",
+			 "struct memtx_read_view");
+		return NULL;
+	}
+	rlist_create(&rv->entries);
+	rv->space_count = 0;
+	rv->curr = NULL;
+	vclock_copy(&rv->vclock, &replicaset_vclock);
+	rv->loop = loop();
+	ev_async_init(&rv->on_space_done, memtx_read_view_on_space_done);
+	rv->on_space_done.data = rv;
+	ev_async_start(rv->loop, &rv->on_space_done);
+	rlist_add_tail_entry(&memtx_open_views, rv, in_open_views);
+	rv->is_ddl_locked = false;
+	/*
+	 * Tuples existing at this point must not be freed
+	 * until the view is done with them.
+	 */
+	rv->generation = memtx_tuple_begin_read_view();
+	return rv;
+}
+
+void
+memtx_read_view_delete(struct memtx_read_view *rv)
+{
+	ev_async_stop(rv->loop, &rv->on_space_done);
+	rlist_del_entry(rv, in_open_views);
+	struct memtx_read_view_entry *entry, *tmp;
+	rlist_foreach_entry_safe(entry, &rv->entries, link, tmp) {
+		entry->index->destroyReadViewForIterator(entry->iterator);
+		entry->iterator->free(entry->iterator);
+		if (!entry->is_released)
+			memtx_tuple_release_format(entry->format);
+		memtx_tuple_unpin_format(entry->format);
+		free(entry);
+	}
+	memtx_tuple_end_read_view();
+	free(rv);
+}
+
+void
+memtx_read_view_add_space(struct memtx_read_view *rv, struct space *space)
+{
+	if (!space_is_memtx(space)) {
+		tnt_raise(ClientError, ER_UNSUPPORTED,
+			  space->handler->engine->name, "read view");
+	}
+	Index *pk = index_find_xc(space, 0);
+	struct memtx_read_view_entry *entry =
+		(struct memtx_read_view_entry *) malloc(sizeof(*entry));
+	if (entry == NULL) {
+		tnt_raise(OutOfMemory, sizeof(*entry), "malloc",
+			  "struct memtx_read_view_entry");
+	}
+	auto entry_guard = make_scoped_guard([=]{ free(entry); });
+	if (memtx_tuple_pin_format(space->format) != 0)
+		diag_raise();
+	auto format_guard = make_scoped_guard([=]{
+		memtx_tuple_release_format(space->format);
+		memtx_tuple_unpin_format(space->format);
+	});
+	entry->space_id = space_id(space);
+	entry->index = pk;
+	entry->format = space->format;
+	entry->is_done = false;
+	entry->is_released = false;
+	entry->iterator = pk->allocIterator();
+	auto iterator_guard = make_scoped_guard([=]{
+		entry->iterator->free(entry->iterator);
+	});
+	pk->initIterator(entry->iterator, ITER_ALL, NULL, 0);
+	pk->createReadViewForIterator(entry->iterator);
+	iterator_guard.is_active = false;
+	format_guard.is_active = false;
+	entry_guard.is_active = false;
+
+	rlist_add_tail_entry(&rv->entries, entry, link);
+	rv->space_count++;
+	if (rv->curr == NULL)
+		rv->curr = entry;
+}
+
+void
+memtx_read_view_next(struct memtx_read_view *rv, uint32_t *space_id,
+		     struct tuple **tuple)
+{
+	struct memtx_read_view_entry *entry = rv->curr;
+	while (entry != NULL) {
+		struct iterator *it = entry->iterator;
+		*tuple = it->next(it);
+		if (*tuple != NULL) {
+			*space_id = entry->space_id;
+			return;
+		}
+		memtx_read_view_space_done(rv, entry);
+		if (&entry->link == rlist_last(&rv->entries))
+			entry = NULL;
+		else
+			entry = rlist_next_entry(entry, link);
+		rv->curr = entry;
+	}
+	*tuple = NULL;
+}
+
+bool
+memtx_read_view_has_space(uint32_t space_id)
+{
+	struct memtx_read_view *rv;
+	rlist_foreach_entry(rv, &memtx_open_views, in_open_views) {
+		if (!rv->is_ddl_locked)
+			continue;
+		struct memtx_read_view_entry *entry;
+		rlist_foreach_entry(entry, &rv->entries, link) {
+			if (entry->space_id == space_id)
+				return true;
+		}
+	}
+	return false;
+}
+
+void
+memtx_read_view_delayed_free_stat(void (*cb)(uint32_t space_id,
+					     size_t size, void *arg),
+				  void *arg)
+{
+	struct memtx_read_view *rv;
+	rlist_foreach_entry(rv, &memtx_open_views, in_open_views) {
+		struct memtx_read_view_entry *entry;
+		rlist_foreach_entry(entry, &rv->entries, link) {
+			size_t size = memtx_tuple_delayed_free_size_by_format(
+							entry->format);
+			if (size > 0)
+				cb(entry->space_id, size, arg);
+		}
+	}
+}
+
+static void
+memtx_read_view_write_row(struct xlog *l, struct xrow_header *row)
+{
+	static ev_tstamp last = 0;
+	if (last == 0) {
+		ev_now_update(loop());
+		last = ev_now(loop());
+	}
+
+	row->tm = last;
+	row->replica_id = 0;
+	/**
+	 * Rows in snapshot are numbered from 1 to %rows.
+	 * This makes streaming such rows to a replica or
+	 * to recovery look similar to streaming a normal
+	 * WAL. @sa the place which skips old rows in
+	 * recovery_apply_row().
+	 */
+	row->lsn = l->rows + l->tx_rows;
+	row->sync = 0; /* don't write sync to wal */
+
+	ssize_t written = xlog_write_row(l, row);
+	fiber_gc();
+	if (written < 0) {
+		diag_raise();
+	}
+
+	if ((l->rows + l->tx_rows) % 100000 == 0)
+		say_crit("%.1fM rows written", (l->rows + l->tx_rows) / 1000000.0);
+
+}
+
+static void
+memtx_read_view_write_tuple(struct xlog *l, uint32_t type, uint32_t n,
+			    struct tuple *tuple)
+{
+	struct request_replace_body body;
+	body.m_body = 0x82; /* map of two elements. */
+	body.k_space_id = IPROTO_SPACE_ID;
+	body.m_space_id = 0xce; /* uint32 */
+	body.v_space_id = mp_bswap_u32(n);
+	body.k_tuple = IPROTO_TUPLE;
+
+	struct xrow_header row;
+	memset(&row, 0, sizeof(struct xrow_header));
+	row.type = type;
+
+	row.bodycnt = 2;
+	row.body[0].iov_base = &body;
+	row.body[0].iov_len = sizeof(body);
+	uint32_t bsize;
+	row.body[1].iov_base = (char *) tuple_data_range(tuple, &bsize);
+	row.body[1].iov_len = bsize;
+	memtx_read_view_write_row(l, &row);
+}
+
+void
+memtx_read_view_write(struct memtx_read_view *rv, struct xlog *l)
+{
+	uint32_t space_id;
+	struct tuple *tuple;
+	memtx_read_view_next(rv, &space_id, &tuple);
+	while (tuple != NULL) {
+		memtx_read_view_write_tuple(l, IPROTO_INSERT, space_id, tuple);
+		memtx_read_view_next(rv, &space_id, &tuple);
+	}
+}
+
+void
+memtx_read_view_write_delta(struct memtx_read_view *rv,
+			    struct memtx_delta_log *log,
+			    uint32_t base_generation, struct xlog *l)
+{
+	assert(!log->is_overflow);
+	const char *pos = log->data.rpos;
+	while (pos < log->data.wpos) {
+		const struct memtx_delta_row *delta_row =
+			(const struct memtx_delta_row *) pos;
+		struct xrow_header row;
+		memset(&row, 0, sizeof(row));
+		row.type = delta_row->type;
+		row.bodycnt = 1;
+		row.body[0].iov_base = (void *) (delta_row + 1);
+		row.body[0].iov_len = delta_row->bsize;
+		memtx_read_view_write_row(l, &row);
+		pos += memtx_delta_row_size(delta_row->bsize);
+	}
+
+	uint32_t space_id;
+	struct tuple *tuple;
+	memtx_read_view_next(rv, &space_id, &tuple);
+	while (tuple != NULL) {
+		/* Generations may wrap around. */
+		if ((int32_t) (memtx_tuple_version(tuple) -
+			       base_generation) >= 0) {
+			memtx_read_view_write_tuple(l, IPROTO_REPLACE,
+						    space_id, tuple);
+		}
+		memtx_read_view_next(rv, &space_id, &tuple);
+	}
+}
+
+/** Arguments of a read view scan done in a separate thread. */
+struct memtx_read_view_task {
+	struct memtx_read_view *rv;
+	/** Output file of memtx_read_view_export(). */
+	const char *path;
+	/** Output array of memtx_read_view_stat(). */
+	struct memtx_read_view_stat *stat;
+};
+
+static int
+memtx_read_view_export_f(va_list ap)
+{
+	struct memtx_read_view_task *task =
+		va_arg(ap, struct memtx_read_view_task *);
+	struct memtx_read_view *rv = task->rv;
+	const char *path = task->path;
+
+	struct xlog_meta meta;
+	snprintf(meta.filetype, sizeof(meta.filetype), "SNAP");
+	meta.instance_uuid = INSTANCE_UUID;
+	vclock_copy(&meta.vclock, &rv->vclock);
+	meta.base_signature = -1;
+
+	struct xlog l;
+	if (xlog_create(&l, path, &meta) != 0)
+		diag_raise();
+	auto guard = make_scoped_guard([&]{ xlog_close(&l, false); });
+
+	say_info("exporting read view to `%s'", path);
+	memtx_read_view_write(rv, &l);
+	if (xlog_flush(&l) < 0 || xlog_rename(&l) != 0)
+		diag_raise();
+	say_info("done");
+	return 0;
+}
+
+int
+memtx_read_view_export(struct memtx_read_view *rv, const char *path)
+{
+	struct memtx_read_view_task task;
+	task.rv = rv;
+	task.path = path;
+	task.stat = NULL;
+	struct cord cord;
+	if (cord_costart(&cord, "read_view", memtx_read_view_export_f,
+			 &task) != 0)
+		return -1;
+	return cord_cojoin(&cord);
+}
+
+static int
+memtx_read_view_stat_f(va_list ap)
+{
+	struct memtx_read_view_task *task =
+		va_arg(ap, struct memtx_read_view_task *);
+	struct memtx_read_view *rv = task->rv;
+	struct memtx_read_view_stat *stat = task->stat;
+
+	struct memtx_read_view_entry *entry;
+	rlist_foreach_entry(entry, &rv->entries, link) {
+		stat->space_id = entry->space_id;
+		stat->count = 0;
+		stat->bsize = 0;
+		struct iterator *it = entry->iterator;
+		struct tuple *tuple;
+		while ((tuple = it->next(it)) != NULL) {
+			stat->count++;
+			stat->bsize += tuple->bsize;
+		}
+		memtx_read_view_space_done(rv, entry);
+		stat++;
+	}
+	rv->curr = NULL;
+	return 0;
+}
+
+int
+memtx_read_view_stat(struct memtx_read_view *rv,
+		     struct memtx_read_view_stat *stat)
+{
+	struct memtx_read_view_task task;
+	task.rv = rv;
+	task.path = NULL;
+	task.stat = stat;
+	struct cord cord;
+	if (cord_costart(&cord, "read_view", memtx_read_view_stat_f,
+			 &task) != 0)
+		return -1;
+	return cord_cojoin(&cord);
+}
+
+box_read_view_t *
+box_read_view_open(const uint32_t *space_ids, uint32_t space_count)
+{
+	struct memtx_read_view *rv = memtx_read_view_new();
+	if (rv == NULL)
+		return NULL;
+	/*
+	 * Unlike checkpoints, user read views may be kept open
+	 * for arbitrarily long, so lock DDL on their spaces.
+	 */
+	rv->is_ddl_locked = true;
+	try {
+		for (uint32_t i = 0; i < space_count; i++) {
+			struct space *space = space_cache_find(space_ids[i]);
+			memtx_read_view_add_space(rv, space);
+		}
+	} catch (Exception *e) {
+		memtx_read_view_delete(rv);
+		return NULL;
+	}
+	return rv;
+}
+
+void
+box_read_view_next(box_read_view_t *rv, uint32_t *space_id,
+		   const char **data, const char **data_end)
+{
+	struct tuple *tuple;
+	memtx_read_view_next(rv, space_id, &tuple);
+	if (tuple == NULL) {
+		*data = *data_end = NULL;
+		return;
+	}
+	uint32_t bsize;
+	*data = tuple_data_range(tuple, &bsize);
+	*data_end = *data + bsize;
+}
+
+void
+box_read_view_close(box_read_view_t *rv)
+{
+	memtx_read_view_delete(rv);
+}
@@ -0,0 +1,286 @@
+#ifndef TARANTOOL_BOX_MEMTX_READ_VIEW_H_INCLUDED
+#define TARANTOOL_BOX_MEMTX_READ_VIEW_H_INCLUDED
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+#include "trivia/util.h"
+#include "small/rlist.h"
+#include "third_party/tarantool_ev.h"
+#include "vclock.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct tuple;
+struct tuple_format;
+struct space;
+struct iterator;
+struct Index;
+
+/**
+ * A consistent read view over a set of memtx spaces.
+ *
+ * A read view is opened in the tx thread: primary keys of
+ * the chosen spaces are frozen (@sa
+ * Index::createReadViewForIterator()) and the tuple allocator
+ * is switched to the delayed free mode, so that tuples
+ * visible in the view survive deletion. After that the view
+ * can be handed over to any other thread and iterated there
+ * without blocking the tx thread. It is the way memtx
+ * checkpoints are written.
+ *
+ * Once a space has been scanned, the tx thread is notified
+ * and deleted tuples of the space are freed without waiting
+ * for the view to be closed (@sa memtx_tuple_pin_format()).
+ *
+ * Rules:
+ * - a read view must be opened and closed in the tx thread;
+ * - while a read view is open, the primary keys of its spaces
+ *   must not be dropped; this is enforced for views opened with
+ *   box_read_view_open();
+ * - a read view can be iterated by one thread at a time;
+ * - a read view can be scanned only once, either with
+ *   memtx_read_view_next(), memtx_read_view_export() or
+ *   memtx_read_view_stat().
+ */
+struct memtx_read_view_entry {
+	/** Id of the space. */
+	uint32_t space_id;
+	/** Primary key of the space. */
+	struct Index *index;
+	/** Frozen iterator over the primary key. */
+	struct iterator *iterator;
+	/** Format of the space pinned by the view. */
+	struct tuple_format *format;
+	/**
+	 * Set by the thread iterating the view when the space
+	 * has been scanned.
+	 */
+	bool is_done;
+	/** Set when the tx thread has released the format. */
+	bool is_released;
+	/** Link in memtx_read_view::entries. */
+	struct rlist link;
+};
+
+struct memtx_read_view {
+	/** List of memtx_read_view_entry, one per space. */
+	struct rlist entries;
+	/** The number of spaces in the view. */
+	uint32_t space_count;
+	/** Entry iterated by memtx_read_view_next(). */
+	struct memtx_read_view_entry *curr;
+	/** The vclock at the time the view was opened. */
+	struct vclock vclock;
+	/**
+	 * Tuple generation started when the view was opened,
+	 * @sa memtx_tuple_version().
+	 */
+	uint32_t generation;
+	/** Event loop of the tx thread. */
+	struct ev_loop *loop;
+	/**
+	 * Signalled by the thread iterating the view when
+	 * a space has been scanned, so that the tx thread
+	 * can release the format of the space.
+	 */
+	struct ev_async on_space_done;
+	/** Link in the list of all open read views. */
+	struct rlist in_open_views;
+	/**
+	 * Set if spaces of the view must not be altered or
+	 * dropped while it is open, @sa memtx_read_view_has_space().
+	 */
+	bool is_ddl_locked;
+};
+
+/** Statistics of a space collected by memtx_read_view_stat(). */
+struct memtx_read_view_stat {
+	/** Id of the space. */
+	uint32_t space_id;
+	/** The number of tuples in the space. */
+	uint64_t count;
+	/** Total size of tuple data in the space, in bytes. */
+	uint64_t bsize;
+};
+
+/**
+ * Create an empty read view. All spaces must be added to the
+ * view with memtx_read_view_add_space() without yielding.
+ *
+ * @retval NULL on memory allocation error, check diag.
+ */
+struct memtx_read_view *
+memtx_read_view_new(void);
+
+/** Close a read view and free all resources it holds. */
+void
+memtx_read_view_delete(struct memtx_read_view *rv);
+
+/**
+ * Get the next tuple from a read view. Spaces are iterated in
+ * the order they were added to the view.
+ *
+ * @param rv read view
+ * @param[out] space_id id of the space the tuple belongs to
+ * @param[out] tuple tuple or NULL at the end of the view
+ */
+void
+memtx_read_view_next(struct memtx_read_view *rv, uint32_t *space_id,
+		     struct tuple **tuple);
+
+/**
+ * Write a read view to a file in the snapshot format.
+ * A thread is started to do the work, the calling fiber
+ * waits for it to complete.
+ *
+ * @retval 0 success
+ * @retval -1 error, check diag
+ */
+int
+memtx_read_view_export(struct memtx_read_view *rv, const char *path);
+
+/**
+ * Count tuples and their total size in each space of a read
+ * view. A thread is started to do the work, the calling fiber
+ * waits for it to complete.
+ *
+ * @param rv read view
+ * @param[out] stat array of rv->space_count elements, filled
+ *                  in the order spaces were added to the view
+ *
+ * @retval 0 success
+ * @retval -1 error, check diag
+ */
+int
+memtx_read_view_stat(struct memtx_read_view *rv,
+		     struct memtx_read_view_stat *stat);
+
+/**
+ * Return true if a space is used by an open read view that
+ * locks DDL, @sa memtx_read_view::is_ddl_locked. Indexes of
+ * such a space must not be altered or dropped, since the view
+ * iterates over them in another thread.
+ */
+bool
+memtx_read_view_has_space(uint32_t space_id);
+
+/**
+ * Report the size of deleted tuples kept for open read views
+ * for each space of the views, @sa memtx_tuple_delayed_free_size().
+ * Spaces without such tuples are skipped, a space may be
+ * reported more than once.
+ */
+void
+memtx_read_view_delayed_free_stat(void (*cb)(uint32_t space_id,
+					     size_t size, void *arg),
+				  void *arg);
+
+/** \cond public */
+
+typedef struct memtx_read_view box_read_view_t;
+
+/**
+ * Open a consistent read view over memtx spaces.
+ * Must be called from the tx thread. The spaces can't be
+ * altered, truncated or dropped until the view is closed.
+ *
+ * \param space_ids ids of spaces to include into the view
+ * \param space_count the number of elements in \a space_ids
+ * \retval NULL on error (check box_error_last())
+ * \retval read view otherwise
+ */
+API_EXPORT box_read_view_t *
+box_read_view_open(const uint32_t *space_ids, uint32_t space_count);
+
+/**
+ * Get the next tuple from a read view. The function doesn't
+ * use tuple reference counting and thus may be called from
+ * any thread, including threads started with pthread_create().
+ *
+ * \param rv read view
+ * \param[out] space_id id of the space the tuple belongs to
+ * \param[out] data tuple data in MsgPack Array format,
+ *                  NULL at the end of the view
+ * \param[out] data_end the end of \a data
+ */
+API_EXPORT void
+box_read_view_next(box_read_view_t *rv, uint32_t *space_id,
+		   const char **data, const char **data_end);
+
+/**
+ * Close a read view. Must be called from the tx thread
+ * when no other thread uses the view.
+ *
+ * \param rv read view
+ */
+API_EXPORT void
+box_read_view_close(box_read_view_t *rv);
+
+/** \endcond public */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+
+struct xlog;
+
+/**
+ * Add the primary key of a memtx space to a read view.
+ * Throws an exception on error.
+ */
+void
+memtx_read_view_add_space(struct memtx_read_view *rv, struct space *space);
+
+/**
+ * Write all tuples of a read view to an xlog as INSERT rows.
+ * Throws an exception on error.
+ */
+void
+memtx_read_view_write(struct memtx_read_view *rv, struct xlog *l);
+
+struct memtx_delta_log;
+
+/**
+ * Write changes made since the read view of generation
+ * @a base_generation was opened to an xlog: first rows of
+ * the change log, then REPLACE for each tuple of the view
+ * with version >= @a base_generation (@sa memtx_delta.h).
+ * Throws an exception on error.
+ */
+void
+memtx_read_view_write_delta(struct memtx_read_view *rv,
+			    struct memtx_delta_log *log,
+			    uint32_t base_generation, struct xlog *l);
+
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_MEMTX_READ_VIEW_H_INCLUDED */
@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "memtx_space.h"
+#include "memtx_engine.h"
 #include "space.h"
 #include "iproto_constants.h"
 #include "txn.h"
@@ -40,6 +41,8 @@
 #include "memtx_bitset.h"
 #include "port.h"
 #include "memtx_tuple.h"
+#include "memtx_delta.h"
+#include "tuple_update.h"
 
 /**
  * A version of space_replace for a space which has
@@ -103,6 +106,7 @@ memtx_replace_primary_key(struct txn_stmt *stmt, struct space *space,
 						   stmt->new_tuple, mode);
 	stmt->engine_savepoint = stmt;
 	stmt->bsize_change = space_bsize_update(space, stmt->old_tuple, stmt->new_tuple);
+	memtx_delta_on_replace(space, stmt->old_tuple, stmt->new_tuple);
 }
 
 /**
@@ -231,6 +235,7 @@ memtx_replace_all_keys(struct txn_stmt *stmt, struct space *space,
 	stmt->old_tuple = old_tuple;
 	stmt->engine_savepoint = stmt;
 	stmt->bsize_change = space_bsize_update(space, old_tuple, new_tuple);
+	memtx_delta_on_replace(space, old_tuple, new_tuple);
 }
 
 
@@ -249,6 +254,12 @@ dup_replace_mode(uint32_t op)
 void
 MemtxSpace::applyInitialJoinRow(struct space *space, struct request *request)
 {
+	if (request->type == IPROTO_REPLACE ||
+	    request->type == IPROTO_DELETE) {
+		/* A row of a delta snapshot, @sa memtx_delta.h */
+		applyDeltaRow(space, request);
+		return;
+	}
 	if (request->type != IPROTO_INSERT) {
 		tnt_raise(ClientError, ER_UNKNOWN_REQUEST_TYPE,
 				(uint32_t) request->type);
@@ -268,6 +279,25 @@ MemtxSpace::applyInitialJoinRow(struct space *space, struct request *request)
 	/** The new tuple is referenced by the primary key. */
 }
 
+void
+MemtxSpace::applyDeltaRow(struct space *space, struct request *request)
+{
+	((MemtxEngine *) engine)->beginDeltaRecovery();
+	request->header->replica_id = 0;
+	struct txn *txn = txn_begin_stmt(space);
+	try {
+		if (request->type == IPROTO_DELETE)
+			executeDelete(txn, space, request);
+		else
+			executeReplace(txn, space, request);
+		txn_commit_stmt(txn, request);
+	} catch (Exception *e) {
+		say_error("rollback: %s", e->errmsg);
+		txn_rollback_stmt();
+		throw;
+	}
+}
+
 void
 MemtxSpace::prepareReplace(struct txn_stmt *stmt, struct space *space,
 			   struct request *request)
@@ -305,6 +335,9 @@ MemtxSpace::prepareUpdate(struct txn_stmt *stmt, struct space *space,
 	if (stmt->old_tuple == NULL)
 		return;
 
+	if (updateInPlace(stmt, space, request))
+		return;
+
 	/* Update the tuple; legacy, request ops are in request->tuple */
 	uint32_t new_size = 0, bsize;
 	const char *old_data = tuple_data_range(stmt->old_tuple, &bsize);
@@ -321,6 +354,165 @@ MemtxSpace::prepareUpdate(struct txn_stmt *stmt, struct space *space,
 	tuple_ref(stmt->new_tuple);
 }
 
+/** Undo record of an UPDATE applied in place. */
+struct memtx_update_undo {
+	/** Offset of the changed range in tuple data. */
+	uint32_t offset;
+	/** Size of the changed range. */
+	uint32_t size;
+	/** Old contents of the changed range. */
+	const char *data;
+};
+
+/**
+ * Calculate the mask of columns used in indexes of a space,
+ * in the format of the update column mask.
+ */
+static uint64_t
+memtx_space_key_mask(struct space *space)
+{
+	uint64_t key_mask = 0;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct key_def *key_def = &space->index[i]->index_def->key_def;
+		for (uint32_t j = 0; j < key_def->part_count; j++) {
+			uint32_t fieldno = key_def->parts[j].fieldno;
+			if (fieldno >= 64)
+				return UINT64_MAX;
+			key_mask |= ((uint64_t) 1) << (63 - fieldno);
+		}
+	}
+	return key_mask;
+}
+
+/**
+ * Try to apply an UPDATE without allocating a new tuple and
+ * replacing it in indexes: arithmetic and bitwise operations
+ * on non-indexed fields which don't change the encoded field
+ * size can be done right in the old tuple. It's only safe if
+ * no one but the space holds the tuple and it isn't visible
+ * in a read view (a checkpoint in particular). on_replace
+ * triggers expect distinct old and new tuples, so the fast
+ * path is off for spaces which have them. It's also limited
+ * to autocommit statements: the tuple returned by the update
+ * is restored on rollback, which must not be seen by the user.
+ * Other fibers may get the tuple while the statement waits
+ * for WAL, so memtx_rollback_update_in_place() replaces it
+ * with a restored copy rather than patches it if needed.
+ *
+ * On success, both stmt->old_tuple and stmt->new_tuple point
+ * to the updated tuple, and stmt->engine_savepoint points to
+ * the undo record.
+ *
+ * @retval true the update was applied in place
+ * @retval false the tuple must be updated the usual way
+ */
+bool
+MemtxSpace::updateInPlace(struct txn_stmt *stmt, struct space *space,
+			  struct request *request)
+{
+	struct tuple *tuple = stmt->old_tuple;
+	struct txn *txn = in_txn();
+	if (txn == NULL || !txn->is_autocommit)
+		return false;
+	if (tuple->refs != 1 || memtx_tuple_is_in_read_view(tuple) ||
+	    !rlist_empty(&space->on_replace))
+		return false;
+	if (replace != memtx_replace_all_keys &&
+	    replace != memtx_replace_primary_key)
+		return false;
+
+	struct region *gc = &fiber()->gc;
+	struct memtx_update_undo *undo =
+		region_alloc_object_xc(gc, struct memtx_update_undo);
+	char *data = (char *) tuple_data(tuple);
+	int rc = tuple_update_execute_inplace(region_aligned_alloc_cb, gc,
+					      request->tuple,
+					      request->tuple_end,
+					      data, data + tuple->bsize,
+					      request->index_base,
+					      memtx_space_key_mask(space),
+					      &undo->data, &undo->offset,
+					      &undo->size);
+	if (rc < 0)
+		diag_raise();
+	if (rc > 0)
+		return false;
+	/* The tuple must get to the next delta checkpoint. */
+	memtx_tuple_touch(tuple);
+
+	/*
+	 * The statement both "deletes" and "inserts" the tuple,
+	 * so take a reference for the commit/rollback to drop.
+	 */
+	tuple_ref(tuple);
+	stmt->new_tuple = tuple;
+	stmt->engine_savepoint = undo;
+	stmt->bsize_change = 0;
+	return true;
+}
+
+/**
+ * Create a copy of a tuple updated in place with the old data
+ * restored from the undo record. Returns NULL on memory error.
+ */
+static struct tuple *
+memtx_update_undo_restore(struct tuple *tuple, struct memtx_update_undo *undo)
+{
+	uint32_t bsize;
+	const char *data = tuple_data_range(tuple, &bsize);
+	struct tuple *restored = memtx_tuple_new(tuple_format(tuple),
+						 data, data + bsize);
+	if (restored == NULL)
+		return NULL;
+	char *restored_data = (char *) tuple_data(restored);
+	memcpy(restored_data + undo->offset, undo->data, undo->size);
+	return restored;
+}
+
+void
+memtx_rollback_update_in_place(struct txn_stmt *stmt)
+{
+	assert(stmt->old_tuple == stmt->new_tuple);
+	struct memtx_update_undo *undo =
+		(struct memtx_update_undo *) stmt->engine_savepoint;
+	struct tuple *tuple = stmt->new_tuple;
+	/*
+	 * While the statement was waiting for WAL, other fibers
+	 * could have got references to the updated tuple or
+	 * a read view could have been opened. Tuples are
+	 * immutable for them, so instead of patching the tuple
+	 * replace it in indexes with a copy having the old data.
+	 * The space and the statement hold two references.
+	 */
+	struct tuple *restored = NULL;
+	if (tuple->refs > 2 || memtx_tuple_is_in_read_view(tuple)) {
+		restored = memtx_update_undo_restore(tuple, undo);
+		if (restored == NULL) {
+			say_error("rollback: %s, restoring the tuple "
+				  "in place", diag_last_error(diag_get())->errmsg);
+		}
+	}
+	if (restored != NULL) {
+		struct space *space = stmt->space;
+		struct MemtxSpace *handler = (struct MemtxSpace *) space->handler;
+		uint32_t index_count = 1;
+		if (handler->replace == memtx_replace_all_keys)
+			index_count = space->index_count;
+		for (uint32_t i = 0; i < index_count; i++)
+			space->index[i]->replace(tuple, restored, DUP_INSERT);
+		tuple_ref(restored);
+		/* Drop the reference of the space. */
+		tuple_unref(tuple);
+	} else {
+		char *data = (char *) tuple_data(tuple);
+		memcpy(data + undo->offset, undo->data, undo->size);
+	}
+	tuple_unref(tuple);
+	stmt->old_tuple = NULL;
+	stmt->new_tuple = NULL;
+	stmt->engine_savepoint = NULL;
+}
+
 void
 MemtxSpace::prepareUpsert(struct txn_stmt *stmt, struct space *space,
 			  struct request *request)
@@ -440,7 +632,8 @@ MemtxSpace::executeUpdate(struct txn *txn, struct space *space,
 {
 	struct txn_stmt *stmt = txn_current_stmt(txn);
 	prepareUpdate(stmt, space, request);
-	if (stmt->old_tuple)
+	/* Nothing to replace if the update was done in place. */
+	if (stmt->old_tuple && stmt->old_tuple != stmt->new_tuple)
 		this->replace(stmt, space, DUP_REPLACE);
 	return stmt->new_tuple;
 }
@@ -462,6 +655,159 @@ MemtxSpace::executeUpsert(struct txn *txn, struct space *space,
 	/* Return nothing: UPSERT does not return data. */
 }
 
+/**
+ * Undo record of a DELETE_RANGE: the tuples removed from the
+ * space by the statement, in the primary key order.
+ */
+struct memtx_delete_range_undo {
+	/** Array of deleted tuples, allocated with malloc(). */
+	struct tuple **tuples;
+	/** The number of tuples deleted so far. */
+	uint32_t count;
+	/** The number of tuples the array can hold. */
+	uint32_t capacity;
+};
+
+/**
+ * Collect the tuples of the range [begin, end) of a TREE
+ * primary key. An empty end key stands for +inf.
+ */
+static void
+memtx_delete_range_collect(struct memtx_delete_range_undo *undo,
+			   Index *pk, const char *begin,
+			   uint32_t begin_part_count, const char *end,
+			   uint32_t end_part_count)
+{
+	struct key_def *key_def = &pk->index_def->key_def;
+	struct iterator *it = pk->allocIterator();
+	IteratorGuard guard(it);
+	pk->initIterator(it, ITER_GE, begin, begin_part_count);
+	struct tuple *tuple;
+	while ((tuple = it->next(it)) != NULL) {
+		if (end_part_count > 0 &&
+		    tuple_compare_with_key(tuple, end, end_part_count,
+					   key_def) >= 0)
+			break;
+		if (undo->count == undo->capacity) {
+			uint32_t capacity = MAX(undo->capacity * 2, 64);
+			size_t size = capacity * sizeof(*undo->tuples);
+			struct tuple **tuples = (struct tuple **)
+				realloc(undo->tuples, size);
+			if (tuples == NULL) {
+				tnt_raise(OutOfMemory, size, "realloc",
+					  "struct tuple *");
+			}
+			undo->tuples = tuples;
+			undo->capacity = capacity;
+		}
+		undo->tuples[undo->count++] = tuple;
+	}
+}
+
+/**
+ * DELETE_RANGE walks the primary key once and removes the
+ * found tuples from all indexes right away, without building
+ * a statement per tuple. The statement has neither old nor
+ * new tuple, the deleted tuples are kept in the undo record
+ * pointed to by stmt->engine_savepoint, @sa
+ * memtx_rollback_delete_range() and memtx_commit_delete_range().
+ */
+void
+MemtxSpace::executeDeleteRange(struct txn *txn, struct space *space,
+			       struct request *request)
+{
+	struct txn_stmt *stmt = txn_current_stmt(txn);
+	Index *pk = index_find_unique(space, 0);
+	if (pk->index_def->type != TREE) {
+		tnt_raise(ClientError, ER_UNSUPPORTED,
+			  index_type_strs[pk->index_def->type],
+			  "delete_range");
+	}
+	if (replace != memtx_replace_all_keys &&
+	    replace != memtx_replace_primary_key) {
+		tnt_raise(ClientError, ER_UNSUPPORTED,
+			  "Snapshot recovery", "delete_range");
+	}
+	const char *begin = request->key;
+	uint32_t begin_part_count = mp_decode_array(&begin);
+	if (key_validate(pk->index_def, ITER_GE, begin, begin_part_count))
+		diag_raise();
+	const char *end = request->tuple;
+	uint32_t end_part_count = mp_decode_array(&end);
+	if (key_validate(pk->index_def, ITER_LT, end, end_part_count))
+		diag_raise();
+
+	struct memtx_delete_range_undo *undo =
+		region_alloc_object_xc(&fiber()->gc,
+				       struct memtx_delete_range_undo);
+	undo->tuples = NULL;
+	undo->count = 0;
+	undo->capacity = 0;
+	try {
+		memtx_delete_range_collect(undo, pk, begin, begin_part_count,
+					   end, end_part_count);
+	} catch (Exception *e) {
+		free(undo->tuples);
+		throw;
+	}
+	if (undo->count == 0) {
+		free(undo->tuples);
+		return;
+	}
+	/*
+	 * Tuples are counted as deleted one by one, so that
+	 * the statement rollback puts back exactly what was
+	 * removed if we run out of memory half way.
+	 */
+	uint32_t found = undo->count;
+	undo->count = 0;
+	stmt->engine_savepoint = undo;
+	uint32_t index_count = replace == memtx_replace_all_keys ?
+			       space->index_count : 1;
+	for (uint32_t i = 0; i < found; i++) {
+		struct tuple *tuple = undo->tuples[i];
+		memtx_index_extent_reserve(RESERVE_EXTENTS_BEFORE_DELETE);
+		for (uint32_t j = 0; j < index_count; j++)
+			space->index[j]->replace(tuple, NULL, DUP_INSERT);
+		undo->count++;
+		stmt->bsize_change += space_bsize_update(space, tuple, NULL);
+		memtx_delta_on_replace(space, tuple, NULL);
+	}
+}
+
+void
+memtx_rollback_delete_range(struct txn_stmt *stmt)
+{
+	assert(stmt->old_tuple == NULL && stmt->new_tuple == NULL);
+	struct memtx_delete_range_undo *undo =
+		(struct memtx_delete_range_undo *) stmt->engine_savepoint;
+	struct space *space = stmt->space;
+	struct MemtxSpace *handler = (struct MemtxSpace *) space->handler;
+	uint32_t index_count = handler->replace == memtx_replace_all_keys ?
+			       space->index_count : 1;
+	for (uint32_t i = undo->count; i > 0; i--) {
+		struct tuple *tuple = undo->tuples[i - 1];
+		for (uint32_t j = 0; j < index_count; j++)
+			space->index[j]->replace(NULL, tuple, DUP_INSERT);
+		memtx_delta_on_rollback(space, tuple, NULL);
+	}
+	space_bsize_rollback(space, stmt->bsize_change);
+	free(undo->tuples);
+	stmt->engine_savepoint = NULL;
+}
+
+void
+memtx_commit_delete_range(struct txn_stmt *stmt)
+{
+	assert(stmt->old_tuple == NULL && stmt->new_tuple == NULL);
+	struct memtx_delete_range_undo *undo =
+		(struct memtx_delete_range_undo *) stmt->engine_savepoint;
+	for (uint32_t i = 0; i < undo->count; i++)
+		tuple_unref(undo->tuples[i]);
+	free(undo->tuples);
+	stmt->engine_savepoint = NULL;
+}
+
 Index *
 MemtxSpace::createIndex(struct space *space, struct index_def *index_def_arg)
 {
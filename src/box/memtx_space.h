@@ -48,6 +48,25 @@ void
 memtx_replace_all_keys(struct txn_stmt *, struct space *space,
 		       enum dup_replace_mode /* mode */);
 
+/**
+ * Undo an UPDATE which was applied to a tuple in place,
+ * i.e. stmt->old_tuple == stmt->new_tuple.
+ */
+void
+memtx_rollback_update_in_place(struct txn_stmt *stmt);
+
+/**
+ * A DELETE_RANGE statement has neither old nor new tuple,
+ * stmt->engine_savepoint points to the list of deleted tuples
+ * if it has deleted any. Put them back to the space.
+ */
+void
+memtx_rollback_delete_range(struct txn_stmt *stmt);
+
+/** Release the tuples deleted by a DELETE_RANGE statement. */
+void
+memtx_commit_delete_range(struct txn_stmt *stmt);
+
 struct MemtxSpace: public Handler {
 	MemtxSpace(Engine *e);
 	virtual ~MemtxSpace()
@@ -71,6 +90,9 @@ struct MemtxSpace: public Handler {
 	executeUpsert(struct txn *txn, struct space *space,
 		      struct request *request) override;
 	virtual void
+	executeDeleteRange(struct txn *txn, struct space *space,
+			   struct request *request) override;
+	virtual void
 	executeSelect(struct txn *, struct space *space,
 		      uint32_t index_id, uint32_t iterator,
 		      uint32_t offset, uint32_t limit,
@@ -89,6 +111,8 @@ public:
 	 */
 	engine_replace_f replace;
 private:
+	void
+	applyDeltaRow(struct space *space, struct request *request);
 	void
 	prepareReplace(struct txn_stmt *stmt, struct space *space,
 		       struct request *request);
@@ -98,6 +122,9 @@ private:
 	void
 	prepareUpdate(struct txn_stmt *stmt, struct space *space,
 		      struct request *request);
+	bool
+	updateInPlace(struct txn_stmt *stmt, struct space *space,
+		      struct request *request);
 	void
 	prepareUpsert(struct txn_stmt *stmt, struct space *space,
 		      struct request *request);
@@ -233,6 +233,30 @@ MemtxTree::findByKey(const char *key, uint32_t part_count) const
 	return res ? *res : 0;
 }
 
+void
+MemtxTree::findByKeys(const char **keys, uint32_t part_count,
+		      uint32_t key_count, struct tuple **result) const
+{
+	assert(index_def->opts.is_unique && part_count == index_def->key_def.part_count);
+
+	enum { BATCH_SIZE = 64 };
+	struct key_data key_data[BATCH_SIZE];
+	struct key_data *key_ptrs[BATCH_SIZE];
+	struct tuple **res[BATCH_SIZE];
+	for (uint32_t start = 0; start < key_count; start += BATCH_SIZE) {
+		uint32_t n = MIN(key_count - start, (uint32_t) BATCH_SIZE);
+		for (uint32_t i = 0; i < n; i++) {
+			key_data[i].key = keys[start + i];
+			key_data[i].part_count = part_count;
+			key_ptrs[i] = &key_data[i];
+		}
+		memtx_tree_find_batch(&tree, key_ptrs, n, res);
+		for (uint32_t i = 0; i < n; i++)
+			result[start + i] = res[i] != NULL ? *res[i] : NULL;
+	}
+	memtx_index_ref_found(result, key_count);
+}
+
 struct tuple *
 MemtxTree::replace(struct tuple *old_tuple, struct tuple *new_tuple,
 		   enum dup_replace_mode mode)
@@ -44,11 +44,44 @@ struct memtx_tuple {
 	 * Please don't change it without understanding
 	 * how smfree_delayed and snapshotting COW works.
 	 */
-	/** Snapshot generation version. */
+	/** Read view generation the tuple was created in. */
 	uint32_t version;
 	struct tuple base;
 };
 
+enum { MEMTX_GARBAGE_CHUNK_CAPACITY = 510 };
+
+/** A chunk of deleted tuples kept for read views. */
+struct memtx_garbage_chunk {
+	struct memtx_garbage_chunk *next;
+	uint32_t count;
+	struct memtx_tuple *tuples[MEMTX_GARBAGE_CHUNK_CAPACITY];
+};
+
+/**
+ * Deleted tuples which are still visible in read views.
+ * Unlike smfree_delayed(), the list doesn't reuse the tuple
+ * header, so that read views can still look at tuple versions.
+ */
+struct memtx_garbage {
+	/** Stack of chunks, the first one may be partially filled. */
+	struct memtx_garbage_chunk *chunks;
+	/** Total size of tuples in the list, in bytes. */
+	size_t size;
+};
+
+/** Read view state of a tuple format, indexed by format id. */
+struct memtx_format_pin {
+	/** The number of open read views the format is in. */
+	uint32_t refs;
+	/** The number of read views still scanning the format. */
+	uint32_t pins;
+	/** Generation of the last read view the format is in. */
+	uint32_t generation;
+	/** Deleted tuples of the format needed by read views. */
+	struct memtx_garbage garbage;
+};
+
 /** Memtx slab arena */
 extern struct slab_arena memtx_arena; /* defined in memtx_engine.cc */
 /* Memtx slab_cache for tuples */
@@ -60,6 +93,28 @@ struct small_alloc memtx_alloc; /* used box box.slab.info() */
 
 uint32_t snapshot_version;
 
+/**
+ * Read view generation, incremented each time a read view
+ * (e.g. the one of a checkpoint) is opened. A tuple created
+ * after the most recent read view was opened is not visible
+ * in any of them and can be freed immediately.
+ */
+static uint32_t memtx_tuple_generation;
+/** The number of open read views. */
+static uint32_t memtx_read_view_count;
+/** Size of garbage pinned by open read views, in bytes. */
+static size_t memtx_delayed_free_size;
+/**
+ * Garbage of formats unknown to some of open read views,
+ * freed when the last view is closed.
+ */
+static struct memtx_garbage memtx_garbage;
+/** Read view state of tuple formats, indexed by format id. */
+static struct memtx_format_pin *memtx_format_pins;
+static uint32_t memtx_format_pins_size;
+/** @sa memtx_tuple_lost_version_count(). */
+static uint64_t memtx_lost_version_count;
+
 enum {
 	/** Lowest allowed slab_alloc_minimal */
 	OBJSIZE_MIN = 16,
@@ -114,6 +169,7 @@ memtx_tuple_init(uint64_t tuple_arena_max_size, uint32_t objsize_min,
 void
 memtx_tuple_free(void)
 {
+	free(memtx_format_pins);
 }
 
 struct tuple_format_vtab memtx_tuple_format_vtab = {
@@ -155,7 +211,7 @@ memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 	}
 	struct tuple *tuple = &memtx_tuple->base;
 	tuple->refs = 0;
-	memtx_tuple->version = snapshot_version;
+	memtx_tuple->version = memtx_tuple_generation;
 	assert(tuple_len <= UINT32_MAX); /* bsize is UINT32_MAX */
 	tuple->bsize = tuple_len;
 	tuple->format_id = tuple_format_id(format);
@@ -177,6 +233,63 @@ memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 	return tuple;
 }
 
+/** Free a tuple which was kept for read views. */
+static void
+memtx_tuple_free_garbage(struct memtx_tuple *memtx_tuple)
+{
+	struct tuple_format *format =
+		tuple_format_by_id(memtx_tuple->base.format_id);
+	size_t total = sizeof(struct memtx_tuple) +
+		       tuple_format_meta_size(format) +
+		       memtx_tuple->base.bsize;
+	tuple_format_ref(format, -1);
+	smfree(&memtx_alloc, memtx_tuple, total);
+	assert(memtx_delayed_free_size >= total);
+	memtx_delayed_free_size -= total;
+}
+
+static int
+memtx_garbage_push(struct memtx_garbage *garbage,
+		   struct memtx_tuple *memtx_tuple, size_t size)
+{
+	struct memtx_garbage_chunk *chunk = garbage->chunks;
+	if (chunk == NULL || chunk->count == MEMTX_GARBAGE_CHUNK_CAPACITY) {
+		chunk = (struct memtx_garbage_chunk *) malloc(sizeof(*chunk));
+		if (chunk == NULL)
+			return -1;
+		chunk->count = 0;
+		chunk->next = garbage->chunks;
+		garbage->chunks = chunk;
+	}
+	chunk->tuples[chunk->count++] = memtx_tuple;
+	garbage->size += size;
+	memtx_delayed_free_size += size;
+	return 0;
+}
+
+static void
+memtx_garbage_free(struct memtx_garbage *garbage)
+{
+	struct memtx_garbage_chunk *chunk = garbage->chunks;
+	while (chunk != NULL) {
+		for (uint32_t i = 0; i < chunk->count; i++)
+			memtx_tuple_free_garbage(chunk->tuples[i]);
+		struct memtx_garbage_chunk *next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	garbage->chunks = NULL;
+	garbage->size = 0;
+}
+
+static inline struct memtx_format_pin *
+memtx_format_pin(struct tuple_format *format)
+{
+	if (format->id >= memtx_format_pins_size)
+		return NULL;
+	return &memtx_format_pins[format->id];
+}
+
 void
 memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple)
 {
@@ -184,27 +297,157 @@ memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple)
 	assert(tuple->refs == 0);
 	size_t total = sizeof(struct memtx_tuple) +
 		       tuple_format_meta_size(format) + tuple->bsize;
-	tuple_format_ref(format, -1);
 	struct memtx_tuple *memtx_tuple =
 		container_of(tuple, struct memtx_tuple, base);
-	if (!memtx_alloc.is_delayed_free_mode ||
-	    memtx_tuple->version == snapshot_version)
+	if (memtx_read_view_count == 0 ||
+	    memtx_tuple->version == memtx_tuple_generation) {
+		tuple_format_ref(format, -1);
 		smfree(&memtx_alloc, memtx_tuple, total);
-	else
+		return;
+	}
+	struct memtx_garbage *garbage = &memtx_garbage;
+	struct memtx_format_pin *pin = memtx_format_pin(format);
+	if (pin != NULL && pin->refs == memtx_read_view_count) {
+		/*
+		 * All open read views know the format, so
+		 * the tuple can be freed as soon as they are
+		 * done with it.
+		 */
+		if (pin->pins == 0) {
+			tuple_format_ref(format, -1);
+			smfree(&memtx_alloc, memtx_tuple, total);
+			return;
+		}
+		garbage = &pin->garbage;
+	}
+	/* The format is unreferenced when the tuple is freed. */
+	if (memtx_garbage_push(garbage, memtx_tuple, total) != 0) {
+		tuple_format_ref(format, -1);
 		smfree_delayed(&memtx_alloc, memtx_tuple, total);
+		memtx_lost_version_count++;
+		memtx_delayed_free_size += total;
+	}
 }
 
-void
-memtx_tuple_begin_snapshot()
+uint32_t
+memtx_tuple_begin_read_view()
 {
-	snapshot_version++;
-	small_alloc_setopt(&memtx_alloc, SMALL_DELAYED_FREE_MODE, true);
+	memtx_tuple_generation++;
+	if (memtx_read_view_count++ == 0)
+		small_alloc_setopt(&memtx_alloc, SMALL_DELAYED_FREE_MODE, true);
+	return memtx_tuple_generation;
 }
 
 void
-memtx_tuple_end_snapshot()
+memtx_tuple_end_read_view()
 {
+	assert(memtx_read_view_count > 0);
+	if (--memtx_read_view_count > 0)
+		return;
+	memtx_garbage_free(&memtx_garbage);
 	small_alloc_setopt(&memtx_alloc, SMALL_DELAYED_FREE_MODE, false);
+	memtx_delayed_free_size = 0;
+}
+
+int
+memtx_tuple_pin_format(struct tuple_format *format)
+{
+	assert(memtx_read_view_count > 0);
+	if (format->id >= memtx_format_pins_size) {
+		uint32_t new_size = MAX(memtx_format_pins_size * 2,
+					(uint32_t) format->id + 1);
+		struct memtx_format_pin *pins = (struct memtx_format_pin *)
+			realloc(memtx_format_pins, new_size * sizeof(*pins));
+		if (pins == NULL) {
+			diag_set(OutOfMemory, new_size * sizeof(*pins),
+				 "realloc", "memtx_format_pins");
+			return -1;
+		}
+		memset(pins + memtx_format_pins_size, 0,
+		       (new_size - memtx_format_pins_size) * sizeof(*pins));
+		memtx_format_pins = pins;
+		memtx_format_pins_size = new_size;
+	}
+	struct memtx_format_pin *pin = &memtx_format_pins[format->id];
+	if (pin->refs > 0 && pin->generation == memtx_tuple_generation) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Read view",
+			 "duplicate spaces");
+		return -1;
+	}
+	pin->generation = memtx_tuple_generation;
+	pin->refs++;
+	pin->pins++;
+	tuple_format_ref(format, 1);
+	return 0;
+}
+
+void
+memtx_tuple_release_format(struct tuple_format *format)
+{
+	struct memtx_format_pin *pin = memtx_format_pin(format);
+	assert(pin != NULL && pin->pins > 0);
+	if (--pin->pins == 0)
+		memtx_garbage_free(&pin->garbage);
+}
+
+void
+memtx_tuple_unpin_format(struct tuple_format *format)
+{
+	struct memtx_format_pin *pin = memtx_format_pin(format);
+	assert(pin != NULL && pin->refs > pin->pins);
+	pin->refs--;
+	tuple_format_ref(format, -1);
+}
+
+bool
+memtx_tuple_is_in_read_view(const struct tuple *tuple)
+{
+	const struct memtx_tuple *memtx_tuple =
+		container_of(tuple, struct memtx_tuple, base);
+	return memtx_read_view_count > 0 &&
+	       memtx_tuple->version != memtx_tuple_generation;
+}
+
+uint32_t
+memtx_tuple_version(const struct tuple *tuple)
+{
+	const struct memtx_tuple *memtx_tuple =
+		container_of(tuple, struct memtx_tuple, base);
+	return memtx_tuple->version;
+}
+
+uint32_t
+memtx_tuple_new_generation()
+{
+	return ++memtx_tuple_generation;
+}
+
+void
+memtx_tuple_touch(struct tuple *tuple)
+{
+	assert(!memtx_tuple_is_in_read_view(tuple));
+	struct memtx_tuple *memtx_tuple =
+		container_of(tuple, struct memtx_tuple, base);
+	memtx_tuple->version = memtx_tuple_generation;
+}
+
+size_t
+memtx_tuple_delayed_free_size()
+{
+	return memtx_delayed_free_size;
+}
+
+size_t
+memtx_tuple_delayed_free_size_by_format(struct tuple_format *format)
+{
+	struct memtx_format_pin *pin = memtx_format_pin(format);
+	return pin != NULL ? pin->garbage.size : 0;
+}
+
+uint64_t
+memtx_tuple_lost_version_count()
+{
+	return memtx_lost_version_count;
 }
 
 box_tuple_t *
@@ -66,11 +66,115 @@ memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple);
 /** tuple format vtab for memtx engine. */
 extern struct tuple_format_vtab memtx_tuple_format_vtab;
 
+/**
+ * Switch the tuple allocator to the delayed free mode:
+ * tuples which exist at the time of the call are not
+ * freed until memtx_tuple_end_read_view() is called, so that
+ * frozen index iterators (@sa Index::createReadViewForIterator())
+ * can safely access them. Calls may nest, the delayed free
+ * mode is on while there is at least one open read view.
+ * Garbage of a format registered with memtx_tuple_pin_format()
+ * is freed as soon as all views are done with the format.
+ *
+ * Returns the new tuple generation, @sa memtx_tuple_version().
+ */
+uint32_t
+memtx_tuple_begin_read_view();
+
+/** Close a read view opened with memtx_tuple_begin_read_view(). */
 void
-memtx_tuple_begin_snapshot();
+memtx_tuple_end_read_view();
+
+/**
+ * Return true if a tuple may be visible in an open read view,
+ * i.e. it was created before a read view was opened. Such a
+ * tuple must not be changed in place.
+ */
+bool
+memtx_tuple_is_in_read_view(const struct tuple *tuple);
+
+/**
+ * Return the generation a tuple was created (or last changed
+ * in place) in. The generation is incremented each time a read
+ * view is opened or memtx_tuple_new_generation() is called, so
+ * a tuple with version >= G was changed after generation G
+ * started.
+ */
+uint32_t
+memtx_tuple_version(const struct tuple *tuple);
 
+/**
+ * Start a new generation without opening a read view.
+ * Returns the new generation.
+ */
+uint32_t
+memtx_tuple_new_generation();
+
+/**
+ * Mark a tuple as changed in the current generation.
+ * Must be called when a tuple is updated in place.
+ * @pre !memtx_tuple_is_in_read_view(tuple)
+ */
 void
-memtx_tuple_end_snapshot();
+memtx_tuple_touch(struct tuple *tuple);
+
+/**
+ * Register a tuple format in the read view being opened, i.e.
+ * the one started by the last memtx_tuple_begin_read_view()
+ * call. Until the format is released with
+ * memtx_tuple_release_format(), tuples of this format that are
+ * visible in the view are not freed on deletion.
+ *
+ * Tuples of formats that are not registered in every open
+ * read view are kept until all views are closed.
+ *
+ * @retval 0 success
+ * @retval -1 memory allocation error or the format is already
+ *            registered in the view, check diag
+ */
+int
+memtx_tuple_pin_format(struct tuple_format *format);
+
+/**
+ * Tell the allocator that a read view won't access tuples of
+ * a format any more, e.g. because the snapshot thread is done
+ * with the space. Tuples of the format deleted while the view
+ * was open are freed unless other views still need them.
+ */
+void
+memtx_tuple_release_format(struct tuple_format *format);
+
+/**
+ * Unregister a format on read view close.
+ * @pre the format was released
+ */
+void
+memtx_tuple_unpin_format(struct tuple_format *format);
+
+/**
+ * Return the size of tuples which were deleted but can't be
+ * freed yet because of open read views, in bytes.
+ */
+size_t
+memtx_tuple_delayed_free_size();
+
+/**
+ * Return the size of deleted tuples of a format which are
+ * kept for open read views, in bytes. Tuples kept until all
+ * views are closed are not accounted here.
+ */
+size_t
+memtx_tuple_delayed_free_size_by_format(struct tuple_format *format);
+
+/**
+ * Return the number of deleted tuples which were handed over
+ * to the small allocator delayed free list, because there was
+ * no memory to track them otherwise. The list reuses the tuple
+ * header, so memtx_tuple_version() of such tuples is garbage
+ * until all read views are closed.
+ */
+uint64_t
+memtx_tuple_lost_version_count();
 
 /** \cond public */
 
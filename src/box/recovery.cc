@@ -512,6 +512,8 @@ recovery_follow_f(va_list ap)
 			 (r->cursor.state == XLOG_CURSOR_CLOSED ||
 			  r->cursor.state == XLOG_CURSOR_EOF));
 
+		xstream_flush_xc(stream);
+
 		subscription.set_log_path(r->cursor.state != XLOG_CURSOR_CLOSED ?
 					  r->cursor.name: NULL);
 
@@ -540,6 +542,7 @@ recovery_follow_local(struct recovery *r, struct xstream *stream,
 	 */
 	xdir_scan_xc(&r->wal_dir);
 	recover_remaining_wals(r, stream, NULL);
+	xstream_flush_xc(stream);
 	/*
 	 * Start 'hot_standby' background fiber to follow xlog changes.
 	 * It will pick up from the position of the currently open
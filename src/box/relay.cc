@@ -30,10 +30,13 @@
  */
 #include "relay.h"
 
+#include <msgpuck.h>
+
 #include "trivia/config.h"
 #include "trivia/util.h"
 #include "cbus.h"
 #include "cfg.h"
+#include "clock.h"
 #include "errinj.h"
 #include "fiber.h"
 #include "say.h"
@@ -54,6 +57,13 @@
 /** Report relay status to tx thread at least once per this interval */
 static const int RELAY_REPORT_INTERVAL = 1;
 
+/**
+ * If the stream is compressed, rows are sent in blocks of
+ * about this size, or smaller if there are no more rows to
+ * send for now.
+ */
+static const size_t RELAY_COMPRESSION_BLOCK_SIZE = 128 * 1024;
+
 /**
  * Cbus message to send status updates from relay to tx thread.
  */
@@ -64,6 +74,8 @@ struct relay_status_msg {
 	struct relay *relay;
 	/** New vclock */
 	struct vclock vclock;
+	/** Compression statistics */
+	struct relay_compression_stat compression;
 };
 
 /**
@@ -94,6 +106,21 @@ struct relay {
 	ev_tstamp wal_dir_rescan_delay;
 	/** Remote replica id */
 	uint32_t replica_id;
+	/**
+	 * zstd compression level of the stream, 0 if rows
+	 * are sent one by one without compression.
+	 */
+	int compression_level;
+	/** zstd compression context, NULL if not compressing. */
+	ZSTD_CCtx *zctx;
+	/** Rows accumulated to be compressed into one block. */
+	struct ibuf rows;
+	/** Compressed block to send. */
+	struct ibuf block;
+	/** Timestamp of the last accumulated row. */
+	double last_row_tm;
+	/** Compression statistics maintained by relay thread. */
+	struct relay_compression_stat compression;
 
 	/** Relay endpoint */
 	struct cbus_endpoint endpoint;
@@ -113,6 +140,8 @@ struct relay {
 		alignas(CACHELINE_SIZE)
 		/** Current vclock sent by relay */
 		struct vclock vclock;
+		/** Compression statistics of the relay */
+		struct relay_compression_stat compression;
 		/** The condition is signaled at relay exit. */
 		struct ipc_cond exit_cond;
 	} tx;
@@ -124,10 +153,27 @@ relay_vclock(const struct relay *relay)
 	return &relay->tx.vclock;
 }
 
+int
+relay_compression_level(const struct relay *relay)
+{
+	return relay->compression_level;
+}
+
+const struct relay_compression_stat *
+relay_compression_stat(const struct relay *relay)
+{
+	return &relay->tx.compression;
+}
+
 static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row);
 static void
+relay_send_initial_join_block(struct xstream *stream, int fd, off_t offset,
+			      size_t size);
+static void
 relay_send_row(struct xstream *stream, struct xrow_header *row);
+static void
+relay_flush(struct xstream *stream);
 
 static inline void
 relay_create(struct relay *relay, int fd, uint64_t sync,
@@ -145,6 +191,38 @@ relay_destroy(struct relay *relay)
 	(void) relay;
 }
 
+/**
+ * Start compression of the stream if it's enabled.
+ * Must be called in the relay thread.
+ */
+static void
+relay_start_compression(struct relay *relay)
+{
+	if (relay->compression_level == 0)
+		return;
+	relay->zctx = ZSTD_createCCtx();
+	if (relay->zctx == NULL) {
+		tnt_raise(ClientError, ER_COMPRESSION,
+			  "failed to create context");
+	}
+	ibuf_create(&relay->rows, &cord()->slabc, RELAY_COMPRESSION_BLOCK_SIZE);
+	ibuf_create(&relay->block, &cord()->slabc,
+		    RELAY_COMPRESSION_BLOCK_SIZE);
+	relay->stream.flush = relay_flush;
+}
+
+static void
+relay_stop_compression(struct relay *relay)
+{
+	if (relay->zctx == NULL)
+		return;
+	ibuf_destroy(&relay->rows);
+	ibuf_destroy(&relay->block);
+	ZSTD_freeCCtx(relay->zctx);
+	relay->zctx = NULL;
+	relay->stream.flush = NULL;
+}
+
 static inline void
 relay_set_cord_name(int fd)
 {
@@ -161,10 +239,13 @@ relay_set_cord_name(int fd)
 }
 
 void
-relay_initial_join(int fd, uint64_t sync, struct vclock *vclock)
+relay_initial_join(int fd, uint64_t sync, struct vclock *vclock,
+		   bool raw_blocks)
 {
 	struct relay relay;
 	relay_create(&relay, fd, sync, relay_send_initial_join_row);
+	if (raw_blocks)
+		relay.stream.write_block = relay_send_initial_join_block;
 	auto scope_guard = make_scoped_guard([&]{
 		relay_destroy(&relay);
 	});
@@ -179,21 +260,28 @@ relay_final_join_f(va_list ap)
 	struct relay *relay = va_arg(ap, struct relay *);
 	coeio_enable();
 	relay_set_cord_name(relay->io.fd);
+	relay_start_compression(relay);
+	auto compression_guard = make_scoped_guard([=]{
+		relay_stop_compression(relay);
+	});
 
 	/* Send all WALs until stop_vclock */
 	assert(relay->stream.write != NULL);
 	xdir_scan_xc(&relay->r->wal_dir);
 	recover_remaining_wals(relay->r, &relay->stream, &relay->stop_vclock);
+	xstream_flush_xc(&relay->stream);
 	assert(vclock_compare(&relay->r->vclock, &relay->stop_vclock) == 0);
 	return 0;
 }
 
 void
 relay_final_join(int fd, uint64_t sync, struct vclock *start_vclock,
-	         struct vclock *stop_vclock)
+	         struct vclock *stop_vclock, bool raw_blocks)
 {
 	struct relay relay;
 	relay_create(&relay, fd, sync, relay_send_row);
+	if (raw_blocks)
+		relay.compression_level = cfg_geti("replication_compression");
 	relay.r = recovery_new(cfg_gets("wal_dir"),
 			       cfg_geti("force_recovery"),
 			       start_vclock);
@@ -238,6 +326,7 @@ tx_status_update(struct cmsg *msg)
 {
 	struct relay_status_msg *status = (struct relay_status_msg *)msg;
 	vclock_copy(&status->relay->tx.vclock, &status->vclock);
+	status->relay->tx.compression = status->compression;
 	static const struct cmsg_hop route[] = {
 		{relay_status_update, NULL}
 	};
@@ -304,6 +393,10 @@ relay_subscribe_f(va_list ap)
 		relay_cbus_detach(relay);
 	});
 	relay_set_cord_name(relay->io.fd);
+	relay_start_compression(relay);
+	auto compression_guard = make_scoped_guard([=]{
+		relay_stop_compression(relay);
+	});
 	recovery_follow_local(r, &relay->stream, fiber_name(fiber()),
 			      relay->wal_dir_rescan_delay);
 
@@ -368,6 +461,7 @@ relay_subscribe_f(va_list ap)
 		};
 		cmsg_init(&relay->status_msg.msg, route);
 		vclock_copy(&relay->status_msg.vclock, &r->vclock);
+		relay->status_msg.compression = relay->compression;
 		relay->status_msg.relay = relay;
 		cpipe_push(&relay->tx_pipe, &relay->status_msg.msg);
 	}
@@ -383,7 +477,7 @@ relay_subscribe_f(va_list ap)
 /** Replication acceptor fiber handler. */
 void
 relay_subscribe(int fd, uint64_t sync, struct replica *replica,
-		struct vclock *replica_clock)
+		struct vclock *replica_clock, bool raw_blocks)
 {
 	assert(replica->id != REPLICA_ID_NIL);
 	/* Don't allow multiple relays for the same replica */
@@ -400,6 +494,8 @@ relay_subscribe(int fd, uint64_t sync, struct replica *replica,
 	vclock_copy(&relay.tx.vclock, replica_clock);
 	relay.replica_id = replica->id;
 	relay.wal_dir_rescan_delay = cfg_getd("wal_dir_rescan_delay");
+	if (raw_blocks)
+		relay.compression_level = cfg_geti("replication_compression");
 	replica_set_relay(replica, &relay);
 
 	auto scope_guard = make_scoped_guard([&]{
@@ -449,6 +545,97 @@ relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row)
 	});
 }
 
+/**
+ * Send a snapshot block as is: the packet header is written
+ * from memory, the block itself goes straight from the file.
+ */
+static void
+relay_send_initial_join_block(struct xstream *stream, int fd, off_t offset,
+			      size_t size)
+{
+	struct relay *relay = container_of(stream, struct relay, stream);
+	char bin[5];
+	struct xrow_header packet;
+	memset(&packet, 0, sizeof(packet));
+	packet.type = IPROTO_RAW_BLOCK;
+	packet.sync = relay->sync;
+	packet.body[0].iov_base = bin;
+	packet.body[0].iov_len = mp_encode_binl(bin, size) - bin;
+	packet.bodycnt = 1;
+
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_to_iovec(&packet, iov);
+	/* Fix up the packet length to account the block. */
+	uint32_t len = size - mp_sizeof_uint(UINT32_MAX);
+	for (int i = 0; i < iovcnt; i++)
+		len += iov[i].iov_len;
+	char *data = (char *) iov[0].iov_base + 1; /* MP_UINT32 */
+	*(uint32_t *) data = mp_bswap_u32(len);
+	coio_writev(&relay->io, iov, iovcnt, 0);
+	coio_sendfile(&relay->io, fd, offset, size);
+	fiber_gc();
+	ERROR_INJECT(ERRINJ_RELAY,
+	{
+		fiber_sleep(1000.0);
+	});
+}
+
+/**
+ * Compress rows accumulated by relay_buffer_row() and send
+ * them to the replica in one IPROTO_RAW_BLOCK packet.
+ */
+static void
+relay_flush(struct xstream *stream)
+{
+	struct relay *relay = container_of(stream, struct relay, stream);
+	size_t raw_size = ibuf_used(&relay->rows);
+	if (raw_size == 0)
+		return;
+	double start = clock_thread();
+	ibuf_reset(&relay->block);
+	ssize_t size = xlog_tx_encode(relay->zctx, relay->compression_level,
+				      relay->rows.rpos, raw_size,
+				      &relay->block);
+	if (size < 0)
+		diag_raise();
+	relay->compression.time += clock_thread() - start;
+	relay->compression.raw_size += raw_size;
+	relay->compression.compressed_size += size;
+	ibuf_reset(&relay->rows);
+
+	char bin[5];
+	struct xrow_header packet;
+	memset(&packet, 0, sizeof(packet));
+	packet.type = IPROTO_RAW_BLOCK;
+	packet.tm = relay->last_row_tm;
+	packet.body[0].iov_base = bin;
+	packet.body[0].iov_len = mp_encode_binl(bin, size) - bin;
+	packet.body[1].iov_base = relay->block.rpos;
+	packet.body[1].iov_len = size;
+	packet.bodycnt = 2;
+	relay_send(relay, &packet);
+}
+
+/** Add a row to the block to be compressed. */
+static void
+relay_buffer_row(struct relay *relay, struct xrow_header *packet)
+{
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_header_encode_xc(packet, iov, 0);
+	for (int i = 0; i < iovcnt; i++) {
+		void *dst = ibuf_alloc(&relay->rows, iov[i].iov_len);
+		if (dst == NULL) {
+			tnt_raise(OutOfMemory, iov[i].iov_len,
+				  "runtime", "relay rows");
+		}
+		memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+	}
+	relay->last_row_tm = packet->tm;
+	fiber_gc();
+	if (ibuf_used(&relay->rows) >= RELAY_COMPRESSION_BLOCK_SIZE)
+		relay_flush(&relay->stream);
+}
+
 /** Send a single row to the client. */
 static void
 relay_send_row(struct xstream *stream, struct xrow_header *packet)
@@ -461,7 +648,10 @@ relay_send_row(struct xstream *stream, struct xrow_header *packet)
 	 * (i.e. don't send replica's own rows back).
 	 */
 	if (packet->replica_id != relay->replica_id) {
-		relay_send(relay, packet);
+		if (relay->zctx != NULL)
+			relay_buffer_row(relay, packet);
+		else
+			relay_send(relay, packet);
 		ERROR_INJECT(ERRINJ_RELAY,
 		{
 			fiber_sleep(1000.0);
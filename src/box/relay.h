@@ -50,6 +50,30 @@ struct vclock;
 const struct vclock *
 relay_vclock(const struct relay *relay);
 
+/** Compression statistics of a relay stream. */
+struct relay_compression_stat {
+	/** Total size of rows before compression, in bytes. */
+	uint64_t raw_size;
+	/** Total size of compressed blocks, in bytes. */
+	uint64_t compressed_size;
+	/** CPU time spent on compression, in seconds. */
+	double time;
+};
+
+/**
+ * Returns zstd compression level of the relay stream,
+ * 0 if the stream is not compressed.
+ */
+int
+relay_compression_level(const struct relay *relay);
+
+/**
+ * Returns compression statistics of the relay stream,
+ * updated along with relay's vclock.
+ */
+const struct relay_compression_stat *
+relay_compression_stat(const struct relay *relay);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -60,27 +84,34 @@ relay_vclock(const struct relay *relay);
  * @param fd        client connection
  * @param sync      sync from incoming JOIN request
  * @param vclock    vclock of the last checkpoint
+ * @param raw_blocks send snapshot blocks as is, without
+ *                  decoding them into rows
  */
 void
-relay_initial_join(int fd, uint64_t sync, struct vclock *vclock);
+relay_initial_join(int fd, uint64_t sync, struct vclock *vclock,
+		   bool raw_blocks);
 
 /**
  * Send final JOIN rows to the replica.
  *
  * @param fd        client connection
  * @param sync      sync from incoming JOIN request
+ * @param raw_blocks the replica accepts IPROTO_RAW_BLOCK, so
+ *                  rows can be compressed
  */
 void
 relay_final_join(int fd, uint64_t sync, struct vclock *start_vclock,
-	         struct vclock *stop_vclock);
+	         struct vclock *stop_vclock, bool raw_blocks);
 
 /**
  * Subscribe a replica to updates.
  *
+ * @param raw_blocks the replica accepts IPROTO_RAW_BLOCK, so
+ *                  rows can be compressed
  * @return none.
  */
 void
 relay_subscribe(int fd, uint64_t sync, struct replica *replica,
-		struct vclock *replica_vclock);
+		struct vclock *replica_vclock, bool raw_blocks);
 
 #endif /* TARANTOOL_REPLICATION_RELAY_H_INCLUDED */
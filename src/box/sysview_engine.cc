@@ -47,6 +47,9 @@ struct SysviewSpace: public Handler {
 	executeUpdate(struct txn *, struct space *, struct request *) override;
 	virtual void
 	executeUpsert(struct txn *, struct space *, struct request *) override;
+	virtual void
+	executeDeleteRange(struct txn *, struct space *,
+			   struct request *) override;
 
 	virtual Index *createIndex(struct space *space,
 				   struct index_def *index_def) override;
@@ -81,6 +84,13 @@ SysviewSpace::executeUpsert(struct txn *, struct space *space, struct request *)
 	tnt_raise(ClientError, ER_VIEW_IS_RO, space->def.name);
 }
 
+void
+SysviewSpace::executeDeleteRange(struct txn *, struct space *space,
+				 struct request *)
+{
+	tnt_raise(ClientError, ER_VIEW_IS_RO, space->def.name);
+}
+
 Index *
 SysviewSpace::createIndex(struct space *space, struct index_def *index_def)
 {
@@ -453,6 +453,76 @@ tuple_compare_with_key_slowpath(const struct tuple *tuple, const char *key,
 						   part_count, key_def);
 }
 
+/**
+ * Look up a field of a tuple that has no field map. The scan
+ * continues from the field found by the previous call, stored
+ * in @a field and @a field_no, so key parts going in the field
+ * order are found in one pass over the tuple.
+ */
+static inline const char *
+tuple_field_raw_scan(const char *data, const char **field,
+		     uint32_t *field_no, uint32_t fieldno)
+{
+	if (fieldno < *field_no) {
+		*field = data;
+		*field_no = 0;
+	}
+	for (; *field_no < fieldno; (*field_no)++)
+		mp_next(field);
+	return *field;
+}
+
+int
+tuple_compare_with_key_raw(const char *data, const char *key,
+			   uint32_t part_count, const struct key_def *key_def)
+{
+	assert(key != NULL || part_count == 0);
+	assert(part_count <= key_def->part_count);
+	uint32_t field_count = mp_decode_array(&data);
+	(void) field_count;
+	const char *field = data;
+	uint32_t field_no = 0;
+	const struct key_part *part = key_def->parts;
+	const struct key_part *end = part + part_count;
+	int r = 0; /* Part count can be 0 in wildcard searches. */
+	for (; part < end; part++) {
+		assert(part->fieldno < field_count);
+		tuple_field_raw_scan(data, &field, &field_no, part->fieldno);
+		r = tuple_compare_field(field, key, part->type);
+		if (r != 0)
+			break;
+		mp_next(&key);
+	}
+	return r;
+}
+
+int
+tuple_compare_with_raw(const struct tuple *tuple, const char *data,
+		       const struct key_def *key_def)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	const uint32_t *field_map = tuple_field_map(tuple);
+	uint32_t field_count = mp_decode_array(&data);
+	(void) field_count;
+	const char *field = data;
+	uint32_t field_no = 0;
+	const struct key_part *part = key_def->parts;
+	const struct key_part *end = part + key_def->part_count;
+	int r = 0;
+	for (; part < end; part++) {
+		assert(part->fieldno < field_count);
+		const char *field_a = tuple_field_raw(format,
+						      tuple_data(tuple),
+						      field_map,
+						      part->fieldno);
+		tuple_field_raw_scan(data, &field, &field_no, part->fieldno);
+		r = tuple_compare_field(field_a, field, part->type);
+		if (r != 0)
+			break;
+	}
+	return r;
+}
+
 template <int TYPE>
 static inline int
 field_compare(const char **field_a, const char **field_b);
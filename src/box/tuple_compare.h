@@ -106,6 +106,33 @@ tuple_compare_with_key(const struct tuple *tuple, const char *key,
 	return key_def->tuple_compare_with_key(tuple, key, part_count, key_def);
 }
 
+/**
+ * Compare a tuple that has no field map, e.g. one stored on
+ * disk, with a key. Fields of the tuple are found by scanning
+ * it, so no tuple has to be allocated to do the comparison.
+ * @param data tuple with MessagePack array header
+ * @param key key parts without MessagePack array header
+ * @param part_count the number of parts in @a key
+ * @param key_def key definition
+ *
+ * @sa tuple_compare_with_key()
+ */
+int
+tuple_compare_with_key_raw(const char *data, const char *key,
+			   uint32_t part_count, const struct key_def *key_def);
+
+/**
+ * Compare a tuple with a tuple that has no field map.
+ * @param tuple tuple
+ * @param data tuple with MessagePack array header
+ * @param key_def key definition
+ *
+ * @sa tuple_compare()
+ */
+int
+tuple_compare_with_raw(const struct tuple *tuple, const char *data,
+		       const struct key_def *key_def);
+
 /** \cond public */
 
 /**
@@ -1143,6 +1143,119 @@ tuple_update_execute(tuple_update_alloc_func alloc, void *alloc_ctx,
 	return update_finish(&update, p_tuple_len);
 }
 
+/**
+ * Calculate the result of an arithmetic or bitwise operation
+ * on a field without building a rope. Return the new encoded
+ * size of the field or 0 if the operation can not be done.
+ */
+static uint32_t
+update_op_eval_field(struct tuple_update *update, struct update_op *op,
+		     const char *field)
+{
+	if (op->meta == &op_arith) {
+		struct op_arith_arg left_arg;
+		if (mp_read_arith_arg(update->index_base, op, &field,
+				      &left_arg))
+			return 0;
+		if (make_arith_operation(left_arg, op->arg.arith, op->opcode,
+					 update->index_base + op->field_no,
+					 &op->arg.arith))
+			return 0;
+		return mp_sizeof_op_arith_arg(op->arg.arith);
+	}
+	assert(op->meta == &op_bit);
+	uint64_t val;
+	if (mp_read_uint(update->index_base, op, &field, &val))
+		return 0;
+	switch (op->opcode) {
+	case '&':
+		op->arg.bit.val &= val;
+		break;
+	case '^':
+		op->arg.bit.val ^= val;
+		break;
+	case '|':
+		op->arg.bit.val |= val;
+		break;
+	default:
+		unreachable(); /* checked by update_read_ops */
+	}
+	return mp_sizeof_uint(op->arg.bit.val);
+}
+
+int
+tuple_update_execute_inplace(tuple_update_alloc_func alloc, void *alloc_ctx,
+			     const char *expr, const char *expr_end,
+			     char *data, const char *data_end,
+			     int index_base, uint64_t key_mask,
+			     const char **p_undo, uint32_t *p_undo_offset,
+			     uint32_t *p_undo_size)
+{
+	struct tuple_update update;
+	update_init(&update, alloc, alloc_ctx, index_base);
+	if (update_read_ops(&update, expr, expr_end))
+		return -1;
+	if (update.op_count == 0 || (update.column_mask & key_mask) != 0)
+		return 1;
+	/*
+	 * The column mask is exact when all operations change
+	 * single fields with numbers in range [0..63].
+	 */
+	uint64_t column_mask = 0;
+	struct update_op *op = update.ops;
+	struct update_op *ops_end = op + update.op_count;
+	for (; op < ops_end; op++) {
+		if (op->meta != &op_arith && op->meta != &op_bit)
+			return 1;
+		if (op->field_no < 0 || op->field_no > 63)
+			return 1;
+		uint64_t one_col = ((uint64_t) 1) << (63 - op->field_no);
+		if (column_mask & one_col)
+			return 1; /* double update of the same field */
+		column_mask |= one_col;
+	}
+	/* Find the changed fields and calculate their new values. */
+	char **fields = (char **)
+		alloc(alloc_ctx, update.op_count * sizeof(*fields));
+	if (fields == NULL)
+		return -1;
+	const char *pos = data;
+	uint32_t field_count = mp_decode_array(&pos);
+	const char *first = pos;
+	char *begin = (char *) data_end;
+	char *end = data;
+	for (op = update.ops; op < ops_end; op++) {
+		if ((uint32_t) op->field_no >= field_count)
+			return 1;
+		const char *field = first;
+		for (int32_t i = 0; i < op->field_no; i++)
+			mp_next(&field);
+		const char *field_end = field;
+		mp_next(&field_end);
+		op->new_field_len = update_op_eval_field(&update, op, field);
+		if (op->new_field_len != (uint32_t) (field_end - field))
+			return 1;
+		fields[op - update.ops] = (char *) field;
+		if (field < begin)
+			begin = (char *) field;
+		if (field_end > end)
+			end = (char *) field_end;
+	}
+	assert(begin < end && end <= data_end);
+	/* Save the old data and apply the update. */
+	uint32_t undo_size = end - begin;
+	char *undo = (char *) alloc(alloc_ctx, undo_size);
+	if (undo == NULL)
+		return -1;
+	memcpy(undo, begin, undo_size);
+	for (op = update.ops; op < ops_end; op++)
+		op->meta->store(&op->arg, NULL, fields[op - update.ops]);
+	*p_undo = undo;
+	*p_undo_offset = begin - data;
+	*p_undo_size = undo_size;
+	return 0;
+}
+
 const char *
 tuple_upsert_execute(tuple_update_alloc_func alloc, void *alloc_ctx,
 		     const char *expr,const char *expr_end,
@@ -64,6 +64,39 @@ tuple_upsert_execute(tuple_update_alloc_func alloc, void *alloc_ctx,
 		     uint32_t *p_new_size, int index_base, bool suppress_error,
 		     uint64_t *column_mask);
 
+/**
+ * Try to apply update operations to tuple data in place.
+ *
+ * This is only possible if all operations are arithmetic or
+ * bitwise, each of them changes a different field among the
+ * first 64 fields of the tuple, none of the changed fields is
+ * set in @a key_mask and the encoded size of each field stays
+ * the same. The result is byte-to-byte equal to the result of
+ * tuple_update_execute().
+ *
+ * Before the data is changed, the changed range is copied to
+ * memory allocated with @a alloc to make it possible to undo
+ * the update.
+ *
+ * @param key_mask     Mask of columns which must not change,
+ *                     in the format of a column mask.
+ * @param[out] p_undo  Copy of the changed range of the old data.
+ * @param[out] p_undo_offset Offset of the changed range.
+ * @param[out] p_undo_size   Size of the changed range.
+ *
+ * @retval  0 the update was applied in place.
+ * @retval  1 the update can't be applied in place, the data is
+ *            left intact.
+ * @retval -1 error, the data is left intact, diag is set.
+ */
+int
+tuple_update_execute_inplace(tuple_update_alloc_func alloc, void *alloc_ctx,
+			     const char *expr, const char *expr_end,
+			     char *data, const char *data_end,
+			     int index_base, uint64_t key_mask,
+			     const char **p_undo, uint32_t *p_undo_offset,
+			     uint32_t *p_undo_size);
+
 /**
  * Try to merge two update/upsert expressions to an equivalent one.
  * Resulting expression is allocated on given allocator.
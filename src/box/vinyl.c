@@ -57,6 +57,7 @@
 #include "cfg.h"
 #include "diag.h"
 #include "fiber.h" /* cord_slab_cache() */
+#include "trigger.h"
 #include "ipc.h"
 #include "coeio.h"
 #include "cbus.h"
@@ -221,6 +222,11 @@ struct vy_stat {
 	struct vy_latency get_latency;
 	struct vy_latency tx_latency;
 	struct vy_latency cursor_latency;
+	/**
+	 * Time transactions that were paced spent waiting for
+	 * quota before the first write, @sa vy_quota_pace().
+	 */
+	struct vy_latency throttle_latency;
 	/**
 	 * Dump bandwidth is needed for calculating the quota watermark.
 	 * The higher the bandwidth, the later we can start dumping w/o
@@ -313,6 +319,13 @@ vy_stat_tx(struct vy_stat *s, ev_tstamp start,
 	vy_latency_update(&s->tx_latency, diff);
 }
 
+static void
+vy_stat_throttle(struct vy_stat *s, ev_tstamp start)
+{
+	ev_tstamp diff = ev_now(loop()) - start;
+	vy_latency_update(&s->throttle_latency, diff);
+}
+
 static void
 vy_stat_cursor(struct vy_stat *s, ev_tstamp start, int ops)
 {
@@ -436,8 +449,30 @@ struct vy_range {
 	 * how we  decide how many runs to compact next time.
 	 */
 	int compact_priority;
+	/**
+	 * Number of lookups that reached the runs of this range
+	 * since it was last compacted. Together with per-run
+	 * lookup counters it gives read amplification of the
+	 * range, @sa vy_range_read_amp().
+	 */
+	uint64_t lookup_count;
+	/**
+	 * Estimated number of run lookups that would have been
+	 * saved if the runs included into the next compaction
+	 * had been compacted before. Ranges that are read more
+	 * often gain more from compaction, so the compaction heap
+	 * is ordered by this value weighted by compact_priority.
+	 * @sa vy_range_update_compact_benefit().
+	 */
+	uint64_t compact_benefit;
 	/** Number of times the range was compacted. */
 	int n_compactions;
+	/**
+	 * All range tombstones with LSN <= this value have been
+	 * applied to all runs of this range, @sa vy_tombstone.
+	 * Set on major compaction.
+	 */
+	int64_t tombstone_lsn;
 	/**
 	 * If this range is a part of a range that is being split,
 	 * this field points to the original range.
@@ -465,6 +500,173 @@ struct vy_range {
 
 typedef rb_tree(struct vy_range) vy_range_tree_t;
 
+/**
+ * A range tombstone is left in the primary index by
+ * a DELETE_RANGE statement. It deletes all statements
+ * with keys in [begin, end) and LSN less than the LSN
+ * of the tombstone.
+ *
+ * Tombstones are not written to runs. Instead, they are
+ * stored in the metadata log and kept in memory, in
+ * vy_index::tombstones, until all statements covered by
+ * them have been purged by compaction, @sa
+ * vy_index_gc_tombstones().
+ *
+ * A tombstone may be referenced by write iterators
+ * working in worker threads, so it is reference counted.
+ * Once created, it is never modified except for the LSN,
+ * which is assigned on commit, before it gets visible to
+ * write iterators.
+ */
+struct vy_tombstone {
+	/** Unique ID of the tombstone or -1 if not logged. */
+	int64_t id;
+	/** LSN of the DELETE_RANGE statement. */
+	int64_t lsn;
+	/** Range lower bound, inclusive. NULL means -inf. */
+	char *begin;
+	/** Range upper bound, exclusive. NULL means +inf. */
+	char *end;
+	/**
+	 * SELECT statements made of begin and end, used for
+	 * lookups in the tuple cache and in the read set while
+	 * the tombstone is being committed. NULL if the bound
+	 * is infinite or the tombstone was recovered.
+	 */
+	struct tuple *begin_stmt;
+	struct tuple *end_stmt;
+	/** Reference counter. */
+	int refs;
+	/** Index this tombstone was created for. */
+	struct vy_index *index;
+	/**
+	 * Link in vy_index::tombstones. The newer a tombstone,
+	 * the closer it to the list head.
+	 */
+	struct rlist in_index;
+	/** Link in vy_tx::tombstones until committed. */
+	struct rlist in_tx;
+};
+
+static struct vy_tombstone *
+vy_tombstone_new(int64_t id, int64_t lsn, const char *begin, const char *end)
+{
+	struct vy_tombstone *tombstone = calloc(1, sizeof(*tombstone));
+	if (tombstone == NULL) {
+		diag_set(OutOfMemory, sizeof(*tombstone), "calloc",
+			 "struct vy_tombstone");
+		return NULL;
+	}
+	if (begin != NULL) {
+		tombstone->begin = vy_key_dup(begin);
+		if (tombstone->begin == NULL)
+			goto fail;
+	}
+	if (end != NULL) {
+		tombstone->end = vy_key_dup(end);
+		if (tombstone->end == NULL)
+			goto fail;
+	}
+	tombstone->id = id;
+	tombstone->lsn = lsn;
+	tombstone->refs = 1;
+	rlist_create(&tombstone->in_index);
+	rlist_create(&tombstone->in_tx);
+	return tombstone;
+fail:
+	free(tombstone->begin);
+	free(tombstone);
+	return NULL;
+}
+
+static void
+vy_tombstone_ref(struct vy_tombstone *tombstone)
+{
+	assert(cord_is_main());
+	assert(tombstone->refs > 0);
+	tombstone->refs++;
+}
+
+static void
+vy_tombstone_unref(struct vy_tombstone *tombstone)
+{
+	assert(cord_is_main());
+	assert(tombstone->refs > 0);
+	if (--tombstone->refs > 0)
+		return;
+	if (tombstone->begin_stmt != NULL)
+		tuple_unref(tombstone->begin_stmt);
+	if (tombstone->end_stmt != NULL)
+		tuple_unref(tombstone->end_stmt);
+	free(tombstone->begin);
+	free(tombstone->end);
+	TRASH(tombstone);
+	free(tombstone);
+}
+
+/** Return true if a tombstone covers the key of a statement. */
+static inline bool
+vy_tombstone_covers_stmt(const struct vy_tombstone *tombstone,
+			 const struct tuple *stmt,
+			 const struct key_def *key_def)
+{
+	if (tombstone->begin != NULL &&
+	    vy_stmt_compare_with_raw_key(stmt, tombstone->begin,
+					 key_def) < 0)
+		return false;
+	if (tombstone->end != NULL &&
+	    vy_stmt_compare_with_raw_key(stmt, tombstone->end,
+					 key_def) >= 0)
+		return false;
+	return true;
+}
+
+/**
+ * Return true if a tombstone may cover keys in [begin, end).
+ * Since tombstone boundaries may be partial keys, the check
+ * is conservative.
+ */
+static inline bool
+vy_tombstone_overlaps(const struct vy_tombstone *tombstone,
+		      const char *begin, const char *end,
+		      const struct key_def *key_def)
+{
+	if (tombstone->end != NULL && begin != NULL &&
+	    key_compare(tombstone->end, begin, key_def) < 0)
+		return false;
+	if (tombstone->begin != NULL && end != NULL &&
+	    key_compare(end, tombstone->begin, key_def) < 0)
+		return false;
+	return true;
+}
+
+/** Return true if a tombstone covers all keys in [begin, end). */
+static inline bool
+vy_tombstone_covers_range(const struct vy_tombstone *tombstone,
+			  const char *begin, const char *end,
+			  const struct key_def *key_def)
+{
+	if (tombstone->begin != NULL &&
+	    (begin == NULL ||
+	     key_compare(tombstone->begin, begin, key_def) > 0))
+		return false;
+	if (tombstone->end != NULL) {
+		if (end == NULL)
+			return false;
+		int cmp = key_compare(end, tombstone->end, key_def);
+		if (cmp > 0)
+			return false;
+		/*
+		 * A partial key equal to the range end by prefix
+		 * excludes the keys preceding the range end.
+		 */
+		const char *key = tombstone->end;
+		if (cmp == 0 && mp_decode_array(&key) < key_def->part_count)
+			return false;
+	}
+	return true;
+}
+
 /**
  * A single operation made by a transaction:
  * a single read or write in a vy_index.
@@ -486,6 +688,12 @@ struct txv {
 	/** true if that is a read statement,
 	 * and there was no value found for that key */
 	bool is_gap;
+	/**
+	 * true if that is a read statement inserted into the
+	 * index read set. Reads of autocommit transactions are
+	 * inserted lazily, @sa vy_tx_track().
+	 */
+	bool in_read_set;
 };
 
 typedef rb_tree(struct txv) read_set_t;
@@ -558,6 +766,13 @@ struct vy_index {
 	uint64_t mem_used;
 	/** Histogram of number of runs in range. */
 	struct histogram *run_hist;
+	/**
+	 * Histogram of read amplification of ranges. Unlike
+	 * run_hist, it is only filled while index info is
+	 * collected, because read amplification changes on
+	 * every lookup, @sa vy_index_info().
+	 */
+	struct histogram *read_amp_hist;
 	/**
 	 * Reference counter. Used to postpone index drop
 	 * until all pending operations have completed.
@@ -626,8 +841,40 @@ struct vy_index {
 	 * (@sa vy_update).
 	 */
 	uint64_t column_mask;
+	/**
+	 * List of range tombstones of this index, linked by
+	 * vy_tombstone::in_index. The newer a tombstone, the
+	 * closer it to the list head. Only the primary index
+	 * may have tombstones.
+	 */
+	struct rlist tombstones;
+	/**
+	 * Incremented each time a tombstone is added to or
+	 * removed from the list, to invalidate iterators.
+	 */
+	uint32_t tombstone_version;
 };
 
+/**
+ * Return the LSN of the newest tombstone of an index covering
+ * the key of a statement and visible from a read view with
+ * @vlsn, or 0 if there is no such tombstone.
+ */
+static int64_t
+vy_index_tombstone_lsn(struct vy_index *index, const struct tuple *stmt,
+		       int64_t vlsn)
+{
+	const struct key_def *key_def = &index->index_def->key_def;
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry(tombstone, &index->tombstones, in_index) {
+		if (tombstone->lsn > vlsn)
+			continue;
+		if (vy_tombstone_covers_stmt(tombstone, stmt, key_def))
+			return tombstone->lsn;
+	}
+	return 0;
+}
+
 /** @sa implementation for details. */
 extern struct vy_index *
 vy_index(struct Index *index);
@@ -754,6 +1001,34 @@ struct vy_tx {
 	 * forcibly closed.
 	 */
 	struct rlist cursors;
+	/**
+	 * Range tombstones created by the transaction, linked by
+	 * vy_tombstone::in_tx. A tombstone is removed from the
+	 * list when the transaction commits.
+	 */
+	struct rlist tombstones;
+	/**
+	 * Set for autocommit transactions. Reads of such
+	 * a transaction are not added to index read sets until
+	 * the fiber executing it yields, @sa vy_tx_track().
+	 */
+	bool is_autocommit;
+	/**
+	 * Set once the transaction has begun its first write
+	 * statement, @sa vy_begin_write().
+	 */
+	bool is_writer;
+	/**
+	 * Trigger installed on the fiber executing an autocommit
+	 * transaction while some of its reads are not in index
+	 * read sets, @sa vy_tx_on_yield().
+	 */
+	struct trigger on_yield;
+	/**
+	 * Value of tx_manager::psn at the time of the first read
+	 * not added to an index read set.
+	 */
+	int64_t deferred_psn;
 	struct tx_manager *xm;
 };
 
@@ -857,6 +1132,29 @@ struct vy_merge_iterator {
 	 * means that it must switch to next range
 	 */
 	bool range_ended;
+	/* {{{ Heap of immutable sources */
+	/**
+	 * Sources following the mutable ones can't change
+	 * during iteration, so once all of them are positioned,
+	 * they are kept in a binary heap ordered by the current
+	 * statement and the source age. The next key is then
+	 * found in O(log(src_count)) rather than O(src_count)
+	 * comparisons.
+	 */
+	heap_t src_heap;
+	/** Set if src_heap is in sync with the sources. */
+	bool heap_is_valid;
+	/** Offset of the first source managed by the heap. */
+	uint32_t heap_start;
+	/**
+	 * Sources managed by the heap that are positioned at
+	 * the current key. They are popped from the heap,
+	 * ordered by offset.
+	 */
+	uint32_t *heap_front;
+	/** Number of elements in the heap_front array. */
+	uint32_t heap_front_count;
+	/* Heap of immutable sources }}} */
 };
 
 struct vy_range_iterator {
@@ -896,6 +1194,15 @@ struct vy_read_iterator {
 	struct tuple *curr_stmt;
 	/* is lazy search started */
 	bool search_started;
+	/**
+	 * Set if a range tombstone of the index overlaps the
+	 * range with id tombstone_range_id. Valid as long as
+	 * the index tombstone version is tombstone_version,
+	 * @sa vy_read_iterator_check_tombstones().
+	 */
+	bool range_has_tombstones;
+	int64_t tombstone_range_id;
+	uint32_t tombstone_version;
 };
 
 /**
@@ -1508,6 +1815,8 @@ vy_scheduler_add_range(struct vy_scheduler *, struct vy_range *range);
 static void
 vy_scheduler_update_range(struct vy_scheduler *, struct vy_range *range);
 static void
+vy_scheduler_update_compact(struct vy_scheduler *, struct vy_range *range);
+static void
 vy_scheduler_remove_range(struct vy_scheduler *, struct vy_range*);
 static void
 vy_scheduler_add_mem(struct vy_scheduler *scheduler, struct vy_mem *mem);
@@ -1799,15 +2108,97 @@ vy_index_remove_range(struct vy_index *index, struct vy_range *range)
 	index->range_count--;
 }
 
-/* dump statement to the run page buffers (stmt header and data) */
+/**
+ * Append a statement to the records of a prefix-compressed page,
+ * @sa VY_PAGE_VERSION_PREFIX. The record of the previous statement
+ * of the page is kept in @a last.
+ */
 static int
-vy_run_dump_stmt(struct tuple *value, struct xlog *data_xlog,
+vy_run_dump_stmt(struct tuple *value, struct ibuf *rows, struct ibuf *last,
 		 struct vy_page_info *info, const struct key_def *key_def,
 		 bool is_primary)
 {
 	struct region *region = &fiber()->gc;
 	size_t used = region_used(region);
 
+	enum iproto_type type = vy_stmt_type(value);
+	const char *data;
+	const char *ops = NULL;
+	uint32_t data_size, ops_size = 0;
+	if (is_primary && type == IPROTO_REPLACE) {
+		data = tuple_data_range(value, &data_size);
+	} else if (is_primary && type == IPROTO_UPSERT) {
+		data = vy_upsert_data_range(value, &data_size);
+		ops = vy_stmt_upsert_ops(value, &ops_size);
+	} else {
+		/* In secondary indexes only REPLACE/DELETE are written. */
+		assert(type == IPROTO_REPLACE || type == IPROTO_DELETE);
+		data = tuple_extract_key(value, key_def, &data_size);
+		if (data == NULL)
+			return -1;
+	}
+	int64_t lsn = vy_stmt_lsn(value);
+	uint32_t len = data_size + mp_sizeof_uint(type) +
+		       mp_sizeof_uint(lsn) + ops_size;
+	char *record = region_alloc(region, len);
+	if (record == NULL) {
+		diag_set(OutOfMemory, len, "region", "page record");
+		return -1;
+	}
+	char *pos = record;
+	memcpy(pos, data, data_size);
+	pos += data_size;
+	pos = mp_encode_uint(pos, type);
+	pos = mp_encode_uint(pos, lsn);
+	if (ops != NULL)
+		memcpy(pos, ops, ops_size);
+
+	/* Restart points are stored in full. */
+	uint32_t shared = 0;
+	if (info->count % VY_PAGE_RESTART_INTERVAL != 0) {
+		const char *prev = last->rpos;
+		uint32_t max_shared = MIN(len, ibuf_used(last));
+		while (shared < max_shared && prev[shared] == record[shared])
+			shared++;
+	}
+	uint32_t unshared = len - shared;
+	size_t size = mp_sizeof_uint(shared) + mp_sizeof_uint(unshared) +
+		      unshared;
+	pos = ibuf_alloc(rows, size);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, size, "ibuf", "page rows");
+		return -1;
+	}
+	pos = mp_encode_uint(pos, shared);
+	pos = mp_encode_uint(pos, unshared);
+	memcpy(pos, record + shared, unshared);
+
+	ibuf_reset(last);
+	pos = ibuf_alloc(last, len);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, len, "ibuf", "page record");
+		return -1;
+	}
+	memcpy(pos, record, len);
+
+	region_truncate(region, used);
+	++info->count;
+	return 0;
+}
+
+/**
+ * Write a statement to a page as a separate xrow,
+ * @sa VY_PAGE_VERSION_XROW. Only used by tests to check
+ * that pages written by older versions are readable.
+ */
+static int
+vy_run_dump_stmt_xrow(struct tuple *value, struct xlog *data_xlog,
+		      struct vy_page_info *info, const struct key_def *key_def,
+		      bool is_primary)
+{
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+
 	struct xrow_header xrow;
 	int rc = (is_primary ?
 		  vy_stmt_encode_primary(value, key_def, 0, &xrow) :
@@ -1826,6 +2217,41 @@ vy_run_dump_stmt(struct tuple *value, struct xlog *data_xlog,
 	return 0;
 }
 
+/**
+ * Encode statement records of a prefix-compressed page as xrow.
+ *
+ * @param rows records
+ * @param size size of records
+ * @param[out] xrow xrow to fill.
+ * @retval 0 for success
+ * @retval -1 for error
+ */
+static int
+vy_page_rows_encode(const char *rows, uint32_t size, struct xrow_header *xrow)
+{
+	memset(xrow, 0, sizeof(*xrow));
+	xrow->type = VY_RUN_PAGE_ROWS;
+
+	size_t header_size = mp_sizeof_map(1) +
+			     mp_sizeof_uint(VY_PAGE_ROWS_ROWS) +
+			     mp_sizeof_binl(size);
+	char *pos = region_alloc(&fiber()->gc, header_size);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, header_size, "region", "page rows");
+		return -1;
+	}
+	xrow->body[0].iov_base = pos;
+	pos = mp_encode_map(pos, 1);
+	pos = mp_encode_uint(pos, VY_PAGE_ROWS_ROWS);
+	pos = mp_encode_binl(pos, size);
+	xrow->body[0].iov_len = header_size;
+	/* Records are written as is, without copying. */
+	xrow->body[1].iov_base = (void *)rows;
+	xrow->body[1].iov_len = size;
+	xrow->bodycnt = 2;
+	return 0;
+}
+
 struct vy_write_iterator;
 
 static struct vy_write_iterator *
@@ -1834,13 +2260,22 @@ vy_write_iterator_new(struct vy_env *env, const struct key_def *key_def,
 		      struct tuple_format *surrogate_format,
 		      struct tuple_format *upsert_format,
 		      bool is_primary, uint64_t column_mask,
-		      bool is_last_level, int64_t oldest_vlsn);
+		      bool is_last_level, int64_t oldest_vlsn,
+		      const char *begin);
 static NODISCARD int
 vy_write_iterator_add_run(struct vy_write_iterator *wi, struct vy_run *run,
 			  struct tuple *compact_from, const char *end);
 static NODISCARD int
 vy_write_iterator_add_mem(struct vy_write_iterator *wi, struct vy_mem *mem);
 static NODISCARD int
+vy_write_iterator_add_tombstones(struct vy_write_iterator *wi,
+				 struct vy_index *index,
+				 const char *begin, const char *end);
+static bool
+vy_write_iterator_run_is_deleted(struct vy_write_iterator *wi,
+				 struct vy_run *run,
+				 const char *begin, const char *end);
+static NODISCARD int
 vy_write_iterator_next(struct vy_write_iterator *wi, struct tuple **ret);
 
 /**
@@ -1915,9 +2350,15 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 	bool end_of_run = false;
 	struct tuple *stmt = NULL;
 
-	/* row offsets accumulator */
+	/* restart point offsets accumulator */
 	struct ibuf page_index_buf;
 	ibuf_create(&page_index_buf, &cord()->slabc, sizeof(uint32_t) * 4096);
+	/* statement records accumulator */
+	struct ibuf rows_buf;
+	ibuf_create(&rows_buf, &cord()->slabc, page_size);
+	/* the last record written to the page */
+	struct ibuf last_buf;
+	ibuf_create(&last_buf, &cord()->slabc, 1024);
 
 	if (run_info->count >= *page_info_capacity) {
 		uint32_t cap = *page_info_capacity > 0 ?
@@ -1947,25 +2388,39 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 
 	page = run_info->page_infos + run_info->count;
 	vy_page_info_create(page, data_xlog->offset, *curr_stmt, key_def);
+	page->version = VY_PAGE_VERSION_PREFIX;
+	ERROR_INJECT(ERRINJ_VY_RUN_WRITE_XROW, {
+		page->version = VY_PAGE_VERSION_XROW;
+	});
+	bool is_xrow = page->version == VY_PAGE_VERSION_XROW;
 	xlog_tx_begin(data_xlog);
 
 	do {
-		uint32_t *offset = (uint32_t *) ibuf_alloc(&page_index_buf,
-							   sizeof(uint32_t));
-		if (offset == NULL) {
-			diag_set(OutOfMemory, sizeof(uint32_t),
-				 "ibuf", "row index");
-			goto error_rollback;
+		if (is_xrow || page->count % VY_PAGE_RESTART_INTERVAL == 0) {
+			uint32_t *offset = (uint32_t *)
+				ibuf_alloc(&page_index_buf, sizeof(uint32_t));
+			if (offset == NULL) {
+				diag_set(OutOfMemory, sizeof(uint32_t),
+					 "ibuf", "row index");
+				goto error_rollback;
+			}
+			*offset = is_xrow ? page->unpacked_size :
+					    ibuf_used(&rows_buf);
 		}
-		*offset = page->unpacked_size;
 
 		if (stmt != NULL)
 			tuple_unref(stmt);
 		stmt = *curr_stmt;
 		tuple_ref(stmt);
-		if (vy_run_dump_stmt(stmt, data_xlog, page,
-				     key_def, is_primary) != 0)
-			goto error_rollback;
+		if (is_xrow) {
+			if (vy_run_dump_stmt_xrow(stmt, data_xlog, page,
+						  key_def, is_primary) != 0)
+				goto error_rollback;
+		} else {
+			if (vy_run_dump_stmt(stmt, &rows_buf, &last_buf, page,
+					     key_def, is_primary) != 0)
+				goto error_rollback;
+		}
 		bloom_spectrum_add(bs, tuple_hash(stmt, user_key_def));
 
 		if (vy_write_iterator_next(wi, curr_stmt))
@@ -1977,7 +2432,8 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 			 vy_tuple_compare_with_raw_key(*curr_stmt, end_key,
 						       key_def) >= 0);
 	} while (end_of_run == false &&
-		 obuf_size(&data_xlog->obuf) < page_size);
+		 (is_xrow ? obuf_size(&data_xlog->obuf) :
+			    ibuf_used(&rows_buf)) < page_size);
 
 	/* We don't write empty pages. */
 	assert(stmt != NULL);
@@ -2001,17 +2457,34 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 	tuple_unref(stmt);
 	stmt = NULL;
 
+	/* Write statement records */
+	struct xrow_header xrow;
+	ssize_t written;
+	if (!is_xrow) {
+		if (vy_page_rows_encode(rows_buf.rpos, ibuf_used(&rows_buf),
+					&xrow) < 0)
+			goto error_rollback;
+
+		written = xlog_write_row(data_xlog, &xrow);
+		if (written < 0)
+			goto error_rollback;
+
+		page->unpacked_size += written;
+	}
+
 	/* Save offset to row index  */
 	page->page_index_offset = page->unpacked_size;
 
 	/* Write row index */
-	struct xrow_header xrow;
+	uint32_t restart_count = is_xrow ? page->count :
+				 (page->count + VY_PAGE_RESTART_INTERVAL - 1) /
+				 VY_PAGE_RESTART_INTERVAL;
 	const uint32_t *page_index = (const uint32_t *) page_index_buf.rpos;
-	assert(ibuf_used(&page_index_buf) == sizeof(uint32_t) * page->count);
-	if (vy_page_index_encode(page_index, page->count, &xrow) < 0)
+	assert(ibuf_used(&page_index_buf) == sizeof(uint32_t) * restart_count);
+	if (vy_page_index_encode(page_index, restart_count, &xrow) < 0)
 		goto error_rollback;
 
-	ssize_t written = xlog_write_row(data_xlog, &xrow);
+	written = xlog_write_row(data_xlog, &xrow);
 	if (written < 0)
 		goto error_rollback;
 
@@ -2032,12 +2505,16 @@ vy_run_write_page(struct vy_run_info *run_info, struct xlog *data_xlog,
 	run_info->keys += page->count;
 
 	ibuf_destroy(&page_index_buf);
+	ibuf_destroy(&rows_buf);
+	ibuf_destroy(&last_buf);
 	return !end_of_run ? 0: 1;
 
 error_rollback:
 	xlog_tx_rollback(data_xlog);
 error_page_index:
 	ibuf_destroy(&page_index_buf);
+	ibuf_destroy(&rows_buf);
+	ibuf_destroy(&last_buf);
 	if (stmt != NULL)
 		tuple_unref(stmt);
 	return -1;
@@ -2069,6 +2546,7 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 	struct xlog_meta meta = {
 		.filetype = XLOG_META_TYPE_RUN,
 		.instance_uuid = INSTANCE_UUID,
+		.base_signature = -1,
 	};
 	if (xlog_create(&data_xlog, path, &meta) < 0)
 		return -1;
@@ -2131,10 +2609,13 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	mp_next(&tmp);
 	min_key_size = tmp - page_info->min_key;
 
+	/* The version is omitted for the legacy page format. */
+	uint32_t map_size = page_info->version != VY_PAGE_VERSION_XROW ? 7 : 6;
+
 	/* calc tuple size */
 	uint32_t size;
 	/* 3 items: page offset, size, and map */
-	size = mp_sizeof_map(6) +
+	size = mp_sizeof_map(map_size) +
 	       mp_sizeof_uint(VY_PAGE_INFO_OFFSET) +
 	       mp_sizeof_uint(page_info->offset) +
 	       mp_sizeof_uint(VY_PAGE_INFO_SIZE) +
@@ -2147,6 +2628,9 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	       mp_sizeof_uint(page_info->unpacked_size) +
 	       mp_sizeof_uint(VY_PAGE_INFO_PAGE_INDEX_OFFSET) +
 	       mp_sizeof_uint(page_info->page_index_offset);
+	if (page_info->version != VY_PAGE_VERSION_XROW)
+		size += mp_sizeof_uint(VY_PAGE_INFO_VERSION) +
+			mp_sizeof_uint(page_info->version);
 
 	char *pos = region_alloc(region, size);
 	if (pos == NULL) {
@@ -2157,7 +2641,7 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	memset(xrow, 0, sizeof(*xrow));
 	/* encode page */
 	xrow->body->iov_base = pos;
-	pos = mp_encode_map(pos, 6);
+	pos = mp_encode_map(pos, map_size);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_OFFSET);
 	pos = mp_encode_uint(pos, page_info->offset);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_SIZE);
@@ -2171,6 +2655,10 @@ vy_page_info_encode(const struct vy_page_info *page_info,
 	pos = mp_encode_uint(pos, page_info->unpacked_size);
 	pos = mp_encode_uint(pos, VY_PAGE_INFO_PAGE_INDEX_OFFSET);
 	pos = mp_encode_uint(pos, page_info->page_index_offset);
+	if (page_info->version != VY_PAGE_VERSION_XROW) {
+		pos = mp_encode_uint(pos, VY_PAGE_INFO_VERSION);
+		pos = mp_encode_uint(pos, page_info->version);
+	}
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	xrow->bodycnt = 1;
 
@@ -2290,6 +2778,7 @@ vy_run_write_index(struct vy_run *run, const char *dirpath)
 	struct xlog_meta meta = {
 		.filetype = XLOG_META_TYPE_INDEX,
 		.instance_uuid = INSTANCE_UUID,
+		.base_signature = -1,
 	};
 	if (xlog_create(&index_xlog, path, &meta) < 0)
 		return -1;
@@ -2496,6 +2985,73 @@ vy_range_delete(struct vy_range *range)
 	free(range);
 }
 
+/**
+ * Return true if a range doesn't store statements with LSN
+ * less than @lsn which haven't been checked against range
+ * tombstones with LSN <= @lsn.
+ */
+static bool
+vy_range_is_purged(struct vy_range *range, int64_t lsn)
+{
+	/* Data of a range being split is stored in the old range. */
+	if (range->shadow != NULL)
+		return false;
+	if (range->mem_min_lsn < lsn)
+		return false;
+	if (range->tombstone_lsn >= lsn)
+		return true;
+	struct vy_run *run;
+	rlist_foreach_entry(run, &range->runs, in_range) {
+		if (run->info.min_lsn < lsn)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Delete range tombstones of an index that are of no use
+ * anymore, because all statements they could delete have
+ * been purged by dump or compaction.
+ */
+static void
+vy_index_gc_tombstones(struct vy_index *index)
+{
+	if (index->is_dropped)
+		return;
+	const struct key_def *key_def = &index->index_def->key_def;
+	struct vy_tombstone *tombstone, *next_tombstone;
+	rlist_foreach_entry_safe(tombstone, &index->tombstones, in_index,
+				 next_tombstone) {
+		if (tombstone->id < 0)
+			continue; /* not committed */
+		bool is_purged = true;
+		struct vy_range *range;
+		for (range = vy_range_tree_first(&index->tree); range != NULL;
+		     range = vy_range_tree_next(&index->tree, range)) {
+			if (vy_tombstone_overlaps(tombstone, range->begin,
+						  range->end, key_def) &&
+			    !vy_range_is_purged(range, tombstone->lsn)) {
+				is_purged = false;
+				break;
+			}
+		}
+		if (!is_purged)
+			continue;
+		/*
+		 * If we fail to log the deletion, the tombstone
+		 * will be recovered on restart, which is harmless.
+		 */
+		vy_log_tx_begin();
+		vy_log_delete_tombstone(tombstone->id);
+		if (vy_log_tx_try_commit() < 0)
+			say_warn("failed to log range tombstone deletion: %s",
+				 diag_last_error(diag_get())->errmsg);
+		rlist_del_entry(tombstone, in_index);
+		index->tombstone_version++;
+		vy_tombstone_unref(tombstone);
+	}
+}
+
 /**
  * Create a write iterator to dump in-memory indexes.
  *
@@ -2529,9 +3085,12 @@ vy_range_get_dump_iterator(struct vy_range *range, int64_t vlsn,
 				   index->upsert_format,
 				   index->index_def->iid == 0,
 				   index->column_mask,
-				   range->run_count == 0, vlsn);
+				   range->run_count == 0, vlsn, NULL);
 	if (wi == NULL)
 		goto err_wi;
+	if (vy_write_iterator_add_tombstones(wi, index, range->begin,
+					     range->end) != 0)
+		goto err_wi_sub;
 	rlist_foreach_entry(mem, &range->sealed, in_sealed) {
 		if (mem->min_lsn > dump_lsn)
 			continue;
@@ -2557,11 +3116,16 @@ err_wi:
  * iterator. Set to @range->run_count for major compaction,
  * 0 < .. < @range->run_count for minor compaction, or 0 for
  * dump.
+ *
+ * If @begin or @end is not NULL, only statements falling in
+ * [@begin, @end) are returned by the iterator. It is used for
+ * writing a part of a range, @sa vy_task_split_new().
  */
 static struct vy_write_iterator *
 vy_range_get_compact_iterator(struct vy_range *range, int run_count,
 			      int64_t vlsn, int64_t dump_lsn,
-			      bool is_last_level, size_t *p_max_output_count,
+			      bool is_last_level, const char *begin,
+			      const char *end, size_t *p_max_output_count,
 			      int64_t *p_min_lsn, int64_t *p_max_lsn,
 			      struct tuple *compact_from)
 {
@@ -2580,9 +3144,12 @@ vy_range_get_compact_iterator(struct vy_range *range, int run_count,
 				   index->upsert_format,
 				   index->index_def->iid == 0,
 				   index->column_mask,
-				   is_last_level, vlsn);
+				   is_last_level, vlsn, begin);
 	if (wi == NULL)
 		goto err_wi;
+	if (vy_write_iterator_add_tombstones(wi, index, range->begin,
+					     range->end) != 0)
+		goto err_wi_sub;
 	/*
 	 * Prepare for merge. Note, merge iterator requires newer
 	 * sources to be added first so mems are added before runs.
@@ -2600,7 +3167,14 @@ vy_range_get_compact_iterator(struct vy_range *range, int run_count,
 	rlist_foreach_entry(run, &range->runs, in_range) {
 		if (run_count-- == 0)
 			break;
-		if (vy_write_iterator_add_run(wi, run, compact_from, NULL) != 0)
+		/*
+		 * A run whose statements are all deleted by a range
+		 * tombstone is dropped without reading it.
+		 */
+		if (vy_write_iterator_run_is_deleted(wi, run, range->begin,
+						     range->end))
+			continue;
+		if (vy_write_iterator_add_run(wi, run, compact_from, end) != 0)
 			goto err_wi_sub;
 		*p_max_output_count += run->info.keys;
 		*p_min_lsn = MIN(*p_min_lsn, run->info.min_lsn);
@@ -2663,21 +3237,30 @@ vy_range_write_run(struct vy_range *range, struct vy_write_iterator *wi,
 	return 0;
 }
 
+/** Max number of ranges a range can be split into at once. */
+enum { VY_RANGE_SPLIT_MAX = 16 };
+
 /**
- * Return true and set split_key accordingly if the range needs to be
- * split in two.
+ * Return true and fill @split_keys accordingly if the range needs
+ * to be split. The number of keys is returned in @p_split_key_count,
+ * @split_keys must have room for VY_RANGE_SPLIT_MAX - 1 keys.
  *
  * - We should never split a range until it was merged at least once
  *   (actually, it should be a function of run_count_per_level/number
  *   of runs used for the merge: with low run_count_per_level it's more
  *   than once, with high run_count_per_level it's once).
  * - We should use the last run size as the size of the range.
- * - We should split around the last run middle key.
  * - We should only split if the last run size is greater than
  *   4/3 * range_size.
+ * - We should split the range in as many parts as range_size fits
+ *   in the last run size, so that a big range doesn't have to be
+ *   split over and over again.
+ * - We should split around the keys dividing the last run page
+ *   index in equal parts.
  */
 static bool
-vy_range_needs_split(struct vy_range *range, const char **p_split_key)
+vy_range_needs_split(struct vy_range *range, const char **split_keys,
+		     int *p_split_key_count)
 {
 	struct vy_index *index = range->index;
 	struct index_def *index_def = index->index_def;
@@ -2692,23 +3275,92 @@ vy_range_needs_split(struct vy_range *range, const char **p_split_key)
 	run = rlist_last_entry(&range->runs, struct vy_run, in_range);
 
 	/* The range is too small to be split. */
-	if (vy_run_size(run) < (uint64_t)index_def->opts.range_size * 4 / 3)
+	uint64_t run_size = vy_run_size(run);
+	uint64_t range_size = index_def->opts.range_size;
+	if (run_size < range_size * 4 / 3)
 		return false;
 
-	/* Find the median key in the oldest run (approximately). */
-	struct vy_page_info *mid_page;
-	mid_page = vy_run_page_info(run, run->info.count / 2);
-
-	struct vy_page_info *first_page = vy_run_page_info(run, 0);
-
-	/* No point in splitting if a new range is going to be empty. */
-	if (key_compare(first_page->min_key, mid_page->min_key,
-			&index_def->key_def) == 0)
+	uint64_t part_count = run_size / range_size;
+	part_count = MAX(part_count, 2);
+	part_count = MIN(part_count, VY_RANGE_SPLIT_MAX);
+
+	/* Find the keys dividing the oldest run (approximately). */
+	const char *prev_key = vy_run_page_info(run, 0)->min_key;
+	int split_key_count = 0;
+	for (uint64_t i = 1; i < part_count; i++) {
+		struct vy_page_info *page;
+		page = vy_run_page_info(run, run->info.count * i / part_count);
+		/* No point in splitting if a new range is going to be empty. */
+		if (key_compare(prev_key, page->min_key,
+				&index_def->key_def) == 0)
+			continue;
+		prev_key = split_keys[split_key_count++] = page->min_key;
+	}
+	if (split_key_count == 0)
 		return false;
-	*p_split_key = mid_page->min_key;
+	*p_split_key_count = split_key_count;
 	return true;
 }
 
+/**
+ * Return read amplification of a range, i.e. the average number
+ * of runs searched per lookup since the range was last compacted.
+ * Lookups avoided thanks to bloom filters are not counted.
+ */
+static double
+vy_range_read_amp(struct vy_range *range)
+{
+	if (range->lookup_count == 0)
+		return 0;
+	uint64_t run_lookup_count = 0;
+	struct vy_run *run;
+	rlist_foreach_entry(run, &range->runs, in_range)
+		run_lookup_count += run->lookup_count;
+	return (double)run_lookup_count / range->lookup_count;
+}
+
+/**
+ * Reset read statistics of a range, @sa vy_range_read_amp().
+ * Called on compaction, because it changes the layout of runs
+ * the statistics were collected for.
+ */
+static void
+vy_range_reset_read_stat(struct vy_range *range)
+{
+	range->lookup_count = 0;
+	struct vy_run *run;
+	rlist_foreach_entry(run, &range->runs, in_range) {
+		run->lookup_count = 0;
+		run->bloom_reflect_count = 0;
+	}
+}
+
+/**
+ * Estimate how many run lookups the next compaction of a range
+ * would save. Runs to be compacted are merged into one, so
+ * of L lookups done in K runs we would have done only about L/K.
+ * Ranges that are not read are estimated to gain nothing, but
+ * they still compete for compaction by compact_priority,
+ * @sa heap_compact_less().
+ */
+static void
+vy_range_update_compact_benefit(struct vy_range *range)
+{
+	range->compact_benefit = 0;
+	if (range->compact_priority == 0)
+		return;
+	uint64_t run_lookup_count = 0;
+	int n = range->compact_priority;
+	struct vy_run *run;
+	rlist_foreach_entry(run, &range->runs, in_range) {
+		run_lookup_count += run->lookup_count;
+		if (--n == 0)
+			break;
+	}
+	range->compact_benefit = run_lookup_count -
+			run_lookup_count / range->compact_priority;
+}
+
 /**
  * To reduce write amplification caused by compaction, we follow
  * the LSM tree design. Runs in each range are divided into groups
@@ -2810,6 +3462,7 @@ vy_range_update_compact_priority(struct vy_range *range)
 			est_new_run_size = total_size;
 		}
 	}
+	vy_range_update_compact_benefit(range);
 }
 
 /**
@@ -3022,6 +3675,19 @@ vy_index_recovery_cb(const struct vy_log_record *record, void *cb_arg)
 		}
 		vy_range_add_run(range, run);
 		break;
+	case VY_LOG_INSERT_TOMBSTONE: {
+		/* Tombstones are logged in chronological order. */
+		struct vy_tombstone *tombstone;
+		tombstone = vy_tombstone_new(record->tombstone_id,
+					     record->tombstone_lsn,
+					     record->range_begin,
+					     record->range_end);
+		if (tombstone == NULL)
+			return -1;
+		rlist_add_entry(&index->tombstones, tombstone, in_index);
+		index->tombstone_version++;
+		break;
+	}
 	default:
 		unreachable();
 	}
@@ -3514,6 +4180,14 @@ struct vy_task {
 	/** Range of ranges to coalesce: [begin, end). */
 	struct vy_range *coalesce_begin;
 	struct vy_range *coalesce_end;
+	/** For split tasks: the split this task is a part of. */
+	struct vy_split *split;
+	/** For split tasks: the first new range written by the task. */
+	struct vy_range *split_first;
+	/** For split tasks: number of new ranges written by the task. */
+	int split_range_count;
+	/** For split tasks: ordinal number of the task in the split. */
+	int split_task_no;
 };
 
 /**
@@ -3597,6 +4271,10 @@ vy_task_dump_complete(struct vy_task *task)
 	say_info("%s: completed dumping range %s",
 		 index->name, vy_range_str(range));
 
+	/* Dump of a range without runs is a major compaction. */
+	if (range->run_count == 0)
+		range->tombstone_lsn = task->wi->oldest_vlsn;
+
 	/* The iterator has been cleaned up in a worker thread. */
 	vy_write_iterator_delete(task->wi);
 
@@ -3608,6 +4286,7 @@ vy_task_dump_complete(struct vy_task *task)
 	range->version++;
 	vy_index_acct_range(index, range);
 	vy_scheduler_add_range(scheduler, range);
+	vy_index_gc_tombstones(index);
 	return 0;
 }
 
@@ -3716,13 +4395,36 @@ err_task:
 	return -1;
 }
 
+/**
+ * State shared by the tasks splitting a range.
+ *
+ * Writing all new ranges of a big range on a single worker
+ * thread may take very long while other workers are idle, so
+ * the new ranges are distributed among several tasks executed
+ * in parallel, each of which writes runs of a contiguous subset
+ * of the new ranges using its own write iterator. The tasks are
+ * completed one by one. The last task to complete commits the
+ * split in the metadata log, or rolls it back if any of the
+ * tasks failed.
+ */
+struct vy_split {
+	/** Range being split. */
+	struct vy_range *range;
+	/** Total number of tasks. */
+	int task_count;
+	/** Number of tasks that haven't been completed yet. */
+	int pending_count;
+	/** Set if any of the tasks failed. */
+	bool is_failed;
+};
+
 static int
 vy_task_split_execute(struct vy_task *task)
 {
 	struct vy_range *range = task->range;
 	struct vy_write_iterator *wi = task->wi;
+	struct vy_range *r = task->split_first;
 	struct tuple *stmt;
-	struct vy_range *r;
 	uint64_t unused;
 
 	/* The range has been deleted from the scheduler queues. */
@@ -3733,7 +4435,9 @@ vy_task_split_execute(struct vy_task *task)
 	if (vy_write_iterator_next(wi, &stmt) != 0)
 		goto error;
 	assert(!rlist_empty(&range->split_list));
-	rlist_foreach_entry(r, &range->split_list, split_list) {
+	for (int i = 0; i < task->split_range_count; i++) {
+		if (i > 0)
+			r = rlist_next_entry(r, split_list);
 		assert(r->shadow == range);
 		if (&r->split_list != rlist_first(&range->split_list)) {
 			ERROR_INJECT(ERRINJ_VY_RANGE_SPLIT,
@@ -3753,17 +4457,95 @@ error:
 	return -1;
 }
 
-static int
-vy_task_split_complete(struct vy_task *task)
-{
-	struct vy_index *index = task->index;
+/**
+ * Roll back a split after all its tasks have been completed
+ * and at least one of them failed.
+ */
+static void
+vy_split_rollback(struct vy_split *split, bool in_shutdown)
+{
+	struct vy_range *range = split->range;
+	struct vy_index *index = range->index;
+	struct vy_range *r, *tmp;
+
+	if (!in_shutdown && !index->is_dropped) {
+		rlist_foreach_entry(r, &range->split_list, split_list)
+			vy_range_discard_new_run(r);
+		vy_scheduler_add_range(index->env->scheduler, range);
+	}
+
+	/*
+	 * On split failure we delete new ranges, but leave their
+	 * mems and runs linked to the old range so that statements
+	 * inserted while split was in progress don't get lost.
+	 */
+	rlist_foreach_entry_safe(r, &range->split_list, split_list, tmp) {
+		assert(r->run_count == 0);
+
+		vy_range_seal_mem(r);
+		rlist_splice(&range->sealed, &r->sealed);
+		if (range->mem_used == 0)
+			range->mem_min_lsn = r->mem_min_lsn;
+		assert(range->mem_min_lsn <= r->mem_min_lsn);
+		range->mem_used += r->mem_used;
+
+		rlist_del(&r->split_list);
+		assert(r->shadow == range);
+		r->shadow = NULL;
+
+		vy_index_remove_range(index, r);
+		vy_range_delete(r);
+	}
+	vy_range_unseal_mem(range);
+
+	/* Insert the range back into the tree. */
+	vy_index_add_range(index, range);
+	index->version++;
+	free(split);
+}
+
+/**
+ * Account a completed task of a split that can't be committed,
+ * because other tasks are still in progress or failed. If this
+ * is the last task of a failed split, roll the split back.
+ */
+static void
+vy_task_split_finish(struct vy_task *task, bool in_shutdown)
+{
+	struct vy_split *split = task->split;
+
+	/* The iterator has been cleaned up in a worker thread. */
+	vy_write_iterator_delete(task->wi);
+
+	assert(split->pending_count > 0);
+	if (--split->pending_count > 0)
+		return;
+	assert(split->is_failed);
+	vy_split_rollback(split, in_shutdown);
+}
+
+static int
+vy_task_split_complete(struct vy_task *task)
+{
+	struct vy_index *index = task->index;
 	struct vy_range *range = task->range;
+	struct vy_split *split = task->split;
 	struct vy_scheduler *scheduler = index->env->scheduler;
 	struct vy_range *r, *tmp;
 	struct vy_mem *mem;
 
+	if (split->pending_count > 1 || split->is_failed) {
+		say_info("%s: completed part %d/%d of splitting range %s, "
+			 "%zu bytes written", index->name,
+			 task->split_task_no + 1, split->task_count,
+			 vy_range_str(range), task->dump_size);
+		vy_task_split_finish(task, false);
+		return 0;
+	}
+
 	/*
-	 * Log change in metadata.
+	 * This is the last task of the split and all tasks
+	 * succeeded. Log change in metadata.
 	 */
 	vy_log_tx_begin();
 	vy_log_delete_range(range->id);
@@ -3778,9 +4560,16 @@ vy_task_split_complete(struct vy_task *task)
 	if (vy_log_tx_commit() < 0)
 		return -1;
 
+	say_info("%s: completed part %d/%d of splitting range %s, "
+		 "%zu bytes written", index->name,
+		 task->split_task_no + 1, split->task_count,
+		 vy_range_str(range), task->dump_size);
 	say_info("%s: completed splitting range %s",
 		 index->name, vy_range_str(range));
 
+	/* All new ranges were written by iterators with the same vlsn. */
+	int64_t tombstone_lsn = task->wi->oldest_vlsn;
+
 	/* The iterator has been cleaned up in a worker thread. */
 	vy_write_iterator_delete(task->wi);
 
@@ -3798,6 +4587,7 @@ vy_task_split_complete(struct vy_task *task)
 		rlist_del(&r->split_list);
 		assert(r->shadow == range);
 		r->shadow = NULL;
+		r->tombstone_lsn = tombstone_lsn;
 
 		vy_index_acct_range(index, r);
 		vy_scheduler_add_range(scheduler, r);
@@ -3810,6 +4600,8 @@ vy_task_split_complete(struct vy_task *task)
 		vy_scheduler_mem_dumped(scheduler, mem);
 
 	vy_range_delete(range);
+	free(split);
+	vy_index_gc_tombstones(index);
 	return 0;
 }
 
@@ -3818,58 +4610,33 @@ vy_task_split_abort(struct vy_task *task, bool in_shutdown)
 {
 	struct vy_index *index = task->index;
 	struct vy_range *range = task->range;
-	struct vy_range *r, *tmp;
-
-	/* The iterator has been cleaned up in a worker thread. */
-	vy_write_iterator_delete(task->wi);
+	struct vy_split *split = task->split;
 
 	if (!in_shutdown && !index->is_dropped) {
-		say_error("%s: failed to split range %s: %s",
+		say_error("%s: failed to split range %s, part %d/%d: %s",
 			  index->name, vy_range_str(range),
+			  task->split_task_no + 1, split->task_count,
 			  diag_last_error(&task->diag)->errmsg);
-		rlist_foreach_entry(r, &range->split_list, split_list)
-			vy_range_discard_new_run(r);
-		vy_scheduler_add_range(index->env->scheduler, range);
-	}
-
-	/*
-	 * On split failure we delete new ranges, but leave their
-	 * mems and runs linked to the old range so that statements
-	 * inserted while split was in progress don't get lost.
-	 */
-	rlist_foreach_entry_safe(r, &range->split_list, split_list, tmp) {
-		assert(r->run_count == 0);
-
-		vy_range_seal_mem(r);
-		rlist_splice(&range->sealed, &r->sealed);
-		if (range->mem_used == 0)
-			range->mem_min_lsn = r->mem_min_lsn;
-		assert(range->mem_min_lsn <= r->mem_min_lsn);
-		range->mem_used += r->mem_used;
-
-		rlist_del(&r->split_list);
-		assert(r->shadow == range);
-		r->shadow = NULL;
-
-		vy_index_remove_range(index, r);
-		vy_range_delete(r);
 	}
-	vy_range_unseal_mem(range);
-
-	/* Insert the range back into the tree. */
-	vy_index_add_range(index, range);
-	index->version++;
+	split->is_failed = true;
+	vy_task_split_finish(task, in_shutdown);
 }
 
+/**
+ * Create tasks to split a range by @split_keys and append them
+ * to @tasks, @sa struct vy_split.
+ */
 static int
 vy_task_split_new(struct mempool *pool, struct vy_range *range,
-		  const char *split_key, struct vy_task **p_task)
+		  const char **split_keys, int split_key_count,
+		  struct stailq *tasks)
 {
 	struct vy_index *index = range->index;
 	struct tx_manager *xm = index->env->xm;
 	struct vy_scheduler *scheduler = index->env->scheduler;
 
 	assert(rlist_empty(&range->split_list));
+	assert(split_key_count > 0 && split_key_count < VY_RANGE_SPLIT_MAX);
 
 	static struct vy_task_ops split_ops = {
 		.execute = vy_task_split_execute,
@@ -3877,18 +4644,33 @@ vy_task_split_new(struct mempool *pool, struct vy_range *range,
 		.abort = vy_task_split_abort,
 	};
 
-	const char *keys[3];
-	struct vy_range *parts[2] = {NULL, };
-	const int n_parts = 2;
+	const char *keys[VY_RANGE_SPLIT_MAX + 1];
+	struct vy_range *parts[VY_RANGE_SPLIT_MAX] = {NULL, };
+	struct vy_task *split_tasks[VY_RANGE_SPLIT_MAX] = {NULL, };
+	const int n_parts = split_key_count + 1;
 
-	struct vy_task *task = vy_task_new(pool, index, &split_ops);
-	if (task == NULL)
-		goto err_task;
+	/*
+	 * Use all idle worker threads except the one reserved
+	 * for dumps, see vy_schedule().
+	 */
+	int n_tasks = MIN(n_parts, scheduler->workers_available - 1);
+	n_tasks = MAX(n_tasks, 1);
+
+	struct vy_split *split = calloc(1, sizeof(*split));
+	if (split == NULL) {
+		diag_set(OutOfMemory, sizeof(*split), "calloc",
+			 "struct vy_split");
+		goto err_split;
+	}
+	split->range = range;
+	split->task_count = n_tasks;
+	split->pending_count = n_tasks;
 
 	/* Determine new ranges' boundaries. */
 	keys[0] = range->begin;
-	keys[1] = split_key;
-	keys[2] = range->end;
+	for (int i = 0; i < split_key_count; i++)
+		keys[i + 1] = split_keys[i];
+	keys[n_parts] = range->end;
 
 	/* Allocate new ranges. */
 	for (int i = 0; i < n_parts; i++) {
@@ -3908,14 +4690,31 @@ vy_task_split_new(struct mempool *pool, struct vy_range *range,
 	vy_range_seal_mem(range);
 	int64_t dump_lsn = INT64_MAX;
 
+	/*
+	 * Each task writes a contiguous subset of the new ranges
+	 * with a write iterator limited by their boundaries.
+	 */
 	int64_t min_lsn, max_lsn;
-	struct vy_write_iterator *wi;
-	wi = vy_range_get_compact_iterator(range, range->run_count,
-					   tx_manager_vlsn(xm), dump_lsn, true,
-					   &task->max_output_count,
-					   &min_lsn, &max_lsn, NULL);
-	if (wi == NULL)
-		goto err_wi;
+	for (int i = 0; i < n_tasks; i++) {
+		int first = n_parts * i / n_tasks;
+		int last = n_parts * (i + 1) / n_tasks;
+		struct vy_task *task = vy_task_new(pool, index, &split_ops);
+		if (task == NULL)
+			goto err_tasks;
+		split_tasks[i] = task;
+		task->wi = vy_range_get_compact_iterator(range,
+					range->run_count, tx_manager_vlsn(xm),
+					dump_lsn, true, parts[first]->begin,
+					parts[last - 1]->end,
+					&task->max_output_count,
+					&min_lsn, &max_lsn, NULL);
+		if (task->wi == NULL)
+			goto err_tasks;
+		task->split = split;
+		task->split_first = parts[first];
+		task->split_range_count = last - first;
+		task->split_task_no = i;
+	}
 
 	/* Replace the old range with the new ones. */
 	vy_index_remove_range(index, range);
@@ -3948,18 +4747,30 @@ vy_task_split_new(struct mempool *pool, struct vy_range *range,
 	 */
 	vy_range_wait_pinned(range);
 
-	task->range = range;
-	task->wi = wi;
-	task->dump_lsn = dump_lsn;
-	task->bloom_fpr = index->env->conf->bloom_fpr;
+	for (int i = 0; i < n_tasks; i++) {
+		struct vy_task *task = split_tasks[i];
+		task->range = range;
+		task->dump_lsn = dump_lsn;
+		task->bloom_fpr = index->env->conf->bloom_fpr;
+		stailq_add_tail_entry(tasks, task, link);
+	}
 
 	vy_scheduler_remove_range(scheduler, range);
 
-	say_info("%s: started splitting range %s by key %s",
-		 index->name, vy_range_str(range), vy_key_str(split_key));
-	*p_task = task;
+	say_info("%s: started splitting range %s in %d parts, tasks %d",
+		 index->name, vy_range_str(range), n_parts, n_tasks);
 	return 0;
-err_wi:
+err_tasks:
+	for (int i = 0; i < n_tasks; i++) {
+		struct vy_task *task = split_tasks[i];
+		if (task == NULL)
+			continue;
+		if (task->wi != NULL) {
+			vy_write_iterator_cleanup(task->wi);
+			vy_write_iterator_delete(task->wi);
+		}
+		vy_task_delete(pool, task);
+	}
 	vy_range_unseal_mem(range);
 err_parts:
 	for (int i = 0; i < n_parts; i++) {
@@ -3970,8 +4781,8 @@ err_parts:
 			vy_range_discard_new_run(r);
 		vy_range_delete(r);
 	}
-	vy_task_delete(pool, task);
-err_task:
+	free(split);
+err_split:
 	say_error("%s: can't start range splitting %s: %s", index->name,
 		  vy_range_str(range), diag_last_error(diag_get())->errmsg);
 	return -1;
@@ -4024,6 +4835,9 @@ vy_task_coalesce_complete(struct vy_task *task)
 	if (vy_log_tx_commit() < 0)
 		/* Schedule old ranges in abort() function. */
 		return -1;
+	result->tombstone_lsn = task->wi->oldest_vlsn;
+	/* The iterator has been cleaned up in worker. */
+	vy_write_iterator_delete(task->wi);
 	vy_range_add_run(result, result->new_run);
 	/* Remove old ranges from the index. */
 	it = task->coalesce_begin;
@@ -4047,6 +4861,7 @@ vy_task_coalesce_complete(struct vy_task *task)
 	vy_scheduler_add_range(scheduler, result);
 	say_info("%s: completed coalescing ranges %s", index->name,
 		 vy_range_str(result));
+	vy_index_gc_tombstones(index);
 	return 0;
 }
 
@@ -4057,6 +4872,10 @@ vy_task_coalesce_abort(struct vy_task *task, bool in_shutdown)
 	struct vy_range *result = task->range;
 	struct vy_range *it = task->coalesce_begin;
 	struct vy_scheduler *scheduler = index->env->scheduler;
+
+	/* The iterator has been cleaned up in worker. */
+	vy_write_iterator_delete(task->wi);
+
 	if (!in_shutdown && !index->is_dropped) {
 		say_error("%s: failed to coalesce range %s: %s",
 			  index->name, vy_range_str(result),
@@ -4078,7 +4897,7 @@ vy_task_coalesce_abort(struct vy_task *task, bool in_shutdown)
  */
 static int
 vy_task_coalesce_new(struct mempool *pool, struct vy_range *first,
-		     struct vy_range *last, struct vy_task **p_task)
+		     struct vy_range *last, struct stailq *tasks)
 {
 	static struct vy_task_ops coalesce_ops = {
 		/* Yes, execute() is the same as compact. */
@@ -4104,7 +4923,7 @@ vy_task_coalesce_new(struct mempool *pool, struct vy_range *first,
 				      index->upsert_format,
 				      index->index_def->iid == 0,
 				      index->column_mask,
-				      true, tx_manager_vlsn(xm));
+				      true, tx_manager_vlsn(xm), NULL);
 	if (wi == NULL)
 		goto err_wi;
 	struct vy_task *task = vy_task_new(pool, index, &coalesce_ops);
@@ -4120,6 +4939,9 @@ vy_task_coalesce_new(struct mempool *pool, struct vy_range *first,
 
 	/* Add sealed mems and runs. */
 	it = first;
+	if (vy_write_iterator_add_tombstones(wi, index, first->begin,
+					     last->end) != 0)
+		goto err_wi_sub;
 	while (it != end) {
 		struct vy_run_info *info = &result->new_run->info;
 		info->min_lsn = INT64_MAX;
@@ -4152,7 +4974,7 @@ vy_task_coalesce_new(struct mempool *pool, struct vy_range *first,
 	task->range = result;
 	task->bloom_fpr = index->env->conf->bloom_fpr;
 	task->dump_lsn = xm->lsn;
-	*p_task = task;
+	stailq_add_tail_entry(tasks, task, link);
 	say_info("%s: started coalescing range %s", index->name,
 		 vy_range_str(result));
 	return 0;
@@ -4207,6 +5029,9 @@ vy_task_compact_complete(struct vy_task *task)
 	say_info("%s: completed compacting range %s",
 		 index->name, vy_range_str(range));
 
+	if (task->run_count == range->run_count)
+		range->tombstone_lsn = task->wi->oldest_vlsn;
+
 	/* The iterator has been cleaned up in worker. */
 	vy_write_iterator_delete(task->wi);
 
@@ -4224,11 +5049,13 @@ vy_task_compact_complete(struct vy_task *task)
 	}
 	assert(n == 0);
 	vy_range_add_run(range, range->new_run);
+	vy_range_reset_read_stat(range);
 	range->new_run = NULL;
 	range->n_compactions++;
 	range->version++;
 	vy_index_acct_range(index, range);
 	vy_scheduler_add_range(scheduler, range);
+	vy_index_gc_tombstones(index);
 	return 0;
 }
 
@@ -4257,9 +5084,14 @@ vy_task_compact_abort(struct vy_task *task, bool in_shutdown)
 	 */
 }
 
+/**
+ * Create tasks to compact a range and append them to @tasks.
+ * If the range is too big or too small, it is split or coalesced
+ * with its neighbors instead.
+ */
 static int
 vy_task_compact_new(struct mempool *pool, struct vy_range *range,
-		    struct vy_task **p_task)
+		    struct stailq *tasks)
 {
 	assert(range->compact_priority > 0);
 
@@ -4279,13 +5111,15 @@ vy_task_compact_new(struct mempool *pool, struct vy_range *range,
 	}
 
 	/* Consider splitting the range if it's too big. */
-	const char *split_key;
-	if (vy_range_needs_split(range, &split_key))
-		return vy_task_split_new(pool, range, split_key, p_task);
+	const char *split_keys[VY_RANGE_SPLIT_MAX - 1];
+	int split_key_count;
+	if (vy_range_needs_split(range, split_keys, &split_key_count))
+		return vy_task_split_new(pool, range, split_keys,
+					 split_key_count, tasks);
 
 	struct vy_range *first, *last;
 	if (vy_range_needs_coalesce(range, &first, &last))
-		return vy_task_coalesce_new(pool, first, last, p_task);
+		return vy_task_coalesce_new(pool, first, last, tasks);
 
 	struct vy_task *task = vy_task_new(pool, index, &compact_ops);
 	if (task == NULL)
@@ -4306,7 +5140,7 @@ vy_task_compact_new(struct mempool *pool, struct vy_range *range,
 	bool is_last_level = range->compact_priority == range->run_count;
 	wi = vy_range_get_compact_iterator(range, range->compact_priority,
 					   tx_manager_vlsn(xm), dump_lsn,
-					   is_last_level,
+					   is_last_level, NULL, NULL,
 					   &task->max_output_count,
 					   &range->new_run->info.min_lsn,
 					   &range->new_run->info.max_lsn, NULL);
@@ -4321,13 +5155,14 @@ vy_task_compact_new(struct mempool *pool, struct vy_range *range,
 	task->bloom_fpr = index->env->conf->bloom_fpr;
 	task->run_count = range->compact_priority;
 	range->compact_priority = 0;
+	range->compact_benefit = 0;
 
 	vy_scheduler_remove_range(scheduler, range);
 
 	say_info("%s: started compacting range %s, runs %d/%d",
 		 index->name, vy_range_str(range),
                  range->compact_priority, range->run_count);
-	*p_task = task;
+	stailq_add_tail_entry(tasks, task, link);
 	return 0;
 err_wi:
 	/* Leave the new mem on the list in case of failure. */
@@ -4374,9 +5209,21 @@ heap_compact_less(struct heap_node *a, struct heap_node *b)
 	struct vy_range *left = container_of(a, struct vy_range, in_compact);
 	struct vy_range *right = container_of(b, struct vy_range, in_compact);
 	/*
-	 * Prefer ranges whose read amplification will be reduced
-	 * most as a result of compaction.
-	 */
+	 * Prefer ranges that have more runs to compact, giving
+	 * a bonus to those that would save more run lookups.
+	 * Ordering by the benefit alone would starve ranges that
+	 * are written but never read: their runs would pile up
+	 * while there's a range that is read. Weighted by the
+	 * number of runs, the score of such a range keeps growing
+	 * with each dump while the benefit of a read range is
+	 * reset once it is compacted.
+	 */
+	uint64_t left_score = (left->compact_benefit + 1) *
+			      left->compact_priority;
+	uint64_t right_score = (right->compact_benefit + 1) *
+			       right->compact_priority;
+	if (left_score != right_score)
+		return left_score > right_score;
 	return left->compact_priority > right->compact_priority;
 }
 
@@ -4585,6 +5432,20 @@ vy_scheduler_update_range(struct vy_scheduler *scheduler,
 	assert(range->in_compact.pos != UINT32_MAX);
 }
 
+/**
+ * Update the position of a range in the compaction heap after
+ * its read statistics changed, @sa vy_range::compact_benefit.
+ */
+static void
+vy_scheduler_update_compact(struct vy_scheduler *scheduler,
+			    struct vy_range *range)
+{
+	if (range->in_compact.pos == UINT32_MAX)
+		return; /* range is being processed by a task */
+
+	vy_compact_heap_update(&scheduler->compact_heap, &range->in_compact);
+}
+
 static void
 vy_scheduler_remove_range(struct vy_scheduler *scheduler,
 			  struct vy_range *range)
@@ -4641,9 +5502,10 @@ retry:
 }
 
 /**
- * Create a task for compacting a range. The new task is returned
- * in @ptask. If there's no range that needs to be compacted @ptask
- * is set to NULL.
+ * Create tasks for compacting a range. The new tasks are appended
+ * to @tasks. If there's no range that needs to be compacted @tasks
+ * is left empty. A big range may be compacted by several tasks
+ * executed in parallel, @sa struct vy_split.
  *
  * We compact ranges that have more runs in a level than specified
  * by run_count_per_level configuration option. Among those runs we
@@ -4654,10 +5516,10 @@ retry:
  */
 static int
 vy_scheduler_peek_compact(struct vy_scheduler *scheduler,
-			  struct vy_task **ptask)
+			  struct stailq *tasks)
 {
 retry:
-	*ptask = NULL;
+	assert(stailq_empty(tasks));
 	/* Do not schedule compaction until snapshot is complete. */
 	if (scheduler->checkpoint_lsn != -1)
 		return 0;
@@ -4667,24 +5529,31 @@ retry:
 	struct vy_range *range = container_of(pn, struct vy_range, in_compact);
 	if (range->compact_priority == 0)
 		return 0; /* nothing to do */
-	if (vy_task_compact_new(&scheduler->task_pool, range, ptask) != 0)
+	if (vy_task_compact_new(&scheduler->task_pool, range, tasks) != 0)
 		return -1;
-	if (*ptask == NULL)
+	if (stailq_empty(tasks))
 		goto retry; /* index dropped */
 	return 0; /* new task */
 }
 
+/**
+ * Create tasks to execute and append them to @tasks.
+ * If there's nothing to do, @tasks is left empty.
+ */
 static int
-vy_schedule(struct vy_scheduler *scheduler, struct vy_task **ptask)
+vy_schedule(struct vy_scheduler *scheduler, struct stailq *tasks)
 {
-	*ptask = NULL;
+	assert(stailq_empty(tasks));
 	if (rlist_empty(&scheduler->env->indexes))
 		return 0;
 
-	if (vy_scheduler_peek_dump(scheduler, ptask) != 0)
+	struct vy_task *task;
+	if (vy_scheduler_peek_dump(scheduler, &task) != 0)
 		goto fail;
-	if (*ptask != NULL)
+	if (task != NULL) {
+		stailq_add_tail_entry(tasks, task, link);
 		return 0;
+	}
 
 	if (scheduler->workers_available <= 1) {
 		/*
@@ -4698,12 +5567,9 @@ vy_schedule(struct vy_scheduler *scheduler, struct vy_task **ptask)
 		return 0;
 	}
 
-	if (vy_scheduler_peek_compact(scheduler, ptask) != 0)
+	if (vy_scheduler_peek_compact(scheduler, tasks) != 0)
 		goto fail;
-	if (*ptask != NULL)
-		return 0;
 
-	/* no task to run */
 	return 0;
 fail:
 	assert(!diag_is_empty(diag_get()));
@@ -4782,7 +5648,7 @@ vy_scheduler_f(va_list va)
 	vy_scheduler_start_workers(scheduler);
 
 	while (scheduler->scheduler != NULL) {
-		struct stailq output_queue;
+		struct stailq output_queue, tasks;
 		struct vy_task *task, *next;
 		int tasks_failed = 0, tasks_done = 0;
 		bool was_empty;
@@ -4830,22 +5696,26 @@ vy_scheduler_f(va_list va)
 		/* All worker threads are busy. */
 		if (scheduler->workers_available == 0)
 			goto wait;
-		/* Get a task to schedule. */
-		if (vy_schedule(scheduler, &task) != 0)
+		/* Get tasks to schedule. */
+		stailq_create(&tasks);
+		if (vy_schedule(scheduler, &tasks) != 0)
 			goto error;
 		/* Nothing to do. */
-		if (task == NULL)
+		if (stailq_empty(&tasks))
 			goto wait;
 
-		/* Queue the task and notify workers if necessary. */
+		stailq_foreach_entry(task, &tasks, link)
+			scheduler->workers_available--;
+		assert(scheduler->workers_available >= 0);
+
+		/* Queue the tasks and notify workers if necessary. */
 		tt_pthread_mutex_lock(&scheduler->mutex);
 		was_empty = stailq_empty(&scheduler->input_queue);
-		stailq_add_tail_entry(&scheduler->input_queue, task, link);
+		stailq_concat(&scheduler->input_queue, &tasks);
 		if (was_empty)
-			tt_pthread_cond_signal(&scheduler->worker_cond);
+			tt_pthread_cond_broadcast(&scheduler->worker_cond);
 		tt_pthread_mutex_unlock(&scheduler->mutex);
 
-		scheduler->workers_available--;
 		fiber_reschedule();
 		continue;
 error:
@@ -5243,6 +6113,7 @@ vy_info_append_performance(struct vy_env *env, struct info_handler *h)
 	vy_info_append_stat_latency(h, "tx_latency", &stat->tx_latency);
 	vy_info_append_stat_latency(h, "get_latency", &stat->get_latency);
 	vy_info_append_stat_latency(h, "cursor_latency", &stat->cursor_latency);
+	vy_info_append_stat_latency(h, "tx_throttle", &stat->throttle_latency);
 
 	info_append_u64(h, "tx_rollback", stat->tx_rlb);
 	info_append_u64(h, "tx_conflict", stat->tx_conflict);
@@ -5311,6 +6182,32 @@ vy_index_info(struct vy_index *index, struct info_handler *h)
 	info_append_u32(h, "run_avg", index->run_count / index->range_count);
 	histogram_snprint(buf, sizeof(buf), index->run_hist);
 	info_append_str(h, "run_histogram", buf);
+
+	uint64_t lookup_count = 0;
+	uint64_t run_lookup_count = 0;
+	uint64_t bloom_reflect_count = 0;
+	struct vy_range *range;
+	for (range = vy_range_tree_first(&index->tree); range != NULL;
+	     range = vy_range_tree_next(&index->tree, range)) {
+		lookup_count += range->lookup_count;
+		struct vy_run *run;
+		rlist_foreach_entry(run, &range->runs, in_range) {
+			run_lookup_count += run->lookup_count;
+			bloom_reflect_count += run->bloom_reflect_count;
+		}
+		histogram_collect(index->read_amp_hist,
+				  (int64_t)(vy_range_read_amp(range) + 0.5));
+	}
+	histogram_snprint(buf, sizeof(buf), index->read_amp_hist);
+	for (range = vy_range_tree_first(&index->tree); range != NULL;
+	     range = vy_range_tree_next(&index->tree, range)) {
+		histogram_discard(index->read_amp_hist,
+				  (int64_t)(vy_range_read_amp(range) + 0.5));
+	}
+	info_append_u64(h, "lookup_count", lookup_count);
+	info_append_u64(h, "run_lookup_count", run_lookup_count);
+	info_append_u64(h, "bloom_reflect_count", bloom_reflect_count);
+	info_append_str(h, "read_amp_histogram", buf);
 	info_end(h);
 }
 
@@ -5560,6 +6457,11 @@ vy_index_new(struct vy_env *e, struct index_def *user_index_def,
 	if (index->run_hist == NULL)
 		goto fail_run_hist;
 
+	index->read_amp_hist = histogram_new(run_buckets,
+					     lengthof(run_buckets));
+	if (index->read_amp_hist == NULL)
+		goto fail_read_amp_hist;
+
 	if (user_index_def->iid > 0) {
 		/**
 		 * Calculate the bitmask of columns used in this
@@ -5582,6 +6484,8 @@ vy_index_new(struct vy_env *e, struct index_def *user_index_def,
 	vy_range_tree_new(&index->tree);
 	index->version = 1;
 	rlist_create(&index->link);
+	rlist_create(&index->tombstones);
+	index->tombstone_version = 0;
 	read_set_new(&index->read_set);
 	index->space = space;
 	index->user_index_def = user_index_def;
@@ -5592,6 +6496,8 @@ vy_index_new(struct vy_env *e, struct index_def *user_index_def,
 	return index;
 
 fail_cache_init:
+	histogram_delete(index->read_amp_hist);
+fail_read_amp_hist:
 	histogram_delete(index->run_hist);
 fail_run_hist:
 	free(index->name);
@@ -5742,6 +6648,12 @@ vy_index_delete(struct vy_index *index)
 {
 	read_set_iter(&index->read_set, NULL, read_set_delete_cb, NULL);
 	vy_range_tree_iter(&index->tree, NULL, vy_range_tree_free_cb, index);
+	while (!rlist_empty(&index->tombstones)) {
+		struct vy_tombstone *tombstone;
+		tombstone = rlist_shift_entry(&index->tombstones,
+					      struct vy_tombstone, in_index);
+		vy_tombstone_unref(tombstone);
+	}
 	free(index->name);
 	free(index->path);
 	tuple_format_ref(index->surrogate_format, -1);
@@ -5751,6 +6663,7 @@ vy_index_delete(struct vy_index *index)
 		index_def_delete(index->index_def);
 	index_def_delete(index->user_index_def);
 	histogram_delete(index->run_hist);
+	histogram_delete(index->read_amp_hist);
 	vy_cache_delete(index->cache);
 	tuple_format_ref(index->space_format, -1);
 	TRASH(index);
@@ -6036,6 +6949,7 @@ vy_tx_set(struct vy_tx *tx, struct vy_index *index, struct tuple *stmt)
 		struct txv *v = txv_new(index, stmt, tx);
 		v->is_read = false;
 		v->is_gap = false;
+		v->in_read_set = false;
 		write_set_insert(&tx->write_set, v);
 		tx->write_set_version++;
 		stailq_add_tail_entry(&tx->log, v, next_in_log);
@@ -6260,6 +7174,26 @@ error_unref:
 	return -1;
 }
 
+/**
+ * Check if REPLACE and DELETE in a space with secondary indexes
+ * may be executed without looking up the old tuple, i.e. if
+ * the space has defer_deletes flag and nothing else needs the
+ * old tuple: neither on_replace triggers nor a duplicate check
+ * in a unique secondary index, which can't tell a stale entry
+ * from a live one without reading the primary index anyway.
+ *
+ * If so, the old tuple isn't deleted from secondary indexes,
+ * and the stale entry is skipped on read, when it is checked
+ * against the primary index, @sa vy_index_full_by_stmt().
+ */
+static inline bool
+vy_space_defers_deletes(struct space *space)
+{
+	return space->def.opts.defer_deletes &&
+	       !space->has_unique_secondary_key &&
+	       rlist_empty(&space->on_replace);
+}
+
 /**
  * Execute REPLACE in a space with multiple indexes and lookup for
  * an old tuple, that should has been set in \p stmt->old_tuple if
@@ -6298,7 +7232,8 @@ vy_replace_impl(struct vy_tx *tx, struct space *space, struct request *request,
 	uint32_t part_count = mp_decode_array(&key);
 
 	/* Get full tuple from the primary index. */
-	if (vy_index_get(tx, pk, key, part_count, &old_stmt) != 0)
+	if (!vy_space_defers_deletes(space) &&
+	    vy_index_get(tx, pk, key, part_count, &old_stmt) != 0)
 		goto error;
 
 	/*
@@ -6394,7 +7329,8 @@ vy_unique_key_validate(struct vy_index *index, const char *key,
  * @param index     Secondary index.
  * @param partial   Partial tuple from the secondary \p index.
  * @param[out] full The full tuple is stored here. Must be
- *                  unreferenced after usage.
+ *                  unreferenced after usage. Set to NULL if
+ *                  \p partial is a stale entry.
  *
  * @retval  0 Success.
  * @retval -1 Memory error.
@@ -6421,7 +7357,19 @@ vy_index_full_by_stmt(struct vy_tx *tx, struct vy_index *index,
 	struct space *space = index->space;
 	struct vy_index *pk = vy_index_find(space, 0);
 	assert(pk != NULL);
-	return vy_index_get(tx, pk, pkey, part_count, full);
+	if (vy_index_get(tx, pk, pkey, part_count, full) != 0)
+		return -1;
+	/*
+	 * If the space defers deletes, the secondary entry may
+	 * be left from an overwritten or deleted tuple. Skip it
+	 * unless it matches the tuple found in the primary index.
+	 */
+	if (*full != NULL && space->def.opts.defer_deletes &&
+	    vy_tuple_compare(partial, *full, &index->index_def->key_def) != 0) {
+		tuple_unref(*full);
+		*full = NULL;
+	}
+	return 0;
 }
 
 /**
@@ -6514,19 +7462,24 @@ vy_delete(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	 *
 	 * - if the space has one or more secondary indexes, then
 	 *   we need to extract secondary keys from the old tuple
-	 *   and pass them to indexes for deletion.
+	 *   and pass them to indexes for deletion, unless the
+	 *   space defers deletes (@sa vy_space_defers_deletes()).
 	 */
-	if (has_secondary || !rlist_empty(&space->on_replace)) {
+	if ((has_secondary && !vy_space_defers_deletes(space)) ||
+	    !rlist_empty(&space->on_replace)) {
 		if (vy_index_full_by_key(tx, index, key, part_count,
 					 &stmt->old_tuple))
 			return -1;
 		if (stmt->old_tuple == NULL)
 			return 0;
 	}
-	if (has_secondary) {
-		assert(stmt->old_tuple != NULL);
+	if (stmt->old_tuple != NULL && has_secondary) {
 		return vy_delete_impl(tx, space, stmt->old_tuple);
-	} else { /* Primary is the single index in the space. */
+	} else {
+		/*
+		 * Primary is the single index in the space or
+		 * secondary indexes are cleaned up on read.
+		 */
 		assert(index->index_def->iid == 0);
 		struct tuple *delete =
 			vy_stmt_new_surrogate_delete_from_key(request->key,
@@ -6539,6 +7492,75 @@ vy_delete(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	}
 }
 
+int
+vy_delete_range(struct vy_tx *tx, struct space *space,
+		struct request *request)
+{
+	struct vy_index *pk = vy_index_find(space, 0);
+	if (pk == NULL)
+		return -1;
+	/*
+	 * The tombstone is only left in the primary index, so
+	 * stale entries of secondary indexes must be skipped on
+	 * read, @sa vy_space_defers_deletes().
+	 */
+	if (space->index_count > 1 && !vy_space_defers_deletes(space)) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "delete_range in a space with secondary indexes "
+			 "unless defer_deletes is set");
+		return -1;
+	}
+	const struct key_def *key_def = &pk->index_def->key_def;
+	const char *begin = request->key;
+	uint32_t begin_part_count = mp_decode_array(&begin);
+	if (key_validate(pk->index_def, ITER_GE, begin, begin_part_count))
+		return -1;
+	const char *end = request->tuple;
+	uint32_t end_part_count = mp_decode_array(&end);
+	if (key_validate(pk->index_def, ITER_LT, end, end_part_count))
+		return -1;
+	/* An empty key stands for infinity. */
+	const char *begin_key = begin_part_count > 0 ? request->key : NULL;
+	const char *end_key = end_part_count > 0 ? request->tuple : NULL;
+	if (begin_key != NULL && end_key != NULL) {
+		/*
+		 * Keys are compared by the common prefix. If it's
+		 * equal, keys starting with it are not less than
+		 * the end, unless the end is longer than the begin,
+		 * @sa vy_tombstone_covers_stmt().
+		 */
+		int cmp = key_compare(begin_key, end_key, key_def);
+		if (cmp > 0 || (cmp == 0 &&
+				end_part_count <= begin_part_count))
+			return 0; /* empty range */
+	}
+
+	struct vy_env *env = pk->env;
+	struct vy_tombstone *tombstone = vy_tombstone_new(-1, 0, begin_key,
+							  end_key);
+	if (tombstone == NULL)
+		return -1;
+	tombstone->index = pk;
+	if (begin_key != NULL) {
+		tombstone->begin_stmt = vy_stmt_new_select(env->key_format,
+							   begin,
+							   begin_part_count);
+		if (tombstone->begin_stmt == NULL)
+			goto fail;
+	}
+	if (end_key != NULL) {
+		tombstone->end_stmt = vy_stmt_new_select(env->key_format,
+							 end, end_part_count);
+		if (tombstone->end_stmt == NULL)
+			goto fail;
+	}
+	rlist_add_tail_entry(&tx->tombstones, tombstone, in_tx);
+	return 0;
+fail:
+	vy_tombstone_unref(tombstone);
+	return -1;
+}
+
 /**
  * We do not allow changes of the primary key during update.
  *
@@ -6965,6 +7987,38 @@ vy_replace(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	}
 }
 
+/**
+ * Add reads of a transaction that were done since the fiber
+ * last yielded to index read sets, @sa vy_tx_track().
+ * If a transaction has been prepared since the first of
+ * the reads, it might have overwritten them unnoticed, so
+ * the transaction is aborted, @sa vy_tx_prepare().
+ */
+static void
+vy_tx_track_deferred(struct vy_tx *tx)
+{
+	trigger_clear(&tx->on_yield);
+	if (tx->deferred_psn != tx->xm->psn)
+		tx->state = VINYL_TX_ABORT;
+	struct txv *v;
+	stailq_foreach_entry(v, &tx->log, next_in_log) {
+		if (!v->is_read || v->in_read_set)
+			continue;
+		read_set_t *read_set = &v->index->read_set;
+		if (read_set_search_key(read_set, v->stmt, tx) != NULL)
+			continue; /* read twice */
+		read_set_insert(read_set, v);
+		v->in_read_set = true;
+	}
+}
+
+static void
+vy_tx_on_yield(struct trigger *trigger, void *event)
+{
+	(void) event;
+	vy_tx_track_deferred((struct vy_tx *) trigger->data);
+}
+
 static void
 vy_tx_create(struct tx_manager *xm, struct vy_tx *tx)
 {
@@ -6977,6 +8031,11 @@ vy_tx_create(struct tx_manager *xm, struct vy_tx *tx)
 	tx->read_view = (struct vy_read_view *) xm->p_global_read_view;
 	tx->psn = 0;
 	rlist_create(&tx->cursors);
+	rlist_create(&tx->tombstones);
+	tx->is_autocommit = false;
+	tx->is_writer = false;
+	trigger_create(&tx->on_yield, vy_tx_on_yield, tx, NULL);
+	tx->deferred_psn = 0;
 	xm->tx_count++;
 }
 
@@ -6995,22 +8054,32 @@ vy_tx_destroy(struct vy_tx *tx)
 	vy_tx_abort_cursors(tx);
 
 	tx_manager_destroy_read_view(tx->xm, tx->read_view);
+	trigger_clear(&tx->on_yield);
 
 	/* Remove from the conflict manager index */
 	struct txv *v, *tmp;
 	stailq_foreach_entry_safe(v, tmp, &tx->log, next_in_log) {
-		if (v->is_read)
+		if (v->in_read_set)
 			read_set_remove(&v->index->read_set, v);
 		txv_delete(v);
 	}
 
+	/* Release tombstones that were not committed. */
+	struct vy_tombstone *tombstone, *next_tombstone;
+	rlist_foreach_entry_safe(tombstone, &tx->tombstones, in_tx,
+				 next_tombstone) {
+		rlist_del_entry(tombstone, in_tx);
+		vy_tombstone_unref(tombstone);
+	}
+
 	tx->xm->tx_count--;
 }
 
 static bool
 vy_tx_is_ro(struct vy_tx *tx)
 {
-	return tx->write_set.rbt_root == &tx->write_set.rbt_nil;
+	return tx->write_set.rbt_root == &tx->write_set.rbt_nil &&
+	       rlist_empty(&tx->tombstones);
 }
 
 /**
@@ -7032,12 +8101,34 @@ vy_tx_track(struct vy_tx *tx, struct vy_index *index,
 			return 0;
 		}
 	}
+	if (tx->is_autocommit) {
+		/*
+		 * Other transactions may only prepare while the
+		 * fiber executing this one is yielding, so there's
+		 * no point in adding the read to the shared read
+		 * set right away. Do it on yield instead: most
+		 * autocommit statements don't yield at all.
+		 */
+		struct txv *v = txv_new(index, key, tx);
+		if (v == NULL)
+			return -1;
+		v->is_read = true;
+		v->is_gap = is_gap;
+		v->in_read_set = false;
+		stailq_add_tail_entry(&tx->log, v, next_in_log);
+		if (rlist_empty(&tx->on_yield.link)) {
+			tx->deferred_psn = tx->xm->psn;
+			trigger_add(&fiber()->on_yield, &tx->on_yield);
+		}
+		return 0;
+	}
 	struct txv *v = read_set_search_key(&index->read_set, key, tx);
 	if (v == NULL) {
 		if ((v = txv_new(index, key, tx)) == NULL)
 			return -1;
 		v->is_read = true;
 		v->is_gap = is_gap;
+		v->in_read_set = true;
 		stailq_add_tail_entry(&tx->log, v, next_in_log);
 		read_set_insert(&index->read_set, v);
 	}
@@ -7113,28 +8204,179 @@ vy_tx_abort_readers(struct vy_tx *tx, struct txv *v)
 	}
 }
 
-static int
-vy_tx_prepare(struct vy_tx *tx)
+/**
+ * Return the first entry of the read set of an index that may
+ * have been read from the range deleted by a tombstone.
+ */
+static struct txv *
+vy_tombstone_first_reader(struct vy_tombstone *tombstone,
+			  struct vy_index *index)
 {
-	struct tx_manager *xm = tx->xm;
-	struct vy_env *env = xm->env;
-	/* proceed non-aborted read-only transactions */
-	if ((!vy_tx_is_ro(tx) && vy_tx_is_in_read_view(tx)) ||
-	    tx->state == VINYL_TX_ABORT) {
-		env->stat->tx_conflict++;
-		diag_set(ClientError, ER_TRANSACTION_CONFLICT);
-		return -1;
-	}
-
-	assert(tx->state == VINYL_TX_READY);
+	read_set_t *tree = &index->read_set;
+	if (tombstone->begin_stmt == NULL)
+		return read_set_first(tree);
+	struct read_set_key key;
+	key.stmt = tombstone->begin_stmt;
+	key.tx = NULL;
+	return read_set_nsearch(tree, &key);
+}
 
-	/*
-	 * Wait for quota to be not overused. We can't
-	 * invoke vy_quota_use() at the end of prepare,
-	 * since we have pinned mems, and a wait for quota
-	 * may lead to a deadlock.
-	 */
-	vy_quota_use(&env->quota, 0);
+/**
+ * Return true if the read set entry v was made by another
+ * active transaction and its key is deleted by a tombstone
+ * created by tx. If the entry is past the tombstone end,
+ * set *stop to true.
+ */
+static bool
+vy_tombstone_is_conflicting_read(struct vy_tx *tx, struct txv *v,
+				 struct vy_tombstone *tombstone, bool *stop)
+{
+	struct key_def *key_def = &v->index->index_def->key_def;
+	if (tombstone->end != NULL &&
+	    vy_stmt_compare_with_raw_key(v->stmt, tombstone->end,
+					 key_def) >= 0) {
+		*stop = true;
+		return false;
+	}
+	/* Don't abort self. */
+	if (v->tx == tx)
+		return false;
+	/* Abort only active TXs */
+	if (v->tx->state != VINYL_TX_READY)
+		return false;
+	/* Delete of nothing does not cause a conflict */
+	if (v->is_gap)
+		return false;
+	return true;
+}
+
+/**
+ * Send to a read view all transactions which have read keys
+ * deleted by the tombstone written by tx.
+ */
+static int
+vy_tx_send_tombstone_readers_to_read_view(struct vy_tx *tx,
+					  struct vy_tombstone *tombstone)
+{
+	struct vy_index *index = tombstone->index;
+	read_set_t *tree = &index->read_set;
+	bool stop = false;
+	for (struct txv *abort = vy_tombstone_first_reader(tombstone, index);
+	     abort != NULL; abort = read_set_next(tree, abort)) {
+		if (!vy_tombstone_is_conflicting_read(tx, abort, tombstone,
+						      &stop)) {
+			if (stop)
+				break;
+			continue;
+		}
+		/* already in (earlier) read view */
+		if (vy_tx_is_in_read_view(abort->tx))
+			continue;
+
+		struct vy_read_view *rv = tx_manager_read_view(tx->xm);
+		if (rv == NULL)
+			return -1;
+		abort->tx->read_view = rv;
+	}
+	return 0;
+}
+
+/**
+ * Abort all transactions which have read keys deleted by
+ * the tombstone written by tx.
+ */
+static void
+vy_tx_abort_tombstone_readers(struct vy_tx *tx, struct vy_tombstone *tombstone)
+{
+	struct vy_index *index = tombstone->index;
+	read_set_t *tree = &index->read_set;
+	bool stop = false;
+	for (struct txv *abort = vy_tombstone_first_reader(tombstone, index);
+	     abort != NULL; abort = read_set_next(tree, abort)) {
+		if (!vy_tombstone_is_conflicting_read(tx, abort, tombstone,
+						      &stop)) {
+			if (stop)
+				break;
+			continue;
+		}
+		abort->tx->state = VINYL_TX_ABORT;
+	}
+}
+
+/**
+ * Commit a range tombstone: assign the LSN and log it in
+ * the metadata log. The tombstone has already been added to
+ * the index on prepare.
+ */
+static void
+vy_index_commit_tombstone(struct vy_index *index,
+			  struct vy_tombstone *tombstone, int64_t lsn)
+{
+	tombstone->lsn = lsn;
+	if (index->env->status == VINYL_FINAL_RECOVERY_LOCAL) {
+		/*
+		 * Skip a tombstone that has already been
+		 * recovered from the metadata log.
+		 */
+		struct vy_tombstone *t;
+		rlist_foreach_entry(t, &index->tombstones, in_index) {
+			if (t != tombstone && t->lsn == lsn) {
+				rlist_del_entry(tombstone, in_index);
+				index->tombstone_version++;
+				vy_tombstone_unref(tombstone);
+				return;
+			}
+		}
+	}
+	/*
+	 * We can't abort here, because the DELETE_RANGE statement
+	 * has already been written to WAL. If we fail to log the
+	 * tombstone, leave it in the log buffer, to be flushed
+	 * along with the next transaction, @sa vy_index_drop().
+	 */
+	tombstone->id = vy_log_next_tombstone_id();
+	vy_log_tx_begin();
+	vy_log_insert_tombstone(index->index_def->opts.lsn, tombstone->id,
+				tombstone->begin, tombstone->end, lsn);
+	if (vy_log_tx_try_commit() < 0)
+		say_warn("failed to log range tombstone: %s",
+			 diag_last_error(diag_get())->errmsg);
+}
+
+static int
+vy_tx_prepare(struct vy_tx *tx)
+{
+	struct tx_manager *xm = tx->xm;
+	struct vy_env *env = xm->env;
+	/*
+	 * Reads that are not in read sets yet could only be
+	 * overwritten by a transaction prepared in a fiber
+	 * started from this one without a yield, e.g. by
+	 * fiber.create() in an on_replace trigger. Treat such
+	 * reads as conflicting, since we can't check them.
+	 */
+	bool has_stale_reads = !rlist_empty(&tx->on_yield.link) &&
+			       tx->deferred_psn != xm->psn;
+	/* proceed non-aborted read-only transactions */
+	if ((!vy_tx_is_ro(tx) &&
+	     (vy_tx_is_in_read_view(tx) || has_stale_reads)) ||
+	    tx->state == VINYL_TX_ABORT) {
+		env->stat->tx_conflict++;
+		diag_set(ClientError, ER_TRANSACTION_CONFLICT);
+		return -1;
+	}
+
+	assert(tx->state == VINYL_TX_READY);
+	/* Reads don't matter after the conflict check. */
+	trigger_clear(&tx->on_yield);
+
+	/*
+	 * Wait for quota to be not overused. We can't
+	 * invoke vy_quota_use() at the end of prepare,
+	 * since we have pinned mems, and a wait for quota
+	 * may lead to a deadlock.
+	 */
+	vy_quota_use(&env->quota, 0);
 
 	tx->state = VINYL_TX_COMMIT;
 
@@ -7151,6 +8393,11 @@ vy_tx_prepare(struct vy_tx *tx)
 		if (vy_tx_send_to_read_view(tx, v))
 			return -1;
 	}
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry(tombstone, &tx->tombstones, in_tx) {
+		if (vy_tx_send_tombstone_readers_to_read_view(tx, tombstone))
+			return -1;
+	}
 
 	/*
 	 * Flush transactional changes to the index.
@@ -7195,6 +8442,23 @@ vy_tx_prepare(struct vy_tx *tx)
 	size_t write_size = mem_used_after - mem_used_before;
 	vy_stat_tx(env->stat, tx->start, count, write_count, write_size);
 	vy_quota_force_use(&env->quota, write_size);
+	if (status == VINYL_ONLINE)
+		vy_quota_pace(&env->quota, write_size, ev_now(loop()));
+
+	/*
+	 * Make range tombstones visible to readers. Like
+	 * statements written to in-memory trees, they get
+	 * the LSN of the transaction on commit.
+	 */
+	rlist_foreach_entry(tombstone, &tx->tombstones, in_tx) {
+		struct vy_index *index = tombstone->index;
+		tombstone->lsn = MAX_LSN + tx->psn;
+		vy_tombstone_ref(tombstone);
+		rlist_add_entry(&index->tombstones, tombstone, in_index);
+		index->tombstone_version++;
+		vy_cache_on_delete_range(index->cache, tombstone->begin_stmt,
+					 tombstone->end_stmt);
+	}
 	xm->last_prepared_tx = tx;
 	return 0;
 }
@@ -7228,6 +8492,14 @@ vy_tx_commit(struct vy_tx *tx, int64_t lsn)
 			vy_mem_unpin(v->mem);
 	}
 
+	struct vy_tombstone *tombstone, *next_tombstone;
+	rlist_foreach_entry_safe(tombstone, &tx->tombstones, in_tx,
+				 next_tombstone) {
+		rlist_del_entry(tombstone, in_tx);
+		vy_index_commit_tombstone(tombstone->index, tombstone, lsn);
+		vy_tombstone_unref(tombstone);
+	}
+
 	/* Update read views of dependant transactions. */
 	if (tx->read_view != &xm->global_read_view)
 		tx->read_view->vlsn = lsn;
@@ -7261,6 +8533,23 @@ vy_tx_rollback_after_prepare(struct vy_tx *tx)
 	     v != NULL; v = write_set_next(&tx->write_set, v)) {
 		vy_tx_abort_readers(tx, v);
 	}
+
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry(tombstone, &tx->tombstones, in_tx) {
+		if (rlist_empty(&tombstone->in_index))
+			continue; /* not prepared */
+		struct vy_index *index = tombstone->index;
+		rlist_del_entry(tombstone, in_index);
+		index->tombstone_version++;
+		vy_tombstone_unref(tombstone);
+		/*
+		 * Readers could have cached the result of the
+		 * deletion, invalidate it.
+		 */
+		vy_cache_on_delete_range(index->cache, tombstone->begin_stmt,
+					 tombstone->end_stmt);
+		vy_tx_abort_tombstone_readers(tx, tombstone);
+	}
 }
 
 static void
@@ -7275,7 +8564,7 @@ vy_tx_rollback(struct vy_tx *tx)
 }
 
 struct vy_tx *
-vy_begin(struct vy_env *e)
+vy_begin(struct vy_env *e, bool is_autocommit)
 {
 	struct vy_tx *tx = mempool_alloc(&e->xm->tx_mempool);
 	if (unlikely(tx == NULL)) {
@@ -7284,6 +8573,7 @@ vy_begin(struct vy_env *e)
 		return NULL;
 	}
 	vy_tx_create(e->xm, tx);
+	tx->is_autocommit = is_autocommit;
 	return tx;
 }
 
@@ -7307,6 +8597,30 @@ vy_rollback(struct vy_tx *tx)
 	mempool_free(&tx->xm->tx_mempool, tx);
 }
 
+void
+vy_begin_write(struct vy_tx *tx)
+{
+	struct vy_env *env = tx->xm->env;
+	if (tx->is_writer)
+		return;
+	tx->is_writer = true;
+	if (env->status != VINYL_ONLINE)
+		return;
+	ev_tstamp start = ev_now(loop());
+	double delay = vy_quota_pace_delay(&env->quota, start);
+	if (delay <= 0)
+		return;
+	/*
+	 * Re-check the deadline after wake-up, since it may
+	 * have been moved by writers that woke up earlier.
+	 */
+	do {
+		fiber_sleep(delay);
+	} while ((delay = vy_quota_pace_delay(&env->quota,
+					      ev_now(loop()))) > 0);
+	vy_stat_throttle(env->stat, start);
+}
+
 void *
 vy_savepoint(struct vy_tx *tx)
 {
@@ -7331,7 +8645,7 @@ vy_rollback_to_savepoint(struct vy_tx *tx, void *svp)
 	struct txv *v, *tmp;
 	stailq_foreach_entry_safe(v, tmp, &tail, next_in_log) {
 		/* Remove from the conflict manager index */
-		if (v->is_read)
+		if (v->in_read_set)
 			read_set_remove(&v->index->read_set, v);
 		/* Remove from the transaction write log. */
 		if (!v->is_read) {
@@ -7867,6 +9181,42 @@ struct vy_merge_src {
 	 */
 	uint32_t front_id;
 	struct tuple *stmt;
+	/** Link in vy_merge_iterator::src_heap. */
+	struct heap_node in_heap;
+};
+
+/**
+ * Sources with a smaller statement go first, sources with
+ * equal statements are ordered by age, the youngest first.
+ */
+static bool
+vy_merge_heap_less(heap_t *heap, struct heap_node *a, struct heap_node *b)
+{
+	struct vy_merge_iterator *itr =
+		container_of(heap, struct vy_merge_iterator, src_heap);
+	struct vy_merge_src *left = container_of(a, struct vy_merge_src,
+						 in_heap);
+	struct vy_merge_src *right = container_of(b, struct vy_merge_src,
+						  in_heap);
+	int cmp = iterator_direction(itr->iterator_type) *
+		  vy_tuple_compare(left->stmt, right->stmt, itr->key_def);
+	return cmp < 0 || (cmp == 0 && left < right);
+}
+
+#define HEAP_NAME vy_merge_heap
+#define HEAP_LESS(h, l, r) vy_merge_heap_less(h, l, r)
+
+#include "salad/heap.h"
+
+#undef HEAP_LESS
+#undef HEAP_NAME
+
+enum {
+	/**
+	 * Minimal number of immutable sources for which the
+	 * merge iterator uses a heap.
+	 */
+	VY_MERGE_HEAP_MIN = 4,
 };
 
 /**
@@ -7910,6 +9260,11 @@ vy_merge_iterator_open(struct vy_merge_iterator *itr,
 		tuple_field_count(key) >= key_def->part_count;
 	itr->search_started = false;
 	itr->range_ended = false;
+	vy_merge_heap_create(&itr->src_heap);
+	itr->heap_is_valid = false;
+	itr->heap_start = 0;
+	itr->heap_front = NULL;
+	itr->heap_front_count = 0;
 }
 
 /**
@@ -7933,6 +9288,7 @@ vy_merge_iterator_cleanup(struct vy_merge_iterator *itr)
 	itr->index_version = 0;
 	itr->p_index_version = NULL;
 	itr->p_range_version = NULL;
+	itr->heap_is_valid = false;
 }
 
 /**
@@ -7950,6 +9306,9 @@ vy_merge_iterator_close(struct vy_merge_iterator *itr)
 	free(itr->src);
 	itr->src_count = 0;
 	itr->src = NULL;
+	vy_merge_heap_destroy(&itr->src_heap);
+	free(itr->heap_front);
+	itr->heap_front = NULL;
 }
 
 /**
@@ -8041,6 +9400,155 @@ vy_merge_iterator_check_version(struct vy_merge_iterator *itr)
 	return -2; /* iterator is not valid anymore */
 }
 
+/**
+ * Put all immutable sources to the heap, except those that are
+ * positioned at the current key, which go to heap_front.
+ * Called when all sources have been positioned by the linear
+ * merge. Leaves the heap invalid if the heap is not worth it
+ * or on memory error.
+ */
+static void
+vy_merge_iterator_build_heap(struct vy_merge_iterator *itr)
+{
+	assert(!itr->heap_is_valid);
+	assert(itr->skipped_start == itr->src_count);
+	itr->heap_start = itr->mutable_end;
+	if (itr->src_count - itr->heap_start < VY_MERGE_HEAP_MIN)
+		return;
+	/* range_ended is maintained for the heap as a whole. */
+	for (uint32_t i = itr->heap_start + 1; i < itr->src_count; i++) {
+		if (itr->src[i].belong_range !=
+		    itr->src[itr->heap_start].belong_range)
+			return;
+	}
+	if (itr->heap_front == NULL) {
+		itr->heap_front = malloc(sizeof(*itr->heap_front) *
+					 itr->src_count);
+		if (itr->heap_front == NULL)
+			return;
+	}
+	itr->src_heap.size = 0;
+	itr->heap_front_count = 0;
+	for (uint32_t i = itr->heap_start; i < itr->src_count; i++) {
+		struct vy_merge_src *src = &itr->src[i];
+		if (itr->curr_stmt != NULL && src->front_id == itr->front_id) {
+			itr->heap_front[itr->heap_front_count++] = i;
+			continue;
+		}
+		if (src->stmt == NULL)
+			continue;
+		if (vy_merge_heap_insert(&itr->src_heap, &src->in_heap) != 0)
+			return;
+	}
+	itr->heap_is_valid = true;
+}
+
+/**
+ * Return the front source managed by the heap with offset
+ * >= @a i or UINT32_MAX if there is no such source.
+ */
+static uint32_t
+vy_merge_iterator_next_front(struct vy_merge_iterator *itr, uint32_t i)
+{
+	for (uint32_t k = 0; k < itr->heap_front_count; k++) {
+		if (itr->heap_front[k] >= i)
+			return itr->heap_front[k];
+	}
+	return UINT32_MAX;
+}
+
+/**
+ * Return the front sources to the heap, e.g. when a younger
+ * mutable source turns out to have a smaller key.
+ */
+static NODISCARD int
+vy_merge_iterator_push_front(struct vy_merge_iterator *itr)
+{
+	for (uint32_t k = 0; k < itr->heap_front_count; k++) {
+		struct vy_merge_src *src = &itr->src[itr->heap_front[k]];
+		if (src->stmt == NULL)
+			continue;
+		if (vy_merge_heap_insert(&itr->src_heap,
+					 &src->in_heap) != 0) {
+			diag_set(OutOfMemory, sizeof(struct heap_node *),
+				 "realloc", "merge heap");
+			return -1;
+		}
+	}
+	itr->heap_front_count = 0;
+	return 0;
+}
+
+/**
+ * The part of vy_merge_iterator_next_key() that handles
+ * the sources managed by the heap: advance the sources
+ * positioned at the previous key, then pop the sources
+ * positioned at the next key from the heap.
+ *
+ * @param itr           Merge iterator.
+ * @param[in,out] min_stmt The minimal statement found in the
+ *                      sources preceding the heap.
+ *
+ * @retval 0 success
+ * @retval -1 read error
+ * @retval -2 iterator is not valid anymore
+ */
+static NODISCARD int
+vy_merge_iterator_next_key_heap(struct vy_merge_iterator *itr,
+				struct tuple **min_stmt)
+{
+	const struct key_def *def = itr->key_def;
+	int dir = iterator_direction(itr->iterator_type);
+	for (uint32_t k = 0; k < itr->heap_front_count; k++) {
+		struct vy_merge_src *src = &itr->src[itr->heap_front[k]];
+		bool stop = false;
+		int rc = src->iterator.iface->next_key(&src->iterator,
+						       &src->stmt, &stop);
+		if (vy_merge_iterator_check_version(itr))
+			return -2;
+		if (rc != 0)
+			return rc;
+		if (src->stmt == NULL)
+			continue;
+		if (vy_merge_heap_insert(&itr->src_heap,
+					 &src->in_heap) != 0) {
+			diag_set(OutOfMemory, sizeof(struct heap_node *),
+				 "realloc", "merge heap");
+			return -1;
+		}
+	}
+	itr->heap_front_count = 0;
+
+	struct heap_node *node = vy_merge_heap_top(&itr->src_heap);
+	if (node == NULL)
+		return 0;
+	if (itr->src[itr->heap_start].belong_range)
+		itr->range_ended = false;
+	struct vy_merge_src *src = container_of(node, struct vy_merge_src,
+						in_heap);
+	int cmp = *min_stmt == NULL ? -1 :
+		  dir * vy_tuple_compare(src->stmt, *min_stmt, def);
+	if (cmp > 0)
+		return 0;
+	if (cmp < 0) {
+		itr->front_id++;
+		if (*min_stmt != NULL)
+			tuple_unref(*min_stmt);
+		*min_stmt = src->stmt;
+		tuple_ref(*min_stmt);
+		itr->curr_src = src - itr->src;
+	}
+	while ((node = vy_merge_heap_top(&itr->src_heap)) != NULL) {
+		src = container_of(node, struct vy_merge_src, in_heap);
+		if (vy_tuple_compare(src->stmt, *min_stmt, def) != 0)
+			break;
+		vy_merge_heap_pop(&itr->src_heap);
+		src->front_id = itr->front_id;
+		itr->heap_front[itr->heap_front_count++] = src - itr->src;
+	}
+	return 0;
+}
+
 /**
  * Iterate to the next key
  * @retval 0 success or EOF (*ret == NULL)
@@ -8066,7 +9574,10 @@ vy_merge_iterator_next_key(struct vy_merge_iterator *itr, struct tuple **ret)
 	int rc = 0;
 
 	bool was_yield_possible = false;
-	for (uint32_t i = 0; i < itr->src_count; i++) {
+	/* Sources managed by the heap are handled separately. */
+	uint32_t linear_end = itr->heap_is_valid ? itr->heap_start :
+			      itr->src_count;
+	for (uint32_t i = 0; i < linear_end; i++) {
 		bool is_yield_possible = i >= itr->mutable_end;
 		was_yield_possible = was_yield_possible || is_yield_possible;
 
@@ -8137,9 +9648,28 @@ vy_merge_iterator_next_key(struct vy_merge_iterator *itr, struct tuple **ret)
 			break;
 		}
 	}
+	if (itr->heap_is_valid) {
+		if (itr->skipped_start < itr->src_count) {
+			/*
+			 * The sources managed by the heap have been
+			 * skipped, fall back on the linear merge.
+			 */
+			itr->heap_is_valid = false;
+		} else {
+			was_yield_possible = true;
+			rc = vy_merge_iterator_next_key_heap(itr, &min_stmt);
+			if (rc != 0) {
+				itr->heap_is_valid = false;
+				if (min_stmt != NULL)
+					tuple_unref(min_stmt);
+				return rc;
+			}
+		}
+	}
 	if (itr->skipped_start < itr->src_count)
 		itr->range_ended = false;
 
+	uint32_t heap_front_id = itr->front_id;
 	for (int i = MIN(itr->skipped_start, itr->mutable_end) - 1;
 	     was_yield_possible && i >= (int) itr->mutable_start; i--) {
 		struct vy_merge_src *src = &itr->src[i];
@@ -8180,6 +9710,15 @@ vy_merge_iterator_next_key(struct vy_merge_iterator *itr, struct tuple **ret)
 	itr->curr_stmt = min_stmt;
 	*ret = itr->curr_stmt;
 
+	if (itr->heap_is_valid && itr->front_id != heap_front_id) {
+		/* A mutable source has a smaller key. */
+		if (vy_merge_iterator_push_front(itr) != 0) {
+			itr->heap_is_valid = false;
+			return -1;
+		}
+	}
+	if (!itr->heap_is_valid && itr->skipped_start == itr->src_count)
+		vy_merge_iterator_build_heap(itr);
 	return 0;
 }
 
@@ -8214,6 +9753,11 @@ vy_merge_iterator_next_lsn(struct vy_merge_iterator *itr, struct tuple **ret)
 		return 0;
 	}
 	for (uint32_t i = itr->curr_src + 1; i < itr->src_count; i++) {
+		if (itr->heap_is_valid && i >= itr->heap_start) {
+			i = vy_merge_iterator_next_front(itr, i);
+			if (i == UINT32_MAX)
+				break;
+		}
 		src = &itr->src[i];
 
 		if (i >= itr->skipped_start) {
@@ -8254,7 +9798,11 @@ vy_merge_iterator_next_lsn(struct vy_merge_iterator *itr, struct tuple **ret)
 
 /**
  * Squash in the single statement all rest statements of current key
- * starting from the current statement.
+ * starting from the current statement. Statements with LSN less
+ * than @min_lsn are ignored, @sa vy_tombstone. If @min_lsn_reached
+ * is not NULL, it is set if a statement with LSN less than
+ * @min_lsn was found, i.e. the result doesn't depend on any
+ * older statements, even those the iterator doesn't see.
  *
  * @retval 0 success or EOF (*ret == NULL)
  * @retval -1 error
@@ -8263,9 +9811,12 @@ vy_merge_iterator_next_lsn(struct vy_merge_iterator *itr, struct tuple **ret)
 static NODISCARD int
 vy_merge_iterator_squash_upsert(struct vy_merge_iterator *itr,
 				struct tuple **ret, bool suppress_error,
-				struct vy_stat *stat)
+				struct vy_stat *stat, int64_t min_lsn,
+				bool *min_lsn_reached)
 {
 	*ret = NULL;
+	if (min_lsn_reached != NULL)
+		*min_lsn_reached = false;
 	struct tuple *t = itr->curr_stmt;
 
 	if (t == NULL)
@@ -8282,6 +9833,11 @@ vy_merge_iterator_squash_upsert(struct vy_merge_iterator *itr,
 		}
 		if (next == NULL)
 			break;
+		if (vy_stmt_lsn(next) < min_lsn) {
+			if (min_lsn_reached != NULL)
+				*min_lsn_reached = true;
+			break;
+		}
 		struct tuple *applied;
 		applied = vy_apply_upsert(t, next, itr->key_def, itr->format,
 					  itr->upsert_format, itr->is_primary,
@@ -8315,6 +9871,7 @@ vy_merge_iterator_restore(struct vy_merge_iterator *itr,
 		result = result || rc;
 	}
 	itr->skipped_start = itr->src_count;
+	itr->heap_is_valid = false;
 	return result;
 }
 
@@ -8455,15 +10012,39 @@ struct vy_write_iterator {
 	struct tuple *key;
 	struct tuple *tmp_stmt;
 	struct vy_merge_iterator mi;
+	/**
+	 * Arena for statements read from runs. Statements are
+	 * copied out of it only when upserts are squashed.
+	 */
+	struct vy_stmt_arena arena;
 	/* Usage statistics of mem iterators */
 	struct vy_iterator_stat mem_iterator_stat;
 	/* Usage statistics of run iterators */
 	struct vy_iterator_stat run_iterator_stat;
+	/**
+	 * Range tombstones visible from the oldest read view,
+	 * sorted by the lower bound. Statements deleted by them
+	 * are skipped. Referenced by the iterator.
+	 */
+	struct vy_tombstone **tombstones;
+	/** Number of elements in the tombstones array. */
+	int tombstone_count;
+	/**
+	 * Statements are returned in the key order, so the
+	 * tombstones array is split in three parts: tombstones
+	 * ending before the last statement, [0, tombstone_done),
+	 * tombstones covering it, [tombstone_done, tombstone_next),
+	 * and tombstones starting after it, which are still
+	 * sorted, @sa vy_write_iterator_tombstone_lsn().
+	 */
+	int tombstone_done;
+	int tombstone_next;
 };
 
 /*
  * Open an empty write iterator. To add sources to the iterator
- * use vy_write_iterator_add_* functions
+ * use vy_write_iterator_add_* functions. If @begin is not NULL,
+ * statements with keys less than @begin are skipped.
  */
 static int
 vy_write_iterator_open(struct vy_write_iterator *wi, struct vy_env *env,
@@ -8472,14 +10053,18 @@ vy_write_iterator_open(struct vy_write_iterator *wi, struct vy_env *env,
 		       struct tuple_format *surrogate_format,
 		       struct tuple_format *upsert_format,
 		       bool is_primary, uint64_t column_mask,
-		       bool is_last_level, uint64_t oldest_vlsn)
+		       bool is_last_level, uint64_t oldest_vlsn,
+		       const char *begin)
 {
 	wi->env = env;
 	wi->oldest_vlsn = oldest_vlsn;
 	wi->is_last_level = is_last_level;
 	wi->goto_next_key = false;
 
-	wi->key = vy_stmt_new_select(env->key_format, NULL, 0);
+	uint32_t part_count = 0;
+	if (begin != NULL)
+		part_count = mp_decode_array(&begin);
+	wi->key = vy_stmt_new_select(env->key_format, begin, part_count);
 	if (wi->key == NULL)
 		return -1;
 	wi->key_def = key_def;
@@ -8490,6 +10075,7 @@ vy_write_iterator_open(struct vy_write_iterator *wi, struct vy_env *env,
 	tuple_format_ref(upsert_format, 1);
 	wi->is_primary = is_primary;
 	wi->column_mask = column_mask;
+	vy_stmt_arena_create(&wi->arena);
 	vy_merge_iterator_open(&wi->mi, ITER_GE, wi->key, key_def,
 			       surrogate_format, upsert_format, is_primary);
 	return 0;
@@ -8501,7 +10087,8 @@ vy_write_iterator_new(struct vy_env *env, const struct key_def *key_def,
 		      struct tuple_format *surrogate_format,
 		      struct tuple_format *upsert_format,
 		      bool is_primary, uint64_t column_mask,
-		      bool is_last_level, int64_t oldest_vlsn)
+		      bool is_last_level, int64_t oldest_vlsn,
+		      const char *begin)
 {
 	struct vy_write_iterator *wi = calloc(1, sizeof(*wi));
 	if (wi == NULL) {
@@ -8511,7 +10098,7 @@ vy_write_iterator_new(struct vy_env *env, const struct key_def *key_def,
 	if (vy_write_iterator_open(wi, env, key_def, user_key_def,
 				   surrogate_format, upsert_format,
 				   is_primary, column_mask,
-				   is_last_level, oldest_vlsn) != 0) {
+				   is_last_level, oldest_vlsn, begin) != 0) {
 		free(wi);
 		return NULL;
 	}
@@ -8531,10 +10118,144 @@ vy_write_iterator_add_run(struct vy_write_iterator *wi, struct vy_run *run,
 			     compact_from, end,
 			     &wi->env->xm->p_global_read_view, wi->key_def,
 			     wi->user_key_def, wi->surrogate_format,
-			     wi->upsert_format, wi->is_primary);
+			     wi->upsert_format, wi->is_primary, &wi->arena);
 	return 0;
 }
 
+/**
+ * Compare lower bounds of two range tombstones. A partial key
+ * is less than any key it is a prefix of, because it covers
+ * all of them.
+ */
+static int
+vy_tombstone_compare_begin(const struct vy_tombstone *a,
+			   const struct vy_tombstone *b,
+			   const struct key_def *key_def)
+{
+	if (a->begin == NULL || b->begin == NULL)
+		return (a->begin != NULL) - (b->begin != NULL);
+	int cmp = key_compare(a->begin, b->begin, key_def);
+	if (cmp != 0)
+		return cmp;
+	const char *key_a = a->begin, *key_b = b->begin;
+	uint32_t part_count_a = mp_decode_array(&key_a);
+	uint32_t part_count_b = mp_decode_array(&key_b);
+	return part_count_a < part_count_b ? -1 : part_count_a > part_count_b;
+}
+
+/**
+ * Make the write iterator skip statements deleted by a range
+ * tombstone. The tombstone must be visible from the oldest
+ * read view. Must be called before the iteration is started.
+ */
+static NODISCARD int
+vy_write_iterator_add_tombstone(struct vy_write_iterator *wi,
+				struct vy_tombstone *tombstone)
+{
+	assert(wi->is_primary);
+	assert(tombstone->lsn <= wi->oldest_vlsn);
+	assert(wi->tombstone_next == 0);
+	size_t size = (wi->tombstone_count + 1) * sizeof(*wi->tombstones);
+	struct vy_tombstone **tombstones = realloc(wi->tombstones, size);
+	if (tombstones == NULL) {
+		diag_set(OutOfMemory, size, "realloc", "tombstones");
+		return -1;
+	}
+	vy_tombstone_ref(tombstone);
+	/* Keep the array sorted by the lower bound. */
+	int i = wi->tombstone_count++;
+	while (i > 0 && vy_tombstone_compare_begin(tombstones[i - 1],
+						   tombstone, wi->key_def) > 0) {
+		tombstones[i] = tombstones[i - 1];
+		i--;
+	}
+	tombstones[i] = tombstone;
+	wi->tombstones = tombstones;
+	return 0;
+}
+
+/**
+ * Add all tombstones of an index that may delete statements
+ * in [begin, end) and are visible from the oldest read view
+ * to the write iterator.
+ */
+static NODISCARD int
+vy_write_iterator_add_tombstones(struct vy_write_iterator *wi,
+				 struct vy_index *index,
+				 const char *begin, const char *end)
+{
+	if (!wi->is_primary)
+		return 0; /* Tombstones are only in the primary index */
+	const struct key_def *key_def = &index->index_def->key_def;
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry(tombstone, &index->tombstones, in_index) {
+		if (tombstone->lsn > wi->oldest_vlsn)
+			continue;
+		if (!vy_tombstone_overlaps(tombstone, begin, end, key_def))
+			continue;
+		if (vy_write_iterator_add_tombstone(wi, tombstone) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Return the LSN of the newest tombstone of the write iterator
+ * deleting the key of a statement or 0 if there is no such
+ * tombstone. Statements must be passed in the key order, so
+ * that only tombstones covering the current key are checked.
+ */
+static int64_t
+vy_write_iterator_tombstone_lsn(struct vy_write_iterator *wi,
+				const struct tuple *stmt)
+{
+	const struct key_def *key_def = wi->key_def;
+	struct vy_tombstone **tombstones = wi->tombstones;
+	/* Take tombstones starting at or before the statement. */
+	while (wi->tombstone_next < wi->tombstone_count) {
+		struct vy_tombstone *tombstone = tombstones[wi->tombstone_next];
+		if (tombstone->begin != NULL &&
+		    vy_stmt_compare_with_raw_key(stmt, tombstone->begin,
+						 key_def) < 0)
+			break;
+		wi->tombstone_next++;
+	}
+	int64_t lsn = 0;
+	for (int i = wi->tombstone_done; i < wi->tombstone_next; i++) {
+		struct vy_tombstone *tombstone = tombstones[i];
+		if (tombstone->end != NULL &&
+		    vy_stmt_compare_with_raw_key(stmt, tombstone->end,
+						 key_def) >= 0) {
+			/* Ends before the statement, drop it. */
+			tombstones[i] = tombstones[wi->tombstone_done];
+			tombstones[wi->tombstone_done++] = tombstone;
+			continue;
+		}
+		lsn = MAX(lsn, tombstone->lsn);
+	}
+	return lsn;
+}
+
+/**
+ * Return true if all statements of a run of a range with
+ * boundaries [begin, end) are deleted by a tombstone of the
+ * write iterator, so that the run needn't be read.
+ */
+static bool
+vy_write_iterator_run_is_deleted(struct vy_write_iterator *wi,
+				 struct vy_run *run,
+				 const char *begin, const char *end)
+{
+	for (int i = 0; i < wi->tombstone_count; i++) {
+		struct vy_tombstone *tombstone = wi->tombstones[i];
+		if (run->info.max_lsn < tombstone->lsn &&
+		    vy_tombstone_covers_range(tombstone, begin, end,
+					      wi->key_def))
+			return true;
+	}
+	return false;
+}
+
 static NODISCARD int
 vy_write_iterator_add_mem(struct vy_write_iterator *wi, struct vy_mem *mem)
 {
@@ -8596,6 +10317,9 @@ vy_write_iterator_next(struct vy_write_iterator *wi, struct tuple **ret)
 		if (vy_stmt_lsn(stmt) > wi->oldest_vlsn)
 			break; /* Save the current stmt as the result. */
 		wi->goto_next_key = true;
+		int64_t tombstone_lsn = vy_write_iterator_tombstone_lsn(wi, stmt);
+		if (vy_stmt_lsn(stmt) < tombstone_lsn)
+			continue; /* Skip statements deleted by a tombstone */
 		if (vy_stmt_type(stmt) == IPROTO_DELETE && wi->is_last_level)
 			continue; /* Skip unnecessary DELETE */
 		if (vy_stmt_type(stmt) == IPROTO_REPLACE ||
@@ -8617,11 +10341,23 @@ vy_write_iterator_next(struct vy_write_iterator *wi, struct tuple **ret)
 
 		/* Squash upserts */
 		assert(vy_stmt_type(stmt) == IPROTO_UPSERT);
-		if (vy_merge_iterator_squash_upsert(mi, &stmt, false, NULL)) {
+		bool is_deleted_below;
+		if (vy_merge_iterator_squash_upsert(mi, &stmt, false, NULL,
+						    tombstone_lsn,
+						    &is_deleted_below)) {
 			tuple_unref(stmt);
 			return -1;
 		}
-		if (vy_stmt_type(stmt) == IPROTO_UPSERT && wi->is_last_level) {
+		/*
+		 * If older statements are absent or squashing has
+		 * reached a statement deleted by a tombstone, UPSERT
+		 * can be turned to REPLACE. Note, a live tombstone
+		 * doesn't suffice by itself: older runs that are not
+		 * read by this iterator may still store statements
+		 * newer than the tombstone.
+		 */
+		if (vy_stmt_type(stmt) == IPROTO_UPSERT &&
+		    (wi->is_last_level || is_deleted_below)) {
 			/* Turn UPSERT to REPLACE. */
 			struct tuple *applied;
 			applied = vy_apply_upsert(stmt, NULL, wi->key_def,
@@ -8651,6 +10387,8 @@ vy_write_iterator_cleanup(struct vy_write_iterator *wi)
 		tuple_unref(wi->key);
 	wi->key = NULL;
 	vy_merge_iterator_cleanup(&wi->mi);
+	/* All statements read from runs have been freed. */
+	vy_stmt_arena_destroy(&wi->arena);
 }
 
 static void
@@ -8663,6 +10401,9 @@ vy_write_iterator_delete(struct vy_write_iterator *wi)
 	tuple_format_ref(wi->surrogate_format, -1);
 	tuple_format_ref(wi->upsert_format, -1);
 	vy_merge_iterator_close(&wi->mi);
+	for (int i = 0; i < wi->tombstone_count; i++)
+		vy_tombstone_unref(wi->tombstones[i]);
+	free(wi->tombstones);
 
 	free(wi);
 }
@@ -8745,6 +10486,12 @@ vy_read_iterator_add_mem(struct vy_read_iterator *itr)
 	vy_read_iterator_add_mem_range(itr, range);
 }
 
+/**
+ * How often, in lookups, a range read by a read iterator updates
+ * its position in the compaction heap.
+ */
+enum { VY_COMPACT_BENEFIT_UPDATE_RATE = 16 };
+
 static void
 vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 {
@@ -8761,7 +10508,24 @@ vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 	if (itr->index->space_index_count == 1)
 		format = itr->index->space_format;
 	bool coio_read = cord_is_main() && itr->index->env->status == VINYL_ONLINE;
-	rlist_foreach_entry(run, &itr->curr_range->runs, in_range) {
+	/*
+	 * Account the lookup in the range read statistics and
+	 * let the scheduler know that compacting this range may
+	 * have become more beneficial. Run iterators are lazy,
+	 * so runs are accounted when they are actually searched.
+	 * Updating the heap on each lookup would be too costly,
+	 * so it's only done once per VY_COMPACT_BENEFIT_UPDATE_RATE
+	 * lookups: the benefit changes slowly anyway.
+	 */
+	struct vy_range *range = itr->curr_range;
+	range->lookup_count++;
+	if (range->compact_priority > 0 &&
+	    range->lookup_count % VY_COMPACT_BENEFIT_UPDATE_RATE == 0) {
+		vy_range_update_compact_benefit(range);
+		vy_scheduler_update_compact(itr->index->env->scheduler,
+					    range);
+	}
+	rlist_foreach_entry(run, &range->runs, in_range) {
 		struct vy_merge_src *sub_src = vy_merge_iterator_add(
 			&itr->merge_iterator, false, true);
 		vy_run_iterator_open(&sub_src->run_iterator, coio_read, stat,
@@ -8771,7 +10535,7 @@ vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 				     &itr->index->index_def->key_def,
 				     &itr->index->user_index_def->key_def,
 				     format, itr->index->upsert_format,
-				     itr->index->index_def->iid == 0);
+				     itr->index->index_def->iid == 0, NULL);
 	}
 }
 
@@ -8819,6 +10583,45 @@ vy_read_iterator_open(struct vy_read_iterator *itr, struct vy_index *index,
 	itr->search_started = false;
 	itr->curr_stmt = NULL;
 	itr->curr_range = NULL;
+	itr->range_has_tombstones = true;
+	itr->tombstone_range_id = -1;
+	itr->tombstone_version = 0;
+}
+
+/**
+ * Return true if statements of the current range of a read
+ * iterator may be deleted by a range tombstone. The result is
+ * cached until the iterator switches to another range or the
+ * index tombstone list changes, so that reads from ranges not
+ * touched by DELETE_RANGE don't look up tombstones for each
+ * statement.
+ */
+static bool
+vy_read_iterator_check_tombstones(struct vy_read_iterator *itr)
+{
+	struct vy_index *index = itr->index;
+	if (rlist_empty(&index->tombstones))
+		return false;
+	struct vy_range *range = itr->curr_range;
+	if (range == NULL)
+		return true;
+	if (itr->tombstone_range_id == range->id &&
+	    itr->tombstone_version == index->tombstone_version)
+		return itr->range_has_tombstones;
+	const struct key_def *key_def = &index->index_def->key_def;
+	bool found = false;
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry(tombstone, &index->tombstones, in_index) {
+		if (vy_tombstone_overlaps(tombstone, range->begin,
+					  range->end, key_def)) {
+			found = true;
+			break;
+		}
+	}
+	itr->range_has_tombstones = found;
+	itr->tombstone_range_id = range->id;
+	itr->tombstone_version = index->tombstone_version;
+	return found;
 }
 
 /**
@@ -8981,7 +10784,16 @@ vy_read_iterator_next(struct vy_read_iterator *itr, struct tuple **result)
 			rc = 0; /* No more data. */
 			break;
 		}
-		rc = vy_merge_iterator_squash_upsert(mi, &t, true, stat);
+		/* Skip statements deleted by a range tombstone. */
+		int64_t tombstone_lsn = 0;
+		if (vy_read_iterator_check_tombstones(itr)) {
+			tombstone_lsn = vy_index_tombstone_lsn(itr->index, t,
+						(**itr->read_view).vlsn);
+			if (vy_stmt_lsn(t) < tombstone_lsn)
+				continue;
+		}
+		rc = vy_merge_iterator_squash_upsert(mi, &t, true, stat,
+						     tombstone_lsn, NULL);
 		if (rc != 0) {
 			if (rc == -1)
 				goto clear;
@@ -9096,6 +10908,12 @@ struct vy_join_ctx {
 	 * The newer the run the closer it is to the head of the list.
 	 */
 	struct rlist runs;
+	/**
+	 * List of range tombstones of the current index, linked
+	 * by vy_tombstone::in_index. Statements deleted by them
+	 * are not sent.
+	 */
+	struct rlist tombstones;
 	/**
 	 * LSN to assign to the next statement.
 	 *
@@ -9147,10 +10965,15 @@ vy_send_range(struct vy_join_ctx *ctx)
 	int rc = -1;
 	ctx->wi = vy_write_iterator_new(ctx->env, ctx->key_def, ctx->key_def,
 					ctx->format, ctx->upsert_format,
-					true, 0, true, INT64_MAX);
+					true, 0, true, INT64_MAX, NULL);
 	if (ctx->wi == NULL)
 		goto out;
 
+	struct vy_tombstone *tombstone;
+	rlist_foreach_entry(tombstone, &ctx->tombstones, in_index) {
+		if (vy_write_iterator_add_tombstone(ctx->wi, tombstone) != 0)
+			goto out_delete_wi;
+	}
 	struct vy_run *run;
 	rlist_foreach_entry(run, &ctx->runs, in_join) {
 		if (vy_write_iterator_add_run(ctx->wi, run, NULL, NULL) != 0)
@@ -9175,6 +10998,16 @@ out:
 	return rc;
 }
 
+/** Release range tombstones of the index being relayed. */
+static void
+vy_join_free_tombstones(struct vy_join_ctx *ctx)
+{
+	struct vy_tombstone *tombstone, *tmp;
+	rlist_foreach_entry_safe(tombstone, &ctx->tombstones, in_index, tmp)
+		vy_tombstone_unref(tombstone);
+	rlist_create(&ctx->tombstones);
+}
+
 /** Relay callback, passed to vy_recovery_iterate(). */
 static int
 vy_join_cb(const struct vy_log_record *record, void *arg)
@@ -9199,6 +11032,7 @@ vy_join_cb(const struct vy_log_record *record, void *arg)
 		return 0;
 
 	if (record->type == VY_LOG_CREATE_INDEX) {
+		vy_join_free_tombstones(ctx);
 		vy_index_snprint_path(ctx->index_path, sizeof(ctx->index_path),
 				      ctx->path,
 				      record->space_id, record->index_id);
@@ -9237,6 +11071,17 @@ vy_join_cb(const struct vy_log_record *record, void *arg)
 			return -1;
 		}
 	}
+
+	if (record->type == VY_LOG_INSERT_TOMBSTONE) {
+		struct vy_tombstone *tombstone;
+		tombstone = vy_tombstone_new(record->tombstone_id,
+					     record->tombstone_lsn,
+					     record->range_begin,
+					     record->range_end);
+		if (tombstone == NULL)
+			return -1;
+		rlist_add_entry(&ctx->tombstones, tombstone, in_index);
+	}
 	return 0;
 }
 
@@ -9277,6 +11122,7 @@ vy_join(struct vy_env *env, struct vclock *vclock, struct xstream *stream)
 	ctx->path = env->conf->path;
 	ctx->stream = stream;
 	rlist_create(&ctx->runs);
+	rlist_create(&ctx->tombstones);
 
 	/* Start the relay cord. */
 	char name[FIBER_NAME_MAX];
@@ -9307,6 +11153,7 @@ vy_join(struct vy_env *env, struct vclock *vclock, struct xstream *stream)
 	struct vy_run *run, *tmp;
 	rlist_foreach_entry_safe(run, &ctx->runs, in_join, tmp)
 		vy_run_unref(run);
+	vy_join_free_tombstones(ctx);
 out_join_cord:
 	cbus_stop_loop(&ctx->relay_pipe);
 	cpipe_destroy(&ctx->relay_pipe);
@@ -9493,6 +11340,16 @@ vy_squash_process(struct vy_squash *squash)
 		return -1;
 	if (result == NULL)
 		return 0;
+	/*
+	 * A range tombstone could have deleted the result while
+	 * we were reading on-disk runs. Let the readers sort it
+	 * out then.
+	 */
+	if (vy_index_tombstone_lsn(index, result, INT64_MAX) >
+	    vy_stmt_lsn(result)) {
+		tuple_unref(result);
+		return 0;
+	}
 
 	struct vy_range *range;
 	range = vy_range_tree_find_by_key(&index->tree, ITER_EQ, result,
@@ -9722,22 +11579,30 @@ vy_cursor_next(struct vy_cursor *c, struct tuple **result)
 	}
 
 	assert(c->key != NULL);
-	int rc = vy_read_iterator_next(&c->iterator, &vyresult);
-	if (rc)
-		return -1;
-	c->n_reads++;
-	if (vy_tx_track(c->tx, index, vyresult ? vyresult : c->key,
-			vyresult == NULL))
-		return -1;
-	if (vyresult == NULL)
-		return 0;
-	if (c->need_check_eq &&
-	    vy_tuple_compare_with_key(vyresult, c->key, &def->key_def) != 0)
-		return 0;
-	if (def->iid > 0 && vy_index_full_by_stmt(c->tx, index, vyresult,
-						  &vyresult))
-		return -1;
-	*result = vyresult;
+	struct tuple *full = NULL;
+	do {
+		int rc = vy_read_iterator_next(&c->iterator, &vyresult);
+		if (rc)
+			return -1;
+		c->n_reads++;
+		if (vy_tx_track(c->tx, index, vyresult ? vyresult : c->key,
+				vyresult == NULL))
+			return -1;
+		if (vyresult == NULL)
+			return 0;
+		if (c->need_check_eq &&
+		    vy_tuple_compare_with_key(vyresult, c->key,
+					      &def->key_def) != 0)
+			return 0;
+		if (def->iid == 0) {
+			full = vyresult;
+			break;
+		}
+		/* Stale entries of a space with deferred deletes. */
+		if (vy_index_full_by_stmt(c->tx, index, vyresult, &full))
+			return -1;
+	} while (full == NULL);
+	*result = full;
 	/**
 	 * If the index is not primary (def->iid != 0) then no
 	 * need to reference the tuple, because it is returned
@@ -9745,8 +11610,8 @@ vy_cursor_next(struct vy_cursor *c, struct tuple **result)
 	 * reference.
 	 */
 	if (def->iid == 0)
-		tuple_ref(vyresult);
-	return *result != NULL ? 0 : -1;
+		tuple_ref(full);
+	return 0;
 }
 
 void
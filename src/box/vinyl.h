@@ -117,8 +117,15 @@ vy_index_info(struct vy_index *index, struct info_handler *handler);
  * Transaction
  */
 
+/**
+ * Begin a transaction.
+ * @param e             Vinyl environment.
+ * @param is_autocommit Set if the transaction is autocommit.
+ *                      Such a transaction doesn't add its reads
+ *                      to read sets unless it yields.
+ */
 struct vy_tx *
-vy_begin(struct vy_env *e);
+vy_begin(struct vy_env *e, bool is_autocommit);
 
 /**
  * Get a tuple from the vinyl index.
@@ -169,6 +176,22 @@ int
 vy_delete(struct vy_tx *tx, struct txn_stmt *stmt, struct space *space,
 	  struct request *request);
 
+/**
+ * Execute DELETE_RANGE in a vinyl space: delete all tuples with
+ * the primary key in [request->key, request->tuple) by leaving
+ * a range tombstone in the primary index.
+ * @param tx      Current transaction.
+ * @param space   Vinyl space.
+ * @param request Request with the range boundaries.
+ *
+ * @retval  0 Success
+ * @retval -1 Memory error OR the index is not found OR
+ *            invalid range boundaries.
+ */
+int
+vy_delete_range(struct vy_tx *tx, struct space *space,
+		struct request *request);
+
 /**
  * Execute UPDATE in a vinyl space.
  * @param tx      Current transaction.
@@ -211,6 +234,17 @@ vy_commit(struct vy_tx *tx, int64_t lsn);
 void
 vy_rollback(struct vy_tx *tx);
 
+/**
+ * Called before each statement modifying data in a transaction.
+ * If it's the first such statement, the caller may be put to
+ * sleep if writers are paced due to memory shortage. Pacing is
+ * done before the statement reads anything, so that the wait
+ * neither extends the time its reads are exposed to conflicts
+ * nor lets them go stale. Read-only transactions aren't paced.
+ */
+void
+vy_begin_write(struct vy_tx *tx);
+
 void *
 vy_savepoint(struct vy_tx *tx);
 
@@ -64,7 +64,7 @@ vinyl_engine_get_env()
 VinylEngine::VinylEngine()
 	:Engine("vinyl", &vy_tuple_format_vtab)
 {
-	flags = 0;
+	flags = ENGINE_CAN_DEFER_DELETES;
 	env = NULL;
 }
 
@@ -176,7 +176,7 @@ void
 VinylEngine::begin(struct txn *txn)
 {
 	assert(txn->engine_tx == NULL);
-	txn->engine_tx = vy_begin(env);
+	txn->engine_tx = vy_begin(env, txn->is_autocommit);
 	if (txn->engine_tx == NULL)
 		diag_raise();
 }
@@ -188,6 +188,7 @@ VinylEngine::beginStatement(struct txn *txn)
 	struct vy_tx *tx = (struct vy_tx *)(txn->engine_tx);
 	struct txn_stmt *stmt = txn_current_stmt(txn);
 	stmt->engine_savepoint = vy_savepoint(tx);
+	vy_begin_write(tx);
 }
 
 void
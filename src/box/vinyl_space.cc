@@ -49,7 +49,7 @@ VinylSpace::applyInitialJoinRow(struct space *space, struct request *request)
 	assert(request->header != NULL);
 	struct vy_env *env = ((VinylEngine *)space->handler->engine)->env;
 
-	struct vy_tx *tx = vy_begin(env);
+	struct vy_tx *tx = vy_begin(env, true);
 	if (tx == NULL)
 		diag_raise();
 
@@ -146,6 +146,23 @@ VinylSpace::executeUpsert(struct txn *txn, struct space *space,
 		diag_raise();
 }
 
+void
+VinylSpace::executeDeleteRange(struct txn *txn, struct space *space,
+                               struct request *request)
+{
+	/*
+	 * Reads of a transaction don't see range tombstones
+	 * created by the transaction until it commits.
+	 */
+	if (!txn->is_autocommit) {
+		tnt_raise(ClientError, ER_UNSUPPORTED, "Vinyl",
+			  "delete_range in a multi-statement transaction");
+	}
+	struct vy_tx *tx = (struct vy_tx *)txn->engine_tx;
+	if (vy_delete_range(tx, space, request) != 0)
+		diag_raise();
+}
+
 Index *
 VinylSpace::createIndex(struct space *space, struct index_def *index_def)
 {
@@ -49,6 +49,9 @@ struct VinylSpace: public Handler {
 	virtual void
 	executeUpsert(struct txn*, struct space *space,
 	              struct request *request) override;
+	virtual void
+	executeDeleteRange(struct txn*, struct space *space,
+	                   struct request *request) override;
 	virtual void dropIndex(Index*) override;
 	virtual Index *createIndex(struct space *, struct index_def *) override;
 	virtual void prepareAlterSpace(struct space *old_space,
@@ -396,6 +396,54 @@ vy_cache_on_write(struct vy_cache *cache, const struct tuple *stmt)
 	}
 }
 
+void
+vy_cache_on_delete_range(struct vy_cache *cache, const struct tuple *begin,
+			 const struct tuple *end)
+{
+	vy_cache_gc(cache->env);
+	struct vy_cache_tree *tree = &cache->cache_tree;
+	struct key_def *key_def = &cache->index_def->key_def;
+	struct vy_cache_tree_iterator itr;
+	struct vy_cache_entry **entry;
+	cache->version++;
+	/*
+	 * Remove all entries falling in the range. Deletion
+	 * invalidates tree iterators, so look the range start
+	 * up anew after each one.
+	 */
+	while (true) {
+		bool exact;
+		if (begin != NULL)
+			itr = vy_cache_tree_lower_bound(tree, begin, &exact);
+		else
+			itr = vy_cache_tree_iterator_first(tree);
+		entry = vy_cache_tree_iterator_get_elem(tree, &itr);
+		if (entry == NULL ||
+		    (end != NULL &&
+		     vy_stmt_compare((*entry)->stmt, end, key_def) >= 0))
+			break;
+		struct vy_cache_entry *to_delete = *entry;
+		vy_cache_tree_delete(tree, to_delete);
+		vy_cache_entry_delete(cache->env, to_delete);
+	}
+	/*
+	 * The range may have been cached as a gap between the
+	 * neighbours of the range, break the chain.
+	 */
+	struct vy_cache_tree_iterator prev = itr;
+	vy_cache_tree_iterator_prev(tree, &prev);
+	struct vy_cache_entry **prev_entry =
+		vy_cache_tree_iterator_get_elem(tree, &prev);
+	if (prev_entry != NULL) {
+		(*prev_entry)->flags &= ~VY_CACHE_RIGHT_LINKED;
+		(*prev_entry)->right_boundary_level = key_def->part_count;
+	}
+	if (entry != NULL) {
+		(*entry)->flags &= ~VY_CACHE_LEFT_LINKED;
+		(*entry)->left_boundary_level = key_def->part_count;
+	}
+}
+
 /**
  * Get a stmt by current position
  */
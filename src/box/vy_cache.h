@@ -194,6 +194,19 @@ vy_cache_add(struct vy_cache *cache, struct tuple *stmt,
 void
 vy_cache_on_write(struct vy_cache *cache, const struct tuple *stmt);
 
+/**
+ * Invalidate all cached values in a key range due to a range
+ * delete.
+ * @param cache - pointer to tuple cache.
+ * @param begin - key statement of the range start (inclusive),
+ *  NULL means -inf.
+ * @param end - key statement of the range end (exclusive),
+ *  NULL means +inf.
+ */
+void
+vy_cache_on_delete_range(struct vy_cache *cache, const struct tuple *begin,
+			 const struct tuple *end);
+
 
 /**
  * Cache iterator
@@ -78,6 +78,8 @@ enum vy_log_key {
 	VY_LOG_KEY_MIN_LSN		= 9,
 	VY_LOG_KEY_MAX_LSN		= 10,
 	VY_LOG_KEY_IS_EMPTY		= 11,
+	VY_LOG_KEY_TOMBSTONE_ID		= 12,
+	VY_LOG_KEY_TOMBSTONE_LSN	= 13,
 };
 
 /**
@@ -105,6 +107,12 @@ static const unsigned long vy_log_key_mask[] = {
 					  (1 << VY_LOG_KEY_IS_EMPTY),
 	[VY_LOG_DELETE_RUN]		= (1 << VY_LOG_KEY_RUN_ID),
 	[VY_LOG_FORGET_RUN]		= (1 << VY_LOG_KEY_RUN_ID),
+	[VY_LOG_INSERT_TOMBSTONE]	= (1 << VY_LOG_KEY_INDEX_LSN) |
+					  (1 << VY_LOG_KEY_TOMBSTONE_ID) |
+					  (1 << VY_LOG_KEY_RANGE_BEGIN) |
+					  (1 << VY_LOG_KEY_RANGE_END) |
+					  (1 << VY_LOG_KEY_TOMBSTONE_LSN),
+	[VY_LOG_DELETE_TOMBSTONE]	= (1 << VY_LOG_KEY_TOMBSTONE_ID),
 };
 
 /** vy_log_key -> human readable name. */
@@ -121,6 +129,8 @@ static const char *vy_log_key_name[] = {
 	[VY_LOG_KEY_MIN_LSN]		= "min_lsn",
 	[VY_LOG_KEY_MAX_LSN]		= "max_lsn",
 	[VY_LOG_KEY_IS_EMPTY]		= "is_empty",
+	[VY_LOG_KEY_TOMBSTONE_ID]	= "tombstone_id",
+	[VY_LOG_KEY_TOMBSTONE_LSN]	= "tombstone_lsn",
 };
 
 /** vy_log_type -> human readable name. */
@@ -133,6 +143,8 @@ static const char *vy_log_type_name[] = {
 	[VY_LOG_INSERT_RUN]		= "insert_run",
 	[VY_LOG_DELETE_RUN]		= "delete_run",
 	[VY_LOG_FORGET_RUN]		= "forget_run",
+	[VY_LOG_INSERT_TOMBSTONE]	= "insert_tombstone",
+	[VY_LOG_DELETE_TOMBSTONE]	= "delete_tombstone",
 };
 
 struct vy_recovery;
@@ -167,6 +179,11 @@ struct vy_log {
 	 * Used by vy_log_next_run_id().
 	 */
 	int64_t next_run_id;
+	/**
+	 * Next ID to use for a range tombstone.
+	 * Used by vy_log_next_tombstone_id().
+	 */
+	int64_t next_tombstone_id;
 	/**
 	 * Index of the first record of the current
 	 * transaction in tx_buf.
@@ -190,6 +207,8 @@ struct vy_recovery {
 	struct mh_i64ptr_t *range_hash;
 	/** ID -> vy_run_recovery_info. */
 	struct mh_i64ptr_t *run_hash;
+	/** ID -> vy_tombstone_recovery_info. */
+	struct mh_i64ptr_t *tombstone_hash;
 	/**
 	 * Maximal vinyl range ID, according to the metadata log,
 	 * or -1 in case no ranges were recovered.
@@ -200,6 +219,11 @@ struct vy_recovery {
 	 * or -1 in case no runs were recovered.
 	 */
 	int64_t run_id_max;
+	/**
+	 * Maximal range tombstone ID, according to the metadata
+	 * log, or -1 in case no tombstones were recovered.
+	 */
+	int64_t tombstone_id_max;
 };
 
 /** Vinyl index info stored in a recovery context. */
@@ -230,6 +254,12 @@ struct vy_index_recovery_info {
 	 * vy_run_recovery_info::in_incomplete.
 	 */
 	struct rlist incomplete_runs;
+	/**
+	 * List of range tombstones of the index, linked by
+	 * vy_tombstone_recovery_info::in_index, older tombstones
+	 * are closer to the head.
+	 */
+	struct rlist tombstones;
 };
 
 /** Vinyl range info stored in a recovery context. */
@@ -263,6 +293,22 @@ struct vy_range_recovery_info {
 	struct rlist runs;
 };
 
+/** Range tombstone info stored in a recovery context. */
+struct vy_tombstone_recovery_info {
+	/** Link in vy_index_recovery_info::tombstones. */
+	struct rlist in_index;
+	/** ID of the tombstone. */
+	int64_t id;
+	/** LSN of the statement that created the tombstone. */
+	int64_t lsn;
+	/** Start of the deleted range, stored in MsgPack array. */
+	char *begin;
+	/** End of the deleted range, stored in MsgPack array. */
+	char *end;
+	/** Log signature from the time when the tombstone was created. */
+	int64_t signature;
+};
+
 /** Run info stored in a recovery context. */
 struct vy_run_recovery_info {
 	/** Link in vy_range_recovery_info::runs. */
@@ -368,9 +414,17 @@ vy_log_record_snprint(char *buf, int size, const struct vy_log_record *record)
 		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
 			vy_log_key_name[VY_LOG_KEY_MAX_LSN], record->max_lsn);
 	if (key_mask & (1 << VY_LOG_KEY_IS_EMPTY))
-		SNPRINT(total, snprintf, buf, size, "%s=%d",
+		SNPRINT(total, snprintf, buf, size, "%s=%d, ",
 			vy_log_key_name[VY_LOG_KEY_IS_EMPTY],
 			(int)record->is_empty);
+	if (key_mask & (1 << VY_LOG_KEY_TOMBSTONE_ID))
+		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
+			vy_log_key_name[VY_LOG_KEY_TOMBSTONE_ID],
+			record->tombstone_id);
+	if (key_mask & (1 << VY_LOG_KEY_TOMBSTONE_LSN))
+		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
+			vy_log_key_name[VY_LOG_KEY_TOMBSTONE_LSN],
+			record->tombstone_lsn);
 	SNPRINT(total, snprintf, buf, size, "}");
 	return total;
 }
@@ -493,6 +547,18 @@ vy_log_record_encode(const struct vy_log_record *record,
 		size += mp_sizeof_bool(record->is_empty);
 		n_keys++;
 	}
+	if (key_mask & (1 << VY_LOG_KEY_TOMBSTONE_ID)) {
+		assert(record->tombstone_id >= 0);
+		size += mp_sizeof_uint(VY_LOG_KEY_TOMBSTONE_ID);
+		size += mp_sizeof_uint(record->tombstone_id);
+		n_keys++;
+	}
+	if (key_mask & (1 << VY_LOG_KEY_TOMBSTONE_LSN)) {
+		assert(record->tombstone_lsn >= 0);
+		size += mp_sizeof_uint(VY_LOG_KEY_TOMBSTONE_LSN);
+		size += mp_sizeof_uint(record->tombstone_lsn);
+		n_keys++;
+	}
 	size += mp_sizeof_map(n_keys);
 
 	/*
@@ -571,6 +637,14 @@ vy_log_record_encode(const struct vy_log_record *record,
 		pos = mp_encode_uint(pos, VY_LOG_KEY_IS_EMPTY);
 		pos = mp_encode_bool(pos, record->is_empty);
 	}
+	if (key_mask & (1 << VY_LOG_KEY_TOMBSTONE_ID)) {
+		pos = mp_encode_uint(pos, VY_LOG_KEY_TOMBSTONE_ID);
+		pos = mp_encode_uint(pos, record->tombstone_id);
+	}
+	if (key_mask & (1 << VY_LOG_KEY_TOMBSTONE_LSN)) {
+		pos = mp_encode_uint(pos, VY_LOG_KEY_TOMBSTONE_LSN);
+		pos = mp_encode_uint(pos, record->tombstone_lsn);
+	}
 	assert(pos == tuple + size);
 
 	/*
@@ -692,6 +766,12 @@ vy_log_record_decode(struct vy_log_record *record,
 		case VY_LOG_KEY_IS_EMPTY:
 			record->is_empty = mp_decode_bool(&pos);
 			break;
+		case VY_LOG_KEY_TOMBSTONE_ID:
+			record->tombstone_id = mp_decode_uint(&pos);
+			break;
+		case VY_LOG_KEY_TOMBSTONE_LSN:
+			record->tombstone_lsn = mp_decode_uint(&pos);
+			break;
 		default:
 			diag_set(ClientError, ER_INVALID_VYLOG_FILE,
 				 tt_sprintf("Bad record: unknown key %u",
@@ -808,6 +888,12 @@ vy_log_next_range_id(void)
 	return vy_log.next_range_id++;
 }
 
+int64_t
+vy_log_next_tombstone_id(void)
+{
+	return vy_log.next_tombstone_id++;
+}
+
 int
 vy_log_bootstrap(void)
 {
@@ -851,6 +937,7 @@ vy_log_begin_recovery(const struct vclock *vclock)
 
 	vy_log.next_range_id = recovery->range_id_max + 1;
 	vy_log.next_run_id = recovery->run_id_max + 1;
+	vy_log.next_tombstone_id = recovery->tombstone_id_max + 1;
 
 	vy_log.recovery = recovery;
 	vclock_copy(&vy_log.last_checkpoint, vclock);
@@ -1229,6 +1316,31 @@ vy_recovery_lookup_run(struct vy_recovery *recovery, int64_t run_id)
 	return mh_i64ptr_node(h, k)->val;
 }
 
+/** Lookup a range tombstone in vy_recovery::tombstone_hash map. */
+static struct vy_tombstone_recovery_info *
+vy_recovery_lookup_tombstone(struct vy_recovery *recovery,
+			     int64_t tombstone_id)
+{
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	mh_int_t k = mh_i64ptr_find(h, tombstone_id, NULL);
+	if (k == mh_end(h))
+		return NULL;
+	return mh_i64ptr_node(h, k)->val;
+}
+
+/** Remove a range tombstone from a recovery context and free it. */
+static void
+vy_recovery_free_tombstone(struct vy_recovery *recovery,
+			   struct vy_tombstone_recovery_info *tombstone)
+{
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	mh_int_t k = mh_i64ptr_find(h, tombstone->id, NULL);
+	assert(k != mh_end(h));
+	mh_i64ptr_del(h, k, NULL);
+	rlist_del_entry(tombstone, in_index);
+	free(tombstone);
+}
+
 /**
  * Handle a VY_LOG_CREATE_INDEX log record.
  * This function allocates a new vinyl index with ID @index_lsn
@@ -1270,13 +1382,15 @@ vy_recovery_create_index(struct vy_recovery *recovery, int64_t signature,
 	index->signature = signature;
 	rlist_create(&index->ranges);
 	rlist_create(&index->incomplete_runs);
+	rlist_create(&index->tombstones);
 	return 0;
 }
 
 /**
  * Handle a VY_LOG_DROP_INDEX log record.
- * This function marks the vinyl index with ID @index_lsn as dropped.
- * If the index has no ranges and runs, it is freed.
+ * This function marks the vinyl index with ID @index_lsn as dropped
+ * and frees its range tombstones, which are of no use for a dropped
+ * index. If the index has no ranges and runs, it is freed.
  * Returns 0 on success, -1 if ID not found or index is already marked.
  */
 static int
@@ -1299,6 +1413,10 @@ vy_recovery_drop_index(struct vy_recovery *recovery, int64_t signature,
 		return -1;
 	}
 	vy_index_mark_deleted(index, signature);
+	struct vy_tombstone_recovery_info *tombstone, *next_tombstone;
+	rlist_foreach_entry_safe(tombstone, &index->tombstones,
+				 in_index, next_tombstone)
+		vy_recovery_free_tombstone(recovery, tombstone);
 	if (rlist_empty(&index->ranges) &&
 	    rlist_empty(&index->incomplete_runs)) {
 		mh_i64ptr_del(h, k, NULL);
@@ -1581,6 +1699,102 @@ vy_recovery_delete_range(struct vy_recovery *recovery, int64_t signature,
 	return 0;
 }
 
+/**
+ * Handle a VY_LOG_INSERT_TOMBSTONE log record.
+ * This function allocates a new range tombstone with ID
+ * @tombstone_id, inserts it to the hash, and adds it to the
+ * list of tombstones of the index with ID @index_lsn.
+ * Return 0 on success, -1 on failure (ID collision or OOM).
+ */
+static int
+vy_recovery_insert_tombstone(struct vy_recovery *recovery,
+			     int64_t signature, int64_t index_lsn,
+			     int64_t tombstone_id, const char *begin,
+			     const char *end, int64_t tombstone_lsn)
+{
+	if (vy_recovery_lookup_tombstone(recovery, tombstone_id) != NULL) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Duplicate tombstone id %lld",
+				    (long long)tombstone_id));
+		return -1;
+	}
+	struct vy_index_recovery_info *index;
+	index = vy_recovery_lookup_index(recovery, index_lsn);
+	if (index == NULL) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Tombstone %lld created for unregistered "
+				    "index %lld", (long long)tombstone_id,
+				    (long long)index_lsn));
+		return -1;
+	}
+	if (index->is_dropped) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Tombstone %lld created for dropped "
+				    "index %lld", (long long)tombstone_id,
+				    (long long)index_lsn));
+		return -1;
+	}
+
+	size_t size = sizeof(struct vy_tombstone_recovery_info);
+	const char *data;
+	data = begin;
+	mp_next(&data);
+	size_t begin_size = data - begin;
+	size += begin_size;
+	data = end;
+	mp_next(&data);
+	size_t end_size = data - end;
+	size += end_size;
+
+	struct vy_tombstone_recovery_info *tombstone = malloc(size);
+	if (tombstone == NULL) {
+		diag_set(OutOfMemory, size,
+			 "malloc", "struct vy_tombstone_recovery_info");
+		return -1;
+	}
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	struct mh_i64ptr_node_t node = { tombstone_id, tombstone };
+	if (mh_i64ptr_put(h, &node, NULL, NULL) == mh_end(h)) {
+		diag_set(OutOfMemory, 0, "mh_i64ptr_put", "mh_i64ptr_node_t");
+		free(tombstone);
+		return -1;
+	}
+	tombstone->id = tombstone_id;
+	tombstone->lsn = tombstone_lsn;
+	tombstone->begin = (void *)tombstone + sizeof(*tombstone);
+	memcpy(tombstone->begin, begin, begin_size);
+	tombstone->end = (void *)tombstone + sizeof(*tombstone) + begin_size;
+	memcpy(tombstone->end, end, end_size);
+	tombstone->signature = signature;
+	rlist_add_tail_entry(&index->tombstones, tombstone, in_index);
+	if (recovery->tombstone_id_max < tombstone_id)
+		recovery->tombstone_id_max = tombstone_id;
+	return 0;
+}
+
+/**
+ * Handle a VY_LOG_DELETE_TOMBSTONE log record.
+ * This function frees the range tombstone with ID @tombstone_id.
+ * There are no files associated with a tombstone, so unlike runs,
+ * tombstones don't need to be kept for garbage collection.
+ * Return 0 on success, -1 if tombstone not found.
+ */
+static int
+vy_recovery_delete_tombstone(struct vy_recovery *recovery,
+			     int64_t tombstone_id)
+{
+	struct vy_tombstone_recovery_info *tombstone;
+	tombstone = vy_recovery_lookup_tombstone(recovery, tombstone_id);
+	if (tombstone == NULL) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Tombstone %lld deleted but not "
+				    "registered", (long long)tombstone_id));
+		return -1;
+	}
+	vy_recovery_free_tombstone(recovery, tombstone);
+	return 0;
+}
+
 /**
  * Update a recovery context with a new log record.
  * Return 0 on success, -1 on failure.
@@ -1633,6 +1847,16 @@ vy_recovery_process_record(struct vy_recovery *recovery,
 	case VY_LOG_FORGET_RUN:
 		rc = vy_recovery_forget_run(recovery, record->run_id);
 		break;
+	case VY_LOG_INSERT_TOMBSTONE:
+		rc = vy_recovery_insert_tombstone(recovery, record->signature,
+				record->index_lsn, record->tombstone_id,
+				record->range_begin, record->range_end,
+				record->tombstone_lsn);
+		break;
+	case VY_LOG_DELETE_TOMBSTONE:
+		rc = vy_recovery_delete_tombstone(recovery,
+						  record->tombstone_id);
+		break;
 	default:
 		unreachable();
 	}
@@ -1655,15 +1879,19 @@ vy_recovery_new_f(va_list ap)
 	recovery->index_hash = NULL;
 	recovery->range_hash = NULL;
 	recovery->run_hash = NULL;
+	recovery->tombstone_hash = NULL;
 	recovery->range_id_max = -1;
 	recovery->run_id_max = -1;
+	recovery->tombstone_id_max = -1;
 
 	recovery->index_hash = mh_i64ptr_new();
 	recovery->range_hash = mh_i64ptr_new();
 	recovery->run_hash = mh_i64ptr_new();
+	recovery->tombstone_hash = mh_i64ptr_new();
 	if (recovery->index_hash == NULL ||
 	    recovery->range_hash == NULL ||
-	    recovery->run_hash == NULL) {
+	    recovery->run_hash == NULL ||
+	    recovery->tombstone_hash == NULL) {
 		diag_set(OutOfMemory, 0, "mh_i64ptr_new", "mh_i64ptr_t");
 		goto fail_free;
 	}
@@ -1761,6 +1989,8 @@ vy_recovery_delete(struct vy_recovery *recovery)
 		vy_recovery_delete_hash(recovery->range_hash);
 	if (recovery->run_hash != NULL)
 		vy_recovery_delete_hash(recovery->run_hash);
+	if (recovery->tombstone_hash != NULL)
+		vy_recovery_delete_hash(recovery->tombstone_hash);
 	TRASH(recovery);
 	free(recovery);
 }
@@ -1780,6 +2010,7 @@ vy_recovery_do_iterate_index(struct vy_index_recovery_info *index,
 {
 	struct vy_range_recovery_info *range;
 	struct vy_run_recovery_info *run;
+	struct vy_tombstone_recovery_info *tombstone;
 	struct vy_log_record record;
 	const char *tmp;
 
@@ -1811,6 +2042,22 @@ vy_recovery_do_iterate_index(struct vy_index_recovery_info *index,
 		return 0;
 	}
 
+	/* Dropped indexes don't have tombstones. */
+	rlist_foreach_entry(tombstone, &index->tombstones, in_index) {
+		record.type = VY_LOG_INSERT_TOMBSTONE;
+		record.signature = tombstone->signature;
+		record.tombstone_id = tombstone->id;
+		record.tombstone_lsn = tombstone->lsn;
+		record.range_begin = tmp = tombstone->begin;
+		if (mp_decode_array(&tmp) == 0)
+			record.range_begin = NULL;
+		record.range_end = tmp = tombstone->end;
+		if (mp_decode_array(&tmp) == 0)
+			record.range_end = NULL;
+		if (vy_recovery_cb_call(cb, cb_arg, &record) != 0)
+			return -1;
+	}
+
 	rlist_foreach_entry(range, &index->ranges, in_index) {
 		if (!include_deleted && range->is_deleted)
 			continue;
@@ -120,6 +120,27 @@ enum vy_log_record_type {
 	 * the new log on rotation.
 	 */
 	VY_LOG_FORGET_RUN		= 7,
+	/**
+	 * Insert a range tombstone into a vinyl index.
+	 * Requires vy_log_record::index_lsn, tombstone_id,
+	 * range_begin, range_end, tombstone_lsn.
+	 *
+	 * A range tombstone is left by a DELETE_RANGE statement
+	 * and hides all statements of the index which fall in
+	 * [range_begin, range_end) and are older than the
+	 * tombstone LSN. It is logged when the statement is
+	 * committed, since unlike statements stored in the
+	 * index, tombstones are not dumped to disk.
+	 */
+	VY_LOG_INSERT_TOMBSTONE		= 8,
+	/**
+	 * Delete a range tombstone.
+	 * Requires vy_log_record::tombstone_id.
+	 *
+	 * Written when compaction has purged all statements
+	 * covered by the tombstone.
+	 */
+	VY_LOG_DELETE_TOMBSTONE		= 9,
 
 	vy_log_record_type_MAX
 };
@@ -168,6 +189,10 @@ struct vy_log_record {
 	 * (Empty runs are kept for the sake of min/max LSN).
 	 */
 	bool is_empty;
+	/** Unique ID of the range tombstone. */
+	int64_t tombstone_id;
+	/** LSN of the statement that created the range tombstone. */
+	int64_t tombstone_lsn;
 };
 
 /**
@@ -224,6 +249,10 @@ vy_log_next_run_id(void);
 int64_t
 vy_log_next_range_id(void);
 
+/** Allocate a unique ID for a range tombstone. */
+int64_t
+vy_log_next_tombstone_id(void);
+
 /**
  * Begin a transaction in the metadata log.
  *
@@ -326,9 +355,11 @@ typedef int
  *
  * For each range and run of the index, this function calls @cb passing
  * a log record and an optional @cb_arg to it. A log record type is
- * either VY_LOG_CREATE_INDEX, VY_LOG_INSERT_RANGE, or VY_LOG_INSERT_RUN
- * unless the index was dropped. In the latter case, a VY_LOG_DROP_INDEX
- * record is issued in the end.
+ * either VY_LOG_CREATE_INDEX, VY_LOG_INSERT_TOMBSTONE, VY_LOG_INSERT_RANGE,
+ * or VY_LOG_INSERT_RUN unless the index was dropped. In the latter case,
+ * a VY_LOG_DROP_INDEX record is issued in the end.
+ * Range tombstones of the index go right after VY_LOG_CREATE_INDEX,
+ * in the chronological order.
  * The callback is supposed to rebuild the index structure and open run
  * files. If the callback returns a non-zero value, the function stops
  * iteration over ranges and runs and returns error.
@@ -458,6 +489,36 @@ vy_log_delete_run(int64_t run_id)
 	vy_log_write(&record);
 }
 
+/** Helper to log a range tombstone insertion. */
+static inline void
+vy_log_insert_tombstone(int64_t index_lsn, int64_t tombstone_id,
+			const char *begin, const char *end,
+			int64_t tombstone_lsn)
+{
+	struct vy_log_record record;
+	memset(&record, 0, sizeof(record));
+	record.type = VY_LOG_INSERT_TOMBSTONE;
+	record.signature = -1;
+	record.index_lsn = index_lsn;
+	record.tombstone_id = tombstone_id;
+	record.range_begin = begin;
+	record.range_end = end;
+	record.tombstone_lsn = tombstone_lsn;
+	vy_log_write(&record);
+}
+
+/** Helper to log a range tombstone deletion. */
+static inline void
+vy_log_delete_tombstone(int64_t tombstone_id)
+{
+	struct vy_log_record record;
+	memset(&record, 0, sizeof(record));
+	record.type = VY_LOG_DELETE_TOMBSTONE;
+	record.signature = -1;
+	record.tombstone_id = tombstone_id;
+	vy_log_write(&record);
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -32,6 +32,7 @@
  */
 
 #include <stddef.h>
+#include <stdint.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -67,6 +68,18 @@ struct vy_quota {
 	size_t watermark;
 	/** Current memory consumption. */
 	size_t used;
+	/**
+	 * Rate at which memory is reclaimed, in bytes per
+	 * second, or 0 if unknown. Used for pacing writers
+	 * once the watermark is exceeded.
+	 */
+	size_t release_rate;
+	/**
+	 * Time before which the next writer must not consume
+	 * quota, @sa vy_quota_pace(). It is 0 unless the
+	 * watermark is exceeded.
+	 */
+	double pace_deadline;
 	/** Quota callback. */
 	vy_quota_cb cb;
 	/** Argument passed to cb. */
@@ -79,6 +92,8 @@ vy_quota_init(struct vy_quota *q, vy_quota_cb cb, void *cb_arg)
 	q->limit = SIZE_MAX;
 	q->watermark = SIZE_MAX;
 	q->used = 0;
+	q->release_rate = 0;
+	q->pace_deadline = 0;
 	q->cb = cb;
 	q->cb_arg = cb_arg;
 }
@@ -113,6 +128,7 @@ static inline void
 vy_quota_update_watermark(struct vy_quota *q, size_t chunk_size,
 			  size_t use_rate, size_t release_rate)
 {
+	q->release_rate = release_rate;
 	if (q->limit == SIZE_MAX)
 		return;
 	/*
@@ -126,6 +142,46 @@ vy_quota_update_watermark(struct vy_quota *q, size_t chunk_size,
 		q->watermark = q->limit - gap;
 	else
 		q->watermark = 0;
+	if (q->used <= q->watermark)
+		q->pace_deadline = 0;
+}
+
+/**
+ * Account @size bytes written at time @now and move the pacing
+ * deadline accordingly.
+ *
+ * Instead of letting writers run at full speed until the hard
+ * limit is hit and then stalling them all until memory is
+ * reclaimed, writers are slowed down as soon as the watermark
+ * is exceeded. The write rate admitted is inversely proportional
+ * to how far memory usage has got between the watermark and the
+ * limit, and approaches the reclaim rate as usage approaches the
+ * limit, so that the hard limit is only a last resort.
+ */
+static inline void
+vy_quota_pace(struct vy_quota *q, size_t size, double now)
+{
+	if (q->used <= q->watermark || q->limit == SIZE_MAX ||
+	    q->release_rate == 0)
+		return;
+	double fill = 1;
+	if (q->used < q->limit)
+		fill = (double)(q->used - q->watermark) /
+		       (q->limit - q->watermark);
+	double delay = fill * size / q->release_rate;
+	if (q->pace_deadline < now)
+		q->pace_deadline = now;
+	q->pace_deadline += delay;
+}
+
+/**
+ * Return the time a writer has to wait at time @now before
+ * consuming quota, @sa vy_quota_pace().
+ */
+static inline double
+vy_quota_pace_delay(struct vy_quota *q, double now)
+{
+	return q->pace_deadline > now ? q->pace_deadline - now : 0;
 }
 
 /**
@@ -160,6 +216,8 @@ vy_quota_release(struct vy_quota *q, size_t size)
 {
 	assert(q->used >= size);
 	q->used -= size;
+	if (q->used <= q->watermark)
+		q->pace_deadline = 0;
 	if (q->cb != NULL && q->used < q->limit)
 		q->cb(VY_QUOTA_RELEASED, q->cb_arg);
 }
@@ -31,6 +31,8 @@
 #include "vy_run.h"
 #include "fiber.h"
 #include "coeio.h"
+#include "coeio_file.h"
+#include "coio_uring.h"
 #include "xrow.h"
 #include "xlog.h"
 #include "fio.h"
@@ -44,6 +46,11 @@ struct vy_page_read_task {
 	struct coio_task base;
 	/** vinyl page metadata */
 	struct vy_page_info page_info;
+	/**
+	 * Page data if it has already been read from the
+	 * file, in which case it only needs to be decoded.
+	 */
+	char *data;
 	/** vy_run with fd - ref. counted */
 	struct vy_run *run;
 	/** vy_run_env - contains environment with task mempool */
@@ -132,6 +139,8 @@ vy_run_new(int64_t id)
 	run->id = id;
 	run->fd = -1;
 	run->refs = 1;
+	run->lookup_count = 0;
+	run->bloom_reflect_count = 0;
 	rlist_create(&run->in_range);
 	TRASH(&run->info.bloom);
 	run->info.has_bloom = false;
@@ -205,6 +214,17 @@ vy_page_info_decode(struct vy_page_info *page, const struct xrow_header *xrow,
 		case VY_PAGE_INFO_PAGE_INDEX_OFFSET:
 			page->page_index_offset = mp_decode_uint(&pos);
 			break;
+		case VY_PAGE_INFO_VERSION:
+			page->version = mp_decode_uint(&pos);
+			if (page->version > VY_PAGE_VERSION_PREFIX) {
+				diag_set(ClientError, ER_INVALID_INDEX_FILE,
+					 filename,
+					 tt_sprintf("Can't decode page info: "
+						    "unknown page version %u",
+						    (unsigned)page->version));
+				return -1;
+			}
+			break;
 		default:
 			diag_set(ClientError, ER_INVALID_INDEX_FILE, filename,
 				 tt_sprintf("Can't decode page info: "
@@ -352,9 +372,19 @@ vy_page_new(const struct vy_page_info *page_info)
 	}
 	page->count = page_info->count;
 	page->unpacked_size = page_info->unpacked_size;
-	page->page_index = calloc(page_info->count, sizeof(uint32_t));
+	page->version = page_info->version;
+	page->restart_interval = page->version == VY_PAGE_VERSION_XROW ?
+				 1 : VY_PAGE_RESTART_INTERVAL;
+	page->restart_count = (page->count + page->restart_interval - 1) /
+			      page->restart_interval;
+	page->rows = page->rows_end = NULL;
+	page->row_no = UINT32_MAX;
+	page->row_buf = NULL;
+	page->row_len = page->row_buf_size = 0;
+	page->row_next = NULL;
+	page->page_index = calloc(page->restart_count, sizeof(uint32_t));
 	if (page->page_index == NULL) {
-		diag_set(OutOfMemory, page_info->count * sizeof(uint32_t),
+		diag_set(OutOfMemory, page->restart_count * sizeof(uint32_t),
 			 "malloc", "page->page_index");
 		free(page);
 		return NULL;
@@ -376,13 +406,15 @@ vy_page_delete(struct vy_page *page)
 {
 	uint32_t *page_index = page->page_index;
 	char *data = page->data;
+	char *row_buf = page->row_buf;
 #if !defined(NDEBUG)
-	memset(page->page_index, '#', sizeof(uint32_t) * page->count);
+	memset(page->page_index, '#', sizeof(uint32_t) * page->restart_count);
 	memset(page->data, '#', page->unpacked_size);
 	memset(page, '#', sizeof(*page));
 #endif /* !defined(NDEBUG) */
 	free(page_index);
 	free(data);
+	free(row_buf);
 	free(page);
 }
 
@@ -390,6 +422,7 @@ int
 vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	     struct xrow_header *xrow)
 {
+	assert(page->version == VY_PAGE_VERSION_XROW);
 	assert(stmt_no < page->count);
 	const char *data = page->data + page->page_index[stmt_no];
 	const char *data_end = stmt_no + 1 < page->count ?
@@ -398,6 +431,178 @@ vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	return xrow_header_decode(xrow, &data, data_end);
 }
 
+/** A statement as it is stored in a page. */
+struct vy_page_row {
+	enum iproto_type type;
+	int64_t lsn;
+	/**
+	 * The key for DELETE and REPLACE in a secondary index,
+	 * the tuple otherwise.
+	 */
+	const char *data;
+	const char *data_end;
+	/** UPSERT operations, NULL for other statements. */
+	const char *ops;
+	const char *ops_end;
+};
+
+static inline void
+vy_page_row_corrupted(void)
+{
+	/* TODO: report filename */
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 "Can't decode statement: corrupted page rows");
+}
+
+/**
+ * Decode an unsigned integer of a prefix-compressed record.
+ * @retval  0 Success.
+ * @retval -1 Invalid record.
+ */
+static inline int
+vy_page_row_decode_uint(const char **pos, const char *end, uint64_t *value)
+{
+	if (*pos >= end || mp_typeof(**pos) != MP_UINT ||
+	    mp_check_uint(*pos, end) > 0)
+		return -1;
+	*value = mp_decode_uint(pos);
+	return 0;
+}
+
+/**
+ * Restore statement @a stmt_no of a prefix-compressed page in
+ * page->row_buf. Each record stores the length of the prefix
+ * shared with the previous record and the rest of the data:
+ *
+ *   record = shared:MP_UINT unshared_size:MP_UINT unshared
+ *
+ * The page is decoded from the closest preceding restart point,
+ * unless the previous call restored a statement in between, so
+ * that reading a page in order costs one step per statement.
+ *
+ * @retval  0 Success.
+ * @retval -1 Invalid page or memory error.
+ */
+static int
+vy_page_restore_row(struct vy_page *page, uint32_t stmt_no)
+{
+	assert(page->version == VY_PAGE_VERSION_PREFIX);
+	assert(stmt_no < page->count);
+	if (page->row_no == stmt_no)
+		return 0;
+	uint32_t restart = stmt_no / page->restart_interval;
+	uint32_t i = restart * page->restart_interval;
+	const char *pos = page->rows + page->page_index[restart];
+	if (page->row_no != UINT32_MAX && page->row_no >= i &&
+	    page->row_no < stmt_no) {
+		i = page->row_no + 1;
+		pos = page->row_next;
+	}
+	page->row_no = UINT32_MAX;
+	for (; i <= stmt_no; i++) {
+		uint64_t shared, size;
+		if (vy_page_row_decode_uint(&pos, page->rows_end,
+					    &shared) != 0 ||
+		    vy_page_row_decode_uint(&pos, page->rows_end,
+					    &size) != 0 ||
+		    (i % page->restart_interval == 0 && shared != 0) ||
+		    shared > page->row_len ||
+		    size > (uint64_t)(page->rows_end - pos)) {
+			vy_page_row_corrupted();
+			return -1;
+		}
+		uint32_t len = shared + size;
+		if (len > page->row_buf_size) {
+			uint32_t buf_size = MAX(len, 2 * page->row_buf_size);
+			char *buf = realloc(page->row_buf, buf_size);
+			if (buf == NULL) {
+				diag_set(OutOfMemory, buf_size, "realloc",
+					 "page->row_buf");
+				return -1;
+			}
+			page->row_buf = buf;
+			page->row_buf_size = buf_size;
+		}
+		memcpy(page->row_buf + shared, pos, size);
+		page->row_len = len;
+		pos += size;
+	}
+	page->row_no = stmt_no;
+	page->row_next = pos;
+	return 0;
+}
+
+/**
+ * Find the fields of a statement in the page. The result points
+ * to the page data and is valid until the next call for the same
+ * page.
+ *
+ * A record of a prefix-compressed page starts with the statement
+ * data, so that sorted statements share long prefixes:
+ *
+ *   data:MP_ARRAY type:MP_UINT lsn:MP_UINT [ops:MP_ARRAY]
+ *
+ * @retval  0 Success.
+ * @retval -1 Invalid statement or memory error.
+ */
+static int
+vy_page_row(struct vy_page *page, uint32_t stmt_no, struct vy_page_row *row)
+{
+	if (page->version == VY_PAGE_VERSION_XROW) {
+		struct xrow_header xrow;
+		if (vy_page_xrow(page, stmt_no, &xrow) != 0)
+			return -1;
+		struct request request;
+		request_create(&request, xrow.type);
+		uint64_t key_map = request_key_map(xrow.type);
+		key_map &= ~(1ULL << IPROTO_SPACE_ID); /* space_id is optional */
+		if (request_decode(&request, xrow.body->iov_base,
+				   xrow.body->iov_len, key_map) < 0)
+			return -1;
+		row->type = xrow.type;
+		row->lsn = xrow.lsn;
+		if (xrow.type == IPROTO_DELETE) {
+			row->data = request.key;
+			row->data_end = request.key_end;
+		} else {
+			row->data = request.tuple;
+			row->data_end = request.tuple_end;
+		}
+		row->ops = request.ops;
+		row->ops_end = request.ops_end;
+		return 0;
+	}
+	if (vy_page_restore_row(page, stmt_no) != 0)
+		return -1;
+	const char *pos = page->row_buf;
+	const char *end = pos + page->row_len;
+	uint64_t type, lsn;
+	row->data = pos;
+	if (pos >= end || mp_typeof(*pos) != MP_ARRAY ||
+	    mp_check(&pos, end) != 0)
+		goto corrupted;
+	row->data_end = pos;
+	if (vy_page_row_decode_uint(&pos, end, &type) != 0 ||
+	    vy_page_row_decode_uint(&pos, end, &lsn) != 0)
+		goto corrupted;
+	row->type = type;
+	row->lsn = lsn;
+	row->ops = row->ops_end = NULL;
+	if (type == IPROTO_UPSERT) {
+		row->ops = pos;
+		if (pos >= end || mp_typeof(*pos) != MP_ARRAY ||
+		    mp_check(&pos, end) != 0)
+			goto corrupted;
+		row->ops_end = pos;
+	}
+	if (pos != end)
+		goto corrupted;
+	return 0;
+corrupted:
+	vy_page_row_corrupted();
+	return -1;
+}
+
 /* {{{ vy_run_iterator vy_run_iterator support functions */
 
 /**
@@ -408,6 +613,8 @@ vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
  * @param format        Format for REPLACE/DELETE tuples.
  * @param upsert_format Format for UPSERT tuples.
  * @param is_primary    True if the index is primary.
+ * @param arena         Arena to allocate the statement from or
+ *                      NULL to use malloc().
  *
  * @retval not NULL Statement read from page.
  * @retval     NULL Memory error.
@@ -415,14 +622,83 @@ vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 static struct tuple *
 vy_page_stmt(struct vy_page *page, uint32_t stmt_no,
 	     const struct key_def *key_def, struct tuple_format *format,
-	     struct tuple_format *upsert_format, bool is_primary)
+	     struct tuple_format *upsert_format, bool is_primary,
+	     struct vy_stmt_arena *arena)
 {
-	struct xrow_header xrow;
-	if (vy_page_xrow(page, stmt_no, &xrow) != 0)
+	struct vy_page_row row;
+	if (vy_page_row(page, stmt_no, &row) != 0)
 		return NULL;
-	struct tuple_format *format_to_use = (xrow.type == IPROTO_UPSERT)
+	struct tuple_format *format_to_use = (row.type == IPROTO_UPSERT)
 					     ? upsert_format : format;
-	return vy_stmt_decode(&xrow, key_def, format_to_use, is_primary);
+	return vy_stmt_decode_raw(row.type, row.lsn, row.data, row.data_end,
+				  row.ops, row.ops_end, key_def,
+				  format_to_use, is_primary, arena);
+}
+
+/**
+ * Find statement data in the page without decoding it into
+ * a tuple. Used for comparisons, which don't need anything but
+ * the key fields.
+ * @param page          Page.
+ * @param stmt_no       Statement position in the page.
+ * @param is_primary    True if the index is primary.
+ * @param[out] data     Statement data with MessagePack array
+ *                      header: a full tuple for REPLACE and
+ *                      UPSERT in the primary index, key parts
+ *                      otherwise.
+ * @param[out] is_key   Set if @a data contains key parts.
+ *
+ * @retval  0 Success.
+ * @retval -1 Invalid statement.
+ */
+static int
+vy_page_stmt_raw(struct vy_page *page, uint32_t stmt_no, bool is_primary,
+		 const char **data, bool *is_key)
+{
+	struct vy_page_row row;
+	if (vy_page_row(page, stmt_no, &row) != 0)
+		return -1;
+	switch (row.type) {
+	case IPROTO_DELETE:
+		*is_key = true;
+		break;
+	case IPROTO_REPLACE:
+		*is_key = !is_primary;
+		break;
+	case IPROTO_UPSERT:
+		*is_key = false;
+		break;
+	default:
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 tt_sprintf("Can't decode statement: "
+				    "unknown request type %u",
+				    (unsigned)row.type));
+		return -1;
+	}
+	*data = row.data;
+	return 0;
+}
+
+/**
+ * Compare statement data found with vy_page_stmt_raw() with
+ * a statement. Gives the same result as vy_stmt_compare() of
+ * the decoded statement and @a stmt.
+ */
+static int
+vy_page_stmt_compare(const char *data, bool is_key,
+		     const struct tuple *stmt, const struct key_def *key_def)
+{
+	if (vy_stmt_type(stmt) == IPROTO_SELECT) {
+		const char *key = tuple_data(stmt);
+		if (is_key)
+			return key_compare(data, key, key_def);
+		uint32_t part_count = mp_decode_array(&key);
+		return tuple_compare_with_key_raw(data, key, part_count,
+						  key_def);
+	}
+	if (is_key)
+		return -vy_tuple_compare_with_raw_key(stmt, data, key_def);
+	return -tuple_compare_with_raw(stmt, data, key_def);
 }
 
 /**
@@ -527,68 +803,156 @@ vy_page_index_decode(uint32_t *page_index, uint32_t count,
 }
 
 /**
- * Read a page requests from vinyl xlog data file.
+ * Check the result of reading a page from vinyl xlog data file.
  *
  * @retval 0 on success
  * @retval -1 on error, check diag
  */
-int
-vy_page_read(struct vy_page *page, const struct vy_page_info *page_info, int fd,
-	     ZSTD_DStream *zdctx)
+static int
+vy_page_check_read(const struct vy_page_info *page_info, ssize_t readen)
 {
-	/* read xlog tx from xlog file */
-	size_t region_svp = region_used(&fiber()->gc);
-	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
-	if (data == NULL) {
-		diag_set(OutOfMemory, page_info->size, "region gc", "page");
-		return -1;
-	}
-	ssize_t readen = fio_pread(fd, data, page_info->size,
-				   page_info->offset);
 	if (readen < 0) {
 		/* TODO: report filename */
 		diag_set(SystemError, "failed to read from file");
-		goto error;
+		return -1;
 	}
 	if (readen != (ssize_t)page_info->size) {
 		/* TODO: replace with XlogError, report filename */
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 "Unexpected end of file");
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Find statement records of a prefix-compressed page, which
+ * are stored in the body of the first xrow of the page.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_rows_decode(struct vy_page *page)
+{
+	struct xrow_header xrow;
+	const char *pos = page->rows;
+	if (xrow_header_decode(&xrow, &pos, page->rows_end) == -1)
+		return -1;
+	if (xrow.type != VY_RUN_PAGE_ROWS || xrow.bodycnt != 1) {
+		/* TODO: report filename */
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 tt_sprintf("Wrong page rows type "
+				    "(expected %d, got %u)",
+				    VY_RUN_PAGE_ROWS, (unsigned)xrow.type));
+		return -1;
+	}
+	pos = xrow.body->iov_base;
+	if (mp_typeof(*pos) != MP_MAP)
 		goto error;
+	uint32_t map_size = mp_decode_map(&pos);
+	for (uint32_t map_item = 0; map_item < map_size; ++map_item) {
+		if (mp_typeof(*pos) != MP_UINT)
+			goto error;
+		uint32_t key = mp_decode_uint(&pos);
+		switch (key) {
+		case VY_PAGE_ROWS_ROWS:
+			if (mp_typeof(*pos) != MP_BIN)
+				goto error;
+			uint32_t size = mp_decode_binl(&pos);
+			page->rows = pos;
+			page->rows_end = pos + size;
+			return 0;
+		default:
+			mp_next(&pos);
+		}
 	}
-	ERROR_INJECT(ERRINJ_VY_READ_PAGE_TIMEOUT, {usleep(50000);});
+error:
+	/* TODO: report filename */
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 "Can't decode page rows");
+	return -1;
+}
 
+/**
+ * Decode a page read from vinyl xlog data file.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_decode(struct vy_page *page, const struct vy_page_info *page_info,
+	       const char *data, ZSTD_DStream *zdctx)
+{
 	/* decode xlog tx */
 	const char *data_pos = data;
-	const char *data_end = data + readen;
+	const char *data_end = data + page_info->size;
 	char *rows = page->data;
 	char *rows_end = rows + page_info->unpacked_size;
 	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
-		goto error;
+		return -1;
 
 	struct xrow_header xrow;
+	page->rows = page->data;
+	page->rows_end = page->data + page_info->page_index_offset;
+	if (page_info->version == VY_PAGE_VERSION_PREFIX &&
+	    vy_page_rows_decode(page) != 0)
+		return -1;
+
 	data_pos = page->data + page_info->page_index_offset;
 	data_end = page->data + page_info->unpacked_size;
 	if (xrow_header_decode(&xrow, &data_pos, data_end) == -1)
-		goto error;
+		return -1;
 	if (xrow.type != VY_RUN_PAGE_INDEX) {
 		/* TODO: report filename */
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 tt_sprintf("Wrong page index type "
 				    "(expected %d, got %u)",
 				    VY_RUN_PAGE_INDEX, (unsigned)xrow.type));
-		goto error;
+		return -1;
+	}
+	if (vy_page_index_decode(page->page_index, page->restart_count,
+				 &xrow) != 0)
+		return -1;
+	for (uint32_t i = 0; i < page->restart_count; i++) {
+		if (page->page_index[i] >= page->rows_end - page->rows) {
+			/* TODO: report filename */
+			diag_set(ClientError, ER_INVALID_RUN_FILE,
+				 "Page index offset is out of page bounds");
+			return -1;
+		}
 	}
-	if (vy_page_index_decode(page->page_index, page->count, &xrow) != 0)
-		goto error;
-	region_truncate(&fiber()->gc, region_svp);
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
 		diag_set(ClientError, ER_INJECTION, "vinyl page read");
 		return -1;});
 	return 0;
-	error:
+}
+
+/**
+ * Read a page requests from vinyl xlog data file.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+int
+vy_page_read(struct vy_page *page, const struct vy_page_info *page_info, int fd,
+	     ZSTD_DStream *zdctx)
+{
+	/* read xlog tx from xlog file */
+	size_t region_svp = region_used(&fiber()->gc);
+	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
+	if (data == NULL) {
+		diag_set(OutOfMemory, page_info->size, "region gc", "page");
+		return -1;
+	}
+	ssize_t readen = fio_pread(fd, data, page_info->size,
+				   page_info->offset);
+	ERROR_INJECT(ERRINJ_VY_READ_PAGE_TIMEOUT, {usleep(50000);});
+	int rc = vy_page_check_read(page_info, readen);
+	if (rc == 0)
+		rc = vy_page_decode(page, page_info, data, zdctx);
 	region_truncate(&fiber()->gc, region_svp);
-	return -1;
+	return rc;
 }
 
 /**
@@ -620,8 +984,12 @@ vy_page_read_cb(struct coio_task *base)
 	ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run_env);
 	if (zdctx == NULL)
 		return -1;
-	task->rc = vy_page_read(task->page, &task->page_info,
-				task->run->fd, zdctx);
+	if (task->data != NULL)
+		task->rc = vy_page_decode(task->page, &task->page_info,
+					  task->data, zdctx);
+	else
+		task->rc = vy_page_read(task->page, &task->page_info,
+					task->run->fd, zdctx);
 	return task->rc;
 }
 
@@ -634,6 +1002,7 @@ vy_page_read_cb_free(struct coio_task *base)
 	struct vy_page_read_task *task = (struct vy_page_read_task *)base;
 	vy_page_delete(task->page);
 	vy_run_unref(task->run);
+	free(task->data);
 	coio_task_destroy(&task->base);
 	mempool_free(&task->run_env->read_task_pool, task);
 	return 0;
@@ -691,9 +1060,35 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		task->run = itr->run;
 		vy_run_ref(task->run);
 		task->page_info = *page_info;
+		task->data = NULL;
 		task->run_env = itr->run_env;
 		task->page = page;
 
+		if (coio_uring_is_enabled()) {
+			/*
+			 * Reading with io_uring is much cheaper than
+			 * a round trip to a coeio thread, but the page
+			 * is still decompressed and decoded in a coeio
+			 * thread so as not to stall TX.
+			 */
+			task->data = (char *)malloc(page_info->size);
+			if (task->data == NULL) {
+				diag_set(OutOfMemory, page_info->size,
+					 "malloc", "page");
+				vy_page_read_cb_free(&task->base);
+				return -1;
+			}
+			ssize_t readen = coeio_pread(task->run->fd, task->data,
+						     page_info->size,
+						     page_info->offset);
+			ERROR_INJECT(ERRINJ_VY_READ_PAGE_TIMEOUT,
+				     {fiber_sleep(0.05);});
+			if (vy_page_check_read(page_info, readen) != 0) {
+				vy_page_read_cb_free(&task->base);
+				return -1;
+			}
+		}
+
 		/* Post task to coeio */
 		rc = coio_task_post(&task->base, TIMEOUT_INFINITY);
 		if (rc < 0)
@@ -706,6 +1101,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 			return -1;
 		}
 
+		free(task->data);
 		coio_task_destroy(&task->base);
 		mempool_free(&task->run_env->read_task_pool, task);
 
@@ -763,7 +1159,8 @@ vy_run_iterator_read(struct vy_run_iterator *itr,
 	if (rc != 0)
 		return rc;
 	*stmt = vy_page_stmt(page, pos.pos_in_page, itr->key_def,
-			     itr->format, itr->upsert_format, itr->is_primary);
+			     itr->format, itr->upsert_format, itr->is_primary,
+			     itr->arena);
 	if (*stmt == NULL)
 		return -1;
 	return 0;
@@ -807,6 +1204,12 @@ vy_run_iterator_search_page(struct vy_run_iterator *itr,
  * In terms of STL, makes lower_bound for EQ,GE,LT and upper_bound for GT,LE
  * Additionally *equal_key argument is set to true if the found value is
  * equal to given key (untouched otherwise)
+ *
+ * Restart points are searched first, since they are cheap to
+ * read from a prefix-compressed page, then statements following
+ * the found restart point are scanned in order. Every statement
+ * is a restart point in a VY_PAGE_VERSION_XROW page.
+ *
  * @retval position in the page
  */
 static uint32_t
@@ -814,28 +1217,47 @@ vy_run_iterator_search_in_page(struct vy_run_iterator *itr,
 			       const struct tuple *key, struct vy_page *page,
 			       bool *equal_key)
 {
+	uint32_t interval = page->restart_interval;
 	uint32_t beg = 0;
-	uint32_t end = page->count;
+	uint32_t end = page->restart_count;
 	/* for upper bound we change zero comparison result to -1 */
 	int zero_cmp = itr->iterator_type == ITER_GT ||
 		       itr->iterator_type == ITER_LE ? -1 : 0;
+	const char *data;
+	bool is_key;
+	int cmp;
 	while (beg != end) {
 		uint32_t mid = beg + (end - beg) / 2;
-		struct tuple *fnd_key = vy_page_stmt(page, mid, itr->key_def,
-						     itr->format, itr->upsert_format,
-						     itr->is_primary);
-		if (fnd_key == NULL)
-			return end;
-		int cmp = vy_stmt_compare(fnd_key, key, itr->key_def);
+		if (vy_page_stmt_raw(page, mid * interval, itr->is_primary,
+				     &data, &is_key) != 0)
+			return page->count;
+		cmp = vy_page_stmt_compare(data, is_key, key, itr->key_def);
 		cmp = cmp ? cmp : zero_cmp;
 		*equal_key = *equal_key || cmp == 0;
 		if (cmp < 0)
 			beg = mid + 1;
 		else
 			end = mid;
-		tuple_unref(fnd_key);
 	}
-	return end;
+	if (end == 0)
+		return 0;
+	/*
+	 * The restart point found is the first one not less
+	 * than the key, the one before it is less.
+	 */
+	uint32_t pos_end = MIN(end * interval, page->count);
+	for (uint32_t pos = (end - 1) * interval + 1; pos < pos_end; pos++) {
+		if (vy_page_stmt_raw(page, pos, itr->is_primary,
+				     &data, &is_key) != 0)
+			return page->count;
+		cmp = vy_page_stmt_compare(data, is_key, key, itr->key_def);
+		cmp = cmp ? cmp : zero_cmp;
+		if (cmp >= 0) {
+			*equal_key = *equal_key || cmp == 0;
+			return pos;
+		}
+	}
+	return pos_end;
 }
 
 /**
@@ -1054,11 +1476,21 @@ vy_run_iterator_start(struct vy_run_iterator *itr, struct tuple **ret)
 		if (!bloom_possible_has(&itr->run->info.bloom, hash)) {
 			itr->search_ended = true;
 			itr->stat->bloom_reflections++;
+			if (cord_is_main())
+				itr->run->bloom_reflect_count++;
 			return 0;
 		}
 	}
 
 	itr->stat->lookup_count++;
+	/*
+	 * Run read statistics are only accounted for user
+	 * lookups, which are done in the TX thread. Dump,
+	 * compaction and other scans run in other threads
+	 * and must not touch the run concurrently.
+	 */
+	if (cord_is_main())
+		itr->run->lookup_count++;
 
 	if (itr->run->info.count == 1) {
 		/* there can be a stupid bootstrap run in which it's EOF */
@@ -1149,7 +1581,7 @@ vy_run_iterator_open(struct vy_run_iterator *itr, bool coio_read,
 		     const struct key_def *user_key_def,
 		     struct tuple_format *format,
 		     struct tuple_format *upsert_format,
-		     bool is_primary)
+		     bool is_primary, struct vy_stmt_arena *arena)
 {
 	itr->base.iface = &vy_run_iterator_iface;
 	itr->stat = stat;
@@ -1158,6 +1590,7 @@ vy_run_iterator_open(struct vy_run_iterator *itr, bool coio_read,
 	itr->format = format;
 	itr->upsert_format = upsert_format;
 	itr->is_primary = is_primary;
+	itr->arena = arena;
 	itr->run_env = run_env;
 	itr->run = run;
 	itr->coio_read = coio_read;
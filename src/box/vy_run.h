@@ -59,6 +59,26 @@ static const uint64_t vy_run_info_key_map = (1 << VY_RUN_INFO_MIN_KEY) |
 
 enum { VY_BLOOM_VERSION = 0 };
 
+/** Vinyl page format versions, @sa vy_page_info::version. */
+enum {
+	/**
+	 * A page is a sequence of xrows, one per statement,
+	 * followed by a page index with the offset of each row.
+	 */
+	VY_PAGE_VERSION_XROW = 0,
+	/**
+	 * Statements are stored in a single VY_RUN_PAGE_ROWS
+	 * xrow. Each statement shares a prefix with the previous
+	 * one, except for every VY_PAGE_RESTART_INTERVAL-th
+	 * statement (a restart point), which is stored in full.
+	 * The page index only keeps offsets of restart points.
+	 */
+	VY_PAGE_VERSION_PREFIX = 1,
+};
+
+/** Distance between restart points in a prefix-compressed page. */
+enum { VY_PAGE_RESTART_INTERVAL = 16 };
+
 /** xlog meta type for .run files */
 #define XLOG_META_TYPE_RUN "RUN"
 
@@ -114,6 +134,8 @@ struct vy_page_info {
 	char *min_key;
 	/* row index offset in page */
 	uint32_t page_index_offset;
+	/* page format version, VY_PAGE_VERSION_* */
+	uint32_t version;
 };
 
 /**
@@ -138,6 +160,14 @@ struct vy_run {
 	};
 	/** Unique ID of this run. */
 	int64_t id;
+	/**
+	 * Number of times the run was searched since the range
+	 * it belongs to was last compacted. Only lookups done
+	 * in the TX thread are counted.
+	 */
+	uint64_t lookup_count;
+	/** Number of searches avoided thanks to the bloom filter. */
+	uint64_t bloom_reflect_count;
 };
 
 /** Position of a particular stmt in vy_run. */
@@ -181,6 +211,12 @@ struct vy_run_iterator {
 	struct tuple_format *upsert_format;
 	/** Set if this iterator is for a primary index. */
 	bool is_primary;
+	/**
+	 * Arena to allocate statements read from pages from or
+	 * NULL to allocate them with malloc(). Used by the write
+	 * iterator, @sa struct vy_stmt_arena.
+	 */
+	struct vy_stmt_arena *arena;
 	/* run */
 	struct vy_run *run;
 
@@ -233,10 +269,35 @@ struct vy_page {
 	uint32_t count;
 	/** Page data size */
 	uint32_t unpacked_size;
-	/** Array with row offsets in page data */
+	/** Page format version, @sa vy_page_info::version. */
+	uint32_t version;
+	/**
+	 * Distance between statements stored in full, 1 if
+	 * every statement is (VY_PAGE_VERSION_XROW).
+	 */
+	uint32_t restart_interval;
+	/** The number of restart points, i.e. page_index size. */
+	uint32_t restart_count;
+	/** Array with offsets of restart points in page rows */
 	uint32_t *page_index;
 	/** Page data */
 	char *data;
+	/**
+	 * Statement records, page data for VY_PAGE_VERSION_XROW,
+	 * the body of the VY_RUN_PAGE_ROWS xrow otherwise.
+	 */
+	const char *rows;
+	const char *rows_end;
+	/**
+	 * The last statement restored from a prefix-compressed
+	 * page: its number in the page, UINT32_MAX if none, its
+	 * record and the position of the next record.
+	 */
+	uint32_t row_no;
+	char *row_buf;
+	uint32_t row_len;
+	uint32_t row_buf_size;
+	const char *row_next;
 };
 
 /**
@@ -353,7 +414,7 @@ vy_run_iterator_open(struct vy_run_iterator *itr, bool coio_read,
 		     const struct key_def *user_key_def,
 		     struct tuple_format *format,
 		     struct tuple_format *upsert_format,
-		     bool is_primary);
+		     bool is_primary, struct vy_stmt_arena *arena);
 
 /**
  * Get thread local zstd decompression context
@@ -367,6 +428,9 @@ vy_page_new(const struct vy_page_info *page_info);
 void
 vy_page_delete(struct vy_page *page);
 
+/**
+ * Decode the xrow of a statement of a VY_PAGE_VERSION_XROW page.
+ */
 int
 vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	     struct xrow_header *xrow);
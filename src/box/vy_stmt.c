@@ -57,15 +57,21 @@ vy_tuple_delete(struct tuple_format *format, struct tuple *tuple)
 	 */
 	if (cord_is_main())
 		tuple_format_ref(format, -1);
+	bool in_arena = ((struct vy_stmt *) tuple)->in_arena;
 #ifndef NDEBUG
 	memset(tuple, '#', tuple_size(tuple)); /* fail early */
 #endif
-	free(tuple);
+	if (in_arena)
+		vy_stmt_arena_free(tuple);
+	else
+		free(tuple);
 }
 
 /**
  * Allocate a vinyl statement object on base of the struct tuple
- * with malloc() and the reference counter equal to 1.
+ * with the reference counter equal to 1.
+ * @param arena  Arena to allocate the statement from or NULL
+ *               to allocate it with malloc().
  * @param format Format of an index.
  * @param size   Size of the variable part of the statement. It
  *               includes size of MessagePack tuple data and, for
@@ -73,15 +79,24 @@ vy_tuple_delete(struct tuple_format *format, struct tuple *tuple)
  * @retval not NULL Success.
  * @retval     NULL Memory error.
  */
-struct tuple *
-vy_stmt_alloc(struct tuple_format *format, uint32_t bsize)
+static struct tuple *
+vy_stmt_alloc_in(struct vy_stmt_arena *arena, struct tuple_format *format,
+		 uint32_t bsize)
 {
 	uint32_t meta_size = tuple_format_meta_size(format);
 	uint32_t total_size = sizeof(struct vy_stmt) + meta_size + bsize;
-	struct tuple *tuple = malloc(total_size);
-	if (unlikely(tuple == NULL)) {
-		diag_set(OutOfMemory, total_size, "malloc", "struct vy_stmt");
-		return NULL;
+	struct tuple *tuple;
+	if (arena != NULL) {
+		tuple = vy_stmt_arena_alloc(arena, total_size);
+		if (unlikely(tuple == NULL))
+			return NULL;
+	} else {
+		tuple = malloc(total_size);
+		if (unlikely(tuple == NULL)) {
+			diag_set(OutOfMemory, total_size, "malloc",
+				 "struct vy_stmt");
+			return NULL;
+		}
 	}
 	say_debug("vy_stmt_alloc(format = %d %u, bsize = %zu) = %p",
 		format->id, tuple_format_meta_size(format), bsize, tuple);
@@ -93,9 +108,21 @@ vy_stmt_alloc(struct tuple_format *format, uint32_t bsize)
 	tuple->data_offset = sizeof(struct vy_stmt) + meta_size;;
 	vy_stmt_set_lsn(tuple, 0);
 	vy_stmt_set_type(tuple, 0);
+	((struct vy_stmt *) tuple)->in_arena = arena != NULL;
 	return tuple;
 }
 
+/**
+ * Allocate a vinyl statement object on base of the struct tuple
+ * with malloc() and the reference counter equal to 1.
+ * @sa vy_stmt_alloc_in().
+ */
+struct tuple *
+vy_stmt_alloc(struct tuple_format *format, uint32_t bsize)
+{
+	return vy_stmt_alloc_in(NULL, format, bsize);
+}
+
 struct tuple *
 vy_stmt_dup(const struct tuple *stmt, struct tuple_format *format)
 {
@@ -114,6 +141,7 @@ vy_stmt_dup(const struct tuple *stmt, struct tuple_format *format)
 	memcpy(res, stmt, tuple_size(stmt));
 	res->refs = 1;
 	res->format_id = tuple_format_id(format);
+	((struct vy_stmt *) res)->in_arena = false;
 	assert(tuple_size(res) == tuple_size(stmt));
 	return res;
 }
@@ -138,6 +166,7 @@ vy_stmt_dup_lsregion(const struct tuple *stmt, struct lsregion *lsregion,
 	 * will try to unreference this statement.
 	 */
 	mem_stmt->refs = 0;
+	((struct vy_stmt *) mem_stmt)->in_arena = false;
 	return mem_stmt;
 }
 
@@ -201,11 +230,13 @@ vy_key_dup(const char *key)
  * Create a statement without type and with reserved space for operations.
  * Operations can be saved in the space available by @param extra.
  * For details @sa struct vy_stmt comment.
+ * The statement is allocated from @arena unless it is NULL.
  */
 static struct tuple *
 vy_stmt_new_with_ops(struct tuple_format *format, const char *tuple_begin,
 		     const char *tuple_end, struct iovec *ops,
-		     int op_count, enum iproto_type type)
+		     int op_count, enum iproto_type type,
+		     struct vy_stmt_arena *arena)
 {
 	mp_tuple_assert(tuple_begin, tuple_end);
 
@@ -224,7 +255,7 @@ vy_stmt_new_with_ops(struct tuple_format *format, const char *tuple_begin,
 	 */
 	size_t mpsize = (tuple_end - tuple_begin);
 	size_t bsize = mpsize + ops_size;
-	struct tuple *stmt = vy_stmt_alloc(format, bsize);
+	struct tuple *stmt = vy_stmt_alloc_in(arena, format, bsize);
 	if (stmt == NULL)
 		return NULL;
 	/* Copy MsgPack data */
@@ -259,7 +290,7 @@ vy_stmt_new_upsert(struct tuple_format *format, const char *tuple_begin,
 	assert(format->extra_size == sizeof(uint8_t));
 	struct tuple *upsert =
 		vy_stmt_new_with_ops(format, tuple_begin, tuple_end,
-				     operations, ops_cnt, IPROTO_UPSERT);
+				     operations, ops_cnt, IPROTO_UPSERT, NULL);
 	if (upsert == NULL)
 		return NULL;
 	vy_stmt_set_n_upserts(upsert, 0);
@@ -273,7 +304,7 @@ vy_stmt_new_replace(struct tuple_format *format, const char *tuple_begin,
 	/* REPLACE mustn't have n_upserts field. */
 	assert(format->extra_size != sizeof(uint8_t));
 	return vy_stmt_new_with_ops(format, tuple_begin, tuple_end,
-				    NULL, 0, IPROTO_REPLACE);
+				    NULL, 0, IPROTO_REPLACE, NULL);
 }
 
 struct tuple *
@@ -317,7 +348,8 @@ vy_stmt_replace_from_upsert(struct tuple_format *replace_format,
 static struct tuple *
 vy_stmt_new_surrogate_from_key(const char *key, enum iproto_type type,
 			       const struct key_def *key_def,
-			       struct tuple_format *format)
+			       struct tuple_format *format,
+			       struct vy_stmt_arena *arena)
 {
 	/**
 	 * UPSERT can't be surrogate. Also any not UPSERT tuple
@@ -352,7 +384,7 @@ vy_stmt_new_surrogate_from_key(const char *key, enum iproto_type type,
 		bsize += key - svp;
 	}
 
-	struct tuple *stmt = vy_stmt_alloc(format, bsize);
+	struct tuple *stmt = vy_stmt_alloc_in(arena, format, bsize);
 	if (stmt == NULL)
 		return NULL;
 
@@ -385,7 +417,7 @@ vy_stmt_new_surrogate_delete_from_key(const char *key,
 				      struct tuple_format *format)
 {
 	return vy_stmt_new_surrogate_from_key(key, IPROTO_DELETE,
-					      key_def, format);
+					      key_def, format, NULL);
 }
 
 static struct tuple *
@@ -427,7 +459,7 @@ vy_stmt_new_surrogate(struct tuple_format *format, const struct tuple *src,
 	}
 	assert(pos <= data + src_size);
 
-	return vy_stmt_new_with_ops(format, data, pos, NULL, 0, type);
+	return vy_stmt_new_with_ops(format, data, pos, NULL, 0, type, NULL);
 }
 
 struct tuple *
@@ -514,7 +546,8 @@ vy_stmt_encode_secondary(const struct tuple *value,
 
 struct tuple *
 vy_stmt_decode(struct xrow_header *xrow, const struct key_def *key_def,
-	       struct tuple_format *format, bool is_primary)
+	       struct tuple_format *format, bool is_primary,
+	       struct vy_stmt_arena *arena)
 {
 	struct request request;
 	request_create(&request, xrow->type);
@@ -523,46 +556,70 @@ vy_stmt_decode(struct xrow_header *xrow, const struct key_def *key_def,
 	if (request_decode(&request, xrow->body->iov_base, xrow->body->iov_len,
 			   key_map) < 0)
 		return NULL;
+	if (request.type == IPROTO_DELETE)
+		return vy_stmt_decode_raw(IPROTO_DELETE, xrow->lsn,
+					  request.key, request.key_end,
+					  NULL, NULL, key_def, format,
+					  is_primary, arena);
+	return vy_stmt_decode_raw(request.type, xrow->lsn,
+				  request.tuple, request.tuple_end,
+				  request.ops, request.ops_end,
+				  key_def, format, is_primary, arena);
+}
+
+struct tuple *
+vy_stmt_decode_raw(enum iproto_type type, int64_t lsn,
+		   const char *data, const char *data_end,
+		   const char *ops, const char *ops_end,
+		   const struct key_def *key_def,
+		   struct tuple_format *format, bool is_primary,
+		   struct vy_stmt_arena *arena)
+{
 	struct tuple *stmt = NULL;
-	const char *key;
-	(void) key;
-	struct iovec ops;
-	switch (request.type) {
+	struct iovec ops_iov;
+	switch (type) {
 	case IPROTO_DELETE:
 		/* extract key */
-		stmt = vy_stmt_new_surrogate_from_key(request.key,
-						      IPROTO_DELETE,
-						      key_def, format);
+		stmt = vy_stmt_new_surrogate_from_key(data, IPROTO_DELETE,
+						      key_def, format, arena);
 		break;
 	case IPROTO_REPLACE:
 		if (is_primary) {
-			stmt = vy_stmt_new_replace(format, request.tuple,
-					    request.tuple_end);
+			/* REPLACE mustn't have n_upserts field. */
+			assert(format->extra_size != sizeof(uint8_t));
+			stmt = vy_stmt_new_with_ops(format, data, data_end,
+						    NULL, 0, IPROTO_REPLACE,
+						    arena);
 		} else {
-			stmt = vy_stmt_new_surrogate_from_key(request.tuple,
+			stmt = vy_stmt_new_surrogate_from_key(data,
 							      IPROTO_REPLACE,
-							      key_def, format);
+							      key_def, format,
+							      arena);
 		}
 		break;
 	case IPROTO_UPSERT:
-		ops.iov_base = (char *)request.ops;
-		ops.iov_len = request.ops_end - request.ops;
-		stmt = vy_stmt_new_upsert(format, request.tuple,
-					  request.tuple_end, &ops, 1);
+		ops_iov.iov_base = (char *)ops;
+		ops_iov.iov_len = ops_end - ops;
+		/* UPSERT must have the n_upserts field. */
+		assert(format->extra_size == sizeof(uint8_t));
+		stmt = vy_stmt_new_with_ops(format, data, data_end,
+					    &ops_iov, 1, IPROTO_UPSERT, arena);
+		if (stmt != NULL)
+			vy_stmt_set_n_upserts(stmt, 0);
 		break;
 	default:
 		/* TODO: report filename. */
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 tt_sprintf("Can't decode statement: "
 				    "unknown request type %u",
-				    (unsigned)request.type));
+				    (unsigned)type));
 		return NULL;
 	}
 
 	if (stmt == NULL)
 		return NULL; /* OOM */
 
-	vy_stmt_set_lsn(stmt, xrow->lsn);
+	vy_stmt_set_lsn(stmt, lsn);
 	return stmt;
 }
 
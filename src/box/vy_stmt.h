@@ -42,6 +42,7 @@
 #include "tuple.h"
 #include "tuple_compare.h"
 #include "iproto_constants.h"
+#include "vy_stmt_arena.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -85,6 +86,8 @@ struct vy_stmt {
 	struct tuple base;
 	int64_t lsn;
 	uint8_t  type; /* IPROTO_SELECT/REPLACE/UPSERT/DELETE */
+	/** Set if the statement is allocated from vy_stmt_arena. */
+	bool in_arena;
 	/**
 	 * Number of UPSERT statements for the same key preceding
 	 * this statement. Used to trigger upsert squashing in the
@@ -543,12 +546,33 @@ vy_stmt_encode_secondary(const struct tuple *value,
 /**
  * Reconstruct vinyl tuple info and data from xrow
  *
+ * If @arena is not NULL, the statement is allocated from it,
+ * otherwise with malloc().
+ *
  * @retval stmt on success
  * @retval NULL on error
  */
 struct tuple *
 vy_stmt_decode(struct xrow_header *xrow, const struct key_def *key_def,
-	       struct tuple_format *format, bool is_primary);
+	       struct tuple_format *format, bool is_primary,
+	       struct vy_stmt_arena *arena);
+
+/**
+ * Same as vy_stmt_decode(), but takes the statement fields
+ * already decoded: @a data is the key for DELETE and REPLACE in
+ * a secondary index and the tuple otherwise, @a ops is only set
+ * for UPSERT.
+ *
+ * @retval stmt on success
+ * @retval NULL on error
+ */
+struct tuple *
+vy_stmt_decode_raw(enum iproto_type type, int64_t lsn,
+		   const char *data, const char *data_end,
+		   const char *ops, const char *ops_end,
+		   const struct key_def *key_def,
+		   struct tuple_format *format, bool is_primary,
+		   struct vy_stmt_arena *arena);
 
 /**
  * Format a key into string.
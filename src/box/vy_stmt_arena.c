@@ -0,0 +1,174 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "vy_stmt_arena.h"
+
+#include <assert.h>
+#include <small/slab_cache.h>
+
+#include "trivia/util.h"
+#include "diag.h"
+#include "fiber.h"
+
+/** A slab of a statement arena, @sa struct vy_stmt_arena. */
+struct vy_stmt_slab {
+	/** Arena the slab belongs to. */
+	struct vy_stmt_arena *arena;
+	/** Slab allocated from the slab cache. */
+	struct slab *slab;
+	/** Size of the slab memory, including this header. */
+	uint32_t size;
+	/** Offset of the unused slab memory. */
+	uint32_t used;
+	/** Number of statements allocated from the slab and not freed. */
+	uint32_t stmt_count;
+};
+
+void
+vy_stmt_arena_create(struct vy_stmt_arena *arena)
+{
+	arena->cache = NULL;
+	arena->curr = NULL;
+	arena->spare = NULL;
+	arena->slab_count = 0;
+}
+
+void
+vy_stmt_arena_destroy(struct vy_stmt_arena *arena)
+{
+	if (arena->curr != NULL) {
+		assert(arena->curr->stmt_count == 0);
+		slab_put(arena->cache, arena->curr->slab);
+		arena->slab_count--;
+	}
+	if (arena->spare != NULL) {
+		slab_put(arena->cache, arena->spare->slab);
+		arena->slab_count--;
+	}
+	/* All statements must have been freed. */
+	assert(arena->slab_count == 0);
+	vy_stmt_arena_create(arena);
+}
+
+/**
+ * Get an empty slab with room for @a size bytes, either the spare
+ * one or a new one allocated from the slab cache.
+ */
+static struct vy_stmt_slab *
+vy_stmt_arena_get_slab(struct vy_stmt_arena *arena, uint32_t size)
+{
+	struct vy_stmt_slab *s = arena->spare;
+	if (s != NULL && s->used + size <= s->size) {
+		arena->spare = NULL;
+		return s;
+	}
+	size_t slab_size = MAX(sizeof(*s) + size, VY_STMT_SLAB_SIZE);
+	struct slab *slab = slab_get(arena->cache, slab_size);
+	if (slab == NULL) {
+		diag_set(OutOfMemory, slab_size, "slab_get", "vy_stmt_slab");
+		return NULL;
+	}
+	arena->slab_count++;
+	s = (struct vy_stmt_slab *) ((char *) slab + slab_sizeof());
+	s->arena = arena;
+	s->slab = slab;
+	s->size = slab_capacity(slab);
+	s->used = sizeof(*s);
+	s->stmt_count = 0;
+	return s;
+}
+
+/**
+ * Return a slab all statements of which have been freed to
+ * the arena. The slab is kept as spare or freed.
+ */
+static void
+vy_stmt_arena_put_slab(struct vy_stmt_arena *arena, struct vy_stmt_slab *s)
+{
+	assert(s->stmt_count == 0);
+	s->used = sizeof(*s);
+	if (arena->spare == NULL) {
+		arena->spare = s;
+		return;
+	}
+	slab_put(arena->cache, s->slab);
+	arena->slab_count--;
+}
+
+/* Every statement is preceded by a pointer to its slab. */
+void *
+vy_stmt_arena_alloc(struct vy_stmt_arena *arena, uint32_t size)
+{
+	if (arena->cache == NULL)
+		arena->cache = cord_slab_cache();
+	assert(arena->cache == cord_slab_cache());
+
+	/* Keep statements aligned for vy_stmt::lsn. */
+	size = (sizeof(struct vy_stmt_slab *) + size + sizeof(int64_t) - 1) &
+		~(sizeof(int64_t) - 1);
+	struct vy_stmt_slab *s = arena->curr;
+	if (s == NULL || s->used + size > s->size) {
+		s = vy_stmt_arena_get_slab(arena, size);
+		if (s == NULL)
+			return NULL;
+		/*
+		 * The previous slab is returned to the arena when
+		 * its last statement is freed.
+		 */
+		struct vy_stmt_slab *prev = arena->curr;
+		arena->curr = s;
+		if (prev != NULL && prev->stmt_count == 0)
+			vy_stmt_arena_put_slab(arena, prev);
+	}
+	struct vy_stmt_slab **ptr =
+		(struct vy_stmt_slab **) ((char *) s + s->used);
+	*ptr = s;
+	s->used += size;
+	s->stmt_count++;
+	return ptr + 1;
+}
+
+void
+vy_stmt_arena_free(void *stmt)
+{
+	struct vy_stmt_slab *s = ((struct vy_stmt_slab **) stmt)[-1];
+	struct vy_stmt_arena *arena = s->arena;
+	assert(arena->cache == cord_slab_cache());
+	assert(s->stmt_count > 0);
+	if (--s->stmt_count > 0)
+		return;
+	if (s == arena->curr) {
+		/* Start over with the current slab. */
+		s->used = sizeof(*s);
+		return;
+	}
+	vy_stmt_arena_put_slab(arena, s);
+}
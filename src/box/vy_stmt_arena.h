@@ -0,0 +1,105 @@
+#ifndef INCLUDES_TARANTOOL_BOX_VY_STMT_ARENA_H
+#define INCLUDES_TARANTOOL_BOX_VY_STMT_ARENA_H
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct slab_cache;
+struct vy_stmt_slab;
+
+enum {
+	/** Size of a slab of a statement arena. */
+	VY_STMT_SLAB_SIZE = 128 * 1024,
+};
+
+/**
+ * Allocator of statements read from run pages by a write
+ * iterator during dump and compaction, @sa vy_stmt_decode().
+ *
+ * Statements are allocated from big slabs with a bump pointer
+ * instead of a malloc() per statement. Each slab counts the
+ * statements allocated from it that haven't been freed yet.
+ * Once the counter drops to zero, the slab is reused from the
+ * beginning, so that memory of statements of pages that have
+ * been written out is recycled.
+ *
+ * The arena is bound to the thread that allocates the first
+ * statement from it. All statements must be freed and the arena
+ * must be destroyed in the same thread.
+ */
+struct vy_stmt_arena {
+	/** Slab cache of the thread using the arena. */
+	struct slab_cache *cache;
+	/** Slab statements are currently allocated from. */
+	struct vy_stmt_slab *curr;
+	/** Empty slab kept for reuse. */
+	struct vy_stmt_slab *spare;
+	/** Number of slabs allocated from the slab cache. */
+	uint32_t slab_count;
+};
+
+/** Initialize an empty statement arena. */
+void
+vy_stmt_arena_create(struct vy_stmt_arena *arena);
+
+/**
+ * Free all memory of a statement arena.
+ * @pre All statements allocated from the arena are freed.
+ */
+void
+vy_stmt_arena_destroy(struct vy_stmt_arena *arena);
+
+/**
+ * Allocate @a size bytes for a statement from an arena.
+ * A statement larger than VY_STMT_SLAB_SIZE gets a slab of
+ * its own.
+ *
+ * @retval not NULL Success.
+ * @retval     NULL Memory error.
+ */
+void *
+vy_stmt_arena_alloc(struct vy_stmt_arena *arena, uint32_t size);
+
+/** Free a statement allocated with vy_stmt_arena_alloc(). */
+void
+vy_stmt_arena_free(void *stmt);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* INCLUDES_TARANTOOL_BOX_VY_STMT_ARENA_H */
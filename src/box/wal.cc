@@ -30,6 +30,8 @@
  */
 #include "wal.h"
 
+#include <fcntl.h>
+
 #include "vclock.h"
 #include "fiber.h"
 #include "fio.h"
@@ -53,6 +55,14 @@ wal_write(struct journal *, struct journal_entry *);
 static int64_t
 wal_write_in_wal_mode_none(struct journal *, struct journal_entry *);
 
+enum {
+	/**
+	 * Disk space preallocated for a WAL file ahead of the
+	 * current write position, @sa xlog_fallocate().
+	 */
+	WAL_FALLOCATE_LEN = 16 * 1024 * 1024,
+};
+
 /* WAL thread. */
 struct wal_thread {
 	/** 'wal' thread doing the writes. */
@@ -89,6 +99,14 @@ struct wal_writer
 	int64_t wal_max_size;
 	/** Another one - wal_mode */
 	enum wal_mode wal_mode;
+	/**
+	 * A setting from instance configuration -
+	 * wal_writeback_interval. In 'write' mode, start
+	 * writeback of a WAL file every so many bytes, so that
+	 * the kernel doesn't have to flush a lot of dirty pages
+	 * at once. 0 means writeback is left to the kernel.
+	 */
+	int64_t wal_writeback_interval;
 	/** wal_dir, from the configuration file. */
 	struct xdir wal_dir;
 	/**
@@ -105,6 +123,15 @@ struct wal_writer
 	struct vclock vclock;
 	/** The current WAL file. */
 	struct xlog current_wal;
+	/**
+	 * The file created in advance to become the next WAL
+	 * file or -1, @sa wal_prepare_spare().
+	 */
+	int spare_fd;
+	/** Disk space preallocated for the spare file. */
+	off_t spare_size;
+	/** The fiber creating the spare file or NULL. */
+	struct fiber *spare_fiber;
 	/**
 	 * Used if there was a WAL I/O error and we need to
 	 * keep adding all incoming requests to the rollback
@@ -265,16 +292,20 @@ static void
 wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 		  const char *wal_dirname, const struct tt_uuid *instance_uuid,
 		  struct vclock *vclock, int64_t wal_max_rows,
-		  int64_t wal_max_size)
+		  int64_t wal_max_size, int64_t wal_writeback_interval)
 {
 	writer->wal_mode = wal_mode;
 	writer->wal_max_rows = wal_max_rows;
 	writer->wal_max_size = wal_max_size;
+	writer->wal_writeback_interval = wal_writeback_interval;
 	journal_create(&writer->base, wal_mode == WAL_NONE ?
 		       wal_write_in_wal_mode_none : wal_write, NULL);
 
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, instance_uuid);
 	xlog_clear(&writer->current_wal);
+	writer->spare_fd = -1;
+	writer->spare_size = 0;
+	writer->spare_fiber = NULL;
 	if (wal_mode == WAL_FSYNC)
 		writer->wal_dir.open_wflags |= O_SYNC;
 
@@ -323,14 +354,17 @@ wal_thread_start()
 void
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 const struct tt_uuid *instance_uuid, struct vclock *vclock,
-	 int64_t wal_max_rows, int64_t wal_max_size)
+	 int64_t wal_max_rows, int64_t wal_max_size,
+	 int64_t wal_writeback_interval)
 {
 	assert(wal_max_rows > 1);
+	assert(wal_writeback_interval >= 0);
 
 	struct wal_writer *writer = &wal_writer_singleton;
 
 	wal_writer_create(writer, wal_mode, wal_dirname, instance_uuid,
-			  vclock, wal_max_rows, wal_max_size);
+			  vclock, wal_max_rows, wal_max_size,
+			  wal_writeback_interval);
 
 	xdir_scan_xc(&writer->wal_dir);
 
@@ -462,6 +496,71 @@ wal_collect_garbage(int64_t lsn)
 	fiber_set_cancellable(cancellable);
 }
 
+static ssize_t
+wal_create_spare_cb(va_list ap)
+{
+	struct xdir *dir = va_arg(ap, struct xdir *);
+	off_t size = va_arg(ap, off_t);
+	return xdir_create_spare(dir, size);
+}
+
+static int
+wal_spare_f(va_list ap)
+{
+	struct wal_writer *writer = va_arg(ap, struct wal_writer *);
+	off_t size = MIN(writer->wal_max_size, (int64_t)WAL_FALLOCATE_LEN);
+	int fd = coio_call(wal_create_spare_cb, &writer->wal_dir, size);
+	if (fd < 0) {
+		say_syserror("failed to create a spare WAL file");
+		return 0;
+	}
+	writer->spare_fd = fd;
+	writer->spare_size = size;
+	return 0;
+}
+
+/**
+ * Start creation of the next WAL file in background unless
+ * it's already created or being created, so that rotation
+ * doesn't have to wait for the file system.
+ */
+static void
+wal_prepare_spare(struct wal_writer *writer)
+{
+	if (writer->spare_fiber != NULL) {
+		if (!fiber_is_dead(writer->spare_fiber))
+			return;
+		fiber_join(writer->spare_fiber);
+		writer->spare_fiber = NULL;
+	}
+	if (writer->spare_fd >= 0)
+		return;
+	struct fiber *f = fiber_new("wal_spare", wal_spare_f);
+	if (f == NULL) {
+		/* Not critical, rotation will create a new file. */
+		error_log(diag_last_error(diag_get()));
+		diag_clear(diag_get());
+		return;
+	}
+	fiber_set_joinable(f, true);
+	writer->spare_fiber = f;
+	fiber_start(f, writer);
+}
+
+/** Wait for the spare file creation and remove the file. */
+static void
+wal_remove_spare(struct wal_writer *writer)
+{
+	if (writer->spare_fiber != NULL) {
+		fiber_join(writer->spare_fiber);
+		writer->spare_fiber = NULL;
+	}
+	if (writer->spare_fd >= 0) {
+		xdir_remove_spare(&writer->wal_dir, writer->spare_fd);
+		writer->spare_fd = -1;
+	}
+}
+
 /**
  * If there is no current WAL, try to open it, and close the
  * previous WAL. We close the previous WAL only after opening
@@ -506,14 +605,25 @@ wal_opt_rotate(struct wal_writer *writer)
 	}
 	vclock_copy(vclock, &writer->vclock);
 
-	if (xdir_create_xlog(&writer->wal_dir, &writer->current_wal,
-			     &writer->vclock) != 0) {
+	int rc;
+	if (writer->spare_fd >= 0) {
+		rc = xdir_create_xlog_from_spare(&writer->wal_dir,
+						 &writer->current_wal,
+						 &writer->vclock,
+						 writer->spare_fd,
+						 writer->spare_size);
+		writer->spare_fd = -1;
+	} else {
+		rc = xdir_create_xlog(&writer->wal_dir, &writer->current_wal,
+				      &writer->vclock);
+	}
+	if (rc != 0) {
 		error_log(diag_last_error(diag_get()));
 		free(vclock);
 		return -1;
 	}
 	xdir_add_vclock(&writer->wal_dir, vclock);
-
+	wal_prepare_spare(writer);
 	return 0;
 }
 
@@ -631,6 +741,11 @@ wal_write_to_disk(struct cmsg *msg)
 	 * Iterate over requests (transactions)
 	 */
 	struct journal_entry *entry, *last_commit_entry = NULL;
+	/*
+	 * Preallocation failure is not fatal, the write will
+	 * report the error if the disk is indeed full.
+	 */
+	xlog_fallocate(l, WAL_FALLOCATE_LEN);
 	stailq_foreach_entry(entry, &wal_msg->commit, fifo) {
 		wal_assign_lsn(writer, entry->rows, entry->rows + entry->n_rows);
 		entry->res = vclock_sum(&writer->vclock);
@@ -646,6 +761,18 @@ wal_write_to_disk(struct cmsg *msg)
 
 	last_commit_entry = stailq_last_entry(&wal_msg->commit,
 					      struct journal_entry, fifo);
+#ifdef HAVE_SYNC_FILE_RANGE
+	if (writer->wal_mode == WAL_WRITE &&
+	    writer->wal_writeback_interval > 0 &&
+	    l->offset >= (off_t)(l->synced_size +
+				 writer->wal_writeback_interval)) {
+		/* Don't wait for writeback to complete. */
+		sync_file_range(l->fd, l->synced_size,
+				l->offset - l->synced_size,
+				SYNC_FILE_RANGE_WRITE);
+		l->synced_size = l->offset;
+	}
+#endif /* HAVE_SYNC_FILE_RANGE */
 
 done:
 	struct error *error = diag_last_error(diag_get());
@@ -706,6 +833,8 @@ wal_thread_f(va_list ap)
 	if (xlog_is_open(&writer->current_wal))
 		xlog_close(&writer->current_wal, false);
 
+	wal_remove_spare(writer);
+
 	if (xlog_is_open(&vy_log_writer.xlog))
 		xlog_close(&vy_log_writer.xlog, false);
 
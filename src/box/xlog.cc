@@ -32,6 +32,8 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <ctype.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "fiber.h"
 #include "crc32.h"
@@ -132,7 +134,14 @@ enum {
 #define INSTANCE_UUID_KEY "Instance"
 #define INSTANCE_UUID_KEY_V12 "Server"
 #define VCLOCK_KEY "VClock"
+#define BASE_KEY "Base"
 
+/**
+ * Delta snapshots depend on the snapshot they are based on, so
+ * they are written with a version older binaries don't support,
+ * lest they should load such a snapshot as a full one.
+ */
+static const char v14[] = "0.14";
 static const char v13[] = "0.13";
 static const char v12[] = "0.12";
 
@@ -155,9 +164,16 @@ xlog_meta_format(const struct xlog_meta *meta, char *buf, int size)
 	if (vstr == NULL)
 		return -1;
 	char *instance_uuid = tt_uuid_str(&meta->instance_uuid);
+	char base[32] = "";
+	const char *version = v13;
+	if (meta->base_signature >= 0) {
+		snprintf(base, sizeof(base), BASE_KEY ": %lld\n",
+			 (long long) meta->base_signature);
+		version = v14;
+	}
 	int total = snprintf(buf, size, "%s\n%s\n" INSTANCE_UUID_KEY ": "
-		"%s\n" VCLOCK_KEY ": %s\n\n",
-		 meta->filetype, v13, instance_uuid, vstr);
+		"%s\n" VCLOCK_KEY ": %s\n%s\n",
+		 meta->filetype, version, instance_uuid, vstr, base);
 	assert(total > 0);
 	free(vstr);
 	return total;
@@ -176,6 +192,7 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 		const char *data_end)
 {
 	memset(meta, 0, sizeof(*meta));
+	meta->base_signature = -1;
 	const char *end = (const char *)memmem(*data, data_end - *data,
 					       "\n\n", 2);
 	if (end == NULL)
@@ -197,7 +214,7 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 	assert(pos <= end);
 
 	/*
-	 * Parse version string, i.e. "0.12" or "0.13"
+	 * Parse version string, i.e. "0.12", "0.13" or "0.14"
 	 */
 	char version[10];
 	eol = (const char *)memchr(pos, '\n', end - pos);
@@ -210,7 +227,8 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 	pos = eol + 1;
 	assert(pos <= end);
 	if (strncmp(version, v12, sizeof(v12)) != 0 &&
-	    strncmp(version, v13, sizeof(v13)) != 0) {
+	    strncmp(version, v13, sizeof(v13)) != 0 &&
+	    strncmp(version, v14, sizeof(v14)) != 0) {
 		tnt_error(XlogError,
 			  "unsupported file format version %s",
 			  version);
@@ -271,6 +289,18 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 					  "offset %zd", off);
 				return -1;
 			}
+		} else if (memcmp(key, BASE_KEY, key_end - key) == 0) {
+			/*
+			 * Base: <signature>
+			 */
+			char *base_end;
+			long long base = strtoll(val, &base_end, 10);
+			if (base_end != val_end || base < 0) {
+				tnt_error(XlogError, "can't parse base "
+					  "signature");
+				return -1;
+			}
+			meta->base_signature = base;
 		} else {
 			/*
 			 * Unknown key
@@ -279,6 +309,11 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 				 key);
 		}
 	}
+	if (strncmp(version, v14, sizeof(v14)) == 0 &&
+	    meta->base_signature < 0) {
+		tnt_error(XlogError, "missing base signature");
+		return -1;
+	}
 	*data = end + 1; /* skip the last trailing \n of \n\n sequence */
 	return 0;
 }
@@ -709,9 +744,15 @@ xlog_destroy(struct xlog *xlog)
 	xlog->fd = -1;
 }
 
-int
-xlog_create(struct xlog *xlog, const char *name,
-	    const struct xlog_meta *meta)
+/**
+ * Create a new log file. If @a spare_fd is not negative,
+ * the spare file @a spare_name is renamed and used instead
+ * of creating a new one, @sa xdir_create_spare().
+ */
+static int
+xlog_create_impl(struct xlog *xlog, const char *name,
+		 const struct xlog_meta *meta, int spare_fd,
+		 const char *spare_name, off_t spare_size)
 {
 	char meta_buf[XLOG_META_LEN_MAX];
 	int meta_len;
@@ -742,7 +783,25 @@ xlog_create(struct xlog *xlog, const char *name,
 	 * may think that this is a corrupt file and stop
 	 * replication.
 	 */
-	xlog->fd = open(xlog->filename, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (spare_fd >= 0) {
+		/*
+		 * The spare file is empty, so the rename is as
+		 * good as creating a new file.
+		 */
+		if (rename(spare_name, xlog->filename) != 0) {
+			say_syserror("can't rename %s to %s", spare_name,
+				     xlog->filename);
+			diag_set(SystemError, "failed to rename '%s' file",
+				 spare_name);
+			goto err_open;
+		}
+		xlog->fd = spare_fd;
+		xlog->allocated = spare_size;
+		spare_fd = -1;
+	} else {
+		xlog->fd = open(xlog->filename, O_RDWR | O_CREAT | O_EXCL,
+				0644);
+	}
 	if (xlog->fd < 0) {
 		say_syserror("open, [%s]", name);
 		diag_set(SystemError, "failed to create file '%s'", name);
@@ -770,9 +829,20 @@ err_write:
 err_open:
 	xlog_destroy(xlog);
 err:
+	if (spare_fd >= 0) {
+		close(spare_fd);
+		unlink(spare_name);
+	}
 	return -1;
 }
 
+int
+xlog_create(struct xlog *xlog, const char *name,
+	    const struct xlog_meta *meta)
+{
+	return xlog_create_impl(xlog, name, meta, -1, NULL, 0);
+}
+
 int
 xlog_open(struct xlog *xlog, const char *name)
 {
@@ -847,6 +917,24 @@ err:
 int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock)
+{
+	return xdir_create_xlog_delta(dir, xlog, vclock, -1);
+}
+
+/** Name of the spare file, @sa xdir_create_spare(). */
+static char *
+xdir_format_spare_filename(struct xdir *dir)
+{
+	static __thread char filename[PATH_MAX + 1];
+	snprintf(filename, PATH_MAX, "%s/spare%s%s", dir->dirname,
+		 dir->filename_ext, inprogress_suffix);
+	return filename;
+}
+
+static int
+xdir_create_xlog_impl(struct xdir *dir, struct xlog *xlog,
+		      const struct vclock *vclock, int64_t base_signature,
+		      int spare_fd, off_t spare_size)
 {
 	char *filename;
 	int64_t signature = vclock_sum(vclock);
@@ -864,8 +952,11 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	snprintf(meta.filetype, sizeof(meta.filetype), "%s", dir->filetype);
 	meta.instance_uuid = *dir->instance_uuid;
 	vclock_copy(&meta.vclock, vclock);
+	meta.base_signature = base_signature;
 
-	if (xlog_create(xlog, filename, &meta) != 0)
+	if (xlog_create_impl(xlog, filename, &meta, spare_fd,
+			     xdir_format_spare_filename(dir),
+			     spare_size) != 0)
 		return -1;
 
 	/* set sync interval from xdir settings */
@@ -885,6 +976,82 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	return 0;
 }
 
+int
+xdir_create_xlog_delta(struct xdir *dir, struct xlog *xlog,
+		       const struct vclock *vclock, int64_t base_signature)
+{
+	return xdir_create_xlog_impl(dir, xlog, vclock, base_signature,
+				     -1, 0);
+}
+
+int
+xdir_create_spare(struct xdir *dir, off_t size)
+{
+	const char *filename = xdir_format_spare_filename(dir);
+	int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return -1;
+#ifdef HAVE_FALLOCATE
+	/*
+	 * Keep the file size intact: the file must look empty
+	 * to readers, which treat zeros as a corruption.
+	 */
+	if (fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size) != 0 &&
+	    errno != EOPNOTSUPP) {
+		int save_errno = errno;
+		close(fd);
+		unlink(filename);
+		errno = save_errno;
+		return -1;
+	}
+#else
+	(void) size;
+#endif /* HAVE_FALLOCATE */
+	return fd;
+}
+
+int
+xdir_create_xlog_from_spare(struct xdir *dir, struct xlog *xlog,
+			    const struct vclock *vclock, int fd, off_t size)
+{
+	assert(fd >= 0);
+	return xdir_create_xlog_impl(dir, xlog, vclock, -1, fd, size);
+}
+
+void
+xdir_remove_spare(struct xdir *dir, int fd)
+{
+	close(fd);
+	unlink(xdir_format_spare_filename(dir));
+}
+
+/**
+ * Encode a tx block fixheader: magic, length of the block body,
+ * crc32 of the body and a padding to XLOG_FIXHEADER_SIZE.
+ */
+static void
+xlog_fixheader_encode(char *fixheader, log_magic_t magic, uint32_t len,
+		      uint32_t crc32c)
+{
+	*(log_magic_t *)fixheader = magic;
+	char *data = fixheader + sizeof(log_magic_t);
+	data = mp_encode_uint(data, len);
+	/* Encode crc32 for previous row */
+	data = mp_encode_uint(data, 0);
+	/* Encode crc32 for current row */
+	data = mp_encode_uint(data, crc32c);
+	/*
+	 * Encode a padding, to ensure the resulting
+	 * fixheader always has the same size.
+	 */
+	ssize_t padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
+	if (padding > 0) {
+		data = mp_encode_strl(data, padding - 1);
+		if (padding > 1)
+			memset(data, 0, padding - 1);
+	}
+}
+
 /**
  * Write a sequence of uncompressed xrow objects.
  *
@@ -899,14 +1066,6 @@ xlog_tx_write_plain(struct xlog *log)
 	 * now populate it with data.
 	 */
 	char *fixheader = (char *)log->obuf.iov[0].iov_base;
-	*(log_magic_t *)fixheader = row_marker;
-	char *data = fixheader + sizeof(log_magic_t);
-
-	data = mp_encode_uint(data,
-			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
 	uint32_t crc32c = 0;
 	struct iovec *iov;
 	size_t offset = XLOG_FIXHEADER_SIZE;
@@ -916,19 +1075,9 @@ xlog_tx_write_plain(struct xlog *log)
 				    iov->iov_len - offset);
 		offset = 0;
 	}
-	data = mp_encode_uint(data, crc32c);
-	/*
-	 * Encode a padding, to ensure the resulting
-	 * fixheader always has the same size.
-	 */
-	ssize_t padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
-	}
+	xlog_fixheader_encode(fixheader, row_marker,
+			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE,
+			      crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
@@ -1008,25 +1157,9 @@ xlog_tx_write_zstd(struct xlog *log)
 		offset = 0;
 	}
 
-	*(log_magic_t *)fixheader = zrow_marker;
-	char *data;
-	data = fixheader + sizeof(log_magic_t);
-	data = mp_encode_uint(data,
-			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
-	data = mp_encode_uint(data, crc32c);
-	/* Encode padding */
-	ssize_t padding;
-	padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
-	}
+	xlog_fixheader_encode(fixheader, zrow_marker,
+			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE,
+			      crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
@@ -1274,12 +1407,43 @@ xlog_sync(struct xlog *l)
 	return 0;
 }
 
+int
+xlog_fallocate(struct xlog *log, size_t len)
+{
+#ifdef HAVE_FALLOCATE
+	if (log->fallocate_failed ||
+	    log->allocated >= log->offset + (off_t)(len / 2))
+		return 0;
+	if (fallocate(log->fd, FALLOC_FL_KEEP_SIZE, log->offset, len) != 0) {
+		log->fallocate_failed = true;
+		if (errno == EOPNOTSUPP)
+			return 0;
+		say_syserror("%s: fallocate failed", log->filename);
+		return -1;
+	}
+	log->allocated = log->offset + len;
+#else
+	(void) log;
+	(void) len;
+#endif /* HAVE_FALLOCATE */
+	return 0;
+}
+
 int
 xlog_close(struct xlog *l, bool reuse_fd)
 {
 	int rc = fio_writen(l->fd, &eof_marker, sizeof(log_magic_t));
 	if (rc < 0)
 		say_syserror("%s: failed to write EOF marker", l->filename);
+	/*
+	 * Release disk space preallocated beyond the end
+	 * of the file.
+	 */
+	if (l->allocated > l->offset) {
+		off_t size = l->offset + (rc < 0 ? 0 : sizeof(log_magic_t));
+		if (ftruncate(l->fd, size) != 0)
+			say_syserror("%s: ftruncate() failed", l->filename);
+	}
 
 	/*
 	 * Sync the file before closing, since
@@ -1328,6 +1492,9 @@ xlog_atfork(struct xlog *xlog)
  * @retval 1 if eof
  * @retval -1 if error
  */
+static int
+xlog_cursor_unmap(struct xlog_cursor *cursor);
+
 static int
 xlog_cursor_ensure(struct xlog_cursor *cursor, size_t count)
 {
@@ -1336,6 +1503,17 @@ xlog_cursor_ensure(struct xlog_cursor *cursor, size_t count)
 	/* in-memory mode */
 	if (cursor->fd < 0)
 		return 1;
+	if (cursor->map != NULL) {
+		if (cursor->state == XLOG_CURSOR_EOF)
+			return 1;
+		/*
+		 * The mapped area ended before the eof marker row:
+		 * the file is being appended and what looked like
+		 * the marker was row data. Go on with pread().
+		 */
+		if (xlog_cursor_unmap(cursor) != 0)
+			return -1;
+	}
 
 	size_t to_load = count - ibuf_used(&cursor->rbuf);
 	to_load += XLOG_READ_AHEAD;
@@ -1573,14 +1751,9 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 	ibuf_create(&tx_cursor->rows, &cord()->slabc,
 		    XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	if (fixheader.magic == row_marker) {
-		void *dst = ibuf_alloc(&tx_cursor->rows, fixheader.len);
-		if (dst == NULL) {
-			diag_set(OutOfMemory, fixheader.len,
-				 "runtime", "xlog rows buffer");
-			ibuf_destroy(&tx_cursor->rows);
-			return -1;
-		}
-		memcpy(dst, rpos, fixheader.len);
+		/* Decode rows in place, without copying. */
+		tx_cursor->rpos = rpos;
+		tx_cursor->rend = rpos + fixheader.len;
 		*data = (char *)rpos + fixheader.len;
 		assert(*data <= data_end);
 		return 0;
@@ -1603,6 +1776,8 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 	if (rc != 0)
 		return -1;
 
+	tx_cursor->rpos = tx_cursor->rows.rpos;
+	tx_cursor->rend = tx_cursor->rows.wpos;
 	*data = rpos;
 	assert(*data <= data_end);
 	return 0;
@@ -1612,16 +1787,15 @@ int
 xlog_tx_cursor_next_row(struct xlog_tx_cursor *tx_cursor,
 		        struct xrow_header *xrow)
 {
-	if (ibuf_used(&tx_cursor->rows) == 0)
+	if (tx_cursor->rpos == tx_cursor->rend)
 		return 1;
 	/* Return row from xlog tx buffer */
-	int rc = xrow_header_decode(xrow,
-				    (const char **)&tx_cursor->rows.rpos,
-				    (const char *)tx_cursor->rows.wpos);
+	int rc = xrow_header_decode(xrow, &tx_cursor->rpos,
+				    tx_cursor->rend);
 	if (rc != 0) {
 		tnt_error(XlogError, "can't parse row");
 		/* Discard remaining row data */
-		ibuf_reset(&tx_cursor->rows);
+		tx_cursor->rpos = tx_cursor->rend;
 		return -1;
 	}
 
@@ -1635,6 +1809,41 @@ xlog_tx_cursor_destroy(struct xlog_tx_cursor *tx_cursor)
 	return 0;
 }
 
+ssize_t
+xlog_tx_encode(ZSTD_CCtx *zctx, int level, const char *data, size_t size,
+	       struct ibuf *out)
+{
+	size_t zmax_size = ZSTD_compressBound(size);
+	char *fixheader = (char *)ibuf_alloc(out, XLOG_FIXHEADER_SIZE +
+					     zmax_size);
+	if (fixheader == NULL) {
+		diag_set(OutOfMemory, XLOG_FIXHEADER_SIZE + zmax_size,
+			 "runtime", "xlog tx block");
+		return -1;
+	}
+	char *body = fixheader + XLOG_FIXHEADER_SIZE;
+	size_t zsize = ZSTD_compressCCtx(zctx, body, zmax_size,
+					 data, size, level);
+	if (ZSTD_isError(zsize)) {
+		out->wpos = fixheader;
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZSTD_getErrorName(zsize));
+		return -1;
+	}
+	log_magic_t magic = zrow_marker;
+	if (zsize >= size) {
+		/* Incompressible data, store it as is. */
+		memcpy(body, data, size);
+		magic = row_marker;
+		zsize = size;
+	}
+	out->wpos = body + zsize;
+
+	xlog_fixheader_encode(fixheader, magic, zsize,
+			      crc32_calc(0, body, zsize));
+	return XLOG_FIXHEADER_SIZE + zsize;
+}
+
 /**
  * Find a next xlog tx magic
  */
@@ -1715,6 +1924,48 @@ eof:
 	return 1;
 }
 
+int
+xlog_cursor_next_block(struct xlog_cursor *i, off_t *offset, size_t *size)
+{
+	assert(i->fd >= 0);
+	assert(i->state == XLOG_CURSOR_ACTIVE);
+
+	int rc = xlog_cursor_ensure(i, sizeof(log_magic_t));
+	if (rc != 0)
+		return rc;
+	if (load_u32(i->rbuf.rpos) == eof_marker) {
+		i->state = XLOG_CURSOR_EOF;
+		rc = xlog_cursor_ensure(i, sizeof(log_magic_t) + sizeof(char));
+		if (rc < 0)
+			return -1;
+		if (rc == 0) {
+			tnt_error(XlogError, "%s: has some data after "
+				  "eof marker at %lld", i->name,
+				  xlog_cursor_pos(i));
+			return -1;
+		}
+		return 1;
+	}
+	rc = xlog_cursor_ensure(i, XLOG_FIXHEADER_SIZE);
+	if (rc != 0)
+		return rc;
+	struct xlog_fixheader fixheader;
+	const char *pos = i->rbuf.rpos;
+	if (xlog_fixheader_decode(&fixheader, &pos, i->rbuf.wpos) != 0)
+		return -1;
+
+	*offset = xlog_cursor_pos(i);
+	*size = XLOG_FIXHEADER_SIZE + fixheader.len;
+	if (ibuf_used(&i->rbuf) >= *size) {
+		i->rbuf.rpos += *size;
+	} else {
+		/* Don't read the block, it's going to be sent as is. */
+		ibuf_reset(&i->rbuf);
+		i->read_offset = *offset + *size;
+	}
+	return 0;
+}
+
 int
 xlog_cursor_next_row(struct xlog_cursor *cursor, struct xrow_header *xrow)
 {
@@ -1761,13 +2012,100 @@ xlog_cursor_next(struct xlog_cursor *cursor,
 	return 0;
 }
 
+/** Files smaller than this are always read with pread(). */
+#define XLOG_CURSOR_MMAP_MIN	(1 << 20)
+
+/**
+ * Map the file of a cursor into memory and make the read
+ * buffer point to the mapped area. Only files which end with
+ * the eof marker are mapped: a file without the marker may be
+ * still being appended (the current WAL read by a relay), and
+ * the cursor has to see new rows. The last bytes of a file
+ * being appended may happen to match the marker, so the file
+ * is unmapped and read with pread() if the mapped area ends
+ * before the marker is met at a tx boundary.
+ *
+ * @retval 0 the file is mapped
+ * @retval 1 the file should be read with pread()
+ */
+static int
+xlog_cursor_map(struct xlog_cursor *i, const char *name)
+{
+	struct stat st;
+	if (fstat(i->fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+	    st.st_size < XLOG_CURSOR_MMAP_MIN)
+		return 1;
+	log_magic_t magic;
+	if (fio_pread(i->fd, &magic, sizeof(magic),
+		      st.st_size - sizeof(magic)) != sizeof(magic) ||
+	    magic != eof_marker)
+		return 1;
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, i->fd, 0);
+	if (map == MAP_FAILED) {
+		say_syserror("failed to map '%s' file", name);
+		return 1;
+	}
+	/* The file is read once from the beginning to the end. */
+	if (madvise(map, st.st_size, MADV_SEQUENTIAL) != 0)
+		say_syserror("madvise, file '%s'", name);
+#ifdef HAVE_POSIX_FADVISE
+	(void) posix_fadvise(i->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif /* HAVE_POSIX_FADVISE */
+	i->map = map;
+	i->map_size = st.st_size;
+	i->rbuf.buf = i->rbuf.rpos = (char *)map;
+	i->rbuf.wpos = i->rbuf.end = (char *)map + st.st_size;
+	i->read_offset = st.st_size;
+	return 0;
+}
+
+/**
+ * Unmap the file of a cursor and copy the unread tail of the
+ * mapped area to a read buffer, so that the rest of the file
+ * is read with pread().
+ */
+static int
+xlog_cursor_unmap(struct xlog_cursor *i)
+{
+	assert(i->map != NULL);
+	size_t used = ibuf_used(&i->rbuf);
+	struct ibuf rbuf;
+	ibuf_create(&rbuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD << 1);
+	void *dst = ibuf_alloc(&rbuf, used);
+	if (dst == NULL) {
+		ibuf_destroy(&rbuf);
+		diag_set(OutOfMemory, used, "runtime",
+			 "xlog cursor read buffer");
+		return -1;
+	}
+	memcpy(dst, i->rbuf.rpos, used);
+	munmap(i->map, i->map_size);
+	i->map = NULL;
+	i->map_size = 0;
+	i->rbuf = rbuf;
+	return 0;
+}
+
+/** Free the read buffer of a cursor or unmap the file. */
+static void
+xlog_cursor_destroy_rbuf(struct xlog_cursor *i)
+{
+	if (i->map != NULL) {
+		munmap(i->map, i->map_size);
+		i->map = NULL;
+	} else {
+		ibuf_destroy(&i->rbuf);
+	}
+}
+
 int
 xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 {
 	memset(i, 0, sizeof(*i));
 	i->fd = fd;
-	ibuf_create(&i->rbuf, &cord()->slabc,
-		    XLOG_TX_AUTOCOMMIT_THRESHOLD << 1);
+	if (xlog_cursor_map(i, name) != 0)
+		ibuf_create(&i->rbuf, &cord()->slabc,
+			    XLOG_TX_AUTOCOMMIT_THRESHOLD << 1);
 
 	ssize_t rc;
 	/*
@@ -1796,7 +2134,7 @@ xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 	i->state = XLOG_CURSOR_ACTIVE;
 	return 0;
 error:
-	ibuf_destroy(&i->rbuf);
+	xlog_cursor_destroy_rbuf(i);
 	return -1;
 }
 
@@ -1862,7 +2200,7 @@ xlog_cursor_close(struct xlog_cursor *i, bool reuse_fd)
 {
 	if (i->fd >= 0 && !reuse_fd)
 		close(i->fd);
-	ibuf_destroy(&i->rbuf);
+	xlog_cursor_destroy_rbuf(i);
 	if (i->state == XLOG_CURSOR_TX)
 		xlog_tx_cursor_destroy(&i->tx_cursor);
 	ZSTD_freeDStream(i->zdctx);
@@ -228,6 +228,12 @@ struct xlog_meta {
 	 * is vector clock *at the time the snapshot is taken.
 	 */
 	struct vclock vclock;
+	/**
+	 * Text file header: signature of the snapshot a delta
+	 * snapshot is based on, or -1 if the file is
+	 * self-contained (@sa memtx_delta.h).
+	 */
+	int64_t base_signature;
 };
 
 /* }}} */
@@ -276,6 +282,17 @@ struct xlog {
 	bool is_autocommit;
 	/** The current offset in the log file, for writing. */
 	off_t offset;
+	/**
+	 * The end of disk space preallocated for the file,
+	 * @sa xlog_fallocate().
+	 */
+	off_t allocated;
+	/**
+	 * Set if preallocation failed or isn't supported by
+	 * the file system. It isn't retried then, so as not
+	 * to flood the log when the disk is full.
+	 */
+	bool fallocate_failed;
 	/**
 	 * Output buffer, works as row accumulator for
 	 * compression.
@@ -330,6 +347,48 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock);
 
+/**
+ * Same as xdir_create_xlog(), but the file header refers
+ * to the file with signature @a base_signature the new file
+ * is a delta against. Used for delta snapshots.
+ */
+int
+xdir_create_xlog_delta(struct xdir *dir, struct xlog *xlog,
+		       const struct vclock *vclock, int64_t base_signature);
+
+/**
+ * Create a spare file in the directory and preallocate
+ * @a size bytes of disk space for it, so that a log file
+ * can be created later with xdir_create_xlog_from_spare()
+ * without touching the file system much. The spare file
+ * is ignored by xdir_scan(). An existing spare file is
+ * truncated.
+ *
+ * The function doesn't use diag and so can be called from
+ * a coio thread.
+ *
+ * @retval >= 0 file descriptor of the spare file
+ * @retval -1 error, errno is set
+ */
+int
+xdir_create_spare(struct xdir *dir, off_t size);
+
+/**
+ * Same as xdir_create_xlog(), but instead of creating a new
+ * file rename the spare file @a fd returned by
+ * xdir_create_spare() and use it. The spare file is closed
+ * on error.
+ *
+ * @param size disk space allocated for the spare file
+ */
+int
+xdir_create_xlog_from_spare(struct xdir *dir, struct xlog *xlog,
+			    const struct vclock *vclock, int fd, off_t size);
+
+/** Close and remove the spare file @a fd of the directory. */
+void
+xdir_remove_spare(struct xdir *dir, int fd);
+
 /**
  * Create new xlog writer based on fd.
  * @param fd            file descriptor
@@ -431,6 +490,20 @@ xlog_flush(struct xlog *log);
 int
 xlog_sync(struct xlog *l);
 
+/**
+ * Preallocate @a len bytes of disk space after the current
+ * write position, so that appending to the file doesn't need
+ * to allocate disk blocks. The file size is not changed.
+ * Does nothing if at least half of @a len bytes is already
+ * allocated, so the function can be called before each write.
+ * Once preallocation fails, it isn't tried again for this file.
+ *
+ * @retval 0 success or preallocation is not supported
+ * @retval -1 error, the error is logged
+ */
+int
+xlog_fallocate(struct xlog *log, size_t len);
+
 /**
  * Close the log file and free xlog object.
  *
@@ -454,8 +527,15 @@ xlog_atfork(struct xlog *xlog);
  */
 struct xlog_tx_cursor
 {
-	/** rows buffer */
+	/** buffer for decompressed rows */
 	struct ibuf rows;
+	/**
+	 * Rows to decode. Uncompressed rows are decoded in place,
+	 * directly from the buffer the tx was read from, so the
+	 * buffer must not be changed until all rows are fetched.
+	 */
+	const char *rpos;
+	const char *rend;
 };
 
 /**
@@ -478,6 +558,25 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *cursor,
 int
 xlog_tx_cursor_destroy(struct xlog_tx_cursor *tx_cursor);
 
+/**
+ * Pack rows encoded with xrow_header_encode() into a tx block
+ * of the format used in xlog files, so that it can be decoded
+ * with xlog_tx_cursor_create(). The rows are compressed with
+ * zstd unless compression doesn't make the block smaller.
+ *
+ * @param zctx  zstd compression context
+ * @param level zstd compression level
+ * @param data  encoded rows
+ * @param size  size of @a data
+ * @param out   buffer to append the block to
+ *
+ * @retval >= 0 size of the block
+ * @retval -1 error, check diag
+ */
+ssize_t
+xlog_tx_encode(ZSTD_CCtx *zctx, int level, const char *data, size_t size,
+	       struct ibuf *out);
+
 /**
  * Fetch next xrow from xlog tx cursor
  *
@@ -530,8 +629,18 @@ struct xlog_cursor
 	int fd;
 	/** associated file name */
 	char name[PATH_MAX];
-	/** file read buffer */
+	/**
+	 * File read buffer. If the file is mapped into memory,
+	 * it points to the mapped area and isn't allocated.
+	 */
 	struct ibuf rbuf;
+	/**
+	 * The file mapped into memory or NULL if the file is
+	 * read with pread(), @sa xlog_cursor_openfd().
+	 */
+	void *map;
+	/** Size of the mapped area. */
+	size_t map_size;
 	/** file read position */
 	off_t read_offset;
 	/** cursor for current tx */
@@ -541,7 +650,15 @@ struct xlog_cursor
 };
 
 /**
- * Open cursor from file descriptor
+ * Open cursor from file descriptor.
+ *
+ * A big file, which has been closed properly and thus ends
+ * with the eof marker, is mapped into memory and its rows
+ * are decoded in place. Other files, including ones that are
+ * still being appended, are read with pread(). A mapped file
+ * is switched to pread() if its rows don't end with the eof
+ * marker, i.e. the marker-like tail was row data.
+ *
  * @param cursor cursor
  * @param fd file descriptor
  * @param name associated file name
@@ -591,6 +708,23 @@ xlog_cursor_close(struct xlog_cursor *cursor, bool reuse_fd);
 int
 xlog_cursor_next_tx(struct xlog_cursor *cursor);
 
+/**
+ * Skip the next tx of a file cursor without decoding it and
+ * return its position in the file. The block, including its
+ * fixheader, can be decoded with xlog_tx_cursor_create().
+ * Used to send snapshot blocks as is.
+ *
+ * @param cursor cursor, must not be in the middle of a tx
+ * @param[out] offset offset of the block in the file
+ * @param[out] size size of the block
+ * @retval 0 succes
+ * @retval 1 eof
+ * @retval -1 error, check diag
+ */
+int
+xlog_cursor_next_block(struct xlog_cursor *cursor, off_t *offset,
+		       size_t *size);
+
 /**
  * Fetch next xrow from current xlog tx
  *
@@ -733,6 +867,19 @@ xlog_cursor_next_xc(struct xlog_cursor *cursor,
 	return rc;
 }
 
+/**
+ * @copydoc xlog_cursor_next_block
+ */
+static inline int
+xlog_cursor_next_block_xc(struct xlog_cursor *cursor, off_t *offset,
+			  size_t *size)
+{
+	int rc = xlog_cursor_next_block(cursor, offset, size);
+	if (rc == -1)
+		diag_raise();
+	return rc;
+}
+
 #endif /* defined(__cplusplus) */
 
 #endif /* TARANTOOL_XLOG_H_INCLUDED */
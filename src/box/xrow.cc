@@ -436,7 +436,7 @@ void
 xrow_encode_subscribe(struct xrow_header *row,
 		      const struct tt_uuid *replicaset_uuid,
 		      const struct tt_uuid *instance_uuid,
-		      const struct vclock *vclock)
+		      const struct vclock *vclock, bool raw_blocks)
 {
 	memset(row, 0, sizeof(*row));
 	uint32_t replicaset_size = vclock_size(vclock);
@@ -444,7 +444,7 @@ xrow_encode_subscribe(struct xrow_header *row,
 		(mp_sizeof_uint(UINT32_MAX) + mp_sizeof_uint(UINT64_MAX));
 	char *buf = (char *) region_alloc_xc(&fiber()->gc, size);
 	char *data = buf;
-	data = mp_encode_map(data, 3);
+	data = mp_encode_map(data, raw_blocks ? 4 : 3);
 	data = mp_encode_uint(data, IPROTO_CLUSTER_UUID);
 	data = xrow_encode_uuid(data, replicaset_uuid);
 	data = mp_encode_uint(data, IPROTO_INSTANCE_UUID);
@@ -457,6 +457,10 @@ xrow_encode_subscribe(struct xrow_header *row,
 		data = mp_encode_uint(data, replica.id);
 		data = mp_encode_uint(data, replica.lsn);
 	}
+	if (raw_blocks) {
+		data = mp_encode_uint(data, IPROTO_RAW_BLOCKS);
+		data = mp_encode_bool(data, true);
+	}
 	assert(data <= buf + size);
 	row->body[0].iov_base = buf;
 	row->body[0].iov_len = (data - buf);
@@ -464,9 +468,12 @@ xrow_encode_subscribe(struct xrow_header *row,
 	row->type = IPROTO_SUBSCRIBE;
 }
 
-void
-xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
-		      struct tt_uuid *instance_uuid, struct vclock *vclock)
+/** Decode a body of JOIN or SUBSCRIBE, NULL outputs are skipped. */
+static void
+xrow_decode_replication_body(struct xrow_header *row,
+			     struct tt_uuid *replicaset_uuid,
+			     struct tt_uuid *instance_uuid,
+			     struct vclock *vclock, bool *raw_blocks)
 {
 	if (row->bodycnt == 0)
 		tnt_raise(ClientError, ER_INVALID_MSGPACK, "request body");
@@ -508,6 +515,15 @@ xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 			lsnmap = d;
 			mp_next(&d);
 			break;
+		case IPROTO_RAW_BLOCKS:
+			if (raw_blocks == NULL)
+				goto skip;
+			if (mp_typeof(*d) != MP_BOOL) {
+				tnt_raise(ClientError, ER_INVALID_MSGPACK,
+					  "invalid RAW_BLOCKS");
+			}
+			*raw_blocks = mp_decode_bool(&d);
+			break;
 		default: skip:
 			mp_next(&d); /* value */
 		}
@@ -534,17 +550,33 @@ xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
 }
 
 void
-xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid)
+xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
+		      struct tt_uuid *instance_uuid, struct vclock *vclock,
+		      bool *raw_blocks)
+{
+	if (raw_blocks != NULL)
+		*raw_blocks = false;
+	xrow_decode_replication_body(row, replicaset_uuid, instance_uuid,
+				     vclock, raw_blocks);
+}
+
+void
+xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid,
+		 bool raw_blocks)
 {
 	memset(row, 0, sizeof(*row));
 
 	size_t size = 64;
 	char *buf = (char *) region_alloc_xc(&fiber()->gc, size);
 	char *data = buf;
-	data = mp_encode_map(data, 1);
+	data = mp_encode_map(data, raw_blocks ? 2 : 1);
 	data = mp_encode_uint(data, IPROTO_INSTANCE_UUID);
 	/* Greet the remote replica with our replica UUID */
 	data = xrow_encode_uuid(data, instance_uuid);
+	if (raw_blocks) {
+		data = mp_encode_uint(data, IPROTO_RAW_BLOCKS);
+		data = mp_encode_bool(data, true);
+	}
 	assert(data <= buf + size);
 
 	row->body[0].iov_base = buf;
@@ -553,6 +585,15 @@ xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid)
 	row->type = IPROTO_JOIN;
 }
 
+void
+xrow_decode_join(struct xrow_header *row, struct tt_uuid *instance_uuid,
+		 bool *raw_blocks)
+{
+	*raw_blocks = false;
+	xrow_decode_replication_body(row, NULL, instance_uuid, NULL,
+				     raw_blocks);
+}
+
 void
 xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock)
 {
@@ -289,12 +289,13 @@ xrow_encode_auth(struct xrow_header *row, const char *salt, size_t salt_len,
  * \param replicaset_uuid replica set uuid
  * \param instance_uuid instance uuid
  * \param vclock replication clock
+ * \param raw_blocks set if the replica accepts IPROTO_RAW_BLOCK
 */
 void
 xrow_encode_subscribe(struct xrow_header *row,
 		      const struct tt_uuid *replicaset_uuid,
 		      const struct tt_uuid *instance_uuid,
-		      const struct vclock *vclock);
+		      const struct vclock *vclock, bool raw_blocks);
 
 /**
  * \brief Decode SUBSCRIBE command
@@ -302,29 +303,32 @@ xrow_encode_subscribe(struct xrow_header *row,
  * \param[out] replicaset_uuid
  * \param[out] instance_uuid
  * \param[out] vclock
+ * \param[out] raw_blocks
 */
 void
 xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *replicaset_uuid,
-		      struct tt_uuid *instance_uuid, struct vclock *vclock);
+		      struct tt_uuid *instance_uuid, struct vclock *vclock,
+		      bool *raw_blocks);
 
 /**
  * \brief Encode JOIN command
  * \param[out] row
  * \param instance_uuid
+ * \param raw_blocks set if the replica accepts IPROTO_RAW_BLOCK
 */
 void
-xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid);
+xrow_encode_join(struct xrow_header *row, const struct tt_uuid *instance_uuid,
+		 bool raw_blocks);
 
 /**
  * \brief Decode JOIN command
  * \param row
  * \param[out] instance_uuid
+ * \param[out] raw_blocks
 */
-static inline void
-xrow_decode_join(struct xrow_header *row, struct tt_uuid *instance_uuid)
-{
-	return xrow_decode_subscribe(row, NULL, instance_uuid, NULL);
-}
+void
+xrow_decode_join(struct xrow_header *row, struct tt_uuid *instance_uuid,
+		 bool *raw_blocks);
 
 /**
  * \brief Encode end of stream command (a response to JOIN command)
@@ -342,7 +346,7 @@ xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock);
 static inline void
 xrow_decode_vclock(struct xrow_header *row, struct vclock *vclock)
 {
-	return xrow_decode_subscribe(row, NULL, NULL, vclock);
+	return xrow_decode_subscribe(row, NULL, NULL, vclock, NULL);
 }
 
 #endif
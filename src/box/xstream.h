@@ -32,6 +32,7 @@
  * SUCH DAMAGE.
  */
 
+#include <sys/types.h>
 #include "diag.h"
 
 #if defined(__cplusplus)
@@ -42,15 +43,32 @@ struct xrow_header;
 struct xstream;
 
 typedef void (*xstream_write_f)(struct xstream *, struct xrow_header *);
+typedef void (*xstream_write_block_f)(struct xstream *, int fd,
+				      off_t offset, size_t size);
+typedef void (*xstream_flush_f)(struct xstream *);
 
 struct xstream {
 	xstream_write_f write;
+	/**
+	 * Write a raw xlog tx block located in a file, @sa
+	 * xlog_cursor_next_block(). Optional: if not set, rows
+	 * must be written one by one.
+	 */
+	xstream_write_block_f write_block;
+	/**
+	 * Write out rows buffered by the stream. Called when
+	 * there are no more rows to write for the time being.
+	 * Optional: if not set, the stream doesn't buffer rows.
+	 */
+	xstream_flush_f flush;
 };
 
 static inline void
 xstream_create(struct xstream *xstream, xstream_write_f write)
 {
 	xstream->write = write;
+	xstream->write_block = NULL;
+	xstream->flush = NULL;
 }
 
 int
@@ -66,6 +84,13 @@ xstream_write_xc(struct xstream *stream, struct xrow_header *row)
 		diag_raise();
 }
 
+static inline void
+xstream_flush_xc(struct xstream *stream)
+{
+	if (stream->flush != NULL)
+		stream->flush(stream);
+}
+
 #endif /* defined(__cplusplus) */
 
 #endif /* TARANTOOL_XSTREAM_H_INCLUDED */
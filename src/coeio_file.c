@@ -31,6 +31,7 @@
 
 #include "coeio_file.h"
 #include "coeio.h"
+#include "coio_uring.h"
 #include "fiber.h"
 #include "say.h"
 #include <stdio.h>
@@ -153,6 +154,9 @@ coeio_close(int fd)
 ssize_t
 coeio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 {
+	ssize_t result;
+	if (coio_uring_pwrite(fd, buf, count, offset, &result))
+		return result;
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_write(fd, (void *) buf, count, offset,
 				 0, coeio_complete, &eio);
@@ -162,6 +166,9 @@ coeio_pwrite(int fd, const void *buf, size_t count, off_t offset)
 ssize_t
 coeio_pread(int fd, void *buf, size_t count, off_t offset)
 {
+	ssize_t result;
+	if (coio_uring_pread(fd, buf, count, offset, &result))
+		return result;
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_read(fd, buf, count,
 				offset, 0, coeio_complete, &eio);
@@ -479,6 +486,9 @@ coeio_sync()
 int
 coeio_fsync(int fd)
 {
+	int result;
+	if (coio_uring_fsync(fd, false, &result))
+		return result;
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_fsync(fd, 0, coeio_complete, &eio);
 	return coeio_wait_done(req, &eio);
@@ -487,6 +497,9 @@ coeio_fsync(int fd)
 int
 coeio_fdatasync(int fd)
 {
+	int result;
+	if (coio_uring_fsync(fd, true, &result))
+		return result;
 	INIT_COEIO_FILE(eio);
 	eio_req *req = eio_fdatasync(fd, 0, coeio_complete, &eio);
 	return coeio_wait_done(req, &eio);
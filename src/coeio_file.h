@@ -45,6 +45,10 @@ extern "C" {
  *
  * It follows the error reporting convention of the respective
  * system calls, i.e. it doesn't throw exceptions either.
+ *
+ * pread, pwrite, fsync and fdatasync are done with io_uring
+ * rather than in the eio thread pool when possible,
+ * @sa coio_uring.h.
  */
 
 int     coeio_open(const char *path, int flags, mode_t mode);
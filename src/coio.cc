@@ -35,11 +35,15 @@
 #include <netinet/tcp.h>
 #include <stdio.h>
 #include <arpa/inet.h>
+#if defined(HAVE_SENDFILE_LINUX)
+#include <sys/sendfile.h>
+#endif
 
 #include "iobuf.h"
 #include "sio.h"
 #include "scoped_guard.h"
 #include "coeio.h" /* coeio_resolve() */
+#include "errinj.h"
 
 struct CoioGuard {
 	struct ev_io *ev_io;
@@ -427,6 +431,72 @@ coio_write_timeout(struct ev_io *coio, const void *buf, size_t sz,
 	}
 }
 
+#if defined(HAVE_SENDFILE_LINUX)
+/**
+ * Send a file chunk with sendfile(). Return false if sendfile()
+ * doesn't support the file, in which case nothing is sent.
+ */
+static bool
+coio_sendfile_native(struct ev_io *coio, int file_fd, off_t offset,
+		     size_t size)
+{
+	CoioGuard coio_guard(coio);
+
+	bool is_sent = false;
+	while (size > 0) {
+		ssize_t nwr = sendfile(coio->fd, file_fd, &offset, size);
+		if (nwr > 0) {
+			size -= nwr;
+			is_sent = true;
+			continue;
+		}
+		if (nwr == 0) {
+			/* The file is shorter than expected. */
+			errno = EIO;
+			tnt_raise(SocketError, coio->fd, "sendfile");
+		}
+		if (!is_sent && (errno == EINVAL || errno == ENOSYS))
+			return false;
+		if (errno != EAGAIN && errno != EWOULDBLOCK &&
+		    errno != EINTR)
+			tnt_raise(SocketError, coio->fd, "sendfile");
+		if (! ev_is_active(coio)) {
+			ev_io_set(coio, coio->fd, EV_WRITE);
+			ev_io_start(loop(), coio);
+		}
+		fiber_testcancel();
+		coio_fiber_yield_timeout(coio, TIMEOUT_INFINITY);
+		fiber_testcancel();
+	}
+	return true;
+}
+#endif /* defined(HAVE_SENDFILE_LINUX) */
+
+void
+coio_sendfile(struct ev_io *coio, int file_fd, off_t offset, size_t size)
+{
+#if defined(HAVE_SENDFILE_LINUX)
+	bool use_sendfile = true;
+	ERROR_INJECT(ERRINJ_COIO_SENDFILE, { use_sendfile = false; });
+	if (use_sendfile &&
+	    coio_sendfile_native(coio, file_fd, offset, size))
+		return;
+#endif /* defined(HAVE_SENDFILE_LINUX) */
+	char buf[8192];
+	while (size > 0) {
+		ssize_t nrd = pread(file_fd, buf, MIN(size, sizeof(buf)),
+				    offset);
+		if (nrd <= 0) {
+			if (nrd == 0)
+				errno = EIO;
+			tnt_raise(SystemError, "pread");
+		}
+		coio_write(coio, buf, nrd);
+		offset += nrd;
+		size -= nrd;
+	}
+}
+
 /*
  * Write iov using sio API.
  * Put in an own function to workaround gcc bug with @finally
@@ -149,6 +149,15 @@ coio_writev(struct ev_io *coio, struct iovec *iov, int iovcnt, size_t size)
 	return coio_writev_timeout(coio, iov, iovcnt, size, TIMEOUT_INFINITY);
 }
 
+/**
+ * Send @a size bytes of a file starting at @a offset to a
+ * socket, using sendfile() if the platform supports it.
+ * Falls back on pread() and write() if sendfile() doesn't
+ * support the file. Throws an exception on error.
+ */
+void
+coio_sendfile(struct ev_io *coio, int file_fd, off_t offset, size_t size);
+
 ssize_t
 coio_sendto_timeout(struct ev_io *coio, const void *buf, size_t sz, int flags,
 		    const struct sockaddr *dest_addr, socklen_t addrlen,
@@ -0,0 +1,499 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "coio_uring.h"
+#include "trivia/config.h"
+
+#if defined(ENABLE_IO_URING)
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "fiber.h"
+#include "say.h"
+
+#if !defined(__NR_io_uring_setup)
+#define __NR_io_uring_setup 425
+#endif
+#if !defined(__NR_io_uring_enter)
+#define __NR_io_uring_enter 426
+#endif
+
+enum {
+	/** Number of entries in the submission ring. */
+	COIO_URING_ENTRIES = 256,
+};
+
+struct coio_uring {
+	/** Ring file descriptor. */
+	int fd;
+	/** Submission ring, shared with the kernel. */
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned sq_entries;
+	struct io_uring_sqe *sqes;
+	/** Completion ring, shared with the kernel. */
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	unsigned cq_entries;
+	struct io_uring_cqe *cqes;
+	/** Mapped regions, for munmap(). */
+	void *sq_ptr;
+	size_t sq_size;
+	void *cq_ptr;
+	size_t cq_size;
+	size_t sqes_size;
+	/** Number of queued, but not yet submitted requests. */
+	unsigned to_submit;
+	/** Number of submitted, but not yet completed requests. */
+	unsigned in_flight;
+	/** Reaps completions. */
+	struct ev_io io;
+	/** Submits queued requests before the loop goes to poll. */
+	struct ev_prepare prepare;
+	/** Retries submission if the kernel is out of resources. */
+	struct ev_idle idle;
+	/** The loop the watchers are started in. */
+	struct ev_loop *loop;
+};
+
+/** A request waiting for completion. */
+struct coio_uring_req {
+	/** The waiting fiber. */
+	struct fiber *fiber;
+	/** Buffer of a read or write request. */
+	struct iovec iov;
+	/** Result, negated errno on failure. */
+	int result;
+	bool done;
+};
+
+static __thread struct coio_uring *coio_uring;
+
+static int
+coio_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+	return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int
+coio_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+		 unsigned flags)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+		       flags, NULL, 0);
+}
+
+/**
+ * Submit all queued requests.
+ * @retval 0 success
+ * @retval -1 the kernel is out of resources, try again later
+ */
+static int
+coio_uring_submit(struct coio_uring *ring)
+{
+	while (ring->to_submit > 0) {
+		int rc = coio_uring_enter(ring->fd, ring->to_submit, 0, 0);
+		if (rc >= 0) {
+			assert((unsigned) rc <= ring->to_submit);
+			ring->to_submit -= rc;
+			continue;
+		}
+		if (errno == EINTR)
+			continue;
+		if (errno == EAGAIN || errno == EBUSY)
+			return -1;
+		/*
+		 * The ring itself is broken, which should never
+		 * happen. There's no way to fail the requests,
+		 * because they are already in the ring.
+		 */
+		say_syserror("io_uring_enter");
+		panic("failed to submit io_uring requests");
+	}
+	return 0;
+}
+
+static void
+coio_uring_prepare_cb(ev_loop *loop, struct ev_prepare *w, int events)
+{
+	(void) events;
+	struct coio_uring *ring = (struct coio_uring *) w->data;
+	if (coio_uring_submit(ring) != 0)
+		ev_idle_start(loop, &ring->idle);
+}
+
+static void
+coio_uring_idle_cb(ev_loop *loop, struct ev_idle *w, int events)
+{
+	(void) events;
+	struct coio_uring *ring = (struct coio_uring *) w->data;
+	if (coio_uring_submit(ring) == 0)
+		ev_idle_stop(loop, w);
+}
+
+static void
+coio_uring_io_cb(ev_loop *loop, struct ev_io *w, int events)
+{
+	(void) loop;
+	(void) events;
+	struct coio_uring *ring = (struct coio_uring *) w->data;
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	while (head != tail) {
+		struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+		struct coio_uring_req *req =
+			(struct coio_uring_req *)(uintptr_t) cqe->user_data;
+		req->result = cqe->res;
+		req->done = true;
+		fiber_wakeup(req->fiber);
+		head++;
+		assert(ring->in_flight > 0);
+		ring->in_flight--;
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void
+coio_uring_atfork_child(void)
+{
+	struct coio_uring *ring = coio_uring;
+	if (ring == NULL)
+		return;
+	/*
+	 * The ring is shared with the parent, so the child
+	 * can't use it. Requests in progress belong to the
+	 * parent.
+	 */
+	ring->to_submit = 0;
+	ring->in_flight = 0;
+	coio_uring_free();
+}
+
+int
+coio_uring_init(void)
+{
+	assert(coio_uring == NULL);
+	struct coio_uring *ring =
+		(struct coio_uring *) calloc(1, sizeof(*ring));
+	if (ring == NULL)
+		return -1;
+
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	ring->fd = coio_uring_setup(COIO_URING_ENTRIES, &p);
+	if (ring->fd < 0)
+		goto err_setup;
+
+	ring->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	ring->cq_size = p.cq_off.cqes +
+			p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_size > ring->sq_size)
+			ring->sq_size = ring->cq_size;
+		ring->cq_size = 0;
+	}
+	ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_POPULATE, ring->fd,
+			    IORING_OFF_SQ_RING);
+	if (ring->sq_ptr == MAP_FAILED)
+		goto err_sq;
+	if (ring->cq_size > 0) {
+		ring->cq_ptr = mmap(NULL, ring->cq_size,
+				    PROT_READ | PROT_WRITE,
+				    MAP_SHARED | MAP_POPULATE, ring->fd,
+				    IORING_OFF_CQ_RING);
+		if (ring->cq_ptr == MAP_FAILED)
+			goto err_cq;
+	} else {
+		ring->cq_ptr = ring->sq_ptr;
+	}
+	ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = (struct io_uring_sqe *) mmap(NULL, ring->sqes_size,
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ring->fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED)
+		goto err_sqes;
+
+	char *sq = (char *) ring->sq_ptr;
+	ring->sq_head = (unsigned *)(sq + p.sq_off.head);
+	ring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+	ring->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+	ring->sq_array = (unsigned *)(sq + p.sq_off.array);
+	ring->sq_entries = p.sq_entries;
+	char *cq = (char *) ring->cq_ptr;
+	ring->cq_head = (unsigned *)(cq + p.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+	ring->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+	ring->cq_entries = p.cq_entries;
+
+	ring->loop = loop();
+	ev_io_init(&ring->io, coio_uring_io_cb, ring->fd, EV_READ);
+	ring->io.data = ring;
+	ev_prepare_init(&ring->prepare, coio_uring_prepare_cb);
+	ring->prepare.data = ring;
+	ev_idle_init(&ring->idle, coio_uring_idle_cb);
+	ring->idle.data = ring;
+	ev_io_start(ring->loop, &ring->io);
+	ev_prepare_start(ring->loop, &ring->prepare);
+
+	static bool atfork_registered = false;
+	if (!atfork_registered) {
+		pthread_atfork(NULL, NULL, coio_uring_atfork_child);
+		atfork_registered = true;
+	}
+	coio_uring = ring;
+	return 0;
+
+err_sqes:
+	if (ring->cq_size > 0)
+		munmap(ring->cq_ptr, ring->cq_size);
+err_cq:
+	munmap(ring->sq_ptr, ring->sq_size);
+err_sq:
+	close(ring->fd);
+err_setup:
+	free(ring);
+	return -1;
+}
+
+void
+coio_uring_free(void)
+{
+	struct coio_uring *ring = coio_uring;
+	if (ring == NULL)
+		return;
+	assert(ring->to_submit == 0 && ring->in_flight == 0);
+	ev_io_stop(ring->loop, &ring->io);
+	ev_prepare_stop(ring->loop, &ring->prepare);
+	ev_idle_stop(ring->loop, &ring->idle);
+	munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_size > 0)
+		munmap(ring->cq_ptr, ring->cq_size);
+	munmap(ring->sq_ptr, ring->sq_size);
+	close(ring->fd);
+	free(ring);
+	coio_uring = NULL;
+}
+
+bool
+coio_uring_is_enabled(void)
+{
+	return coio_uring != NULL;
+}
+
+/**
+ * Get a free submission queue entry.
+ * Return NULL if the ring is full.
+ */
+static struct io_uring_sqe *
+coio_uring_get_sqe(struct coio_uring *ring)
+{
+	/*
+	 * Don't let the completion ring overflow: the
+	 * completion callback may be delayed by long running
+	 * fibers.
+	 */
+	if (ring->in_flight >= ring->cq_entries)
+		return NULL;
+	unsigned tail = *ring->sq_tail;
+	unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+	if (tail - head >= ring->sq_entries) {
+		if (coio_uring_submit(ring) != 0)
+			return NULL;
+		head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+		if (tail - head >= ring->sq_entries)
+			return NULL;
+	}
+	unsigned index = tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	ring->sq_array[index] = index;
+	return sqe;
+}
+
+/**
+ * Queue a prepared submission queue entry and wait for the
+ * request to complete.
+ */
+static void
+coio_uring_wait(struct coio_uring *ring, struct coio_uring_req *req)
+{
+	unsigned tail = *ring->sq_tail;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit++;
+	ring->in_flight++;
+	/*
+	 * The request can't be cancelled, since the kernel
+	 * owns the buffer until the request completes.
+	 */
+	while (!req->done)
+		fiber_yield();
+	if (req->result < 0)
+		errno = -req->result;
+}
+
+static bool
+coio_uring_rw(uint8_t opcode, int fd, void *buf, size_t count,
+	      off_t offset, ssize_t *result)
+{
+	struct coio_uring *ring = coio_uring;
+	if (ring == NULL || count > INT_MAX)
+		return false;
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	if (sqe == NULL)
+		return false;
+	struct coio_uring_req req;
+	req.fiber = fiber();
+	req.iov.iov_base = buf;
+	req.iov.iov_len = count;
+	req.result = 0;
+	req.done = false;
+	/*
+	 * Use vectored requests, as they are supported by all
+	 * kernel versions having io_uring.
+	 */
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->off = offset;
+	sqe->addr = (uintptr_t) &req.iov;
+	sqe->len = 1;
+	sqe->user_data = (uintptr_t) &req;
+	coio_uring_wait(ring, &req);
+	*result = req.result < 0 ? -1 : req.result;
+	return true;
+}
+
+bool
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset,
+		 ssize_t *result)
+{
+	return coio_uring_rw(IORING_OP_READV, fd, buf, count, offset, result);
+}
+
+bool
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset,
+		  ssize_t *result)
+{
+	return coio_uring_rw(IORING_OP_WRITEV, fd, (void *) buf, count,
+			     offset, result);
+}
+
+bool
+coio_uring_fsync(int fd, bool datasync, int *result)
+{
+	struct coio_uring *ring = coio_uring;
+	if (ring == NULL)
+		return false;
+	struct io_uring_sqe *sqe = coio_uring_get_sqe(ring);
+	if (sqe == NULL)
+		return false;
+	struct coio_uring_req req;
+	req.fiber = fiber();
+	req.result = 0;
+	req.done = false;
+	sqe->opcode = IORING_OP_FSYNC;
+	sqe->fd = fd;
+	sqe->fsync_flags = datasync ? IORING_FSYNC_DATASYNC : 0;
+	sqe->user_data = (uintptr_t) &req;
+	coio_uring_wait(ring, &req);
+	*result = req.result < 0 ? -1 : 0;
+	return true;
+}
+
+#else /* !defined(ENABLE_IO_URING) */
+
+#include <errno.h>
+
+int
+coio_uring_init(void)
+{
+	errno = ENOSYS;
+	return -1;
+}
+
+void
+coio_uring_free(void)
+{
+}
+
+bool
+coio_uring_is_enabled(void)
+{
+	return false;
+}
+
+bool
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset,
+		 ssize_t *result)
+{
+	(void) fd;
+	(void) buf;
+	(void) count;
+	(void) offset;
+	(void) result;
+	return false;
+}
+
+bool
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset,
+		  ssize_t *result)
+{
+	(void) fd;
+	(void) buf;
+	(void) count;
+	(void) offset;
+	(void) result;
+	return false;
+}
+
+bool
+coio_uring_fsync(int fd, bool datasync, int *result)
+{
+	(void) fd;
+	(void) datasync;
+	(void) result;
+	return false;
+}
+
+#endif /* defined(ENABLE_IO_URING) */
@@ -0,0 +1,101 @@
+#ifndef TARANTOOL_COIO_URING_H_INCLUDED
+#define TARANTOOL_COIO_URING_H_INCLUDED
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <sys/types.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Cooperative file I/O on top of io_uring.
+ *
+ * A request is queued to the submission ring, and the calling
+ * fiber yields. All requests queued during an event loop
+ * iteration are submitted with a single system call before the
+ * loop goes to poll. Completions are reaped by an ev_io watcher
+ * on the ring file descriptor, which wakes up the waiting
+ * fibers. Unlike eio, no thread handoffs are involved.
+ *
+ * The ring is only set up in the main cord if requested with
+ * box.cfg.io_uring, otherwise eio is used. If the ring is not
+ * set up or full, the functions below return false and the
+ * caller is expected to fall back on eio.
+ */
+
+/**
+ * Set up io_uring in the current cord.
+ * @retval 0 success
+ * @retval -1 io_uring is not supported, errno is set
+ */
+int
+coio_uring_init(void);
+
+/**
+ * Tear down io_uring in the current cord. Must not be called
+ * while there are requests in progress.
+ */
+void
+coio_uring_free(void);
+
+/** Return true if io_uring is set up in the current cord. */
+bool
+coio_uring_is_enabled(void);
+
+/**
+ * pread(2) with io_uring.
+ * @retval true request completed, the pread(2) return value is
+ *              stored in @a result, errno is set on failure
+ * @retval false request was not submitted, use eio
+ */
+bool
+coio_uring_pread(int fd, void *buf, size_t count, off_t offset,
+		 ssize_t *result);
+
+/** pwrite(2) with io_uring, @sa coio_uring_pread(). */
+bool
+coio_uring_pwrite(int fd, const void *buf, size_t count, off_t offset,
+		  ssize_t *result);
+
+/**
+ * fsync(2) or fdatasync(2) if @a datasync is set with io_uring,
+ * @sa coio_uring_pread().
+ */
+bool
+coio_uring_fsync(int fd, bool datasync, int *result);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_COIO_URING_H_INCLUDED */
@@ -34,32 +34,94 @@
 #include <unistd.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <assert.h>
+#include <stdint.h>
+#include "trivia/util.h"
 #include "small/slab_cache.h"
 #include "third_party/valgrind/memcheck.h"
 #include "diag.h"
+#include "say.h"
 #if ENABLE_ASAN
 #include <sanitizer/asan_interface.h>
 #endif
 
+enum {
+	/**
+	 * Idle stacks keep at most this many bytes resident:
+	 * a fiber rarely goes deeper, and pages below are
+	 * released when the fiber is recycled.
+	 */
+	CORO_STACK_WATERMARK = 64 * 1024,
+	/** The number of poison marks put below the watermark. */
+	CORO_STACK_POISON_COUNT = 4,
+};
+
+static const uint64_t coro_stack_poison = 0x5a5ac0c0a5a5deadULL;
+
+/**
+ * Put poison marks right below the watermark. If any of them
+ * is overwritten, the stack has grown beyond the watermark.
+ * The stack grows down on all supported platforms.
+ */
+static void
+coro_stack_put_watermark(struct tarantool_coro *coro)
+{
+	uint64_t *mark = (uint64_t *) coro->stack_watermark;
+	for (int i = 1; i <= CORO_STACK_POISON_COUNT; i++)
+		mark[-i * 2] = coro_stack_poison;
+}
+
+static bool
+coro_stack_has_watermark(struct tarantool_coro *coro)
+{
+	const uint64_t *mark = (const uint64_t *) coro->stack_watermark;
+	for (int i = 1; i <= CORO_STACK_POISON_COUNT; i++) {
+		if (mark[-i * 2] != coro_stack_poison)
+			return false;
+	}
+	return true;
+}
+
 int
 tarantool_coro_create(struct tarantool_coro *coro,
-		      struct slab_cache *slabc,
-		      void (*f) (void *), void *data)
+		      struct slab_cache *slabc, size_t stack_size,
+		      bool guard, void (*f) (void *), void *data)
 {
-	const int page = sysconf(_SC_PAGESIZE);
+	const size_t page = sysconf(_SC_PAGESIZE);
 
 	memset(coro, 0, sizeof(*coro));
 
-	/* TODO: guard pages */
-	coro->stack_size = page * 16 - slab_sizeof();
-	coro->stack = (char *) slab_get(slabc, coro->stack_size)
-					+ slab_sizeof();
-
-	if (coro->stack == NULL) {
-		diag_set(OutOfMemory, coro->stack_size + slab_sizeof(),
+	assert(stack_size >= page * 4);
+	coro->stack_slab = slab_get(slabc, stack_size - slab_sizeof());
+	if (coro->stack_slab == NULL) {
+		diag_set(OutOfMemory, stack_size,
 			 "runtime arena", "coro stack");
 		return -1;
 	}
+	coro->stack_alloc_size = stack_size;
+	char *end = (char *) coro->stack_slab + stack_size;
+	coro->stack = (char *) coro->stack_slab + slab_sizeof();
+	if (guard) {
+		/*
+		 * The slab header is followed by a guard page, the
+		 * stack grows down towards it. Protection is set
+		 * once and kept while the stack is cached for reuse.
+		 */
+		char *guard_page = (char *) (((uintptr_t) coro->stack +
+					      page - 1) & ~(page - 1));
+		if (mprotect(guard_page, page, PROT_NONE) != 0) {
+			diag_set(SystemError, "failed to protect coro stack");
+			slab_put(slabc, coro->stack_slab);
+			return -1;
+		}
+		coro->stack = guard_page + page;
+		coro->has_guard = true;
+	}
+	coro->stack_size = end - (char *) coro->stack;
+	if (coro->stack_size > CORO_STACK_WATERMARK + page) {
+		coro->stack_watermark = end - CORO_STACK_WATERMARK;
+		coro_stack_put_watermark(coro);
+	}
 
 	coro->stack_id = VALGRIND_STACK_REGISTER(coro->stack,
 						 (char *) coro->stack +
@@ -72,12 +134,54 @@ tarantool_coro_create(struct tarantool_coro *coro,
 void
 tarantool_coro_destroy(struct tarantool_coro *coro, struct slab_cache *slabc)
 {
-	if (coro->stack != NULL) {
+	if (coro->stack_slab != NULL) {
 		VALGRIND_STACK_DEREGISTER(coro->stack_id);
 #if ENABLE_ASAN
 		ASAN_UNPOISON_MEMORY_REGION(coro->stack, coro->stack_size);
 #endif
-		slab_put(slabc, (struct slab *)
-			 ((char *) coro->stack - slab_sizeof()));
+		/* The slab may be reused for anything, drop the guard. */
+		const size_t page = sysconf(_SC_PAGESIZE);
+		if (coro->has_guard &&
+		    mprotect((char *) coro->stack - page, page,
+			     PROT_READ | PROT_WRITE) != 0)
+			panic_syserror("failed to unprotect coro stack");
+		slab_put(slabc, coro->stack_slab);
+	}
+}
+
+bool
+tarantool_coro_release_stack(struct tarantool_coro *coro)
+{
+	if (coro->stack_watermark == NULL || coro_stack_has_watermark(coro))
+		return false;
+	/* Not running below the watermark. */
+	assert((char *) __builtin_frame_address(0) < (char *) coro->stack ||
+	       (char *) __builtin_frame_address(0) >
+	       (char *) coro->stack_watermark);
+	(void) madvise(coro->stack, (char *) coro->stack_watermark -
+		       (char *) coro->stack, MADV_DONTNEED);
+	coro_stack_put_watermark(coro);
+	return true;
+}
+
+size_t
+tarantool_coro_stack_rss(const struct tarantool_coro *coro)
+{
+	if (coro->stack_slab == NULL)
+		return 0;
+	const size_t page = sysconf(_SC_PAGESIZE);
+	unsigned char vec[256];
+	size_t rss = 0;
+	char *pos = (char *) coro->stack;
+	char *end = pos + coro->stack_size;
+	while (pos < end) {
+		size_t len = MIN((size_t) (end - pos), sizeof(vec) * page);
+		size_t count = (len + page - 1) / page;
+		if (mincore(pos, len, vec) != 0)
+			return 0;
+		for (size_t i = 0; i < count; i++)
+			rss += (vec[i] & 1) * page;
+		pos += len;
 	}
+	return rss;
 }
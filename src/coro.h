@@ -31,6 +31,7 @@
  * SUCH DAMAGE.
  */
 #include <stddef.h> /* size_t */
+#include <stdbool.h>
 
 #include <third_party/coro/coro.h>
 
@@ -38,23 +39,65 @@
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+struct slab;
+
 struct tarantool_coro {
 	coro_context ctx;
+	/** The usable part of the stack, above the guard page. */
 	void *stack;
 	size_t stack_size;
 	/** Valgrind stack id. */
 	unsigned int stack_id;
+	/** The slab the stack is allocated from. */
+	struct slab *stack_slab;
+	/** Size passed to tarantool_coro_create(). */
+	size_t stack_alloc_size;
+	/** Whether the stack is protected with a guard page. */
+	bool has_guard;
+	/**
+	 * Stack memory below this address is returned to the OS
+	 * by tarantool_coro_release_stack(). NULL if the stack is
+	 * too small for that.
+	 */
+	void *stack_watermark;
 };
 
 struct slab_cache;
 
+/**
+ * Create a coroutine with a stack of @a stack_size bytes,
+ * including the guard page, allocated from @a cache.
+ * If @a guard is set, the stack is protected against overflow
+ * with a guard page, which stays in place until the coroutine
+ * is destroyed. Note, the protected page splits the memory
+ * mapping of the arena, so every guarded stack costs up to two
+ * mappings, which are limited by vm.max_map_count on Linux
+ * (65530 by default).
+ */
 int
 tarantool_coro_create(struct tarantool_coro *ctx,
-		      struct slab_cache *cache,
-		      void (*f) (void *), void *data);
+		      struct slab_cache *cache, size_t stack_size,
+		      bool guard, void (*f) (void *), void *data);
 void
 tarantool_coro_destroy(struct tarantool_coro *ctx,
 		       struct slab_cache *cache);
+
+/**
+ * Return stack pages of an idle coroutine below the watermark
+ * to the OS with madvise(MADV_DONTNEED). Does nothing unless
+ * the coroutine has used the stack below the watermark since
+ * the previous call, so a coroutine with a shallow stack costs
+ * no system calls. The caller must not be running on this part
+ * of the stack.
+ *
+ * @retval true if memory has been released
+ */
+bool
+tarantool_coro_release_stack(struct tarantool_coro *ctx);
+
+/** The number of bytes of the stack resident in memory. */
+size_t
+tarantool_coro_stack_rss(const struct tarantool_coro *ctx);
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -34,6 +34,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pmatomic.h>
+#include <unistd.h>
+#include <sys/resource.h>
 
 #include "assoc.h"
 #include "memory.h"
@@ -544,6 +546,8 @@ fiber_recycle(struct fiber *fiber)
 	fiber->fid = 0;
 	region_free(&fiber->gc);
 	rlist_move_entry(&cord()->dead, fiber, link);
+	if (tarantool_coro_release_stack(&fiber->coro))
+		cord()->fiber_stack_released++;
 }
 
 static void
@@ -634,10 +638,21 @@ fiber_new(const char *name, fiber_func f)
 	struct cord *cord = cord();
 	struct fiber *fiber = NULL;
 
-	if (! rlist_empty(&cord->dead)) {
+	while (! rlist_empty(&cord->dead)) {
 		fiber = rlist_first_entry(&cord->dead,
 					  struct fiber, link);
+		if (fiber->coro.stack_alloc_size == cord->fiber_stack_size &&
+		    fiber->coro.has_guard == cord->fiber_stack_guard)
+			break;
+		/* Stack settings have been changed, drop the fiber. */
+		rlist_del_entry(fiber, link);
+		fiber_destroy(cord, fiber);
+		mempool_free(&cord->fiber_mempool, fiber);
+		fiber = NULL;
+	}
+	if (fiber != NULL) {
 		rlist_move_entry(&cord->alive, fiber, link);
+		cord->fiber_stack_reused++;
 	} else {
 		fiber = (struct fiber *)
 			mempool_alloc(&cord->fiber_mempool);
@@ -649,10 +664,13 @@ fiber_new(const char *name, fiber_func f)
 		memset(fiber, 0, sizeof(struct fiber));
 
 		if (tarantool_coro_create(&fiber->coro, &cord->slabc,
+					  cord->fiber_stack_size,
+					  cord->fiber_stack_guard,
 					  fiber_loop, NULL)) {
 			mempool_free(&cord->fiber_mempool, fiber);
 			return NULL;
 		}
+		cord->fiber_stack_created++;
 
 		region_create(&fiber->gc, &cord->slabc);
 
@@ -723,6 +741,11 @@ cord_create(struct cord *cord, const char *name)
 	rlist_create(&cord->alive);
 	rlist_create(&cord->ready);
 	rlist_create(&cord->dead);
+	cord->fiber_stack_size = FIBER_STACK_SIZE_DEFAULT;
+	cord->fiber_stack_guard = true;
+	cord->fiber_stack_created = 0;
+	cord->fiber_stack_reused = 0;
+	cord->fiber_stack_released = 0;
 	cord->fiber_registry = mh_i32ptr_new();
 
 	/* sched fiber is not present in alive/ready/dead list. */
@@ -1043,6 +1066,27 @@ cord_is_main()
 	return cord() == &main_cord;
 }
 
+int
+cord_set_fiber_stack_size(size_t size)
+{
+	if (size < FIBER_STACK_SIZE_MIN || size > FIBER_STACK_SIZE_MAX) {
+		errno = EINVAL;
+		diag_set(SystemError, "fiber stack size %zu is out of "
+			 "range [%u, %u]", size, FIBER_STACK_SIZE_MIN,
+			 FIBER_STACK_SIZE_MAX);
+		return -1;
+	}
+	const size_t page = sysconf(_SC_PAGESIZE);
+	cord()->fiber_stack_size = (size + page - 1) & ~(page - 1);
+	return 0;
+}
+
+void
+cord_set_fiber_stack_guard(bool guard)
+{
+	cord()->fiber_stack_guard = guard;
+}
+
 struct slab_cache *
 cord_slab_cache(void)
 {
@@ -1076,3 +1120,29 @@ int fiber_stat(fiber_stat_cb cb, void *cb_ctx)
 	}
 	return 0;
 }
+
+void
+fiber_stack_stat(struct fiber_stack_stat *stat)
+{
+	struct cord *cord = cord();
+	struct fiber *fiber;
+	memset(stat, 0, sizeof(*stat));
+	stat->size = cord->fiber_stack_size;
+	stat->guard = cord->fiber_stack_guard;
+	stat->created = cord->fiber_stack_created;
+	stat->reused = cord->fiber_stack_reused;
+	stat->released = cord->fiber_stack_released;
+	rlist_foreach_entry(fiber, &cord->alive, link)
+		stat->rss += tarantool_coro_stack_rss(&fiber->coro);
+	rlist_foreach_entry(fiber, &cord->dead, link) {
+		stat->rss += tarantool_coro_stack_rss(&fiber->coro);
+		stat->idle++;
+	}
+	struct rusage usage;
+#ifdef RUSAGE_THREAD
+	if (getrusage(RUSAGE_THREAD, &usage) == 0)
+#else
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+#endif
+		stat->page_faults = usage.ru_minflt;
+}
@@ -292,6 +292,39 @@ struct fiber {
 
 enum { FIBER_CALL_STACK = 16 };
 
+enum {
+	/**
+	 * Default size of a fiber stack, including the guard
+	 * page. Only the pages a fiber actually touches are
+	 * backed by memory.
+	 */
+	FIBER_STACK_SIZE_DEFAULT = 512 * 1024,
+	/** The smallest allowed fiber stack size. */
+	FIBER_STACK_SIZE_MIN = 64 * 1024,
+	/** The largest allowed fiber stack size. */
+	FIBER_STACK_SIZE_MAX = 4 * 1024 * 1024,
+};
+
+/** Statistics of fiber stacks of a cord, @sa fiber_stack_stat(). */
+struct fiber_stack_stat {
+	/** Size of a stack of a new fiber. */
+	size_t size;
+	/** Whether a stack of a new fiber has a guard page. */
+	bool guard;
+	/** The number of stacks allocated. */
+	uint64_t created;
+	/** The number of fibers created with a cached stack. */
+	uint64_t reused;
+	/** How many times stack memory was returned to the OS. */
+	uint64_t released;
+	/** The number of dead fibers cached for reuse. */
+	uint32_t idle;
+	/** Memory resident in stacks of live and dead fibers. */
+	size_t rss;
+	/** Minor page faults of the calling thread. */
+	uint64_t page_faults;
+};
+
 struct cord_on_exit;
 
 /**
@@ -316,8 +349,19 @@ struct cord {
 	struct rlist alive;
 	/** Fibers, ready for execution */
 	struct rlist ready;
-	/** A cache of dead fibers for reuse */
+	/**
+	 * A cache of dead fibers for reuse, the most recently
+	 * used first, so that a new fiber gets a warm stack.
+	 */
 	struct rlist dead;
+	/** Size of the stack of a new fiber. */
+	size_t fiber_stack_size;
+	/** Whether stacks of new fibers have a guard page. */
+	bool fiber_stack_guard;
+	/** Fiber stack statistics, @sa struct fiber_stack_stat. */
+	uint64_t fiber_stack_created;
+	uint64_t fiber_stack_reused;
+	uint64_t fiber_stack_released;
 	/** A watcher to have a single async event for all ready fibers.
 	 * This technique is necessary to be able to suspend
 	 * a single fiber on a few watchers (for example,
@@ -420,6 +464,29 @@ cord_name(struct cord *cord)
 bool
 cord_is_main();
 
+/**
+ * Set the stack size of fibers created in the current cord
+ * from now on. Cached dead fibers with a stack of another
+ * size are freed when the cache is used.
+ *
+ * @retval 0 success
+ * @retval -1 the size is out of range, diag is set
+ */
+int
+cord_set_fiber_stack_size(size_t size);
+
+/**
+ * Enable or disable the guard page of stacks of fibers created
+ * in the current cord from now on. The guard turns a stack
+ * overflow into a crash instead of memory corruption, but each
+ * guarded stack takes up to two memory mappings, so a process
+ * with many fibers may hit vm.max_map_count on Linux. Cached
+ * dead fibers with another setting are freed when the cache
+ * is used. The guard is enabled by default.
+ */
+void
+cord_set_fiber_stack_guard(bool guard);
+
 void
 fiber_init(int (*fiber_invoke)(fiber_func f, va_list ap));
 
@@ -503,6 +570,10 @@ typedef int (*fiber_stat_cb)(struct fiber *f, void *ctx);
 int
 fiber_stat(fiber_stat_cb cb, void *cb_ctx);
 
+/** Collect statistics of fiber stacks of the current cord. */
+void
+fiber_stack_stat(struct fiber_stack_stat *stat);
+
 /** Useful for C unit tests */
 static inline int
 fiber_c_invoke(fiber_func f, va_list ap)
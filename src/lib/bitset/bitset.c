@@ -76,7 +76,86 @@ bitset_test(struct bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	return bit_test(bitset_page_data(page), pos - page->first_pos);
+	return bitset_page_test(page, pos - page->first_pos);
+}
+
+/**
+ * Make room for one more bit in a full array page: double its
+ * capacity or convert it to a bitmap if it is already big
+ * enough. The page is reinserted into the pages tree, since it
+ * may move in memory.
+ * Returns the new page or NULL on memory error.
+ */
+static struct bitset_page *
+bitset_page_grow(struct bitset *bitset, struct bitset_page *page)
+{
+	assert(bitset_page_is_array(page));
+	assert(page->cardinality == page->array_capacity);
+
+	struct bitset_page *new_page;
+	if (page->array_capacity < BITSET_PAGE_ARRAY_MAX) {
+		uint32_t capacity = page->array_capacity * 2;
+		new_page = bitset->realloc(NULL,
+				bitset_page_array_alloc_size(capacity));
+		if (new_page == NULL)
+			return NULL;
+		memcpy(new_page, page,
+		       bitset_page_array_alloc_size(page->array_capacity));
+		new_page->array_capacity = capacity;
+	} else {
+		new_page = bitset->realloc(NULL,
+				bitset_page_alloc_size(bitset->realloc));
+		if (new_page == NULL)
+			return NULL;
+		bitset_page_create(new_page);
+		new_page->first_pos = page->first_pos;
+		new_page->cardinality = page->cardinality;
+		void *data = bitset_page_data(new_page);
+		uint16_t *arr = bitset_page_array(page);
+		for (uint32_t i = 0; i < page->cardinality; i++)
+			bit_set(data, arr[i]);
+	}
+
+	bitset_pages_remove(&bitset->pages, page);
+	bitset_page_destroy(page);
+	bitset->realloc(page, 0);
+	bitset_pages_insert(&bitset->pages, new_page);
+	return new_page;
+}
+
+/**
+ * Convert a bitmap page with few bits set to an array page.
+ * The page is left as is on memory error.
+ */
+static void
+bitset_page_shrink(struct bitset *bitset, struct bitset_page *page)
+{
+	assert(!bitset_page_is_array(page));
+	assert(page->cardinality <= BITSET_PAGE_ARRAY_MAX / 2);
+
+	uint32_t capacity = BITSET_PAGE_ARRAY_MAX / 2;
+	struct bitset_page *new_page = bitset->realloc(NULL,
+				bitset_page_array_alloc_size(capacity));
+	if (new_page == NULL)
+		return;
+	memset(new_page, 0, sizeof(*new_page));
+	new_page->first_pos = page->first_pos;
+	new_page->cardinality = page->cardinality;
+	new_page->array_capacity = capacity;
+	uint16_t *arr = bitset_page_array(new_page);
+
+	struct bit_iterator it;
+	bit_iterator_init(&it, bitset_page_data(page),
+			  BITSET_PAGE_DATA_SIZE, true);
+	size_t offset;
+	while ((offset = bit_iterator_next(&it)) != SIZE_MAX)
+		*arr++ = offset;
+	assert(arr == bitset_page_array(new_page) + page->cardinality);
+
+	bitset_pages_remove(&bitset->pages, page);
+	bitset_page_destroy(page);
+	bitset->realloc(page, 0);
+	bitset_pages_insert(&bitset->pages, new_page);
 }
 
 int
@@ -88,14 +167,16 @@ bitset_set(struct bitset *bitset, size_t pos)
 	/* Find a page in pages tree */
 	struct bitset_page *page = bitset_pages_search(&bitset->pages, &key);
 	if (page == NULL) {
-		/* Allocate a new page */
-		size_t size = bitset_page_alloc_size(bitset->realloc);
+		/* Allocate a new page, a sparse one to begin with */
+		uint32_t capacity = BITSET_PAGE_ARRAY_MIN;
+		size_t size = bitset_page_array_alloc_size(capacity);
 		page = bitset->realloc(NULL, size);
 		if (page == NULL)
 			return -1;
 
-		bitset_page_create(page);
+		memset(page, 0, sizeof(*page));
 		page->first_pos = key.first_pos;
+		page->array_capacity = capacity;
 
 		/* Insert the page into pages tree */
 		bitset_pages_insert(&bitset->pages, page);
@@ -103,10 +184,33 @@ bitset_set(struct bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	bool prev = bit_set(bitset_page_data(page), pos - page->first_pos);
-	if (prev) {
-		/* Value has not changed */
-		return 1;
+	size_t offset = pos - page->first_pos;
+	if (bitset_page_is_array(page)) {
+		uint32_t i = bitset_page_array_find(page, offset);
+		if (i < page->cardinality &&
+		    bitset_page_array(page)[i] == offset) {
+			/* Value has not changed */
+			return 1;
+		}
+		if (page->cardinality == page->array_capacity) {
+			page = bitset_page_grow(bitset, page);
+			if (page == NULL)
+				return -1;
+		}
+		if (bitset_page_is_array(page)) {
+			uint16_t *arr = bitset_page_array(page);
+			memmove(arr + i + 1, arr + i,
+				(page->cardinality - i) * sizeof(*arr));
+			arr[i] = offset;
+		} else {
+			bit_set(bitset_page_data(page), offset);
+		}
+	} else {
+		bool prev = bit_set(bitset_page_data(page), offset);
+		if (prev) {
+			/* Value has not changed */
+			return 1;
+		}
 	}
 
 	bitset->cardinality++;
@@ -128,9 +232,19 @@ bitset_clear(struct bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	bool prev = bit_clear(bitset_page_data(page), pos - page->first_pos);
-	if (!prev) {
-		return 0;
+	size_t offset = pos - page->first_pos;
+	if (bitset_page_is_array(page)) {
+		uint16_t *arr = bitset_page_array(page);
+		uint32_t i = bitset_page_array_find(page, offset);
+		if (i == page->cardinality || arr[i] != offset)
+			return 0;
+		memmove(arr + i, arr + i + 1,
+			(page->cardinality - i - 1) * sizeof(*arr));
+	} else {
+		bool prev = bit_clear(bitset_page_data(page), offset);
+		if (!prev) {
+			return 0;
+		}
 	}
 
 	assert(bitset->cardinality > 0);
@@ -144,6 +258,9 @@ bitset_clear(struct bitset *bitset, size_t pos)
 		/* Free the page */
 		bitset_page_destroy(page);
 		bitset->realloc(page, 0);
+	} else if (!bitset_page_is_array(page) &&
+		   page->cardinality <= BITSET_PAGE_ARRAY_MAX / 2) {
+		bitset_page_shrink(bitset, page);
 	}
 
 	return 1;
@@ -164,6 +281,13 @@ bitset_info(struct bitset *bitset, struct bitset_info *info)
 	struct bitset_page *page = bitset_pages_first(&bitset->pages);
 	while (page != NULL) {
 		info->pages++;
+		if (bitset_page_is_array(page)) {
+			info->array_pages++;
+			info->total_size += bitset_page_array_alloc_size(
+						page->array_capacity);
+		} else {
+			info->total_size += info->page_total_size;
+		}
 		cardinality_check += page->cardinality;
 		page = bitset_pages_next(&bitset->pages, page);
 	}
@@ -205,7 +329,7 @@ bitset_dump(struct bitset *bitset, int verbose, FILE *stream)
 			"utilization = undefined\n");
 	}
 	size_t mem_data  = info.page_data_size * info.pages;
-	size_t mem_total = info.page_total_size * info.pages;
+	size_t mem_total = info.total_size;
 
 	fprintf(stream, "    " "mem_data    = %zu bytes\n", mem_data);
 	fprintf(stream, "    " "mem_total   = %zu bytes "
@@ -236,7 +360,7 @@ bitset_dump(struct bitset *bitset, int verbose, FILE *stream)
 
 		fprintf(stream, "utilization = %8.4f%% (%zu/%zu)",
 			(float) page->cardinality * 1e2 / PAGE_BIT,
-			page->cardinality, PAGE_BIT);
+			(size_t) page->cardinality, PAGE_BIT);
 
 		if (verbose < 2) {
 			fprintf(stream, "\n");
@@ -246,6 +370,16 @@ bitset_dump(struct bitset *bitset, int verbose, FILE *stream)
 
 		fprintf(stream, "vals = {");
 
+		if (bitset_page_is_array(page)) {
+			uint16_t *arr = bitset_page_array(page);
+			for (uint32_t i = 0; i < page->cardinality; i++) {
+				fprintf(stream, "%zu, ",
+					page->first_pos + arr[i]);
+			}
+			fprintf(stream, "}\n");
+			continue;
+		}
+
 		size_t pos = 0;
 		struct bit_iterator it;
 		bit_iterator_init(&it, bitset_page_data(page),
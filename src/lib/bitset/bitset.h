@@ -69,7 +69,13 @@ extern "C" {
 struct bitset_page {
 	size_t first_pos;
 	rb_node(struct bitset_page) node;
-	size_t cardinality;
+	/** Number of bits set in the page */
+	uint32_t cardinality;
+	/**
+	 * Capacity of a sparse page, which stores a sorted array
+	 * of bit offsets instead of a bitmap, 0 for a bitmap page.
+	 */
+	uint32_t array_capacity;
 	uint8_t data[0];
 };
 
@@ -157,6 +163,10 @@ struct bitset_info {
 	size_t page_total_size;
 	/** A multiplier by which an address of page data is aligned **/
 	size_t page_data_alignment;
+	/** Number of sparse pages, stored as arrays of bit offsets */
+	size_t array_pages;
+	/** Memory used by all pages (in bytes) */
+	size_t total_size;
 };
 
 /**
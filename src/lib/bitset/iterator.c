@@ -306,8 +306,23 @@ bitset_iterator_conj_prepare_page(struct bitset_iterator_conj *conj,
 	assert(conj->page_first_pos != SIZE_MAX);
 
 	bitset_page_set_ones(dst);
+	/*
+	 * Sparse pages are ANDed first: they leave only a few
+	 * bits set in dst, or none at all, in which case the rest
+	 * of the conjunction can be skipped.
+	 */
+	for (size_t b = 0; b < conj->size; b++) {
+		if (conj->pre_nots[b] || !bitset_page_is_array(conj->pages[b]))
+			continue;
+		/* conj->pages[b] is rewinded to conj->page_first_pos */
+		assert(conj->pages[b]->first_pos == conj->page_first_pos);
+		if (bitset_page_and_array(dst, conj->pages[b]) == 0)
+			return;
+	}
 	for (size_t b = 0; b < conj->size; b++) {
 		if (!conj->pre_nots[b]) {
+			if (bitset_page_is_array(conj->pages[b]))
+				continue;
 			/* conj->pages[b] is rewinded to conj->page_first_pos */
 			assert(conj->pages[b]->first_pos == conj->page_first_pos);
 			bitset_page_and(dst, conj->pages[b]);
@@ -55,7 +55,16 @@ extern "C" {
 
 enum {
 	/** How many bytes to store in one page */
-	BITSET_PAGE_DATA_SIZE = 160
+	BITSET_PAGE_DATA_SIZE = 160,
+	/**
+	 * Pages with few bits set are stored as sorted arrays of
+	 * bit offsets, which is much more compact than a bitmap.
+	 * An array page is converted to a bitmap when more bits
+	 * are set, and back when half of them are cleared.
+	 */
+	BITSET_PAGE_ARRAY_MAX = 32,
+	/** Initial capacity of an array page */
+	BITSET_PAGE_ARRAY_MIN = 4
 };
 
 #if defined(ENABLE_AVX)
@@ -128,6 +137,53 @@ bitset_page_destroy(struct bitset_page *page)
 	/* nothing */
 }
 
+inline bool
+bitset_page_is_array(const struct bitset_page *page)
+{
+	return page->array_capacity > 0;
+}
+
+inline size_t
+bitset_page_array_alloc_size(uint32_t capacity)
+{
+	return sizeof(struct bitset_page) + capacity * sizeof(uint16_t);
+}
+
+inline uint16_t *
+bitset_page_array(struct bitset_page *page)
+{
+	assert(bitset_page_is_array(page));
+	return (uint16_t *) page->data;
+}
+
+/**
+ * @brief Find the index of \a offset in an array page or the index
+ * where it should be inserted
+ */
+inline uint32_t
+bitset_page_array_find(struct bitset_page *page, size_t offset)
+{
+	const uint16_t *arr = bitset_page_array(page);
+	uint32_t begin = 0, end = page->cardinality;
+	while (begin < end) {
+		uint32_t mid = (begin + end) / 2;
+		if (arr[mid] < offset)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+	return begin;
+}
+
+inline bool
+bitset_page_test(struct bitset_page *page, size_t offset)
+{
+	if (!bitset_page_is_array(page))
+		return bit_test(bitset_page_data(page), offset);
+	uint32_t i = bitset_page_array_find(page, offset);
+	return i < page->cardinality && bitset_page_array(page)[i] == offset;
+}
+
 inline size_t
 bitset_page_first_pos(size_t pos) {
 	return pos - (pos % (BITSET_PAGE_DATA_SIZE * CHAR_BIT));
@@ -147,9 +203,35 @@ bitset_page_set_ones(struct bitset_page *page)
 	memset(data, -1, BITSET_PAGE_DATA_SIZE);
 }
 
+/**
+ * @brief AND a bitmap page with an array page
+ * @return the number of bits left in \a dst
+ */
+inline uint32_t
+bitset_page_and_array(struct bitset_page *dst, struct bitset_page *src)
+{
+	void *d = bitset_page_data(dst);
+	const uint16_t *arr = bitset_page_array(src);
+	uint16_t kept[BITSET_PAGE_ARRAY_MAX];
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < src->cardinality; i++) {
+		if (bit_test(d, arr[i]))
+			kept[count++] = arr[i];
+	}
+	bitset_page_set_zeros(dst);
+	for (uint32_t i = 0; i < count; i++)
+		bit_set(d, kept[i]);
+	return count;
+}
+
 inline void
 bitset_page_and(struct bitset_page *dst, struct bitset_page *src)
 {
+	if (bitset_page_is_array(src)) {
+		bitset_page_and_array(dst, src);
+		return;
+	}
+
 	bitset_word_t *d = (bitset_word_t *) bitset_page_data(dst);
 	bitset_word_t *s = (bitset_word_t *) bitset_page_data(src);
 
@@ -163,6 +245,14 @@ bitset_page_and(struct bitset_page *dst, struct bitset_page *src)
 inline void
 bitset_page_nand(struct bitset_page *dst, struct bitset_page *src)
 {
+	if (bitset_page_is_array(src)) {
+		void *d = bitset_page_data(dst);
+		const uint16_t *arr = bitset_page_array(src);
+		for (uint32_t i = 0; i < src->cardinality; i++)
+			bit_clear(d, arr[i]);
+		return;
+	}
+
 	bitset_word_t *d = (bitset_word_t *) bitset_page_data(dst);
 	bitset_word_t *s = (bitset_word_t *) bitset_page_data(src);
 
@@ -176,6 +266,14 @@ bitset_page_nand(struct bitset_page *dst, struct bitset_page *src)
 inline void
 bitset_page_or(struct bitset_page *dst, struct bitset_page *src)
 {
+	if (bitset_page_is_array(src)) {
+		void *d = bitset_page_data(dst);
+		const uint16_t *arr = bitset_page_array(src);
+		for (uint32_t i = 0; i < src->cardinality; i++)
+			bit_set(d, arr[i]);
+		return;
+	}
+
 	bitset_word_t *d = (bitset_word_t *) bitset_page_data(dst);
 	bitset_word_t *s = (bitset_word_t *) bitset_page_data(src);
 
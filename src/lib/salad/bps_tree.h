@@ -345,6 +345,7 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_build _api_name(build)
 #define bps_tree_destroy _api_name(destroy)
 #define bps_tree_find _api_name(find)
+#define bps_tree_find_batch _api_name(find_batch)
 #define bps_tree_insert _api_name(insert)
 #define bps_tree_delete _api_name(delete)
 #define bps_tree_size _api_name(size)
@@ -591,6 +592,21 @@ bps_tree_destroy(struct bps_tree *tree);
 static inline bps_tree_elem_t *
 bps_tree_find(const struct bps_tree *tree, bps_tree_key_t key);
 
+/**
+ * @brief Find elements equal to each of the given keys
+ * Lookups of several keys are interleaved level by level, and the
+ * blocks of the next level are prefetched, so that cache misses
+ * of different lookups overlap.
+ * @param tree - pointer to a tree
+ * @param keys - array of keys
+ * @param count - number of keys
+ * @param result - array of count pointers to fill, NULL is stored
+ *  for a key that was not found (@sa bps_tree_find)
+ */
+static inline void
+bps_tree_find_batch(const struct bps_tree *tree, const bps_tree_key_t *keys,
+		    size_t count, bps_tree_elem_t **result);
+
 /**
  * @brief Insert an element to the tree or replace an element in the tree
  * In case of replacing, if 'replaced' argument is not null,
@@ -1885,6 +1901,61 @@ bps_tree_find(const struct bps_tree *tree, bps_tree_key_t key)
 		return 0;
 }
 
+/**
+ * @see bps_tree_find_batch description
+ */
+static inline void
+bps_tree_find_batch(const struct bps_tree *tree, const bps_tree_key_t *keys,
+		    size_t count, bps_tree_elem_t **result)
+{
+	/* Number of lookups done in parallel */
+	enum { BPS_TREE_FIND_BATCH = 16 };
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		for (size_t i = 0; i < count; i++)
+			result[i] = 0;
+		return;
+	}
+	struct bps_block *root = bps_tree_root(tree);
+	struct bps_block *blocks[BPS_TREE_FIND_BATCH];
+	bool exact = false;
+	for (size_t start = 0; start < count; start += BPS_TREE_FIND_BATCH) {
+		size_t n = count - start;
+		if (n > BPS_TREE_FIND_BATCH)
+			n = BPS_TREE_FIND_BATCH;
+		for (size_t j = 0; j < n; j++)
+			blocks[j] = root;
+		for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+			for (size_t j = 0; j < n; j++) {
+				struct bps_inner *inner =
+					(struct bps_inner *)blocks[j];
+				bps_tree_pos_t pos;
+				pos = bps_tree_find_ins_point_key(tree,
+						inner->elems,
+						inner->header.size - 1,
+						keys[start + j], &exact);
+				blocks[j] = bps_tree_restore_block(tree,
+						inner->child_ids[pos]);
+				/*
+				 * The block is not needed until the
+				 * rest of the batch descends a level.
+				 */
+				__builtin_prefetch(blocks[j]);
+				__builtin_prefetch((char *)blocks[j] +
+						   BPS_TREE_BLOCK_SIZE / 2);
+			}
+		}
+		for (size_t j = 0; j < n; j++) {
+			struct bps_leaf *leaf = (struct bps_leaf *)blocks[j];
+			bps_tree_pos_t pos;
+			pos = bps_tree_find_ins_point_key(tree, leaf->elems,
+							  leaf->header.size,
+							  keys[start + j],
+							  &exact);
+			result[start + j] = exact ? leaf->elems + pos : 0;
+		}
+	}
+}
+
 /**
  * @brief Add a block to the garbage for future reuse
  */
@@ -5710,6 +5781,7 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_build
 #undef bps_tree_destroy
 #undef bps_tree_find
+#undef bps_tree_find_batch
 #undef bps_tree_insert
 #undef bps_tree_delete
 #undef bps_tree_size
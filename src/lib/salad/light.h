@@ -216,6 +216,28 @@ LIGHT(find)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_DATA_TYPE data);
 uint32_t
 LIGHT(find_key)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_KEY_TYPE data);
 
+/**
+ * @brief Prefetch the record a hash maps to, so that a subsequent
+ *  LIGHT(find_key) with the hash doesn't stall on a cache miss
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to prefetch
+ */
+void
+LIGHT(prefetch)(const struct LIGHT(core) *ht, uint32_t hash);
+
+/**
+ * @brief Get the value of the record a hash maps to without
+ *  comparing keys. Used to prefetch the value before
+ *  a subsequent LIGHT(find_key).
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param value - pointer to a value to fill
+ * @return true if the record has the same hash, false otherwise
+ */
+bool
+LIGHT(peek)(const struct LIGHT(core) *ht, uint32_t hash,
+	    LIGHT_DATA_TYPE *value);
+
 /**
  * @brief Insert a record with given hash and value
  * @param ht - pointer to a hash table struct
@@ -440,6 +462,30 @@ LIGHT(find_key)(const struct LIGHT(core) *ht, uint32_t hash, LIGHT_KEY_TYPE key)
 	return LIGHT(end);
 }
 
+inline void
+LIGHT(prefetch)(const struct LIGHT(core) *ht, uint32_t hash)
+{
+	if (ht->count == 0)
+		return;
+	uint32_t slot = LIGHT(slot)(ht, hash);
+	__builtin_prefetch(matras_get(&ht->mtable, slot));
+}
+
+inline bool
+LIGHT(peek)(const struct LIGHT(core) *ht, uint32_t hash,
+	    LIGHT_DATA_TYPE *value)
+{
+	if (ht->count == 0)
+		return false;
+	uint32_t slot = LIGHT(slot)(ht, hash);
+	struct LIGHT(record) *record = (struct LIGHT(record) *)
+		matras_get(&ht->mtable, slot);
+	if (record->next == slot || record->hash != hash)
+		return false;
+	*value = record->value;
+	return true;
+}
+
 /**
  * @brief Replace a record with given hash and value
  * @param ht - pointer to a hash table struct
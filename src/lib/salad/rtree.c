@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "rtree.h"
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <limits.h>
@@ -43,7 +44,9 @@ enum {
 	RTREE_OPTIMAL_BRANCHES_IN_PAGE = 18,
 	/* actual number of branches could be up to double of the previous
 	 * constant */
-	RTREE_MAXIMUM_BRANCHES_IN_PAGE = RTREE_OPTIMAL_BRANCHES_IN_PAGE * 2
+	RTREE_MAXIMUM_BRANCHES_IN_PAGE = RTREE_OPTIMAL_BRANCHES_IN_PAGE * 2,
+	/* initial capacity of a bulk loading buffer */
+	RTREE_BULK_MIN_CAPACITY = 1024
 };
 
 struct rtree_page_branch {
@@ -1149,6 +1152,223 @@ rtree_number_of_records(const struct rtree *tree) {
 	return tree->n_records;
 }
 
+/*------------------------------------------------------------------------- */
+/* R-tree bulk loading */
+/*------------------------------------------------------------------------- */
+
+void
+rtree_bulk_create(struct rtree_bulk *bulk)
+{
+	bulk->data = NULL;
+	bulk->count = 0;
+	bulk->capacity = 0;
+}
+
+void
+rtree_bulk_destroy(struct rtree_bulk *bulk)
+{
+	free(bulk->data);
+	rtree_bulk_create(bulk);
+}
+
+int
+rtree_bulk_reserve(const struct rtree *tree, struct rtree_bulk *bulk,
+		   size_t capacity)
+{
+	if (capacity <= bulk->capacity)
+		return 0;
+	char *data = (char *)realloc(bulk->data,
+				     capacity * tree->page_branch_size);
+	if (data == NULL)
+		return -1;
+	bulk->data = data;
+	bulk->capacity = capacity;
+	return 0;
+}
+
+static struct rtree_page_branch *
+rtree_bulk_branch(const struct rtree *tree, char *data, size_t ind)
+{
+	return (struct rtree_page_branch *)
+		(data + ind * tree->page_branch_size);
+}
+
+int
+rtree_bulk_add(const struct rtree *tree, struct rtree_bulk *bulk,
+	       const struct rtree_rect *rect, record_t obj)
+{
+	if (bulk->count == bulk->capacity) {
+		size_t capacity = bulk->capacity + bulk->capacity / 2;
+		if (capacity < RTREE_BULK_MIN_CAPACITY)
+			capacity = RTREE_BULK_MIN_CAPACITY;
+		if (rtree_bulk_reserve(tree, bulk, capacity) != 0)
+			return -1;
+	}
+	struct rtree_page_branch *b =
+		rtree_bulk_branch(tree, bulk->data, bulk->count++);
+	b->data.record = obj;
+	rtree_rect_copy(&b->rect, rect, tree->dimension);
+	return 0;
+}
+
+/* Doubled center of a branch rectangle along the given axis */
+static coord_t
+rtree_bulk_key(const struct rtree *tree, char *data, size_t ind,
+	       unsigned axis)
+{
+	const coord_t *coords =
+		&rtree_bulk_branch(tree, data, ind)->rect.coords[2 * axis];
+	return coords[0] + coords[1];
+}
+
+static void
+rtree_bulk_swap(const struct rtree *tree, char *data, size_t i, size_t j)
+{
+	struct rtree_page_branch tmp;
+	struct rtree_page_branch *a = rtree_bulk_branch(tree, data, i);
+	struct rtree_page_branch *b = rtree_bulk_branch(tree, data, j);
+	memcpy(&tmp, a, tree->page_branch_size);
+	memcpy(a, b, tree->page_branch_size);
+	memcpy(b, &tmp, tree->page_branch_size);
+}
+
+/* Sort branches by the center of their rectangles along the axis */
+static void
+rtree_bulk_sort(const struct rtree *tree, char *data, size_t count,
+		unsigned axis)
+{
+	while (count > 16) {
+		/* Hoare partition around the median of three */
+		size_t mid = (count - 1) / 2;
+		if (rtree_bulk_key(tree, data, mid, axis) <
+		    rtree_bulk_key(tree, data, 0, axis))
+			rtree_bulk_swap(tree, data, mid, 0);
+		if (rtree_bulk_key(tree, data, count - 1, axis) <
+		    rtree_bulk_key(tree, data, mid, axis)) {
+			rtree_bulk_swap(tree, data, count - 1, mid);
+			if (rtree_bulk_key(tree, data, mid, axis) <
+			    rtree_bulk_key(tree, data, 0, axis))
+				rtree_bulk_swap(tree, data, mid, 0);
+		}
+		coord_t pivot = rtree_bulk_key(tree, data, mid, axis);
+		size_t i = 0, j = count - 1;
+		while (true) {
+			while (rtree_bulk_key(tree, data, i, axis) < pivot)
+				i++;
+			while (rtree_bulk_key(tree, data, j, axis) > pivot)
+				j--;
+			if (i >= j)
+				break;
+			rtree_bulk_swap(tree, data, i++, j--);
+		}
+		/* [0, j] <= pivot <= [j + 1, count), recurse into smaller */
+		size_t left = j + 1;
+		char *right_data = (char *)rtree_bulk_branch(tree, data, left);
+		if (left < count - left) {
+			rtree_bulk_sort(tree, data, left, axis);
+			data = right_data;
+			count -= left;
+		} else {
+			rtree_bulk_sort(tree, right_data, count - left, axis);
+			count = left;
+		}
+	}
+	for (size_t i = 1; i < count; i++) {
+		for (size_t j = i; j > 0 &&
+		     rtree_bulk_key(tree, data, j, axis) <
+		     rtree_bulk_key(tree, data, j - 1, axis); j--)
+			rtree_bulk_swap(tree, data, j, j - 1);
+	}
+}
+
+/* Smallest s such that s ^ k >= n */
+static size_t
+rtree_bulk_root(size_t n, unsigned k)
+{
+	size_t s = 1;
+	while (true) {
+		size_t p = 1;
+		for (unsigned i = 0; i < k && p < n; i++)
+			p *= s;
+		if (p >= n)
+			return s;
+		s++;
+	}
+}
+
+/*
+ * Sort-Tile-Recursive: sort branches along the first axis, cut
+ * them into slabs, and sort each slab recursively along the rest
+ * of the axes, so that consecutive runs of page_max_fill branches
+ * make compact pages.
+ */
+static void
+rtree_bulk_str(const struct rtree *tree, char *data, size_t count,
+	       unsigned axis)
+{
+	rtree_bulk_sort(tree, data, count, axis);
+	if (axis + 1 == tree->dimension)
+		return;
+	size_t max_fill = tree->page_max_fill;
+	size_t pages = (count + max_fill - 1) / max_fill;
+	size_t slabs = rtree_bulk_root(pages, tree->dimension - axis);
+	size_t slab_size = (pages + slabs - 1) / slabs * max_fill;
+	for (size_t i = 0; i < count; i += slab_size) {
+		size_t n = count - i < slab_size ? count - i : slab_size;
+		rtree_bulk_str(tree, (char *)rtree_bulk_branch(tree, data, i),
+			       n, axis + 1);
+	}
+}
+
+/*
+ * Pack consecutive branches into pages, spreading them evenly so
+ * that no page is less than half full. The branches are replaced
+ * in place with branches pointing to the new pages.
+ * Returns the number of pages.
+ */
+static size_t
+rtree_bulk_pack(struct rtree *tree, char *data, size_t count)
+{
+	size_t max_fill = tree->page_max_fill;
+	size_t pages = (count + max_fill - 1) / max_fill;
+	size_t pos = 0;
+	for (size_t i = 0; i < pages; i++) {
+		size_t end = count * (i + 1) / pages;
+		struct rtree_page *page = rtree_page_alloc(tree);
+		tree->n_pages++;
+		page->n = end - pos;
+		memcpy(page->data, rtree_bulk_branch(tree, data, pos),
+		       page->n * tree->page_branch_size);
+		pos = end;
+		/* Branches up to pos are consumed, it's safe to reuse */
+		struct rtree_page_branch *b = rtree_bulk_branch(tree, data, i);
+		rtree_page_cover(tree, page, &b->rect);
+		b->data.page = page;
+	}
+	return pages;
+}
+
+void
+rtree_bulk_load(struct rtree *tree, struct rtree_bulk *bulk)
+{
+	assert(tree->root == NULL);
+	size_t count = bulk->count;
+	if (count == 0)
+		return;
+	unsigned height = 0;
+	do {
+		rtree_bulk_str(tree, bulk->data, count, 0);
+		count = rtree_bulk_pack(tree, bulk->data, count);
+		height++;
+	} while (count > 1);
+	assert(height <= RTREE_MAX_HEIGHT);
+	tree->root = rtree_bulk_branch(tree, bulk->data, 0)->data.page;
+	tree->height = height;
+	tree->n_records = bulk->count;
+	tree->version++;
+	bulk->count = 0;
+}
+
 #if 0
 #include <stdio.h>
 void
@@ -154,6 +154,20 @@ struct rtree
 	enum rtree_distance_type distance_type;
 };
 
+/*
+ * Buffer of records for bulk loading, see rtree_bulk_load().
+ * Records are stored in the same format as in tree pages.
+ */
+struct rtree_bulk
+{
+	/* Array of records with their rectangles */
+	char *data;
+	/* Number of records in the buffer */
+	size_t count;
+	/* Number of records the buffer can hold */
+	size_t capacity;
+};
+
 /* Struct for iteration and retrieving rtree values */
 struct rtree_iterator
 {
@@ -285,6 +299,54 @@ rtree_insert(struct rtree *tree, struct rtree_rect *rect, record_t obj);
 bool
 rtree_remove(struct rtree *tree, const struct rtree_rect *rect, record_t obj);
 
+/**
+ * @brief Initialize a bulk loading buffer
+ * @param bulk - pointer to a buffer
+ */
+void
+rtree_bulk_create(struct rtree_bulk *bulk);
+
+/**
+ * @brief Free memory used by a bulk loading buffer
+ * @param bulk - pointer to a buffer
+ */
+void
+rtree_bulk_destroy(struct rtree_bulk *bulk);
+
+/**
+ * @brief Reserve space in a bulk loading buffer
+ * @param tree - pointer to a tree the buffer is going to be loaded to
+ * @param bulk - pointer to a buffer
+ * @param capacity - number of records to reserve space for
+ * @return 0 on success, -1 on memory allocation error
+ */
+int
+rtree_bulk_reserve(const struct rtree *tree, struct rtree_bulk *bulk,
+		   size_t capacity);
+
+/**
+ * @brief Add a record to a bulk loading buffer
+ * @param tree - pointer to a tree the buffer is going to be loaded to
+ * @param bulk - pointer to a buffer
+ * @param rect - rectangle of the record
+ * @param obj - record to add
+ * @return 0 on success, -1 on memory allocation error
+ */
+int
+rtree_bulk_add(const struct rtree *tree, struct rtree_bulk *bulk,
+	       const struct rtree_rect *rect, record_t obj);
+
+/**
+ * @brief Build an empty tree from the records of a bulk loading buffer
+ * The tree is packed with Sort-Tile-Recursive algorithm, which is
+ * much faster than inserting records one by one and gives a tree with
+ * fewer and less overlapping pages. The buffer is left empty.
+ * @param tree - pointer to an empty tree
+ * @param bulk - pointer to a buffer
+ */
+void
+rtree_bulk_load(struct rtree *tree, struct rtree_bulk *bulk);
+
 /**
  * @brief Size of memory used by tree
  * @param tree - pointer to a tree
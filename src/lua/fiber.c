@@ -304,6 +304,63 @@ lbox_fiber_create(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Return statistics of fiber stacks of the current thread.
+ */
+static int
+lbox_fiber_stack_info(struct lua_State *L)
+{
+	struct fiber_stack_stat stat;
+	fiber_stack_stat(&stat);
+	lua_newtable(L);
+	lua_pushnumber(L, stat.size);
+	lua_setfield(L, -2, "size");
+	lua_pushboolean(L, stat.guard);
+	lua_setfield(L, -2, "guard");
+	lua_pushnumber(L, stat.created);
+	lua_setfield(L, -2, "created");
+	lua_pushnumber(L, stat.reused);
+	lua_setfield(L, -2, "reused");
+	uint64_t total = stat.created + stat.reused;
+	lua_pushnumber(L, total != 0 ? (double) stat.reused / total : 0);
+	lua_setfield(L, -2, "reuse_rate");
+	lua_pushnumber(L, stat.released);
+	lua_setfield(L, -2, "released");
+	lua_pushnumber(L, stat.idle);
+	lua_setfield(L, -2, "idle");
+	lua_pushnumber(L, stat.rss);
+	lua_setfield(L, -2, "rss");
+	lua_pushnumber(L, stat.page_faults);
+	lua_setfield(L, -2, "page_faults");
+	return 1;
+}
+
+/**
+ * Set the stack size of fibers created from now on.
+ */
+static int
+lbox_fiber_set_stack_size(struct lua_State *L)
+{
+	if (lua_gettop(L) != 1 || !lua_isnumber(L, 1))
+		luaL_error(L, "fiber.set_stack_size(size): bad arguments");
+	if (cord_set_fiber_stack_size(lua_tonumber(L, 1)) != 0)
+		luaT_error(L);
+	return 0;
+}
+
+/**
+ * Enable or disable the guard page of stacks of fibers
+ * created from now on.
+ */
+static int
+lbox_fiber_set_stack_guard(struct lua_State *L)
+{
+	if (lua_gettop(L) != 1 || !lua_isboolean(L, 1))
+		luaL_error(L, "fiber.set_stack_guard(enable): bad arguments");
+	cord_set_fiber_stack_guard(lua_toboolean(L, 1));
+	return 0;
+}
+
 /**
  * Get fiber status.
  * This follows the rules of Lua coroutine.status() function:
@@ -526,6 +583,9 @@ static const struct luaL_reg lbox_fiber_meta [] = {
 
 static const struct luaL_reg fiberlib[] = {
 	{"info", lbox_fiber_info},
+	{"stack_info", lbox_fiber_stack_info},
+	{"set_stack_size", lbox_fiber_set_stack_size},
+	{"set_stack_guard", lbox_fiber_set_stack_guard},
 	{"sleep", lbox_fiber_sleep},
 	{"yield", lbox_fiber_yield},
 	{"self", lbox_fiber_self},
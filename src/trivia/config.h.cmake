@@ -51,6 +51,11 @@
  * showing fiber call stack.
  */
 #cmakedefine ENABLE_BACKTRACE 1
+/*
+ * Defined if cooperative file I/O should use io_uring when
+ * the kernel supports it.
+ */
+#cmakedefine ENABLE_IO_URING 1
 /*
  * Set if the system has bfd.h header and GNU bfd library.
  */
@@ -96,6 +101,14 @@
  * Defined if this platform has GNU specific memrchr().
  */
 #cmakedefine HAVE_MEMRCHR 1
+/*
+ * Defined if this platform has Linux specific sync_file_range().
+ */
+#cmakedefine HAVE_SYNC_FILE_RANGE 1
+/*
+ * Defined if this platform has Linux specific fallocate().
+ */
+#cmakedefine HAVE_FALLOCATE 1
 /*
  * Defined if this platform has sendfile(..).
  */
@@ -388,6 +388,29 @@ fiber.sleep(0.01)
 
 box.space.test2066:drop()
 
+-- fiber stack statistics
+info = fiber.stack_info()
+reused = info.reused
+_ = fiber.create(function() end)
+info = fiber.stack_info()
+info.reused == reused + 1
+info.size > 0 and info.rss > 0 and info.page_faults > 0
+info.reuse_rate > 0 and info.reuse_rate <= 1
+info.guard
+-- stack settings
+size = info.size
+fiber.set_stack_size()
+(pcall(fiber.set_stack_size, 1))
+fiber.set_stack_size(128 * 1024)
+fiber.set_stack_guard(false)
+created = fiber.stack_info().created
+fiber.create(function() end) ~= nil
+info = fiber.stack_info()
+info.created == created + 1
+info.size, info.guard
+fiber.set_stack_size(size)
+fiber.set_stack_guard(true)
+
 fiber = nil
 
 test_run:cmd("clear filter")
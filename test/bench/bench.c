@@ -0,0 +1,141 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+	BENCH_ROUNDS_DEFAULT = 21,
+	BENCH_ROUNDS_MAX = 1000,
+};
+
+volatile uint64_t bench_sink;
+
+static int bench_rounds = BENCH_ROUNDS_DEFAULT;
+static const char *bench_filter = NULL;
+
+static inline uint64_t
+bench_clock(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int
+bench_cmp(const void *a, const void *b)
+{
+	double x = *(const double *) a;
+	double y = *(const double *) b;
+	return x < y ? -1 : x > y;
+}
+
+/** Nearest-rank percentile of a sorted array of samples. */
+static double
+bench_percentile(const double *samples, int count, int p)
+{
+	int rank = (p * count + 99) / 100;
+	if (rank < 1)
+		rank = 1;
+	return samples[rank - 1];
+}
+
+void
+bench_init(void)
+{
+	const char *rounds = getenv("BENCH_ROUNDS");
+	if (rounds != NULL && atoi(rounds) > 0) {
+		bench_rounds = atoi(rounds);
+		if (bench_rounds > BENCH_ROUNDS_MAX)
+			bench_rounds = BENCH_ROUNDS_MAX;
+	}
+	const char *filter = getenv("BENCH_FILTER");
+	if (filter != NULL && *filter != '\0')
+		bench_filter = filter;
+}
+
+bool
+bench_is_enabled(const char *name)
+{
+	return bench_filter == NULL || strstr(name, bench_filter) != NULL;
+}
+
+void
+bench_run(const struct bench *bench, void *arg, size_t count)
+{
+	if (!bench_is_enabled(bench->name))
+		return;
+	double samples[BENCH_ROUNDS_MAX];
+	double sum = 0;
+	for (int i = -1; i < bench_rounds; i++) {
+		if (bench->setup != NULL)
+			bench->setup(arg);
+		uint64_t start = bench_clock();
+		bench->run(arg, count);
+		uint64_t elapsed = bench_clock() - start;
+		if (bench->teardown != NULL)
+			bench->teardown(arg);
+		/* The first round is a warm-up. */
+		if (i < 0)
+			continue;
+		samples[i] = (double) elapsed / count;
+		sum += samples[i];
+	}
+	qsort(samples, bench_rounds, sizeof(*samples), bench_cmp);
+	printf("{\"name\": \"%s\", \"count\": %zu, \"rounds\": %d, "
+	       "\"unit\": \"ns/op\", \"min\": %.2f, \"p50\": %.2f, "
+	       "\"p90\": %.2f, \"p99\": %.2f, \"max\": %.2f, "
+	       "\"mean\": %.2f}\n", bench->name, count, bench_rounds,
+	       samples[0], bench_percentile(samples, bench_rounds, 50),
+	       bench_percentile(samples, bench_rounds, 90),
+	       bench_percentile(samples, bench_rounds, 99),
+	       samples[bench_rounds - 1], sum / bench_rounds);
+	fflush(stdout);
+}
+
+void
+bench_shuffle(uint64_t *keys, size_t count)
+{
+	/* xorshift64* with a fixed seed */
+	uint64_t state = 88172645463325252ULL;
+	for (size_t i = count; i > 1; i--) {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		size_t j = (state * 2685821657736338717ULL) % i;
+		uint64_t tmp = keys[i - 1];
+		keys[i - 1] = keys[j];
+		keys[j] = tmp;
+	}
+}
@@ -0,0 +1,109 @@
+#ifndef INCLUDES_TARANTOOL_TEST_BENCH_H
+#define INCLUDES_TARANTOOL_TEST_BENCH_H
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * A tiny benchmark harness.
+ *
+ * A benchmark is a function performing a given number of
+ * operations. It is run once to warm up and then BENCH_ROUNDS
+ * times, each round is timed separately. The result is printed
+ * to stdout as a single JSON object per line:
+ *
+ * {"name": "bps_tree.find", "count": 1000000, "rounds": 21,
+ *  "unit": "ns/op", "min": 105.21, "p50": 107.90, "p90": 112.40,
+ *  "p99": 120.02, "max": 120.02, "mean": 108.31}
+ *
+ * Percentiles are calculated over the time per operation of
+ * the rounds. Results are collected and compared against a
+ * baseline by test/bench/bench.py (`make bench`).
+ *
+ * Environment variables:
+ * BENCH_ROUNDS - the number of timed rounds, 21 by default;
+ * BENCH_FILTER - run only benchmarks which names contain
+ *                the given substring.
+ */
+struct bench {
+	/** Benchmark name, "<subject>.<operation>". */
+	const char *name;
+	/** Called before each round, not timed. May be NULL. */
+	void (*setup)(void *arg);
+	/** Perform @a count operations. */
+	void (*run)(void *arg, size_t count);
+	/** Called after each round, not timed. May be NULL. */
+	void (*teardown)(void *arg);
+};
+
+/**
+ * Store a result of a benchmarked operation here to prevent
+ * the compiler from optimizing the operation out.
+ */
+extern volatile uint64_t bench_sink;
+
+/** Read the harness settings from the environment. */
+void
+bench_init(void);
+
+/**
+ * Return true if a benchmark with the given name is enabled
+ * by BENCH_FILTER. Use to skip expensive preparation of
+ * disabled benchmarks.
+ */
+bool
+bench_is_enabled(const char *name);
+
+/**
+ * Run a benchmark and print the result, @sa struct bench.
+ * Does nothing if the benchmark is disabled.
+ */
+void
+bench_run(const struct bench *bench, void *arg, size_t count);
+
+/**
+ * Shuffle an array of keys. The permutation depends only on
+ * the array size, so that results are reproducible.
+ */
+void
+bench_shuffle(uint64_t *keys, size_t count);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* INCLUDES_TARANTOOL_TEST_BENCH_H */
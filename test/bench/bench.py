@@ -0,0 +1,168 @@
+#!/usr/bin/env python
+"""Run microbenchmarks and compare the results against a baseline.
+
+Every benchmark prints its results to stdout as JSON objects,
+one per line (see test/bench/bench.h). The script runs all
+benchmark executables (*.bench) found in the build directory
+and box_bench.lua, collects the results and optionally saves
+them to a file and compares them against a previously saved
+baseline.
+
+Typical usage:
+
+    make bench                                  # run, save bench.json
+    cp test/bench/bench.json /tmp/base.json     # remember the baseline
+    ... change the code, rebuild ...
+    BENCH_BASELINE=/tmp/base.json make bench    # run and compare
+
+or directly:
+
+    test/bench/bench.py --builddir=. --baseline=/tmp/base.json \\
+        --filter=bps_tree --rounds=51
+
+A benchmark is reported as a regression if its metric (p50 by
+default) grew more than the threshold (10% by default). The
+exit code is 1 if there is at least one regression.
+"""
+
+from __future__ import print_function
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+
+METRICS = ('min', 'p50', 'p90', 'p99', 'max', 'mean')
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--builddir', default='.',
+                        help='build directory, default: %(default)s')
+    parser.add_argument('--output', help='save results to this file')
+    parser.add_argument('--input',
+                        help='do not run benchmarks, load results '
+                             'from this file instead')
+    parser.add_argument('--baseline',
+                        default=os.environ.get('BENCH_BASELINE'),
+                        help='compare results against this file, '
+                             'default: $BENCH_BASELINE')
+    parser.add_argument('--threshold', type=float,
+                        default=float(os.environ.get('BENCH_THRESHOLD',
+                                                     10)),
+                        help='regression threshold, percent, '
+                             'default: %(default)s')
+    parser.add_argument('--metric', choices=METRICS, default='p50',
+                        help='metric to compare, default: %(default)s')
+    parser.add_argument('--filter',
+                        help='run only benchmarks which names contain '
+                             'this substring')
+    parser.add_argument('--rounds', type=int,
+                        help='the number of timed rounds per benchmark')
+    return parser.parse_args()
+
+
+def run_one(command, cwd, env):
+    print('Running %s' % ' '.join(command), file=sys.stderr)
+    proc = subprocess.Popen(command, cwd=cwd, env=env,
+                            stdout=subprocess.PIPE)
+    results = []
+    for line in proc.stdout:
+        line = line.decode('utf-8').strip()
+        if not line.startswith('{'):
+            continue
+        result = json.loads(line)
+        print('  %-40s %10.2f %s' % (result['name'], result['p50'],
+                                     result['unit']), file=sys.stderr)
+        results.append(result)
+    if proc.wait() != 0:
+        raise RuntimeError('%s failed with exit code %d' %
+                           (command[0], proc.returncode))
+    return results
+
+
+def run_all(args):
+    builddir = os.path.abspath(args.builddir)
+    benchdir = os.path.join(builddir, 'test', 'bench')
+    env = dict(os.environ)
+    env['BUILDDIR'] = builddir
+    if args.filter:
+        env['BENCH_FILTER'] = args.filter
+    if args.rounds:
+        env['BENCH_ROUNDS'] = str(args.rounds)
+
+    commands = [[path] for path in
+                sorted(glob.glob(os.path.join(benchdir, '*.bench')))]
+    tarantool = os.path.join(builddir, 'src', 'tarantool')
+    script = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                          'box_bench.lua')
+    if os.path.exists(tarantool):
+        commands.append([tarantool, script])
+    if not commands:
+        raise RuntimeError('no benchmarks found in %s' % benchdir)
+
+    results = []
+    for command in commands:
+        results.extend(run_one(command, benchdir, env))
+    return results
+
+
+def compare(results, baseline, metric, threshold):
+    """Print a comparison table, return the number of regressions."""
+    base = dict((r['name'], r) for r in baseline)
+    regressions = 0
+    print('%-40s %12s %12s %9s' % ('name', 'baseline', 'current',
+                                   'change'))
+    for result in results:
+        name = result['name']
+        if name not in base:
+            print('%-40s %12s %12.2f %9s' % (name, '-', result[metric],
+                                             'new'))
+            continue
+        old = base[name][metric]
+        new = result[metric]
+        change = (new - old) * 100.0 / old if old > 0 else 0.0
+        verdict = ''
+        if change > threshold:
+            verdict = 'REGRESSION'
+            regressions += 1
+        elif change < -threshold:
+            verdict = 'improvement'
+        print('%-40s %12.2f %12.2f %+8.1f%% %s' % (name, old, new,
+                                                   change, verdict))
+    return regressions
+
+
+def main():
+    args = parse_args()
+    if args.input:
+        with open(args.input) as f:
+            results = json.load(f)['benchmarks']
+    else:
+        try:
+            results = run_all(args)
+        except RuntimeError as e:
+            print(e, file=sys.stderr)
+            return 2
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump({'benchmarks': results}, f, indent=2,
+                      sort_keys=True)
+    if not args.baseline:
+        return 0
+    with open(args.baseline) as f:
+        baseline = json.load(f)['benchmarks']
+    regressions = compare(results, baseline, args.metric, args.threshold)
+    if regressions > 0:
+        print('%d regression(s) over %.1f%% in %s' %
+              (regressions, args.threshold, args.metric))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bench.h"
+#include "salad/bloom.h"
+
+enum { KEY_COUNT = 1000000 };
+
+/** The default vinyl bloom_fpr. */
+static const double FALSE_POSITIVE_RATE = 0.05;
+
+struct bloom_bench {
+	struct bloom bloom;
+	/** Even numbers 0..2 * KEY_COUNT in random order. */
+	uint64_t *keys;
+};
+
+static inline bloom_hash_t
+hash(uint64_t value)
+{
+	/* murmur3 finalizer */
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	return (bloom_hash_t) value;
+}
+
+static void
+add_run(void *arg, size_t count)
+{
+	struct bloom_bench *b = arg;
+	for (size_t i = 0; i < count; i++)
+		bloom_add(&b->bloom, hash(b->keys[i]));
+}
+
+static void
+probe_run(void *arg, size_t count)
+{
+	struct bloom_bench *b = arg;
+	uint64_t found = 0;
+	for (size_t i = 0; i < count; i++)
+		found += bloom_possible_has(&b->bloom, hash(b->keys[i]));
+	bench_sink = found;
+}
+
+static void
+probe_miss_run(void *arg, size_t count)
+{
+	struct bloom_bench *b = arg;
+	uint64_t found = 0;
+	for (size_t i = 0; i < count; i++)
+		found += bloom_possible_has(&b->bloom, hash(b->keys[i] + 1));
+	bench_sink = found;
+}
+
+int
+main(void)
+{
+	bench_init();
+
+	struct quota quota;
+	quota_init(&quota, QUOTA_MAX);
+
+	struct bloom_bench b;
+	b.keys = malloc(KEY_COUNT * sizeof(*b.keys));
+	if (b.keys == NULL)
+		abort();
+	for (size_t i = 0; i < KEY_COUNT; i++)
+		b.keys[i] = 2 * i;
+	bench_shuffle(b.keys, KEY_COUNT);
+
+	if (bloom_create(&b.bloom, KEY_COUNT, FALSE_POSITIVE_RATE,
+			 &quota) != 0)
+		abort();
+	const struct bench add = {
+		"bloom.add", NULL, add_run, NULL
+	};
+	const struct bench probe = {
+		"bloom.probe", NULL, probe_run, NULL
+	};
+	const struct bench probe_miss = {
+		"bloom.probe_miss", NULL, probe_miss_run, NULL
+	};
+	bench_run(&add, &b, KEY_COUNT);
+	bench_run(&probe, &b, KEY_COUNT);
+	bench_run(&probe_miss, &b, KEY_COUNT);
+	bloom_destroy(&b.bloom, &quota);
+
+	free(b.keys);
+	return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Benchmarks which need a configured box: tuple comparators
+ * and tuple update. Built as a module and run by box_bench.lua.
+ */
+#include "module.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <msgpuck.h>
+#include <lua.h>
+#include <lauxlib.h>
+
+#include "bench.h"
+
+enum {
+	/** The number of tuples, must be a power of 2. */
+	TUPLE_COUNT = 1024,
+	OP_COUNT = 1000000,
+};
+
+enum { KEY_UNSIGNED, KEY_STRING, KEY_UNSIGNED_STRING, KEY_MAX };
+
+struct box_bench {
+	box_key_def_t *key_defs[KEY_MAX];
+	/** Key definition used by the current benchmark. */
+	box_key_def_t *key_def;
+	box_tuple_t *tuples[TUPLE_COUNT];
+	/** Keys of tuples for key_def, with MsgPack array header. */
+	char *keys[TUPLE_COUNT];
+	/** Update operations. */
+	char ops[64];
+	const char *ops_end;
+};
+
+static struct box_bench b;
+
+static void
+compare_run(void *arg, size_t count)
+{
+	(void) arg;
+	int64_t sum = 0;
+	for (size_t i = 0; i < count; i++) {
+		box_tuple_t *t1 = b.tuples[i % TUPLE_COUNT];
+		box_tuple_t *t2 = b.tuples[(i * 7 + 1) % TUPLE_COUNT];
+		sum += box_tuple_compare(t1, t2, b.key_def);
+	}
+	bench_sink = sum;
+}
+
+static void
+compare_with_key_run(void *arg, size_t count)
+{
+	(void) arg;
+	int64_t sum = 0;
+	for (size_t i = 0; i < count; i++) {
+		box_tuple_t *t = b.tuples[i % TUPLE_COUNT];
+		const char *key = b.keys[(i * 7 + 1) % TUPLE_COUNT];
+		sum += box_tuple_compare_with_key(t, key, b.key_def);
+	}
+	bench_sink = sum;
+}
+
+static void
+update_run(void *arg, size_t count)
+{
+	(void) arg;
+	for (size_t i = 0; i < count; i++) {
+		box_tuple_t *t = box_tuple_update(b.tuples[i % TUPLE_COUNT],
+						  b.ops, b.ops_end);
+		if (t == NULL)
+			abort();
+	}
+}
+
+enum { MERGE_KEY_COUNT = 100000 };
+
+/** Scan a vinyl space, @a arg is the space id. */
+static void
+merge_run(void *arg, size_t count)
+{
+	uint32_t space_id = *(uint32_t *) arg;
+	char key[8];
+	char *key_end = mp_encode_array(key, 0);
+	size_t done = 0;
+	while (done < count) {
+		box_iterator_t *it = box_index_iterator(space_id, 0, ITER_ALL,
+							key, key_end);
+		if (it == NULL)
+			abort();
+		box_tuple_t *tuple;
+		for (; done < count; done++) {
+			if (box_iterator_next(it, &tuple) != 0)
+				abort();
+			if (tuple == NULL)
+				break;
+		}
+		box_iterator_free(it);
+	}
+}
+
+/**
+ * Scan a vinyl space with @a run_count runs, so that the merge
+ * iterator has that many sources. The space is created by
+ * box_bench.lua.
+ */
+static void
+merge_bench(uint32_t run_count)
+{
+	char name[64];
+	snprintf(name, sizeof(name), "bench_merge_%u", run_count);
+	uint32_t space_id = box_space_id_by_name(name, strlen(name));
+	if (space_id == BOX_ID_NIL)
+		return;
+	snprintf(name, sizeof(name), "vinyl.merge.%u", run_count);
+	const struct bench merge = {
+		name, NULL, merge_run, NULL
+	};
+	bench_run(&merge, &space_id, MERGE_KEY_COUNT);
+}
+
+/** Extract the first @a part_count fields of each tuple. */
+static void
+keys_create(uint32_t part_count)
+{
+	for (int i = 0; i < TUPLE_COUNT; i++) {
+		const char *data = box_tuple_field(b.tuples[i], 0);
+		const char *end = data;
+		/* All tuples are [unsigned, string, ...] */
+		mp_next(&end);
+		if (part_count > 1)
+			mp_next(&end);
+		char *key = malloc(mp_sizeof_array(part_count) + (end - data));
+		if (key == NULL)
+			abort();
+		memcpy(mp_encode_array(key, part_count), data, end - data);
+		free(b.keys[i]);
+		b.keys[i] = key;
+	}
+}
+
+static void
+compare_bench(const char *name, int key, uint32_t part_count)
+{
+	char compare_name[64], with_key_name[64];
+	snprintf(compare_name, sizeof(compare_name), "tuple_compare.%s",
+		 name);
+	snprintf(with_key_name, sizeof(with_key_name),
+		 "tuple_compare_with_key.%s", name);
+	b.key_def = b.key_defs[key];
+	keys_create(part_count);
+
+	const struct bench compare = {
+		compare_name, NULL, compare_run, NULL
+	};
+	const struct bench compare_with_key = {
+		with_key_name, NULL, compare_with_key_run, NULL
+	};
+	bench_run(&compare, NULL, OP_COUNT);
+	bench_run(&compare_with_key, NULL, OP_COUNT);
+}
+
+static void
+update_bench(const char *name, const char *op, uint32_t fieldno)
+{
+	char *pos = b.ops;
+	pos = mp_encode_array(pos, 1);
+	pos = mp_encode_array(pos, 3);
+	pos = mp_encode_str(pos, op, strlen(op));
+	pos = mp_encode_uint(pos, fieldno);
+	pos = mp_encode_uint(pos, 1);
+	b.ops_end = pos;
+
+	const struct bench update = {
+		name, NULL, update_run, NULL
+	};
+	bench_run(&update, NULL, OP_COUNT);
+}
+
+/**
+ * Run all benchmarks. Must be called from the tx thread
+ * after box.cfg{}.
+ */
+static int
+box_bench(void)
+{
+	bench_init();
+
+	uint32_t fields[] = { 0, 1 };
+	uint32_t unsigned_type[] = { FIELD_TYPE_UNSIGNED };
+	uint32_t string_type[] = { FIELD_TYPE_STRING };
+	uint32_t unsigned_string_types[] = {
+		FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING
+	};
+	uint32_t string_field[] = { 1 };
+	b.key_defs[KEY_UNSIGNED] = box_key_def_new(fields, unsigned_type, 1);
+	b.key_defs[KEY_STRING] = box_key_def_new(string_field,
+						 string_type, 1);
+	b.key_defs[KEY_UNSIGNED_STRING] =
+		box_key_def_new(fields, unsigned_string_types, 2);
+	for (int i = 0; i < KEY_MAX; i++) {
+		if (b.key_defs[i] == NULL)
+			return -1;
+	}
+	box_tuple_format_t *format = box_tuple_format_new(b.key_defs, KEY_MAX);
+	if (format == NULL)
+		return -1;
+
+	/*
+	 * [id, 'name', counter, 'payload'], ids are not unique,
+	 * so that comparators have to look at the second part.
+	 */
+	char data[256];
+	for (int i = 0; i < TUPLE_COUNT; i++) {
+		char name[32];
+		int name_len = snprintf(name, sizeof(name), "tuple name %04d",
+					(i * 37) % TUPLE_COUNT);
+		char *pos = data;
+		pos = mp_encode_array(pos, 4);
+		pos = mp_encode_uint(pos, i / 4 * 1000);
+		pos = mp_encode_str(pos, name, name_len);
+		pos = mp_encode_uint(pos, i);
+		pos = mp_encode_str(pos, "payload", strlen("payload"));
+		b.tuples[i] = box_tuple_new(format, data, pos);
+		if (b.tuples[i] == NULL)
+			return -1;
+		box_tuple_ref(b.tuples[i]);
+	}
+
+	compare_bench("unsigned", KEY_UNSIGNED, 1);
+	compare_bench("unsigned_string", KEY_UNSIGNED_STRING, 2);
+
+	/* The string part is the first part of the key. */
+	b.key_def = b.key_defs[KEY_STRING];
+	const struct bench compare_string = {
+		"tuple_compare.string", NULL, compare_run, NULL
+	};
+	bench_run(&compare_string, NULL, OP_COUNT);
+
+	update_bench("tuple_update.assign", "=", 3);
+	update_bench("tuple_update.arith", "+", 3);
+
+	merge_bench(2);
+	merge_bench(8);
+	merge_bench(32);
+
+	for (int i = 0; i < TUPLE_COUNT; i++) {
+		box_tuple_unref(b.tuples[i]);
+		free(b.keys[i]);
+	}
+	box_tuple_format_unref(format);
+	for (int i = 0; i < KEY_MAX; i++)
+		box_key_def_delete(b.key_defs[i]);
+	return 0;
+}
+
+/**
+ * Lua: box_bench.run() runs all benchmarks and returns 0 on
+ * success. Unlike an FFI call, a Lua C function may yield,
+ * which vinyl does on disk reads.
+ */
+static int
+lbox_bench_run(lua_State *L)
+{
+	lua_pushinteger(L, box_bench());
+	return 1;
+}
+
+LUA_API int
+luaopen_box_bench(lua_State *L)
+{
+	static const struct luaL_reg lib[] = {
+		{"run", lbox_bench_run},
+		{NULL, NULL}
+	};
+	luaL_register(L, "box_bench", lib);
+	return 1;
+}
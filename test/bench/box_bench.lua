@@ -0,0 +1,59 @@
+#!/usr/bin/env tarantool
+
+--
+-- Run benchmarks of box_bench module, @sa box_bench.c.
+-- The module is looked up in the current directory and
+-- in $BUILDDIR/test/bench.
+--
+local fio = require('fio')
+
+local build_path = os.getenv('BUILDDIR') or '.'
+package.cpath = './?.so;./?.dylib;' ..
+    build_path .. '/test/bench/?.so;' ..
+    build_path .. '/test/bench/?.dylib;' .. package.cpath
+
+local work_dir = fio.tempdir()
+box.cfg{
+    work_dir = work_dir,
+    wal_mode = 'none',
+    memtx_memory = 512 * 1024 * 1024,
+    log = 'box_bench.log',
+}
+
+--
+-- Vinyl spaces for vinyl.merge.<N> benchmarks. A space has
+-- N runs with interleaved keys, so that a scan merges them all.
+-- Must be in sync with MERGE_KEY_COUNT in box_bench.c.
+--
+local MERGE_KEY_COUNT = 100000
+local filter = os.getenv('BENCH_FILTER')
+for _, run_count in ipairs({2, 8, 32}) do
+    local bench_name = 'vinyl.merge.' .. run_count
+    if filter == nil or bench_name:find(filter, 1, true) then
+        local s = box.schema.space.create('bench_merge_' .. run_count,
+                                          {engine = 'vinyl'})
+        s:create_index('pk', {run_count_per_level = 100,
+                              range_size = 1024 * 1024 * 1024})
+        for run = 0, run_count - 1 do
+            box.begin()
+            for key = run, MERGE_KEY_COUNT - 1, run_count do
+                s:replace{key, run}
+            end
+            box.commit()
+            box.snapshot()
+        end
+    end
+end
+
+local rc = require('box_bench').run()
+
+for _, file in ipairs(fio.glob(fio.pathjoin(work_dir, '*'))) do
+    fio.unlink(file)
+end
+fio.rmdir(work_dir)
+
+if rc ~= 0 then
+    io.stderr:write(tostring(box.error.last()) .. '\n')
+    os.exit(1)
+end
+os.exit(0)
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bench.h"
+
+#define BPS_TREE_NAME bench_tree
+#define BPS_TREE_BLOCK_SIZE 512 /* same as in memtx_tree */
+#define BPS_TREE_EXTENT_SIZE (16 * 1024)
+#define BPS_TREE_COMPARE(a, b, arg) ((a) < (b) ? -1 : (a) > (b))
+#define BPS_TREE_COMPARE_KEY(a, b, arg) ((a) < (b) ? -1 : (a) > (b))
+#define bps_tree_elem_t uint64_t
+#define bps_tree_key_t uint64_t
+#define bps_tree_arg_t int
+#include "salad/bps_tree.h"
+
+enum {
+	KEY_COUNT = 1000000,
+	/** The number of keys looked up at once by find_batch. */
+	BATCH_SIZE = 16,
+};
+
+struct tree_bench {
+	struct bench_tree tree;
+	/** Even numbers 0..2 * KEY_COUNT in random order. */
+	uint64_t *keys;
+	/** The same numbers, sorted. */
+	uint64_t *sorted;
+};
+
+static void *
+extent_alloc(void *ctx)
+{
+	(void) ctx;
+	return malloc(BPS_TREE_EXTENT_SIZE);
+}
+
+static void
+extent_free(void *ctx, void *extent)
+{
+	(void) ctx;
+	free(extent);
+}
+
+static void
+tree_create(void *arg)
+{
+	struct tree_bench *b = arg;
+	bench_tree_create(&b->tree, 0, extent_alloc, extent_free, NULL);
+}
+
+static void
+tree_build(void *arg)
+{
+	struct tree_bench *b = arg;
+	tree_create(b);
+	if (bench_tree_build(&b->tree, b->sorted, KEY_COUNT) != 0)
+		abort();
+}
+
+static void
+tree_destroy(void *arg)
+{
+	struct tree_bench *b = arg;
+	bench_tree_destroy(&b->tree);
+}
+
+static void
+insert_run(void *arg, size_t count)
+{
+	struct tree_bench *b = arg;
+	for (size_t i = 0; i < count; i++) {
+		if (bench_tree_insert(&b->tree, b->keys[i], NULL) != 0)
+			abort();
+	}
+}
+
+static void
+insert_sequential_run(void *arg, size_t count)
+{
+	struct tree_bench *b = arg;
+	for (size_t i = 0; i < count; i++) {
+		if (bench_tree_insert(&b->tree, b->sorted[i], NULL) != 0)
+			abort();
+	}
+}
+
+static void
+find_run(void *arg, size_t count)
+{
+	struct tree_bench *b = arg;
+	uint64_t found = 0;
+	for (size_t i = 0; i < count; i++)
+		found += bench_tree_find(&b->tree, b->keys[i]) != NULL;
+	bench_sink = found;
+}
+
+static void
+find_miss_run(void *arg, size_t count)
+{
+	struct tree_bench *b = arg;
+	uint64_t found = 0;
+	for (size_t i = 0; i < count; i++)
+		found += bench_tree_find(&b->tree, b->keys[i] + 1) != NULL;
+	bench_sink = found;
+}
+
+static void
+find_batch_run(void *arg, size_t count)
+{
+	struct tree_bench *b = arg;
+	uint64_t *result[BATCH_SIZE];
+	uint64_t found = 0;
+	for (size_t i = 0; i + BATCH_SIZE <= count; i += BATCH_SIZE) {
+		bench_tree_find_batch(&b->tree, b->keys + i, BATCH_SIZE,
+				      result);
+		for (int j = 0; j < BATCH_SIZE; j++)
+			found += result[j] != NULL;
+	}
+	bench_sink = found;
+}
+
+static void
+iterate_run(void *arg, size_t count)
+{
+	struct tree_bench *b = arg;
+	struct bench_tree_iterator it = bench_tree_iterator_first(&b->tree);
+	uint64_t sum = 0;
+	for (size_t i = 0; i < count; i++) {
+		sum += *bench_tree_iterator_get_elem(&b->tree, &it);
+		bench_tree_iterator_next(&b->tree, &it);
+	}
+	bench_sink = sum;
+}
+
+static void
+delete_run(void *arg, size_t count)
+{
+	struct tree_bench *b = arg;
+	for (size_t i = 0; i < count; i++) {
+		if (bench_tree_delete(&b->tree, b->keys[i]) != 0)
+			abort();
+	}
+}
+
+int
+main(void)
+{
+	bench_init();
+
+	struct tree_bench b;
+	b.keys = malloc(KEY_COUNT * sizeof(*b.keys));
+	b.sorted = malloc(KEY_COUNT * sizeof(*b.sorted));
+	if (b.keys == NULL || b.sorted == NULL)
+		abort();
+	for (size_t i = 0; i < KEY_COUNT; i++)
+		b.keys[i] = b.sorted[i] = 2 * i;
+	bench_shuffle(b.keys, KEY_COUNT);
+
+	const struct bench insert = {
+		"bps_tree.insert", tree_create, insert_run, tree_destroy
+	};
+	const struct bench insert_sequential = {
+		"bps_tree.insert_sequential", tree_create,
+		insert_sequential_run, tree_destroy
+	};
+	const struct bench del = {
+		"bps_tree.delete", tree_build, delete_run, tree_destroy
+	};
+	bench_run(&insert, &b, KEY_COUNT);
+	bench_run(&insert_sequential, &b, KEY_COUNT);
+	bench_run(&del, &b, KEY_COUNT);
+
+	/* Read-only benchmarks share one tree. */
+	const struct bench find = {
+		"bps_tree.find", NULL, find_run, NULL
+	};
+	const struct bench find_miss = {
+		"bps_tree.find_miss", NULL, find_miss_run, NULL
+	};
+	const struct bench find_batch = {
+		"bps_tree.find_batch", NULL, find_batch_run, NULL
+	};
+	const struct bench iterate = {
+		"bps_tree.iterate", NULL, iterate_run, NULL
+	};
+	tree_build(&b);
+	bench_run(&find, &b, KEY_COUNT);
+	bench_run(&find_miss, &b, KEY_COUNT);
+	bench_run(&find_batch, &b, KEY_COUNT);
+	bench_run(&iterate, &b, KEY_COUNT);
+	tree_destroy(&b);
+
+	free(b.keys);
+	free(b.sorted);
+	return 0;
+}
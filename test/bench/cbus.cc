@@ -0,0 +1,188 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdlib.h>
+
+#include "bench.h"
+#include "memory.h"
+#include "fiber.h"
+#include "cbus.h"
+
+enum {
+	CALL_COUNT = 100000,
+	MSG_COUNT = 1000000,
+};
+
+/** Worker thread, echoes messages back to the main thread. */
+static struct cord worker;
+/** Main thread -> worker. */
+static struct cpipe worker_pipe;
+/** Worker -> main thread. */
+static struct cpipe main_pipe;
+/** Main thread endpoint. */
+static struct cbus_endpoint main_endpoint;
+
+static int
+worker_f(va_list ap)
+{
+	(void) ap;
+	struct cbus_endpoint endpoint;
+	cbus_endpoint_create(&endpoint, "worker", fiber_schedule_cb, fiber());
+	cpipe_create(&main_pipe, "main");
+	cbus_loop(&endpoint);
+	cpipe_destroy(&main_pipe);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	return 0;
+}
+
+static void
+main_cb(struct ev_loop *loop, struct ev_watcher *watcher, int events)
+{
+	(void) loop;
+	(void) events;
+	cbus_process((struct cbus_endpoint *) watcher->data);
+}
+
+static int
+call_f(struct cbus_call_msg *msg)
+{
+	(void) msg;
+	return 0;
+}
+
+/** A synchronous round trip with cbus_call(). */
+static void
+call_run(void *arg, size_t count)
+{
+	(void) arg;
+	struct cbus_call_msg msg;
+	for (size_t i = 0; i < count; i++) {
+		if (cbus_call(&worker_pipe, &main_pipe, &msg, call_f,
+			      NULL, TIMEOUT_INFINITY) != 0)
+			abort();
+	}
+}
+
+struct push_bench {
+	struct cmsg *messages;
+	/** The number of messages which haven't returned yet. */
+	size_t in_flight;
+	/** The fiber waiting for the messages to return. */
+	struct fiber *fiber;
+};
+
+static struct push_bench push;
+
+static void
+ping_f(struct cmsg *msg)
+{
+	(void) msg;
+}
+
+static void
+pong_f(struct cmsg *msg)
+{
+	(void) msg;
+	if (--push.in_flight == 0)
+		fiber_wakeup(push.fiber);
+}
+
+static const struct cmsg_hop push_route[] = {
+	{ ping_f, &main_pipe },
+	{ pong_f, NULL },
+};
+
+/**
+ * Round trips of many messages at once, pushed with
+ * cpipe_push() and batched by the pipes.
+ */
+static void
+push_run(void *arg, size_t count)
+{
+	(void) arg;
+	push.in_flight = count;
+	push.fiber = fiber();
+	for (size_t i = 0; i < count; i++) {
+		cmsg_init(&push.messages[i], push_route);
+		cpipe_push(&worker_pipe, &push.messages[i]);
+	}
+	while (push.in_flight > 0)
+		fiber_yield();
+}
+
+static int
+main_f(va_list ap)
+{
+	(void) ap;
+	cbus_endpoint_create(&main_endpoint, "main", main_cb,
+			     &main_endpoint);
+	if (cord_costart(&worker, "worker", worker_f, NULL) != 0)
+		abort();
+	cpipe_create(&worker_pipe, "worker");
+
+	const struct bench call = {
+		"cbus.call", NULL, call_run, NULL
+	};
+	bench_run(&call, NULL, CALL_COUNT);
+
+	push.messages = (struct cmsg *) calloc(MSG_COUNT,
+					       sizeof(*push.messages));
+	if (push.messages == NULL)
+		abort();
+	const struct bench push_bench = {
+		"cbus.push", NULL, push_run, NULL
+	};
+	bench_run(&push_bench, NULL, MSG_COUNT);
+	free(push.messages);
+
+	cbus_stop_loop(&worker_pipe);
+	cpipe_destroy(&worker_pipe);
+	if (cord_cojoin(&worker) != 0)
+		abort();
+	cbus_endpoint_destroy(&main_endpoint, cbus_process);
+	ev_break(loop(), EVBREAK_ALL);
+	return 0;
+}
+
+int
+main(void)
+{
+	memory_init();
+	fiber_init(fiber_cxx_invoke);
+	cbus_init();
+	bench_init();
+	struct fiber *f = fiber_new_xc("main", main_f);
+	fiber_wakeup(f);
+	ev_run(loop(), 0);
+	cbus_free();
+	fiber_free();
+	memory_free();
+	return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bench.h"
+
+#define LIGHT_NAME
+#define LIGHT_DATA_TYPE uint64_t
+#define LIGHT_KEY_TYPE uint64_t
+#define LIGHT_CMP_ARG_TYPE int
+#define LIGHT_EQUAL(a, b, arg) ((a) == (b))
+#define LIGHT_EQUAL_KEY(a, b, arg) ((a) == (b))
+#include "salad/light.h"
+
+enum {
+	KEY_COUNT = 1000000,
+	EXTENT_SIZE = 16 * 1024, /* same as in memtx_hash */
+};
+
+struct light_bench {
+	struct light_core ht;
+	/** Even numbers 0..2 * KEY_COUNT in random order. */
+	uint64_t *keys;
+};
+
+static inline uint32_t
+hash(uint64_t value)
+{
+	/* murmur3 finalizer */
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	return (uint32_t) value;
+}
+
+static void *
+extent_alloc(void *ctx)
+{
+	(void) ctx;
+	return malloc(EXTENT_SIZE);
+}
+
+static void
+extent_free(void *ctx, void *extent)
+{
+	(void) ctx;
+	free(extent);
+}
+
+static void
+ht_create(void *arg)
+{
+	struct light_bench *b = arg;
+	light_create(&b->ht, EXTENT_SIZE, extent_alloc, extent_free, NULL, 0);
+}
+
+static void
+ht_destroy(void *arg)
+{
+	struct light_bench *b = arg;
+	light_destroy(&b->ht);
+}
+
+static void
+insert_run(void *arg, size_t count)
+{
+	struct light_bench *b = arg;
+	for (size_t i = 0; i < count; i++) {
+		uint64_t key = b->keys[i];
+		if (light_insert(&b->ht, hash(key), key) == light_end)
+			abort();
+	}
+}
+
+static void
+find_run(void *arg, size_t count)
+{
+	struct light_bench *b = arg;
+	uint64_t found = 0;
+	for (size_t i = 0; i < count; i++) {
+		uint64_t key = b->keys[i];
+		found += light_find_key(&b->ht, hash(key), key) != light_end;
+	}
+	bench_sink = found;
+}
+
+static void
+find_miss_run(void *arg, size_t count)
+{
+	struct light_bench *b = arg;
+	uint64_t found = 0;
+	for (size_t i = 0; i < count; i++) {
+		uint64_t key = b->keys[i] + 1;
+		found += light_find_key(&b->ht, hash(key), key) != light_end;
+	}
+	bench_sink = found;
+}
+
+int
+main(void)
+{
+	bench_init();
+
+	struct light_bench b;
+	b.keys = malloc(KEY_COUNT * sizeof(*b.keys));
+	if (b.keys == NULL)
+		abort();
+	for (size_t i = 0; i < KEY_COUNT; i++)
+		b.keys[i] = 2 * i;
+	bench_shuffle(b.keys, KEY_COUNT);
+
+	const struct bench insert = {
+		"light.insert", ht_create, insert_run, ht_destroy
+	};
+	bench_run(&insert, &b, KEY_COUNT);
+
+	const struct bench find = {
+		"light.find", NULL, find_run, NULL
+	};
+	const struct bench find_miss = {
+		"light.find_miss", NULL, find_miss_run, NULL
+	};
+	ht_create(&b);
+	insert_run(&b, KEY_COUNT);
+	bench_run(&find, &b, KEY_COUNT);
+	bench_run(&find_miss, &b, KEY_COUNT);
+	ht_destroy(&b);
+
+	free(b.keys);
+	return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <msgpuck.h>
+
+#include "bench.h"
+#include "memory.h"
+#include "fiber.h"
+#include "crc32.h"
+#include "tt_uuid.h"
+#include "box/xlog.h"
+#include "box/xrow.h"
+#include "box/iproto_constants.h"
+
+enum {
+	/** The number of rows in a file. */
+	ROW_COUNT = 100000,
+	/** The number of rows in a transaction for write_tx. */
+	TX_SIZE = 10,
+};
+
+#define check(rc) do {							\
+	if ((rc) < 0) {							\
+		diag_log();						\
+		abort();						\
+	}								\
+} while (0)
+
+struct xlog_bench {
+	struct xdir dir;
+	struct vclock vclock;
+	struct xlog log;
+	/** Name of the file written by the last round. */
+	char filename[PATH_MAX];
+	/** An INSERT request body. */
+	char body[128];
+	size_t body_size;
+};
+
+static void
+row_create(struct xlog_bench *b, struct xrow_header *row)
+{
+	memset(row, 0, sizeof(*row));
+	row->type = IPROTO_INSERT;
+	row->replica_id = 1;
+	row->lsn = vclock_inc(&b->vclock, 1);
+	row->bodycnt = 1;
+	row->body[0].iov_base = b->body;
+	row->body[0].iov_len = b->body_size;
+}
+
+static void
+log_create(void *arg)
+{
+	struct xlog_bench *b = (struct xlog_bench *) arg;
+	check(xdir_create_xlog(&b->dir, &b->log, &b->vclock));
+	snprintf(b->filename, sizeof(b->filename), "%s", b->log.filename);
+}
+
+static void
+log_close(void *arg)
+{
+	struct xlog_bench *b = (struct xlog_bench *) arg;
+	xlog_close(&b->log, false);
+}
+
+static void
+log_remove(void *arg)
+{
+	struct xlog_bench *b = (struct xlog_bench *) arg;
+	log_close(b);
+	unlink(b->filename);
+}
+
+static void
+write_run(void *arg, size_t count)
+{
+	struct xlog_bench *b = (struct xlog_bench *) arg;
+	struct xrow_header row;
+	for (size_t i = 0; i < count; i++) {
+		row_create(b, &row);
+		check(xlog_write_row(&b->log, &row));
+	}
+	check(xlog_flush(&b->log));
+}
+
+static void
+write_tx_run(void *arg, size_t count)
+{
+	struct xlog_bench *b = (struct xlog_bench *) arg;
+	struct xrow_header row;
+	for (size_t i = 0; i < count; i += TX_SIZE) {
+		xlog_tx_begin(&b->log);
+		for (size_t j = 0; j < TX_SIZE; j++) {
+			row_create(b, &row);
+			check(xlog_write_row(&b->log, &row));
+		}
+		check(xlog_tx_commit(&b->log));
+	}
+	check(xlog_flush(&b->log));
+}
+
+static void
+read_run(void *arg, size_t count)
+{
+	struct xlog_bench *b = (struct xlog_bench *) arg;
+	struct xlog_cursor cursor;
+	struct xrow_header row;
+	check(xlog_cursor_open(&cursor, b->filename));
+	int64_t sum = 0;
+	for (size_t i = 0; i < count; i++) {
+		int rc = xlog_cursor_next(&cursor, &row, false);
+		check(rc);
+		if (rc != 0)
+			abort();
+		sum += row.lsn;
+	}
+	xlog_cursor_close(&cursor, false);
+	bench_sink = sum;
+}
+
+int
+main(void)
+{
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	crc32_init();
+	bench_init();
+
+	char dirname[] = "xlog_bench.XXXXXX";
+	if (mkdtemp(dirname) == NULL)
+		abort();
+	struct tt_uuid uuid;
+	tt_uuid_from_string("a1fd4a76-4c4e-4e3c-b8f2-5da56e1d8b8b", &uuid);
+
+	struct xlog_bench b;
+	xdir_create(&b.dir, dirname, XLOG, &uuid);
+	/* Sync the file in this thread on close. */
+	b.dir.sync_is_async = false;
+	vclock_create(&b.vclock);
+
+	char *pos = b.body;
+	pos = mp_encode_map(pos, 2);
+	pos = mp_encode_uint(pos, IPROTO_SPACE_ID);
+	pos = mp_encode_uint(pos, 512);
+	pos = mp_encode_uint(pos, IPROTO_TUPLE);
+	pos = mp_encode_array(pos, 3);
+	pos = mp_encode_uint(pos, 1234567);
+	pos = mp_encode_str(pos, "tuple field", strlen("tuple field"));
+	pos = mp_encode_double(pos, 3.14);
+	b.body_size = pos - b.body;
+
+	const struct bench write_bench = {
+		"xlog.write", log_create, write_run, log_remove
+	};
+	const struct bench write_tx_bench = {
+		"xlog.write_tx", log_create, write_tx_run, log_remove
+	};
+	const struct bench read_bench = {
+		"xlog.read", NULL, read_run, NULL
+	};
+	bench_run(&write_bench, &b, ROW_COUNT);
+	bench_run(&write_tx_bench, &b, ROW_COUNT);
+
+	log_create(&b);
+	write_run(&b, ROW_COUNT);
+	log_close(&b);
+	bench_run(&read_bench, &b, ROW_COUNT);
+	unlink(b.filename);
+
+	xdir_destroy(&b.dir);
+	rmdir(dirname);
+
+	fiber_free();
+	memory_free();
+	return 0;
+}
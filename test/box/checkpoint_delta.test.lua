@@ -0,0 +1,88 @@
+env = require('test_run')
+test_run = env.new()
+fio = require('fio')
+
+test_run:cmd("setopt delimiter ';'")
+function last_snap()
+    local snaps = fio.glob(fio.pathjoin(box.cfg.memtx_dir, '*.snap'))
+    table.sort(snaps)
+    return snaps[#snaps]
+end;
+-- Signature of the snapshot a delta snapshot is based on.
+function snap_base(path)
+    local f = fio.open(path, {'O_RDONLY'})
+    local header = f:read(512)
+    f:close()
+    return tonumber(header:match('\nBase: (%d+)\n'))
+end;
+-- Delta snapshots have a version older binaries reject.
+function snap_version(path)
+    local f = fio.open(path, {'O_RDONLY'})
+    local header = f:read(512)
+    f:close()
+    return header:match('^%a+\n([%d.]+)\n')
+end;
+function snap_lsn(path)
+    return tonumber(fio.basename(path, '.snap'))
+end;
+test_run:cmd("setopt delimiter ''");
+
+s = box.schema.space.create('checkpoint_delta')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+for i = 1, 100 do s:insert{i, i, 0} end
+
+-- The first checkpoint after the option is set is full.
+box.cfg{checkpoint_delta_count = 1}
+box.snapshot()
+snap1 = last_snap()
+snap_base(snap1)
+snap_version(snap1)
+
+-- Delta: deletions, replace, in-place update, rollback.
+for i = 1, 100, 2 do s:delete{i} end
+s:replace{2, 1002, 0}
+s:update({4}, {{'+', 3, 1}})
+s:insert{101, 101, 0}
+box.begin() s:delete{6} box.rollback()
+box.snapshot()
+snap2 = last_snap()
+snap_base(snap2) == snap_lsn(snap1)
+snap_version(snap2)
+
+-- The chain is limited by checkpoint_delta_count.
+s:delete{2}
+s:insert{1, 1, 0}
+box.snapshot()
+snap3 = last_snap()
+snap_base(snap3)
+
+s:update({8}, {{'+', 3, 5}})
+s:delete{12}
+box.begin() s:replace{14, 14, 7} box.rollback()
+box.snapshot()
+snap4 = last_snap()
+snap_base(snap4) == snap_lsn(snap3)
+
+-- Recovery from a delta snapshot and WAL.
+s:delete{10}
+test_run:cmd('restart server default')
+s = box.space.checkpoint_delta
+s:count()
+s.index.sk:count()
+s:get{1}
+s:get{2}
+s:get{4}
+s:get{6}
+s:get{8}
+s:get{10}
+s:get{12}
+s:get{14}
+s:get{101}
+s.index.sk:get{1002}
+s.index.sk:get{8}
+
+-- Checkpoints are full by default.
+s:drop()
+box.cfg.checkpoint_delta_count
+box.cfg{checkpoint_delta_count = -1}
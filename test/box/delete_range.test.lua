@@ -0,0 +1,57 @@
+s = box.schema.space.create('test')
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}})
+for i = 1, 10 do s:replace{i, i * 10} end
+
+s:delete_range({3}, {6})
+pk:select()
+sk:select()
+sk:get{40}
+
+-- nil means infinity
+s:delete_range(nil, {2})
+s:delete_range({9})
+pk:select()
+
+-- empty range is a no-op
+s:delete_range({8}, {7})
+s:delete_range({4}, {6})
+pk:select()
+
+-- multi-statement transactions are rolled back as a whole
+box.begin() s:delete_range({7}) s:replace{20, 200} box.rollback()
+pk:select()
+sk:select()
+box.begin() s:delete_range({7}) s:replace{7, 70} box.commit()
+pk:select()
+sk:select()
+s:len()
+
+-- invalid keys
+s:delete_range({'a'}, {1})
+s:delete_range({1, 2}, {3})
+
+-- spaces with triggers are not supported
+f = function() end
+_ = s:on_replace(f)
+s:delete_range({1}, {2})
+s:on_replace(nil, f)
+s:drop()
+
+-- only TREE primary keys are supported
+s = box.schema.space.create('test')
+pk = s:create_index('pk', {type = 'hash'})
+s:replace{1}
+s:delete_range({1}, {2})
+s:drop()
+
+-- keys are compared by the common prefix
+s = box.schema.space.create('test')
+pk = s:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}})
+for i = 1, 2 do for j = 1, 3 do s:replace{i, j} end end
+s:delete_range({1}, {1, 3})
+s:delete_range({2, 2}, {2})
+pk:select()
+s:delete_range({1, 3}, {2, 2})
+pk:select()
+s:drop()
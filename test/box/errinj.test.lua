@@ -243,3 +243,20 @@ box.space.test:select()
 test_run:cmd('restart server default')
 box.space.test:select()
 box.space.test:drop()
+
+-- Rollback of an update applied in place doesn't change
+-- the tuple if someone got it while waiting for WAL
+fiber = require('fiber')
+errinj = box.error.injection
+s = box.schema.space.create('update_inplace')
+_ = s:create_index('pk')
+_ = s:replace{1, 100}
+ch = fiber.channel(1)
+errinj.set('ERRINJ_WAL_WRITE', true)
+_ = fiber.create(function() ch:put((pcall(s.update, s, 1, {{'+', 2, 1}}))) end) t = s:get(1)
+ch:get()
+errinj.set('ERRINJ_WAL_WRITE', false)
+t
+s:get(1)
+t = nil
+s:drop()
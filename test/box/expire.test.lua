@@ -0,0 +1,56 @@
+fiber = require('fiber')
+-- wrong options
+box.schema.space.create('expire', {ttl = -1, ttl_field = 2})
+box.schema.space.create('expire', {ttl = 1})
+box.schema.space.create('expire', {ttl = 'a'})
+-- ttl = 0 disables expiration
+s = box.schema.space.create('expire', {ttl = 0})
+s:drop()
+
+s = box.schema.space.create('expire', {ttl = 0.1, ttl_field = 2})
+box.space._space:get(s.id)[6].ttl_field
+_ = s:create_index('pk')
+-- tuples are not expired without an index over the timestamp
+now = fiber.time()
+_ = s:replace{1, now - 10}
+fiber.sleep(0.3)
+#s:select()
+_ = s:create_index('ttl', {parts = {2, 'number'}, unique = false})
+function wait_count(n) for i = 1, 100 do if #s:select() == n then return true end fiber.sleep(0.05) end return #s:select() end
+wait_count(0)
+-- tuples with fresh timestamps stay
+now = fiber.time()
+for i = 1, 100 do s:replace{i, now - 10} end
+for i = 101, 110 do s:replace{i, now + 1000} end
+wait_count(10)
+box.stat.expire.EXPIRED.total >= 101
+box.stat.expire().lag >= 0
+-- moving the timestamp back makes a tuple expire
+_ = s:update(101, {{'=', 2, fiber.time()}})
+wait_count(9)
+s:get(101) == nil
+s:drop()
+
+-- nothing expires in the read-only mode
+s = box.schema.space.create('expire', {ttl = 0.1, ttl_field = 2})
+_ = s:create_index('pk')
+_ = s:create_index('ttl', {parts = {2, 'number'}, unique = false})
+now = fiber.time()
+for i = 1, 10 do s:replace{i, now + 0.5} end
+box.cfg{read_only = true}
+fiber.sleep(1)
+#s:select()
+box.cfg{read_only = false}
+wait_count(0)
+s:drop()
+
+-- vinyl
+s = box.schema.space.create('expire', {engine = 'vinyl', ttl = 1, ttl_field = 2})
+_ = s:create_index('pk')
+_ = s:create_index('ttl', {parts = {2, 'number', 1, 'unsigned'}})
+now = fiber.time()
+for i = 1, 10 do s:replace{i, now - 10} end
+_ = s:replace{11, now + 1000}
+wait_count(1)
+s:select()[1][1]
+s:drop()
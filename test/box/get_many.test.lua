@@ -0,0 +1,34 @@
+-- index:get_many() looks up a batch of keys at once
+s = box.schema.space.create('get_many')
+_ = s:create_index('pk')
+_ = s:create_index('hash', {type = 'hash', parts = {2, 'unsigned'}})
+_ = s:create_index('multi', {type = 'tree', parts = {2, 'unsigned', 3, 'string'}})
+_ = s:create_index('sk', {type = 'tree', parts = {3, 'string'}, unique = false})
+for i = 1, 100 do s:replace{i, i * 10, tostring(i % 10)} end
+
+-- result[i] is the tuple found by keys[i] or nil
+s:get_many{3, 1, 1000, 2}
+s.index.pk:get_many{{5}, {4}}
+s.index.hash:get_many{50, 999, 10, 20}
+s.index.multi:get_many{{30, '3'}, {30, '4'}, {40, '4'}}
+s:get_many{}
+s.index.hash:get_many{}
+t = s:get_many{1000, 1}
+t[1] == nil, t[2][1]
+
+-- large batches
+t = s:get_many(require('fun').range(1, 300):totable())
+t[100][1], t[101], t[300]
+t = s.index.hash:get_many(require('fun').range(10, 3000, 10):totable())
+t[100][1], t[101], t[300]
+t = s.index.hash:get_many(require('fun').range(1000, 10, -10):totable())
+#t, t[1][1], t[100][1]
+
+-- errors
+s:get_many(1)
+s.index.sk:get_many{'1'}
+s.index.multi:get_many{{30}}
+s:get_many{'a'}
+s:get_many{{1, 2}}
+
+s:drop()
@@ -0,0 +1,87 @@
+fiber = require('fiber')
+fio = require('fio')
+xlog = require('xlog')
+
+s = box.schema.space.create('read_view')
+_ = s:create_index('primary')
+for i = 1, 10 do s:insert{i, string.rep('x', 10)} end
+
+-- stat
+stat = box.read_view.stat({s.id})
+stat[s.id].count
+stat[s.id].bsize == s:bsize()
+
+-- export is not affected by concurrent changes
+path = fio.pathjoin(fio.cwd(), 'read_view.snap')
+ch = fiber.channel(1)
+_ = fiber.create(function() ch:put(box.read_view.export({s.id}, path)) end)
+for i = 1, 10 do s:delete{i} end
+ch:get()
+s:count()
+count = 0
+for lsn, row in xlog.pairs(path) do if row.BODY.space_id == s.id then count = count + 1 end end
+count
+box.read_view.info().delayed_free_size
+_ = fio.unlink(path)
+
+-- delayed free is accounted by space
+t = box.schema.space.create('read_view_tmp', {temporary = true})
+_ = t:create_index('primary')
+for i = 1, 10 do t:insert{i, string.rep('x', 100)} end
+_ = fiber.create(function() ch:put(box.read_view.export({t.id}, path)) end)
+for i = 1, 10 do t:delete{i} end info = box.read_view.info()
+info.delayed_free_size > 1000
+info.spaces[t.id].delayed_free_size == info.delayed_free_size
+ch:get()
+info = box.read_view.info()
+info.delayed_free_size
+next(info.spaces)
+_ = fio.unlink(path)
+t:drop()
+
+-- spaces of an open read view can't be altered or dropped
+_ = fiber.create(function() ch:put(box.read_view.export({s.id}, path)) end)
+s:drop()
+s:truncate()
+s:rename('read_view_new')
+ch:get()
+box.space.read_view ~= nil
+_ = fio.unlink(path)
+
+-- garbage of a scanned space is freed while the view is open
+ffi = require('ffi')
+ffi.cdef('typedef struct memtx_read_view box_read_view_t; box_read_view_t *box_read_view_open(const uint32_t *space_ids, uint32_t space_count); void box_read_view_next(box_read_view_t *rv, uint32_t *space_id, const char **data, const char **data_end); void box_read_view_close(box_read_view_t *rv);')
+t1 = box.schema.space.create('read_view_1')
+_ = t1:create_index('primary')
+t2 = box.schema.space.create('read_view_2')
+_ = t2:create_index('primary')
+for i = 1, 10 do t1:insert{i, string.rep('x', 100)} t2:insert{i, string.rep('x', 100)} end
+rv = ffi.C.box_read_view_open(ffi.new('uint32_t[2]', t1.id, t2.id), 2)
+for i = 1, 10 do t1:delete{i} t2:delete{i} end
+info = box.read_view.info()
+info.spaces[t1.id].delayed_free_size > 1000
+info.spaces[t2.id].delayed_free_size > 1000
+space_id = ffi.new('uint32_t[1]')
+data = ffi.new('const char *[1]')
+data_end = ffi.new('const char *[1]')
+-- scan all of t1 and the first tuple of t2
+for i = 1, 11 do ffi.C.box_read_view_next(rv, space_id, data, data_end) end
+space_id[0] == t2.id
+while box.read_view.info().spaces[t1.id] ~= nil do fiber.sleep(0.01) end
+info = box.read_view.info()
+info.spaces[t2.id].delayed_free_size == info.delayed_free_size
+info.delayed_free_size > 1000
+ffi.C.box_read_view_close(rv)
+box.read_view.info().delayed_free_size
+t1:drop()
+t2:drop()
+
+-- errors
+box.read_view.stat({12345})
+box.read_view.export({s.id})
+v = box.schema.space.create('read_view_vinyl', {engine = 'vinyl'})
+_ = v:create_index('primary')
+box.read_view.stat({v.id})
+v:drop()
+
+s:drop()
@@ -0,0 +1,53 @@
+-- UPDATE of non-indexed fields which doesn't change their size
+-- is applied in place
+s = box.schema.space.create('update_inplace')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+s:replace{1, 1, 100, 7, 1.5}
+-- the address of the tuple stored in the space
+ffi = require('ffi')
+function addr() return ffi.cast('void *', s:get(1)) end
+p = addr()
+_ = collectgarbage('collect')
+s:update(1, {{'+', 3, 1}, {'|', 4, 8}})
+addr() == p
+_ = collectgarbage('collect')
+s:update(1, {{'-', 3, 2}, {'^', 4, 1}, {'+', 5, 1}})
+addr() == p
+-- a tuple referenced from Lua is not changed
+t = s:get(1)
+s:update(1, {{'+', 3, 1}})
+t
+addr() == ffi.cast('void *', t)
+t = nil
+_ = collectgarbage('collect')
+p = addr()
+_ = collectgarbage('collect')
+-- field size changes
+s:update(1, {{'+', 3, 1000}})
+addr() == p
+p = addr()
+_ = collectgarbage('collect')
+-- indexed field
+s:update(1, {{'+', 2, 1}})
+addr() == p
+s.index.sk:get{2}
+s.index.sk:get{1}
+_ = collectgarbage('collect')
+-- double update of the same field
+s:update(1, {{'+', 3, 1}, {'+', 3, 1}})
+-- overflow
+s:update(1, {{'-', 3, 10000}, {'+', 4, 1}})
+s:get(1)
+-- rollback
+box.begin() s:update(1, {{'+', 3, 1}}) box.rollback()
+s:get(1)
+-- a tuple frozen by a read view is not changed
+_ = collectgarbage('collect')
+fiber = require('fiber')
+ch = fiber.channel(1)
+_ = fiber.create(function() ch:put(box.read_view.stat({s.id})) end)
+s:update(1, {{'+', 3, 1}})
+ch:get()[s.id].count
+s:get(1)
+s:drop()
@@ -0,0 +1,42 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+fiber = require('fiber')
+
+(pcall(box.cfg, {replication_compression = -1}))
+box.cfg.replication_compression
+box.cfg{replication_compression = 3}
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test', {engine = engine})
+index = s:create_index('primary')
+for i = 1, 100 do s:insert{i, string.rep('x', 100)} end
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+test_run:cmd("switch replica")
+box.space.test:count()
+
+test_run:cmd("switch default")
+-- rows written after the replica has subscribed
+box.begin() for i = 101, 200 do s:insert{i, string.rep('x', 100)} end box.commit()
+
+test_run:cmd("switch replica")
+fiber = require('fiber')
+while box.space.test:count() < 200 do fiber.sleep(0.01) end
+box.space.test:get{200}[2] == string.rep('x', 100)
+
+test_run:cmd("switch default")
+lsn = box.info.lsn
+while box.info.replication[2].downstream.vclock[1] < lsn do fiber.sleep(0.01) end
+compression = box.info.replication[2].downstream.compression
+compression.level
+compression.ratio > 1
+compression.time >= 0
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+box.space.test:drop()
+box.schema.user.revoke('guest', 'replication')
+box.cfg{replication_compression = 0}
@@ -0,0 +1,68 @@
+env = require('test_run')
+test_run = env.new()
+errinj = box.error.injection
+
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test')
+index = s:create_index('primary')
+for i = 1, 1000 do s:insert{i, string.rep('x', 100)} end
+box.snapshot()
+
+-- Check the master's log for how the initial data was sent.
+function sent_in(uuid, how) return test_run:grep_log('default', 'sending initial data to ' .. uuid:gsub('%-', '%%-') .. ' in ' .. how) ~= nil end
+
+-- Both sides support raw blocks: the snapshot is sent in blocks.
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+test_run:cmd("switch replica")
+box.space.test:count()
+box.space.test:get{1000}[2] == string.rep('x', 100)
+test_run:cmd("switch default")
+uuid = test_run:eval('replica', 'box.info.uuid')[1]
+sent_in(uuid, 'blocks')
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+
+-- sendfile() doesn't work: blocks are sent with pread() and write().
+errinj.set('ERRINJ_COIO_SENDFILE', true)
+test_run:cmd("create server replica_sendfile with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica_sendfile")
+test_run:cmd("switch replica_sendfile")
+box.space.test:count()
+box.space.test:get{1000}[2] == string.rep('x', 100)
+test_run:cmd("switch default")
+uuid = test_run:eval('replica_sendfile', 'box.info.uuid')[1]
+sent_in(uuid, 'blocks')
+errinj.set('ERRINJ_COIO_SENDFILE', false)
+test_run:cmd("stop server replica_sendfile")
+test_run:cmd("cleanup server replica_sendfile")
+
+-- An old master doesn't send raw blocks to a new replica.
+errinj.set('ERRINJ_RELAY_NO_RAW_BLOCKS', true)
+test_run:cmd("create server replica_old_master with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica_old_master")
+test_run:cmd("switch replica_old_master")
+box.space.test:count()
+box.space.test:get{1000}[2] == string.rep('x', 100)
+test_run:cmd("switch default")
+uuid = test_run:eval('replica_old_master', 'box.info.uuid')[1]
+sent_in(uuid, 'rows')
+errinj.set('ERRINJ_RELAY_NO_RAW_BLOCKS', false)
+test_run:cmd("stop server replica_old_master")
+test_run:cmd("cleanup server replica_old_master")
+
+-- An old replica doesn't ask a new master for raw blocks.
+test_run:cmd("create server old_replica with rpl_master=default, script='replication/replica_no_raw_blocks.lua'")
+test_run:cmd("start server old_replica")
+test_run:cmd("switch old_replica")
+box.space.test:count()
+box.space.test:get{1000}[2] == string.rep('x', 100)
+test_run:cmd("switch default")
+uuid = test_run:eval('old_replica', 'box.info.uuid')[1]
+sent_in(uuid, 'rows')
+test_run:cmd("stop server old_replica")
+test_run:cmd("cleanup server old_replica")
+
+-- cleanup
+box.space.test:drop()
+box.schema.user.revoke('guest', 'replication')
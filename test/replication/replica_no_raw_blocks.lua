@@ -0,0 +1,12 @@
+#!/usr/bin/env tarantool
+
+-- A replica that doesn't know about IPROTO_RAW_BLOCK.
+box.error.injection.set('ERRINJ_APPLIER_NO_RAW_BLOCKS', true)
+
+box.cfg({
+    listen              = os.getenv("LISTEN"),
+    replication         = os.getenv("MASTER"),
+    memtx_memory        = 107374182,
+})
+
+require('console').listen(os.getenv('ADMIN'))
@@ -195,12 +195,74 @@ void test_get_set()
 	footer();
 }
 
+static
+void test_sparse_pages()
+{
+	header();
+
+	struct bitset bm;
+	bitset_create(&bm, realloc);
+	struct bitset_info info;
+	bitset_info(&bm, &info);
+
+	const size_t PAGE_BIT = info.page_data_size * CHAR_BIT;
+	const size_t first_pos = 3 * PAGE_BIT;
+
+	/* A few bits in a page are stored as an array */
+	for (size_t i = 0; i < 8; i++)
+		fail_if(bitset_set(&bm, first_pos + PAGE_BIT - 1 - i * 7) < 0);
+	fail_unless(bitset_set(&bm, first_pos + PAGE_BIT - 1) == 1);
+	bitset_info(&bm, &info);
+	fail_unless(info.pages == 1);
+	fail_unless(info.array_pages == 1);
+	fail_unless(info.total_size < info.page_total_size);
+
+	/* More bits convert it to a bitmap */
+	for (size_t i = 0; i < PAGE_BIT; i += 3)
+		fail_if(bitset_set(&bm, first_pos + i) < 0);
+	bitset_info(&bm, &info);
+	fail_unless(info.pages == 1);
+	fail_unless(info.array_pages == 0);
+	size_t cnt = 0;
+	for (size_t i = 0; i < PAGE_BIT; i++) {
+		bool set = (i % 3 == 0) ||
+			   (i >= PAGE_BIT - 1 - 7 * 7 &&
+			    (PAGE_BIT - 1 - i) % 7 == 0);
+		fail_unless(bitset_test(&bm, first_pos + i) == set);
+		cnt += set;
+	}
+	fail_unless(bitset_cardinality(&bm) == cnt);
+
+	/* Clearing most of the bits converts it back */
+	for (size_t i = 0; i < PAGE_BIT; i++) {
+		if (i % 150 != 0)
+			fail_if(bitset_clear(&bm, first_pos + i) < 0);
+	}
+	bitset_info(&bm, &info);
+	fail_unless(info.pages == 1);
+	fail_unless(info.array_pages == 1);
+	fail_unless(bitset_cardinality(&bm) == (PAGE_BIT + 149) / 150);
+	for (size_t i = 0; i < PAGE_BIT; i++)
+		fail_unless(bitset_test(&bm, first_pos + i) == (i % 150 == 0));
+
+	for (size_t i = 0; i < PAGE_BIT; i += 150)
+		fail_unless(bitset_clear(&bm, first_pos + i) == 1);
+	bitset_info(&bm, &info);
+	fail_unless(info.pages == 0);
+	fail_unless(bitset_cardinality(&bm) == 0);
+
+	bitset_destroy(&bm);
+
+	footer();
+}
+
 int main(int argc, char *argv[])
 {
 	setbuf(stdout, NULL);
 	srand(time(NULL));
 	test_cardinality();
 	test_get_set();
+	test_sparse_pages();
 
 	return 0;
 }
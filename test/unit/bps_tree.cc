@@ -566,6 +566,46 @@ loading_test()
 	footer();
 }
 
+static void
+find_batch_test()
+{
+	header();
+
+	test tree;
+	test_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+
+	const size_t key_count = 1000;
+	type_t keys[key_count];
+	type_t *result[key_count];
+	for (size_t i = 0; i < key_count; i++)
+		keys[i] = rand() % 4000;
+
+	/* Empty tree */
+	test_find_batch(&tree, keys, key_count, result);
+	for (size_t i = 0; i < key_count; i++) {
+		if (result[i] != NULL)
+			fail("found a key in an empty tree", "true");
+	}
+
+	for (type_t i = 0; i < 2000; i++)
+		test_insert(&tree, i * 2, NULL);
+
+	/* Partial and multiple batches */
+	for (size_t count = 1; count <= key_count; count = count * 3 + 1) {
+		test_find_batch(&tree, keys, count, result);
+		for (size_t i = 0; i < count; i++) {
+			if (result[i] != test_find(&tree, keys[i]))
+				fail("find_batch differs from find", "true");
+			if (result[i] != NULL && *result[i] != keys[i])
+				fail("find_batch found a wrong element", "true");
+		}
+	}
+
+	test_destroy(&tree);
+
+	footer();
+}
+
 static void
 printing_test()
 {
@@ -763,6 +803,7 @@ main(void)
 	compare_with_sptree_check_branches();
 	bps_tree_debug_self_check();
 	loading_test();
+	find_batch_test();
 	printing_test();
 	white_box_test();
 	approximate_count();
@@ -0,0 +1,222 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "memory.h"
+#include "fiber.h"
+#include "clock.h"
+#include "coeio.h"
+#include "coeio_file.h"
+#include "coio_uring.h"
+#include "unit.h"
+
+enum {
+	BLOCK_SIZE = 4096,
+	BLOCK_COUNT = 64,
+	WORKER_COUNT = 16,
+};
+
+static const char *filename = "coio_uring.out";
+static bool bench = false;
+
+static void
+block_fill(char *buf, size_t block)
+{
+	for (size_t i = 0; i < BLOCK_SIZE; i++)
+		buf[i] = (char) (block * 31 + i);
+}
+
+struct worker {
+	int fd;
+	size_t id;
+	size_t count;
+	int rc;
+};
+
+static int
+write_f(va_list ap)
+{
+	struct worker *w = va_arg(ap, struct worker *);
+	char buf[BLOCK_SIZE];
+	for (size_t b = w->id; b < BLOCK_COUNT; b += WORKER_COUNT) {
+		block_fill(buf, b);
+		if (coeio_pwrite(w->fd, buf, BLOCK_SIZE,
+				 b * BLOCK_SIZE) != BLOCK_SIZE)
+			w->rc = -1;
+	}
+	return 0;
+}
+
+static int
+read_f(va_list ap)
+{
+	struct worker *w = va_arg(ap, struct worker *);
+	char buf[BLOCK_SIZE], expected[BLOCK_SIZE];
+	for (size_t i = 0; i < w->count; i++) {
+		size_t b = rand() % BLOCK_COUNT;
+		if (coeio_pread(w->fd, buf, BLOCK_SIZE,
+				b * BLOCK_SIZE) != BLOCK_SIZE) {
+			w->rc = -1;
+			continue;
+		}
+		block_fill(expected, b);
+		if (memcmp(buf, expected, BLOCK_SIZE) != 0)
+			w->rc = -1;
+	}
+	return 0;
+}
+
+/** Run WORKER_COUNT fibers executing @a f and wait for them. */
+static int
+run_workers(fiber_func f, int fd, size_t count)
+{
+	struct worker workers[WORKER_COUNT];
+	struct fiber *fibers[WORKER_COUNT];
+	for (size_t i = 0; i < WORKER_COUNT; i++) {
+		workers[i].fd = fd;
+		workers[i].id = i;
+		workers[i].count = count;
+		workers[i].rc = 0;
+		fibers[i] = fiber_new_xc("worker", f);
+		fiber_set_joinable(fibers[i], true);
+		fiber_start(fibers[i], &workers[i]);
+	}
+	int rc = 0;
+	for (size_t i = 0; i < WORKER_COUNT; i++) {
+		fiber_join(fibers[i]);
+		if (workers[i].rc != 0)
+			rc = -1;
+	}
+	return rc;
+}
+
+static void
+file_io_test()
+{
+	header();
+
+	int fd = coeio_open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	fail_if(fd < 0);
+	fail_if(run_workers(write_f, fd, 0) != 0);
+	fail_if(coeio_fsync(fd) != 0);
+	fail_if(coeio_fdatasync(fd) != 0);
+	fail_if(run_workers(read_f, fd, 100) != 0);
+
+	char buf[BLOCK_SIZE];
+	/* Read past EOF */
+	fail_if(coeio_pread(fd, buf, BLOCK_SIZE,
+			    BLOCK_COUNT * BLOCK_SIZE) != 0);
+	/* Short read */
+	fail_if(coeio_pread(fd, buf, BLOCK_SIZE,
+			    BLOCK_COUNT * BLOCK_SIZE - 10) != 10);
+	fail_if(coeio_close(fd) != 0);
+
+	/* Errors are reported via errno */
+	errno = 0;
+	fail_if(coeio_pread(fd, buf, BLOCK_SIZE, 0) != -1);
+	fail_if(errno != EBADF);
+	errno = 0;
+	fail_if(coeio_pwrite(fd, buf, BLOCK_SIZE, 0) != -1);
+	fail_if(errno != EBADF);
+	errno = 0;
+	fail_if(coeio_fsync(fd) != -1);
+	fail_if(errno != EBADF);
+
+	(void) remove(filename);
+
+	footer();
+}
+
+enum { BENCH_FILE_BLOCKS = 16384, BENCH_READ_COUNT = 200000 };
+
+static int
+bench_read_f(va_list ap)
+{
+	struct worker *w = va_arg(ap, struct worker *);
+	char buf[BLOCK_SIZE];
+	for (size_t i = 0; i < w->count; i++) {
+		off_t b = rand() % BENCH_FILE_BLOCKS;
+		if (coeio_pread(w->fd, buf, BLOCK_SIZE,
+				b * BLOCK_SIZE) != BLOCK_SIZE)
+			w->rc = -1;
+	}
+	return 0;
+}
+
+/**
+ * Compare io_uring and eio on random 4 KB reads.
+ * Run the test with "bench" argument to enable.
+ */
+static void
+random_read_bench(const char *backend)
+{
+	int fd = coeio_open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	fail_if(fd < 0);
+	off_t size = (off_t) BENCH_FILE_BLOCKS * BLOCK_SIZE;
+	fail_if(coeio_ftruncate(fd, size) != 0);
+
+	for (int fiber_count = 1; fiber_count <= 64; fiber_count *= 4) {
+		struct fiber *fibers[64];
+		struct worker workers[64];
+		double start = clock_monotonic();
+		for (int i = 0; i < fiber_count; i++) {
+			workers[i].fd = fd;
+			workers[i].count = BENCH_READ_COUNT / fiber_count;
+			workers[i].rc = 0;
+			fibers[i] = fiber_new_xc("reader", bench_read_f);
+			fiber_set_joinable(fibers[i], true);
+			fiber_start(fibers[i], &workers[i]);
+		}
+		for (int i = 0; i < fiber_count; i++) {
+			fiber_join(fibers[i]);
+			fail_if(workers[i].rc != 0);
+		}
+		double elapsed = clock_monotonic() - start;
+		printf("%s: %2d fibers: %8.0f reads/sec\n", backend,
+		       fiber_count, BENCH_READ_COUNT / elapsed);
+	}
+	coeio_close(fd);
+	(void) remove(filename);
+}
+
+static int
+main_f(va_list ap)
+{
+	(void) ap;
+	if (bench) {
+		if (coio_uring_is_enabled())
+			random_read_bench("io_uring");
+		coio_uring_free();
+		random_read_bench("eio");
+	} else {
+		/* io_uring, if supported by the kernel */
+		file_io_test();
+		/* eio */
+		coio_uring_free();
+		file_io_test();
+	}
+	ev_break(loop(), EVBREAK_ALL);
+	return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	setbuf(stdout, NULL);
+	bench = argc > 1 && strcmp(argv[1], "bench") == 0;
+	memory_init();
+	fiber_init(fiber_cxx_invoke);
+	coeio_init();
+	coeio_enable();
+	/* Fall back on eio if io_uring isn't supported. */
+	(void) coio_uring_init();
+	struct fiber *test = fiber_new_xc("coio_uring", main_f);
+	fiber_wakeup(test);
+	ev_run(loop(), 0);
+	coeio_shutdown();
+	fiber_free();
+	memory_free();
+	return 0;
+}
@@ -46,6 +46,69 @@ cancel_dead_f(va_list ap)
 	return 0;
 }
 
+static int
+stack_recurse(int depth)
+{
+	volatile char buf[1024];
+	buf[0] = depth;
+	if (depth == 0)
+		return buf[0];
+	return stack_recurse(depth - 1) + buf[0];
+}
+
+static int
+deep_stack_f(va_list ap)
+{
+	int depth = va_arg(ap, int);
+	stack_recurse(depth);
+	return 0;
+}
+
+static void
+fiber_stack_test()
+{
+	header();
+
+	struct fiber_stack_stat stat;
+	fiber_stack_stat(&stat);
+	uint64_t released = stat.released;
+
+	/* A fiber going beyond the watermark releases its stack. */
+	struct fiber *fiber = fiber_new_xc("deep", deep_stack_f);
+	fiber_set_joinable(fiber, true);
+	fiber_start(fiber, 256);
+	fiber_join(fiber);
+	fiber_stack_stat(&stat);
+	fail_unless(stat.released == released + 1);
+
+	/* A shallow fiber doesn't, and its stack is reused. */
+	uint64_t reused = stat.reused;
+	fiber = fiber_new_xc("shallow", deep_stack_f);
+	fiber_set_joinable(fiber, true);
+	fiber_start(fiber, 4);
+	fiber_join(fiber);
+	fiber_stack_stat(&stat);
+	fail_unless(stat.released == released + 1);
+	fail_unless(stat.reused == reused + 1);
+	fail_unless(stat.idle > 0);
+
+	/* Changing the stack size invalidates the cache. */
+	fail_unless(cord_set_fiber_stack_size(1) != 0);
+	diag_clear(diag_get());
+	fail_unless(cord_set_fiber_stack_size(FIBER_STACK_SIZE_MIN) == 0);
+	uint64_t created = stat.created;
+	fiber = fiber_new_xc("small", deep_stack_f);
+	fiber_set_joinable(fiber, true);
+	fiber_start(fiber, 4);
+	fiber_join(fiber);
+	fiber_stack_stat(&stat);
+	fail_unless(stat.created == created + 1);
+	fail_unless(stat.size == FIBER_STACK_SIZE_MIN);
+	cord_set_fiber_stack_size(FIBER_STACK_SIZE_DEFAULT);
+
+	footer();
+}
+
 static void
 fiber_join_test()
 {
@@ -107,6 +170,7 @@ static int
 main_f(va_list ap)
 {
 	fiber_join_test();
+	fiber_stack_test();
 	ev_break(loop(), EVBREAK_ALL);
 	return 0;
 }
@@ -318,6 +318,41 @@ iterator_freeze_check()
 	footer();
 }
 
+static void
+peek_test()
+{
+	header();
+
+	struct light_core ht;
+	light_create(&ht, light_extent_size,
+		     my_light_alloc, my_light_free, &extents_count, 0);
+	hash_value_t val;
+	if (light_peek(&ht, hash(1), &val))
+		fail("peek in an empty table", "true");
+
+	const hash_value_t limits = 10000;
+	for (hash_value_t i = 0; i < limits; i += 2)
+		light_insert(&ht, hash(i), i);
+
+	size_t hits = 0;
+	for (hash_value_t i = 0; i < limits; i++) {
+		light_prefetch(&ht, hash(i));
+		if (!light_peek(&ht, hash(i), &val))
+			continue;
+		/* Hashes are unique, a hash match is a key match */
+		if (val != i || i % 2 != 0)
+			fail("peek returned a wrong value", "true");
+		hits++;
+	}
+	/* Most records are stored in their own slots */
+	if (hits < limits / 4)
+		fail("peek hit ratio is too low", "true");
+
+	light_destroy(&ht);
+
+	footer();
+}
+
 int
 main(int, const char**)
 {
@@ -326,6 +361,7 @@ main(int, const char**)
 	collision_test();
 	iterator_test();
 	iterator_freeze_check();
+	peek_test();
 	if (extents_count != 0)
 		fail("memory leak!", "true");
 }
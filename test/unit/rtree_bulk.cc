@@ -0,0 +1,246 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "unit.h"
+#include "salad/rtree.h"
+
+#include <vector>
+#include <set>
+using namespace std;
+
+const uint32_t extent_size = 1024 * 16;
+
+const coord_t SPACE_LIMIT = 100;
+const coord_t BOX_LIMIT = 10;
+const unsigned QUERY_COUNT = 200;
+
+static int page_count = 0;
+
+static void *
+extent_alloc(void *ctx)
+{
+	int *p_page_count = (int *)ctx;
+	assert(p_page_count == &page_count);
+	++*p_page_count;
+	return malloc(extent_size);
+}
+
+static void
+extent_free(void *ctx, void *page)
+{
+	int *p_page_count = (int *)ctx;
+	assert(p_page_count == &page_count);
+	--*p_page_count;
+	free(page);
+}
+
+static coord_t
+rand_coord(coord_t limit)
+{
+	return (coord_t)rand() * limit / RAND_MAX;
+}
+
+static void
+rand_rect(struct rtree_rect *rect, unsigned dimension)
+{
+	for (unsigned i = 0; i < dimension; i++) {
+		coord_t c = rand_coord(SPACE_LIMIT);
+		rect->coords[2 * i] = c;
+		rect->coords[2 * i + 1] = c + rand_coord(BOX_LIMIT);
+	}
+}
+
+static set<record_t>
+search(const struct rtree *tree, const struct rtree_rect *rect,
+       enum spatial_search_op op)
+{
+	set<record_t> result;
+	struct rtree_iterator iterator;
+	rtree_iterator_init(&iterator);
+	if (rtree_search(tree, rect, op, &iterator)) {
+		record_t rec;
+		while ((rec = rtree_iterator_next(&iterator)) != NULL)
+			result.insert(rec);
+	}
+	rtree_iterator_destroy(&iterator);
+	return result;
+}
+
+static void
+check_equal(const struct rtree *tree1, const struct rtree *tree2,
+	    unsigned dimension)
+{
+	static const enum spatial_search_op ops[] = {
+		SOP_OVERLAPS, SOP_BELONGS, SOP_CONTAINS,
+		SOP_STRICT_BELONGS, SOP_STRICT_CONTAINS,
+	};
+	if (rtree_number_of_records(tree1) != rtree_number_of_records(tree2))
+		fail("record count mismatch", "true");
+	struct rtree_rect all;
+	if (search(tree1, &all, SOP_ALL) != search(tree2, &all, SOP_ALL))
+		fail("SOP_ALL result mismatch", "true");
+	for (unsigned i = 0; i < QUERY_COUNT; i++) {
+		struct rtree_rect rect;
+		rand_rect(&rect, dimension);
+		for (unsigned j = 0; j < sizeof(ops) / sizeof(ops[0]); j++) {
+			if (search(tree1, &rect, ops[j]) !=
+			    search(tree2, &rect, ops[j]))
+				fail("search result mismatch", "true");
+		}
+	}
+}
+
+static void
+bulk_test(unsigned dimension, unsigned count)
+{
+	srand(count);
+	vector<struct rtree_rect> rects(count + 1);
+	for (unsigned i = 1; i <= count; i++)
+		rand_rect(&rects[i], dimension);
+
+	struct rtree tree, bulk_tree;
+	rtree_init(&tree, dimension, extent_size, extent_alloc, extent_free,
+		   &page_count, RTREE_EUCLID);
+	rtree_init(&bulk_tree, dimension, extent_size, extent_alloc,
+		   extent_free, &page_count, RTREE_EUCLID);
+
+	struct rtree_bulk bulk;
+	rtree_bulk_create(&bulk);
+	if (rtree_bulk_reserve(&bulk_tree, &bulk, count / 2) != 0)
+		fail("reserve failed", "true");
+	for (unsigned i = 1; i <= count; i++) {
+		rtree_insert(&tree, &rects[i], (record_t)(uintptr_t)i);
+		if (rtree_bulk_add(&bulk_tree, &bulk, &rects[i],
+				   (record_t)(uintptr_t)i) != 0)
+			fail("bulk add failed", "true");
+	}
+	rtree_bulk_load(&bulk_tree, &bulk);
+	if (bulk.count != 0)
+		fail("bulk buffer is not empty", "true");
+	rtree_bulk_destroy(&bulk);
+
+	check_equal(&tree, &bulk_tree, dimension);
+	/* A packed tree must not be larger than an incremental one */
+	if (rtree_used_size(&bulk_tree) > rtree_used_size(&tree))
+		fail("packed tree is larger", "true");
+
+	/* The packed tree must stay valid after modifications */
+	for (unsigned i = 1; i <= count; i += 2) {
+		if (!rtree_remove(&tree, &rects[i], (record_t)(uintptr_t)i) ||
+		    !rtree_remove(&bulk_tree, &rects[i],
+				  (record_t)(uintptr_t)i))
+			fail("remove failed", "true");
+	}
+	for (unsigned i = 1; i <= count; i += 2) {
+		rand_rect(&rects[i], dimension);
+		rtree_insert(&tree, &rects[i], (record_t)(uintptr_t)i);
+		rtree_insert(&bulk_tree, &rects[i], (record_t)(uintptr_t)i);
+	}
+	check_equal(&tree, &bulk_tree, dimension);
+
+	rtree_destroy(&tree);
+	rtree_destroy(&bulk_tree);
+}
+
+static void
+bulk_check()
+{
+	header();
+
+	static const unsigned dimensions[] = {1, 2, 3, 8};
+	static const unsigned counts[] = {0, 1, 2, 17, 100, 1000, 20000};
+	for (unsigned i = 0; i < sizeof(dimensions) / sizeof(*dimensions); i++) {
+		for (unsigned j = 0; j < sizeof(counts) / sizeof(*counts); j++) {
+			bulk_test(dimensions[i], counts[j]);
+		}
+		printf("dimension %u: ok\n", dimensions[i]);
+	}
+
+	footer();
+}
+
+/**
+ * Compare build and search time of incremental and packed trees.
+ * Run the test with "bench" argument to see the results.
+ */
+static void
+bulk_bench(unsigned count)
+{
+	const unsigned dimension = 2;
+	vector<struct rtree_rect> rects(count);
+	for (unsigned i = 0; i < count; i++)
+		rtree_set2dp(&rects[i], rand_coord(SPACE_LIMIT),
+			     rand_coord(SPACE_LIMIT));
+
+	struct rtree tree, bulk_tree;
+	rtree_init(&tree, dimension, extent_size, extent_alloc, extent_free,
+		   &page_count, RTREE_EUCLID);
+	rtree_init(&bulk_tree, dimension, extent_size, extent_alloc,
+		   extent_free, &page_count, RTREE_EUCLID);
+
+	clock_t start = clock();
+	for (unsigned i = 0; i < count; i++)
+		rtree_insert(&tree, &rects[i], (record_t)(uintptr_t)(i + 1));
+	double insert_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	struct rtree_bulk bulk;
+	rtree_bulk_create(&bulk);
+	rtree_bulk_reserve(&bulk_tree, &bulk, count);
+	for (unsigned i = 0; i < count; i++)
+		rtree_bulk_add(&bulk_tree, &bulk, &rects[i],
+			       (record_t)(uintptr_t)(i + 1));
+	rtree_bulk_load(&bulk_tree, &bulk);
+	rtree_bulk_destroy(&bulk);
+	double bulk_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	double search_time[2];
+	struct rtree *trees[2] = {&tree, &bulk_tree};
+	for (int t = 0; t < 2; t++) {
+		srand(0);
+		size_t found = 0;
+		struct rtree_iterator iterator;
+		rtree_iterator_init(&iterator);
+		start = clock();
+		for (unsigned i = 0; i < count / 10; i++) {
+			struct rtree_rect rect;
+			coord_t x = rand_coord(SPACE_LIMIT);
+			coord_t y = rand_coord(SPACE_LIMIT);
+			rtree_set2d(&rect, x, y, x + 1, y + 1);
+			if (!rtree_search(trees[t], &rect, SOP_OVERLAPS,
+					  &iterator))
+				continue;
+			while (rtree_iterator_next(&iterator) != NULL)
+				found++;
+		}
+		search_time[t] = (double)(clock() - start) / CLOCKS_PER_SEC;
+		rtree_iterator_destroy(&iterator);
+		(void)found;
+	}
+
+	printf("%u records\n", count);
+	printf("insert: build %.3f sec, search %.3f sec, %zu bytes\n",
+	       insert_time, search_time[0], rtree_used_size(&tree));
+	printf("bulk:   build %.3f sec, search %.3f sec, %zu bytes\n",
+	       bulk_time, search_time[1], rtree_used_size(&bulk_tree));
+
+	rtree_destroy(&tree);
+	rtree_destroy(&bulk_tree);
+}
+
+int
+main(int argc, char **argv)
+{
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		bulk_bench(1000000);
+		return 0;
+	}
+	bulk_check();
+	if (page_count != 0) {
+		fail("memory leak!", "true");
+	}
+}
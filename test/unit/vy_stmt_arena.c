@@ -0,0 +1,163 @@
+#include <string.h>
+
+#include "memory.h"
+#include "fiber.h"
+#include "unit.h"
+#include "box/vy_stmt_arena.h"
+
+enum {
+	STMT_SIZE = 1000,
+	STMT_MAX = 4096,
+};
+
+static void *stmts[STMT_MAX];
+static int stmt_count;
+
+/**
+ * Allocate statements until the arena switches to another slab.
+ * Return the index of the first statement of the new slab.
+ */
+static int
+fill_slab(struct vy_stmt_arena *arena)
+{
+	struct vy_stmt_slab *curr = arena->curr;
+	do {
+		fail_if(stmt_count >= STMT_MAX);
+		void *stmt = vy_stmt_arena_alloc(arena, STMT_SIZE);
+		fail_if(stmt == NULL);
+		stmts[stmt_count++] = stmt;
+	} while (arena->curr == curr);
+	return stmt_count - 1;
+}
+
+static void
+free_stmts(int begin, int end)
+{
+	for (int i = begin; i < end; i++)
+		vy_stmt_arena_free(stmts[i]);
+}
+
+static int
+test_slab_reuse(void)
+{
+	plan(4);
+	header();
+
+	struct vy_stmt_arena arena;
+	vy_stmt_arena_create(&arena);
+
+	void *a = vy_stmt_arena_alloc(&arena, 100);
+	void *b = vy_stmt_arena_alloc(&arena, 100);
+	ok(a != NULL && b != NULL && arena.slab_count == 1,
+	   "statements share a slab");
+	ok((char *) b >= (char *) a + 100, "statements don't overlap");
+
+	vy_stmt_arena_free(a);
+	vy_stmt_arena_free(b);
+	void *c = vy_stmt_arena_alloc(&arena, 100);
+	ok(c == a && arena.slab_count == 1,
+	   "empty slab is reused from the beginning");
+
+	vy_stmt_arena_free(c);
+	vy_stmt_arena_destroy(&arena);
+	ok(arena.slab_count == 0, "all slabs are freed");
+
+	footer();
+	return check_plan();
+}
+
+static int
+test_spare(void)
+{
+	plan(6);
+	header();
+
+	struct vy_stmt_arena arena;
+	vy_stmt_arena_create(&arena);
+	stmt_count = 0;
+
+	int s1 = fill_slab(&arena);
+	struct vy_stmt_slab *slab1 = arena.curr;
+	int s2 = fill_slab(&arena);
+	int s3 = fill_slab(&arena);
+	struct vy_stmt_slab *slab3 = arena.curr;
+	ok(arena.slab_count == 3 && arena.spare == NULL, "three slabs");
+
+	free_stmts(s1, s2);
+	ok(arena.spare == slab1 && arena.slab_count == 3,
+	   "drained slab is kept as spare");
+
+	free_stmts(s2, s3);
+	ok(arena.spare == slab1 && arena.slab_count == 2,
+	   "drained slab is freed if there is a spare one");
+
+	int s4 = fill_slab(&arena);
+	ok(arena.curr == slab1 && arena.spare == NULL &&
+	   arena.slab_count == 2, "spare slab is reused");
+
+	free_stmts(s3, s4);
+	ok(arena.spare == slab3 && arena.slab_count == 2,
+	   "previous slab becomes spare");
+
+	free_stmts(s4, stmt_count);
+	vy_stmt_arena_destroy(&arena);
+	ok(arena.slab_count == 0, "all slabs are freed");
+
+	footer();
+	return check_plan();
+}
+
+static int
+test_large_stmt(void)
+{
+	plan(5);
+	header();
+
+	struct vy_stmt_arena arena;
+	vy_stmt_arena_create(&arena);
+
+	void *small = vy_stmt_arena_alloc(&arena, 100);
+	struct vy_stmt_slab *slab = arena.curr;
+
+	uint32_t size = 2 * VY_STMT_SLAB_SIZE;
+	char *large = vy_stmt_arena_alloc(&arena, size);
+	ok(large != NULL, "statement larger than a slab is allocated");
+	memset(large, 'x', size);
+	ok(arena.curr != slab && arena.slab_count == 2,
+	   "it gets a slab of its own");
+
+	vy_stmt_arena_free(small);
+	ok(arena.spare == slab && arena.slab_count == 2,
+	   "previous slab becomes spare");
+
+	size = 3 * VY_STMT_SLAB_SIZE;
+	char *larger = vy_stmt_arena_alloc(&arena, size);
+	memset(larger, 'x', size);
+	ok(larger != NULL && arena.spare == slab && arena.slab_count == 3,
+	   "spare slab is not used if it is too small");
+
+	vy_stmt_arena_free(large);
+	vy_stmt_arena_free(larger);
+	vy_stmt_arena_destroy(&arena);
+	ok(arena.slab_count == 0, "all slabs are freed");
+
+	footer();
+	return check_plan();
+}
+
+int
+main(void)
+{
+	memory_init();
+	fiber_init(fiber_c_invoke);
+
+	plan(3);
+	test_slab_reuse();
+	test_spare();
+	test_large_stmt();
+	int rc = check_plan();
+
+	fiber_free();
+	memory_free();
+	return rc;
+}
@@ -0,0 +1,30 @@
+-- only vinyl supports the flag
+box.schema.space.create('test', {engine = 'memtx', defer_deletes = true})
+
+s = box.schema.space.create('test', {engine = 'vinyl', defer_deletes = true})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+s:replace{1, 10}
+s:replace{2, 20}
+s:replace{3, 30}
+box.snapshot()
+
+-- overwrite and delete without looking up old tuples
+s:replace{1, 11}
+s:replace{2, 20, 'x'}
+s:delete{3}
+pk:select()
+-- stale secondary entries are skipped on read
+sk:select()
+sk:select(10)
+sk:select(30)
+box.snapshot()
+sk:select()
+sk:select({}, {iterator = 'LE'})
+s:replace{3, 10}
+sk:select(10)
+sk:select()
+
+-- the flag can't be cleared, stale entries would become visible
+box.space._space:update(s.id, {{'=', 6, {defer_deletes = false}}})
+s:drop()
@@ -0,0 +1,184 @@
+test_run = require('test_run').new()
+txn_proxy = require('txn_proxy')
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk')
+for i = 1, 10 do s:replace{i} end
+box.snapshot()
+for i = 11, 20 do s:replace{i} end
+
+-- the range covers both disk and memory
+s:delete_range({3}, {15})
+pk:select()
+pk:get{3}
+pk:get{14}
+pk:get{15}
+pk:select({10}, {iterator = 'LE'})
+
+-- nil means infinity
+s:delete_range(nil, {2})
+s:delete_range({19})
+pk:select()
+
+-- empty range is a no-op
+s:delete_range({17}, {17})
+s:delete_range({18}, {16})
+pk:select()
+
+-- statements newer than the range survive
+s:replace{5}
+s:upsert({7, 1}, {{'+', 2, 1}})
+s:upsert({7, 1}, {{'+', 2, 1}})
+pk:select()
+
+-- the range survives dump and restart
+box.snapshot()
+pk:select()
+test_run:cmd('restart server default')
+txn_proxy = require('txn_proxy')
+s = box.space.test
+pk = s.index.pk
+pk:select()
+s:replace{3}
+box.snapshot()
+pk:select()
+
+-- a reader of the deleted range is sent to a read view
+c1 = txn_proxy.new()
+c1:begin()
+c1("s:get{15}")
+s:delete_range({15}, {17})
+c1("s:get{15}")
+c1("s:get{16}")
+c1:commit()
+pk:select()
+
+-- a reader that writes afterwards is aborted
+s:replace{15}
+c1:begin()
+c1("s:get{15}")
+s:delete_range({15}, {16})
+c1("s:replace{100}")
+c1:commit()
+pk:select()
+
+-- only autocommit mode is supported
+box.begin() s:delete_range({1}, {2})
+box.rollback()
+
+-- invalid keys
+s:delete_range({'a'}, {1})
+s:delete_range({1, 2}, {3})
+s:drop()
+
+-- keys are compared by the common prefix
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}})
+for i = 1, 2 do for j = 1, 3 do s:replace{i, j} end end
+s:delete_range({1}, {1, 3})
+s:delete_range({2, 2}, {2})
+pk:select()
+s:delete_range({1, 3}, {2, 2})
+pk:select()
+s:drop()
+
+-- an upsert dumped while a range is alive is turned into
+-- a replace only if it's known to be the first statement
+-- after the range
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {run_count_per_level = 10})
+s:replace{1, 1}
+box.snapshot()
+s:delete_range({1}, {10})
+s:replace{5, 1}
+box.snapshot()
+s:upsert({5, 100}, {{'+', 2, 1}})
+box.snapshot()
+pk:select()
+s:replace{6, 1}
+s:delete_range({6}, {7})
+s:upsert({6, 100}, {{'+', 2, 1}})
+box.snapshot()
+pk:select()
+s:drop()
+
+-- secondary indexes require defer_deletes
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}})
+s:replace{1, 10}
+s:delete_range({1}, {2})
+s:drop()
+
+s = box.schema.space.create('test', {engine = 'vinyl', defer_deletes = true})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+s:replace{1, 10}
+s:replace{2, 20}
+s:replace{3, 30}
+s:delete_range({2}, {3})
+pk:select()
+sk:select()
+s:drop()
+
+-- statements covered by a range are purged by compaction,
+-- then the range is deleted from the metadata log
+fiber = require('fiber')
+fio = require('fio')
+xlog = require('xlog')
+test_run:cmd("setopt delimiter ';'")
+function vylog_records(type)
+    local files = fio.glob(fio.pathjoin(box.cfg.vinyl_dir, '*.vylog'))
+    table.sort(files)
+    local count = 0
+    for _, row in xlog.pairs(files[#files]) do
+        if row.BODY.tuple[1] == type then
+            count = count + 1
+        end
+    end
+    return count
+end;
+test_run:cmd("setopt delimiter ''");
+VY_LOG_INSERT_TOMBSTONE = 8
+VY_LOG_DELETE_TOMBSTONE = 9
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {run_count_per_level = 2})
+for i = 1, 10 do s:replace{i} end
+box.snapshot()
+s:delete_range({3}, {8})
+s:replace{5, 5}
+box.snapshot()
+vylog_records(VY_LOG_INSERT_TOMBSTONE)
+s:replace{20}
+box.snapshot()
+while pk:info().run_count > 1 do fiber.sleep(0.01) end
+pk:select()
+vylog_records(VY_LOG_DELETE_TOMBSTONE)
+box.snapshot()
+vylog_records(VY_LOG_INSERT_TOMBSTONE)
+test_run:cmd('restart server default')
+s = box.space.test
+s:select()
+s:drop()
+
+-- statements covered by a range are not sent on initial join
+box.schema.user.grant('guest', 'read,write,execute', 'universe')
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk')
+for i = 1, 10 do s:replace{i} end
+box.snapshot()
+s:delete_range({3}, {8})
+s:delete_range({9})
+box.snapshot()
+_ = test_run:cmd("create server replica with rpl_master=default, script='vinyl/join_quota.lua'")
+_ = test_run:cmd("start server replica")
+_ = test_run:cmd('wait_lsn replica default')
+test_run:cmd('switch replica')
+box.space.test:select()
+test_run:cmd('switch default')
+_ = test_run:cmd("stop server replica")
+_ = test_run:cmd("cleanup server replica")
+s:drop()
+box.schema.user.revoke('guest', 'replication')
+box.schema.user.revoke('guest', 'read,write,execute', 'universe')
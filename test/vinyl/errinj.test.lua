@@ -270,3 +270,55 @@ c3:commit()
 errinj.set("ERRINJ_WAL_SHORT_DELAY", false)
 
 s:drop()
+
+--
+-- Writers are paced once the quota watermark is exceeded.
+-- Dumps fail, so memory isn't reclaimed until the error
+-- injection is cleared.
+--
+test_run:cmd("create server low_quota with script='vinyl/low_quota.lua'")
+test_run:cmd("start server low_quota")
+test_run:cmd('switch low_quota')
+fiber = require('fiber')
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk')
+box.error.injection.set('ERRINJ_VINYL_SCHED_TIMEOUT', 10)
+box.error.injection.set('ERRINJ_VY_RANGE_DUMP', true)
+pad = string.rep('x', 1000)
+ch = fiber.channel(1)
+_ = fiber.create(function() for i = 1, 2000 do s:replace{i, pad} fiber.sleep(0.001) end ch:put(true) end)
+function is_paced() return box.info.vinyl().performance.tx_throttle.max > 0 end
+for i = 1, 1000 do if is_paced() then break end fiber.sleep(0.01) end
+is_paced()
+box.error.injection.set('ERRINJ_VY_RANGE_DUMP', false)
+ch:get(60)
+s:count()
+test_run:cmd('switch default')
+test_run:cmd("stop server low_quota")
+test_run:cmd("cleanup server low_quota")
+
+--
+-- A range that is read is compacted before a range that is
+-- not, provided they have the same number of runs to compact.
+-- Reading pages is slowed down so that compaction of the cold
+-- range can't finish while we are waiting for the hot one.
+--
+hot = box.schema.space.create('hot', {engine = 'vinyl'})
+_ = hot:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}, run_count_per_level = 1})
+cold = box.schema.space.create('cold', {engine = 'vinyl'})
+_ = cold:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}, run_count_per_level = 1})
+hot:replace{1, 1}
+cold:replace{1, 1}
+box.snapshot()
+-- Lookups by a partial key search all runs.
+for i = 2, 101 do hot:select{i} end
+hot:replace{2, 1}
+cold:replace{2, 1}
+errinj.set('ERRINJ_VY_READ_PAGE_TIMEOUT', true)
+box.snapshot()
+while hot.index.pk:info().run_count > 1 do fiber.sleep(0.01) end
+cold.index.pk:info().run_count
+errinj.set('ERRINJ_VY_READ_PAGE_TIMEOUT', false)
+while cold.index.pk:info().run_count > 1 do fiber.sleep(0.01) end
+hot:drop()
+cold:drop()
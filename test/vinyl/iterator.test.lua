@@ -680,3 +680,77 @@ iterator_next(itr)
 s:select{1}
 
 s:drop()
+
+--
+-- Search in a page compares the key with raw statements: full
+-- tuples and DELETE keys of the primary index with parts out of
+-- the field order, keys of the secondary index.
+--
+s = box.schema.space.create('test', { engine = 'vinyl' })
+pk = s:create_index('primary', { parts = { 3, 'unsigned', 1, 'string' }, page_size = 256 })
+sk = s:create_index('secondary', { parts = { 2, 'unsigned' }, page_size = 256 })
+for i = 1, 200 do s:replace{tostring(i % 10), i * 2, math.floor(i / 10)} end
+box.snapshot()
+for i = 1, 200, 7 do s:delete{math.floor(i / 10), tostring(i % 10)} end
+box.snapshot()
+s:get{5, '3'}
+s:get{0, '1'}
+sk:get{106}
+sk:get{16}
+#pk:select({5}, {iterator = 'GE'})
+#pk:select({5}, {iterator = 'GT'})
+#pk:select({5, '3'}, {iterator = 'LE'})
+#sk:select({100}, {iterator = 'LT'})
+#sk:select({100}, {iterator = 'GE'})
+s:drop()
+
+--
+-- Merge of many runs: compare with a memtx space.
+--
+s = box.schema.space.create('test', { engine = 'vinyl' })
+pk = s:create_index('primary', { run_count_per_level = 100 })
+m = box.schema.space.create('mirror', { engine = 'memtx' })
+_ = m:create_index('primary')
+test_run:cmd("setopt delimiter ';'")
+function apply(op, key, val)
+    for _, space in ipairs({s, m}) do
+        if op == 'replace' then
+            space:replace{key, val}
+        elseif op == 'delete' then
+            space:delete{key}
+        else
+            space:upsert({key, val}, {{'+', 2, val}})
+        end
+    end
+end;
+function equal(key, opts)
+    local a = s:select(key, opts)
+    local b = m:select(key, opts)
+    if #a ~= #b then
+        return false
+    end
+    for i = 1, #a do
+        if a[i][1] ~= b[i][1] or a[i][2] ~= b[i][2] then
+            return false
+        end
+    end
+    return true
+end;
+for run = 1, 8 do
+    for key = run, 200, run do
+        local op = ({'replace', 'delete', 'upsert'})[(key + run) % 3 + 1]
+        apply(op, key, run)
+    end
+    box.snapshot()
+end;
+-- the last changes stay in memory
+for key = 1, 200, 9 do apply('upsert', key, 100) end;
+test_run:cmd("setopt delimiter ''");
+equal({}, {iterator = 'GE'})
+equal({}, {iterator = 'LE'})
+equal({50}, {iterator = 'GT'})
+equal({50}, {iterator = 'LT'})
+equal({150}, {iterator = 'GE', limit = 10})
+equal({151}, {iterator = 'LE', limit = 10})
+s:drop()
+m:drop()
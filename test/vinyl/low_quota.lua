@@ -0,0 +1,8 @@
+#!/usr/bin/env tarantool
+
+box.cfg({
+    listen                    = os.getenv("LISTEN"),
+    vinyl_memory              = 1024 * 1024,
+})
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,63 @@
+-- statements sharing long key prefixes are read from
+-- prefix-compressed pages in any direction
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {parts = {1, 'string', 2, 'unsigned'}, page_size = 512})
+sk = s:create_index('sk', {parts = {2, 'unsigned'}})
+prefix = 'a long common prefix of all keys in the space'
+for i = 1, 100 do s:replace{prefix, i, string.rep('x', i % 7)} end
+box.snapshot()
+
+#pk:select{}
+#pk:select({prefix, 50}, {iterator = 'GE'})
+#pk:select({prefix, 50}, {iterator = 'GT'})
+#pk:select({prefix, 50}, {iterator = 'LE'})
+#pk:select({prefix, 50}, {iterator = 'LT'})
+#pk:select({prefix}, {iterator = 'EQ'})
+pk:get{prefix, 17}
+pk:get{prefix, 101}
+pk:select({prefix, 33}, {iterator = 'LE', limit = 3})
+pk:select({prefix, 62}, {iterator = 'GT', limit = 2})
+sk:select({20}, {iterator = 'LT', limit = 2})
+sk:get{16}
+
+-- upserts and deletes
+sk:drop()
+s:upsert({prefix, 200, ''}, {{'=', 3, 'y'}})
+s:delete{prefix, 40}
+box.snapshot()
+s:upsert({prefix, 200, ''}, {{'=', 3, 'y'}})
+box.snapshot()
+pk:get{prefix, 200}
+pk:get{prefix, 40}
+#pk:select{}
+s:drop()
+
+-- pages written by older versions, one xrow per statement,
+-- are still readable
+errinj = box.error.injection
+xlog = require('xlog')
+function is_xrow(path) for _, row in xlog.pairs(path) do if row.HEADER.type == 'PAGEINFO' and row.BODY.version ~= nil then return false end end return true end
+function all_pages_xrow() local count, xrow = 0, 0 for _, path in ipairs(box.backup.start()) do if path:match('/' .. s.id .. '/') and path:match('%.index$') then count = count + 1 xrow = xrow + (is_xrow(path) and 1 or 0) end end box.backup.stop() return count > 0 and xrow == count end
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {parts = {1, 'string', 2, 'unsigned'}, page_size = 512})
+sk = s:create_index('sk', {parts = {2, 'unsigned'}})
+errinj.set('ERRINJ_VY_RUN_WRITE_XROW', true)
+for i = 1, 100 do s:replace{prefix, i, string.rep('x', i % 7)} end
+s:upsert({prefix, 200, ''}, {{'=', 3, 'y'}})
+box.snapshot()
+errinj.set('ERRINJ_VY_RUN_WRITE_XROW', false)
+all_pages_xrow()
+#pk:select{}
+#pk:select({prefix, 50}, {iterator = 'LE'})
+pk:get{prefix, 17}
+pk:get{prefix, 200}
+pk:select({prefix, 33}, {iterator = 'LE', limit = 3})
+sk:select({20}, {iterator = 'LT', limit = 2})
+-- merged with a run of the current format
+for i = 1, 100, 2 do s:replace{prefix, i, 'y'} end
+box.snapshot()
+#pk:select{}
+pk:get{prefix, 17}
+pk:get{prefix, 18}
+sk:select({20}, {iterator = 'LT', limit = 2})
+s:drop()
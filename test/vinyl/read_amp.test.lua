@@ -0,0 +1,34 @@
+test_run = require('test_run').new()
+
+--
+-- Per-range read statistics reported by index:info().
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}, run_count_per_level = 10})
+
+function read_stat() local info = pk:info() return {info.lookup_count, info.run_lookup_count, info.bloom_reflect_count, info.read_amp_histogram} end
+
+read_stat()
+
+-- Make three runs.
+s:replace{1, 1}
+box.snapshot()
+s:replace{2, 1}
+box.snapshot()
+s:replace{3, 1}
+box.snapshot()
+pk:info().run_count
+
+-- Lookups by a partial key can't use bloom filters
+-- and so have to search all runs.
+for i = 5, 14 do s:select{i} end
+read_stat()
+
+-- A lookup by a full key either searches a run or is
+-- filtered out by its bloom filter.
+for i = 15, 24 do s:select{i, 1} end
+info = pk:info()
+info.lookup_count
+info.run_lookup_count + info.bloom_reflect_count
+
+s:drop()
@@ -33,3 +33,42 @@ vyinfo().range_count
 for i=1,100 do box.space.vinyl:replace({i}) end
 
 space:drop()
+
+--
+-- A big range is split in several ranges at once, the new ranges
+-- are written by parallel tasks.
+--
+digest = require('digest')
+space = box.schema.space.create("vinyl", { engine = 'vinyl' })
+_= space:create_index('primary', { parts = { 1, 'unsigned' }, run_count_per_level = 1 })
+
+pad_size = vyinfo().page_size / 2
+keys_per_dump = 2 * math.ceil(vyinfo().range_size / pad_size + 1)
+
+test_run:cmd("setopt delimiter ';'")
+function dump(r)
+    for i=1,keys_per_dump do
+        space:replace({(r - 1) * keys_per_dump + i, digest.urandom(pad_size)})
+    end
+    box.snapshot()
+end;
+test_run:cmd("setopt delimiter ''");
+
+-- The first compaction, too early to split.
+dump(1)
+dump(2)
+while vyinfo().run_count > 1 do fiber.sleep(0.01) end
+-- Major compaction of a range about 4 * range_size.
+dump(3)
+dump(4)
+while vyinfo().range_count < 2 do fiber.sleep(0.01) end
+while vyinfo().run_count ~= vyinfo().range_count do fiber.sleep(0.01) end
+
+vyinfo().range_count > 2
+space:count() == 4 * keys_per_dump
+space:get(1)[1]
+space:get(4 * keys_per_dump)[1] == 4 * keys_per_dump
+#space:select({}, {limit = 10, iterator = 'GT'})
+#space:select({2 * keys_per_dump}, {iterator = 'GE'}) == 2 * keys_per_dump + 1
+
+space:drop()
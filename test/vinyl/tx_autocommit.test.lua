@@ -0,0 +1,47 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+--
+-- Reads of autocommit statements are added to read sets
+-- only when the fiber yields. Check that conflicts with
+-- concurrent transactions are still detected.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk')
+
+-- The key read by the statement is overwritten by a transaction
+-- prepared while the statement is yielding.
+ch = fiber.channel(1)
+done = false
+f = fiber.create(function() ch:get() s:replace{1, 'other'} done = true end)
+function on_replace(old, new) if new[2] == 'autocommit' then ch:put(true) while not done do fiber.sleep(0.001) end end end
+_ = s:on_replace(on_replace)
+s:insert{1, 'autocommit'}
+s:on_replace(nil, on_replace)
+s:get{1}
+
+-- The key read by the statement is overwritten by a transaction
+-- prepared in a fiber started from an on_replace trigger, i.e.
+-- without a yield.
+nested = false
+function on_replace() if not nested then nested = true fiber.create(function() s:replace{2, 'nested'} end) end end
+_ = s:on_replace(on_replace)
+s:insert{2, 'autocommit'}
+s:on_replace(nil, on_replace)
+s:get{2}
+
+-- Same as above, but the statement yields after the nested
+-- transaction has been prepared.
+nested = false
+function on_replace() if not nested then nested = true fiber.create(function() s:replace{4, 'nested'} end) fiber.sleep(0.001) end end
+_ = s:on_replace(on_replace)
+s:insert{4, 'autocommit'}
+s:on_replace(nil, on_replace)
+s:get{4}
+
+-- No conflict.
+s:insert{3, 'autocommit'}
+s:insert{3, 'autocommit'}
+s:select()
+
+s:drop()
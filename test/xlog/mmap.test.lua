@@ -0,0 +1,42 @@
+env = require('test_run').new()
+digest = require('digest')
+fio = require('fio')
+xlog = require('xlog').pairs
+
+--
+-- Complete xlog files bigger than 1 MB are mapped into memory
+-- and uncompressed rows are decoded in place. Rows are big and
+-- incompressible, so that a WAL of 10 rows (rows_per_wal) is
+-- big enough and stores rows as is.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+for i = 1, 30 do local data = digest.urandom(128 * 1024) s:insert({i, data, digest.md5_hex(data)}) end
+env:cmd('restart server default')
+s = box.space.test
+s:count()
+bad = 0
+for _, t in s:pairs() do if digest.md5_hex(t[2]) ~= t[3] then bad = bad + 1 end end
+bad
+
+env:cmd("setopt delimiter ';'")
+function count_rows()
+    local count = 0
+    local files = fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog'))
+    for _, file in ipairs(files) do
+        for _, row in xlog(file) do
+            if row.BODY ~= nil and row.BODY.space_id == s.id then
+                count = count + 1
+            end
+        end
+    end
+    return count
+end;
+env:cmd("setopt delimiter ''");
+count_rows()
+
+-- The current WAL is being appended and is read with pread().
+for i = 31, 35 do local data = digest.urandom(128 * 1024) s:insert({i, data, digest.md5_hex(data)}) end
+count_rows()
+
+s:drop()
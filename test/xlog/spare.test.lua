@@ -0,0 +1,46 @@
+env = require('test_run').new()
+fio = require('fio')
+fiber = require('fiber')
+
+--
+-- The next WAL file is created in advance under the name
+-- spare.xlog.inprogress and renamed on rotation. The spare
+-- file must look empty and must never be read as a WAL.
+--
+spare = fio.pathjoin(box.cfg.wal_dir, 'spare.xlog.inprogress')
+function spare_size() local st = fio.stat(spare) return st and st.size end
+function wait_spare() for i = 1, 100 do if spare_size() ~= nil then break end fiber.sleep(0.01) end return spare_size() end
+function xlog_count() return #fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog')) end
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+wait_spare()
+-- the spare file is taken on rotation and a new one is created
+count = xlog_count()
+for i = 1, 10 do s:insert{i} end
+xlog_count() - count
+wait_spare()
+-- the spare file is removed on shutdown
+env:cmd('restart server default')
+fio = require('fio')
+fiber = require('fiber')
+spare = fio.pathjoin(box.cfg.wal_dir, 'spare.xlog.inprogress')
+function spare_size() local st = fio.stat(spare) return st and st.size end
+function wait_spare() for i = 1, 100 do if spare_size() ~= nil then break end fiber.sleep(0.01) end return spare_size() end
+spare_size()
+box.space.test:count()
+-- a spare file left after a crash is ignored by recovery
+-- and truncated when the next spare file is created
+f = fio.open(spare, {'O_WRONLY', 'O_CREAT'}, tonumber('0644', 8))
+f:write('garbage')
+f:close()
+env:cmd('restart server default')
+fio = require('fio')
+fiber = require('fiber')
+spare = fio.pathjoin(box.cfg.wal_dir, 'spare.xlog.inprogress')
+function spare_size() local st = fio.stat(spare) return st and st.size end
+function wait_size(size) for i = 1, 100 do if spare_size() == size then break end fiber.sleep(0.01) end return spare_size() end
+spare_size()
+box.space.test:count()
+box.space.test:insert{11}
+wait_size(0)
+box.space.test:drop()